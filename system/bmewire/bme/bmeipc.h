@@ -0,0 +1,128 @@
+/*!
+ * @file bmeipc.h
+ * @brief BME client definitions for builds without the bmeipc package
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+/*
+ * Only on the include path when bmeipc is not available. QmBattery then
+ * talks to the battery simulator only, which is built against the same
+ * definitions, so the values need not match those of BME. The bmeipc_*
+ * functions are left out on purpose, see HAVE_BMEIPC.
+ */
+
+#ifndef BMEWIRE_BMEIPC_H
+#define BMEWIRE_BMEIPC_H
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#define BMEIPC_MQNAME "/bmeipc"
+
+/* Fields of bmestat_t */
+enum
+{
+    CHARGER_STATE,
+    CHARGER_TYPE,
+    CHARGING_STATE,
+    CHARGING_TYPE,
+    CHARGING_TIME,       /* min */
+    BATTERY_STATE,
+    BATTERY_LEVEL_NOW,   /* bars */
+    BATTERY_LEVEL_MAX,
+    BATTERY_LEVEL_PCT,
+    BATTERY_CAPA_NOW,    /* mAh */
+    BATTERY_CAPA_MAX,
+    BATTERY_VOLT_NOW,    /* mV */
+    BATTERY_CURRENT,     /* mA */
+    BATTERY_TEMP,        /* K */
+    BATTERY_CONDITION,
+    COULOMB_COUNTER,     /* mAh */
+    BMESTAT_COUNT
+};
+
+typedef int32_t bmestat_t[BMESTAT_COUNT];
+
+enum
+{
+    CHARGER_TYPE_NONE,
+    CHARGER_TYPE_USBWALL,
+    CHARGER_TYPE_USB500MA,
+    CHARGER_TYPE_USB100MA,
+    CHARGER_TYPE_DYNAMO,
+    CHARGER_TYPE_ERROR
+};
+
+enum
+{
+    CHARGING_STATE_STOPPED,
+    CHARGING_STATE_STARTED,
+    CHARGING_STATE_ERROR
+};
+
+enum
+{
+    BATTERY_STATE_EMPTY,
+    BATTERY_STATE_LOW,
+    BATTERY_STATE_OK,
+    BATTERY_STATE_FULL,
+    BATTERY_STATE_ERROR
+};
+
+enum
+{
+    BATTERY_CONDITION_UNKNOWN,
+    BATTERY_CONDITION_GOOD,
+    BATTERY_CONDITION_POOR
+};
+
+/* Event masks, as returned by bmeipc_eread() */
+#define BMEVENT_ERROR   (-1)
+#define BMEVENT_CHARGER (1 << 0)
+#define BMEVENT_CHARGE  (1 << 1)
+#define BMEVENT_BATMON  (1 << 2)
+
+/* Header of every query */
+typedef struct
+{
+    int32_t type;
+    int32_t subtype;
+} bmeipc_msg_t;
+
+enum
+{
+    MEASUREMENTS_OFF,
+    MEASUREMENTS_ON,
+    MEASUREMENTS_ERROR
+};
+
+/* One message on BMEIPC_MQNAME */
+typedef struct
+{
+    int32_t state;
+    struct timeval timestamp;
+    int32_t bat_current;   /* mA */
+    int32_t bat_voltage;   /* mV */
+    int32_t bat_temp;      /* K */
+} bmeipc_meas_t;
+
+#endif /* BMEWIRE_BMEIPC_H */
@@ -0,0 +1,32 @@
+/*!
+ * @file bmemsg.h
+ * @brief BME message types for builds without the bmeipc package
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef BMEWIRE_BMEMSG_H
+#define BMEWIRE_BMEMSG_H
+
+/* bmeipc_msg_t types, the reply to GETSTAT is a bmestat_t */
+#define BME_SYSMSG_GETSTAT 0x0100
+
+#endif /* BMEWIRE_BMEMSG_H */
@@ -0,0 +1,58 @@
+/*!
+ * @file em_isi.h
+ * @brief BME measurement messages for builds without the bmeipc package
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef BMEWIRE_EM_ISI_H
+#define BMEWIRE_EM_ISI_H
+
+#include <stdint.h>
+
+/* Type of a measurement request, distinct from the bmemsg.h types */
+#define EM_MEASUREMENT_REQ 0x0200
+
+#define EM_MEASUREMENT_ACTION_START 1
+#define EM_MEASUREMENT_ACTION_STOP  2
+
+#define EM_MEASUREMENT_TYPE_CURRENT 1
+
+#define EM_MEASUREMENT_PERIOD_250MS 1
+#define EM_MEASUREMENT_PERIOD_1S    2
+#define EM_MEASUREMENT_PERIOD_5S    3
+
+/* Followed by channel_count elements, each sent as a query of its own */
+struct emsg_measurement_req
+{
+    int32_t type;
+    int32_t subtype;
+    int32_t measurement_action;
+    int32_t channel_count;
+};
+
+struct emsg_measurement_req_elem
+{
+    int32_t type;
+    int32_t period;
+};
+
+#endif /* BMEWIRE_EM_ISI_H */
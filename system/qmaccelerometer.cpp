@@ -34,6 +34,7 @@ namespace MeeGo {
     {
         QmAccelerometerPrivate *priv = new QmAccelerometerPrivate(this);
         connect(priv, SIGNAL(dataAvailable(MeeGo::QmAccelerometerReading)), this, SIGNAL(dataAvailable(MeeGo::QmAccelerometerReading)));
+        connect(priv, SIGNAL(dataAvailable(QVector<MeeGo::QmAccelerometerReading>)), this, SIGNAL(dataAvailable(QVector<MeeGo::QmAccelerometerReading>)));
         priv_ptr = priv;
     }
 
@@ -41,4 +42,16 @@ namespace MeeGo {
     {
 
     }
+
+    void QmAccelerometer::setBatchSize(int samples, int timeout)
+    {
+        QmAccelerometerPrivate *priv = reinterpret_cast<QmAccelerometerPrivate*>(priv_ptr);
+        priv->setBatch(samples, timeout);
+    }
+
+    int QmAccelerometer::batchSize()
+    {
+        QmAccelerometerPrivate *priv = reinterpret_cast<QmAccelerometerPrivate*>(priv_ptr);
+        return priv->batchSize();
+    }
 }
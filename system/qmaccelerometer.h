@@ -32,6 +32,7 @@
 
 #include "system_global.h"
 #include <QtCore/qobject.h>
+#include <QtCore/qvector.h>
 #include <qmsensor.h>
 
 QT_BEGIN_HEADER
@@ -113,6 +114,26 @@ namespace MeeGo {
          */
         ~QmAccelerometer();
 
+        /**
+         * Switches between per-reading and batched delivery. In batch mode
+         * readings are collected and delivered through
+         * dataAvailable(const QVector<MeeGo::QmAccelerometerReading>&) once \c samples
+         * readings have been collected, or \c timeout milliseconds after the
+         * first of them arrived, whichever comes first. The per-reading
+         * signal is not emitted in batch mode. Readings still pending are
+         * delivered when the sensor is stopped.
+         *
+         * @param samples Readings per batch, 0 or 1 for per-reading delivery
+         * @param timeout Maximum delivery delay in milliseconds, 0 for none
+         */
+        void setBatchSize(int samples, int timeout = 0);
+
+        /**
+         * Returns the number of readings per batch.
+         * @return Readings per batch, 0 for per-reading delivery
+         */
+        int batchSize();
+
     Q_SIGNALS:
         /**
          * Signals the availability of new measurement data from the sensor.
@@ -120,10 +141,18 @@ namespace MeeGo {
          */
         void dataAvailable(const MeeGo::QmAccelerometerReading& data);
 
+        /**
+         * Signals a batch of measurement data, see setBatchSize().
+         * @param data Readings in the order of measurement (mG)
+         */
+        void dataAvailable(const QVector<MeeGo::QmAccelerometerReading>& data);
+
     };
 
 } // MeeGo namespace
 
+Q_DECLARE_TYPEINFO(MeeGo::QmAccelerometerReading, Q_PRIMITIVE_TYPE);
+
 QT_END_HEADER
 
 #endif
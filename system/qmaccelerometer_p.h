@@ -31,11 +31,24 @@
 
 #include "qmaccelerometer.h"
 #include "qmsensor_p.h"
+#include "qmsensorkernels_p.h"
 #include "sensord/accelerometersensor_i.h"
 #include "sensord/sensormanagerinterface.h"
 
 namespace MeeGo
 {
+    template <>
+    struct QmSensorChannels<QmAccelerometerReading>
+    {
+        enum { Count = 3 };
+        static int& at(QmAccelerometerReading& reading, int i)
+        {
+            return i == 0 ? reading.x : i == 1 ? reading.y : reading.z;
+        }
+        static int period(int) { return 0; }
+        static int lowest(int) { return 0; }
+    };
+
     class QmAccelerometerPrivate : public QmSensorPrivate
     {
         Q_OBJECT;
@@ -54,12 +67,17 @@ namespace MeeGo
             closeSession();
         }
 
+        const char* sensorId()
+        {
+            return "accelerometersensor";
+        }
+
         bool init()
         {
             qDBusRegisterMetaType<XYZ>();
             SensorManagerInterface& remoteSensorManager = SensorManagerInterface::instance();
-            remoteSensorManager.loadPlugin("accelerometersensor");
-            remoteSensorManager.registerSensorInterface<AccelerometerSensorChannelInterface>("accelerometersensor");
+            remoteSensorManager.loadPlugin(sensorId());
+            remoteSensorManager.registerSensorInterface<AccelerometerSensorChannelInterface>(sensorId());
             initDone_ = true;
             return true;
         }
@@ -67,30 +85,30 @@ namespace MeeGo
         AbstractSensorChannelInterface* controlSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return AccelerometerSensorChannelInterface::controlInterface("accelerometersensor");
+            return AccelerometerSensorChannelInterface::controlInterface(sensorId());
         }
 
         const AbstractSensorChannelInterface* listenSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return AccelerometerSensorChannelInterface::listenInterface("accelerometersensor");
+            return AccelerometerSensorChannelInterface::listenInterface(sensorId());
         }
 
         bool setupSignals(bool setOn)
         {
-            MEEGO_PUBLIC(QmAccelerometer);
-            if(!pub->verifySessionLevel(QmSensor::SessionTypeListen)) {
+            if (source() == NULL) {
+                setError("No session open, unable to (dis)connect signals.");
                 return false;
             }
             if (setOn) {
-                if (!connect(sensorIfc, SIGNAL(dataAvailable(const XYZ)), this, SLOT(slotDataAvailable(XYZ))))
+                if (!connect(source(), SIGNAL(dataAvailable(const XYZ)), this, SLOT(slotDataAvailable(XYZ))))
 
                 {
                     setError("Unable to connect signals");
                     return false;
                 }
             } else {
-                if (!disconnect(sensorIfc, SIGNAL(dataAvailable(const XYZ)), this, SLOT(slotDataAvailable(XYZ))))
+                if (!disconnect(source(), SIGNAL(dataAvailable(const XYZ)), this, SLOT(slotDataAvailable(XYZ))))
                 {
                     setError("Unable to disconnect signals");
                     return false;
@@ -99,22 +117,65 @@ namespace MeeGo
             return true;
         }
 
-    Q_SIGNALS:
+        /**
+         * Converts a sensord reading, turning the x and y axes from the
+         * sensor to the device.
+         */
+        static QmAccelerometerReading convert(const XYZ& data)
+        {
+            QmAccelerometerReading output;
+            output.timestamp = data.XYZData().timestamp_;
+            output.x = data.x();
+            output.y = data.y();
+            output.z = data.z();
+            kernelAccelerometerAxes(&output.x, &output.y, 1);
+            return output;
+        }
+
+    protected:
+        void reserveBatch(int samples)
+        {
+            batch_.reserve(samples);
+        }
+
+        void flushBatch()
+        {
+            if (!batch_.isEmpty()) {
+                filter(batch_.data(), batch_.count());
+                emit dataAvailable(batch_.readings());
+                batch_.clear();
+            }
+        }
 
+    Q_SIGNALS:
         void dataAvailable(const MeeGo::QmAccelerometerReading& data);
+        void dataAvailable(const QVector<MeeGo::QmAccelerometerReading>& data);
 
     public Q_SLOTS:
 
         void slotDataAvailable(const XYZ& data)
         {
-            QmAccelerometerReading output;
-            output.timestamp = data.XYZData().timestamp_;
-            output.x = -data.y();
-            output.y = data.x();
-            output.z = data.z();
+            QmSensorProbe probe(meter_, data.XYZData().timestamp_);
+            QmAccelerometerReading output = convert(data);
+            if (!decimate(decimator_, output)) {
+                return;
+            }
 
-            emit dataAvailable(output);
+            // Batches are filtered as a whole when they are delivered
+            if (batching() && !ring_.isOpen()) {
+                batchAppended(batch_.append(output));
+                return;
+            }
+
+            filter(&output, 1);
+            if (!consume(output)) {
+                emit dataAvailable(output);
+            }
         }
+
+    private:
+        QmSensorDecimator<QmAccelerometerReading> decimator_;
+        QmSensorBatch<QmAccelerometerReading> batch_;
     };
 }
 #endif // QMACCELEROMETER_P_H
@@ -45,12 +45,15 @@ namespace MeeGo {
 
     QmAlsReading QmALS::get()
     {
+        QmALSPrivate *priv = reinterpret_cast<QmALSPrivate*>(priv_ptr);
+        QmAlsReading output;
+        if (priv->cached(priv->cache, &output)) {
+            return output;
+        }
         if(!verifySessionLevel(QmSensor::SessionTypeListen)) {
             return QmAlsReading();
         }
-        QmALSPrivate *priv = reinterpret_cast<QmALSPrivate*>(priv_ptr);
         Unsigned value = priv->sensorIfc->lux();
-        QmAlsReading output;
         output.value = value.UnsignedData().value_;
         output.timestamp = value.UnsignedData().timestamp_;
         return output;
@@ -52,12 +52,17 @@ namespace MeeGo
             closeSession();
         }
 
+        const char* sensorId()
+        {
+            return "alssensor";
+        }
+
         bool init()
         {
             qDBusRegisterMetaType<Unsigned>();
             SensorManagerInterface& remoteSensorManager = SensorManagerInterface::instance();
-            remoteSensorManager.loadPlugin("alssensor");
-            remoteSensorManager.registerSensorInterface<ALSSensorChannelInterface>("alssensor");
+            remoteSensorManager.loadPlugin(sensorId());
+            remoteSensorManager.registerSensorInterface<ALSSensorChannelInterface>(sensorId());
             initDone_ = true;
             return true;
         }
@@ -65,25 +70,25 @@ namespace MeeGo
         AbstractSensorChannelInterface* controlSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return ALSSensorChannelInterface::controlInterface("alssensor");
+            return ALSSensorChannelInterface::controlInterface(sensorId());
         }
 
         const AbstractSensorChannelInterface* listenSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return ALSSensorChannelInterface::listenInterface("alssensor");
+            return ALSSensorChannelInterface::listenInterface(sensorId());
         }
 
         bool setupSignals(bool setOn)
         {
-            if (sensorIfc == NULL) {
+            if (source() == NULL) {
                 setError("No session open, unable to (dis)connect signals.");
                 return false;
             }
 
             if (setOn) {
 
-                if (!connect(sensorIfc, SIGNAL(ALSChanged(const Unsigned&)),
+                if (!connect(source(), SIGNAL(ALSChanged(const Unsigned&)),
                              this, SLOT(slotALSChanged(const Unsigned&))))
                 {
                     setError("Unable to connect signals");
@@ -91,7 +96,7 @@ namespace MeeGo
                 }
 
             } else {
-                if (!disconnect(sensorIfc, SIGNAL(ALSChanged(const Unsigned&)),
+                if (!disconnect(source(), SIGNAL(ALSChanged(const Unsigned&)),
                                 this, SLOT(slotALSChanged(const Unsigned&))))
                 {
                     setError("Unable to disconnect signals");
@@ -102,16 +107,27 @@ namespace MeeGo
             return true;
         }
 
+        void clearCache()
+        {
+            cache.clear();
+        }
+
+        QmSensorCache<QmAlsReading> cache;
+
     Q_SIGNALS:
         void ALSChanged(const MeeGo::QmAlsReading data);
 
     public Q_SLOTS:
         void slotALSChanged(const Unsigned& value)
         {
+            QmSensorProbe probe(meter_, value.UnsignedData().timestamp_);
             QmAlsReading output;
             output.timestamp = value.UnsignedData().timestamp_;
             output.value = value.UnsignedData().value_;
-            emit ALSChanged(output);
+            cache.store(output);
+            if (!consume(output)) {
+                emit ALSChanged(output);
+            }
         }
     };
 
@@ -33,10 +33,10 @@
 
 #include "qmbattery.h"
 #include "qmbattery_p.h"
+#include "qmbatterybackend_p.h"
+#include "qmbatteryenergy_p.h"
+#include "qmbatteryhistory_p.h"
 
-#include <QDBusMetaType>
-#include <QDBusInterface>
-#include <QDBusReply>
 #include <QDebug>
 #include <QSocketNotifier>
 #include <QTimer>
@@ -52,26 +52,12 @@ extern "C" {
 #define BMECLI_TIMEOUT 3000  /* ms */
 #define BMECURRENT_TIMEOUT 5010
 #define STAT_EXPIRATION_TIMEOUT 5 /* seconds */
+#define CHARGER_SETTLE_TIMEOUT 4000 /* ms */
 
 #define DEFAULT_TALK_CURRENT   300 /* mA */
 #define DEFAULT_ACTIVE_CURRENT 150 /* mA */
 #define DEFAULT_IDLE_CURRENT     6 /* mA */
 
-/**
- * The use time D-Bus interface copied from usetime/dbus.h as a workaround to a
- * circular build time dependency between qmsystem2 and usetime.
- */
-
-#define USETIME_SERVICE "com.nokia.usetime"
-#define USETIME_IF "com.nokia.usetime"
-#define USETIME_PATH "/com/nokia/usetime"
-
-#define USETIME_MODE_IDLE   1
-#define USETIME_MODE_ACTIVE 2
-#define USETIME_MODE_TALK   3
-
-#define USETIME_METHOD_GET_CURRENT "getCurrent"
-
 
 #define dbg(a) qDebug() << __PRETTY_FUNCTION__ << ": " << a
 
@@ -142,7 +128,7 @@ public:
 	int tries = 0;
 	while (true) {
 	    tries++;
-	    if (::bmeipc_query(sd_, msg1, len1, msg2, len2) >= 0)
+	    if (EmBackend::instance()->query(sd_, msg1, len1, msg2, len2) >= 0)
 		return true;
 	    if (errno == EIO)
 		restart_count_++;
@@ -164,12 +150,12 @@ private:
 
     inline void open_()
     {
-        sd_ = ::bmeipc_open();
+        sd_ = EmBackend::instance()->open();
     }
 
     inline void close_()
     {
-        ::bmeipc_close(sd_);
+        EmBackend::instance()->close(sd_);
         sd_ = -1;
     }
 
@@ -196,7 +182,7 @@ public:
             return BMEVENT_ERROR;
         }
 
-        int res = ::bmeipc_eread(sd_);
+        int res = EmBackend::instance()->eread(sd_);
         if (res == BMEVENT_ERROR) {
             qDebug() << "bmeipc_eread returned error" << strerror(errno);
         }
@@ -205,13 +191,20 @@ public:
 
     inline bool is_opened() { return sd_ >= 0; }
 
+    /* Called from the notifier's own slot, close() later */
+    void suspend()
+    {
+        if (notifier_)
+            notifier_->setEnabled(false);
+    }
+
     QSocketNotifier const* notifier() const { return notifier_.data(); }
 
 private:
 
     inline void open_()
     {
-        sd_ = ::bmeipc_eopen(mask_);
+        sd_ = EmBackend::instance()->eopen(mask_);
         if (is_opened())
             notifier_.reset(new QSocketNotifier(sd_, QSocketNotifier::Read));
     }
@@ -219,7 +212,7 @@ private:
     inline void close_()
     {
         notifier_.reset(0);
-        ::bmeipc_eclose(sd_);
+        EmBackend::instance()->eclose(sd_);
         sd_ = -1;
     }
 
@@ -242,11 +235,15 @@ public:
           em_ipc_(new EmIpc())
     { }
 
+    /* Stops BME streaming while em_ipc_ and notifier_ are still there,
+       ~EmHandle() runs after they are gone */
+    ~EmCurrentMeasurement() { close(); }
+
     inline bool is_opened() { return mq_ >= 0; }
 
-    bool measure(int &current)
+    bool measure(EmSample &sample)
     {
-        current = 0;
+        memset(&sample, 0, sizeof(sample));
 
         if (!is_opened())
             return false;
@@ -267,7 +264,10 @@ public:
             qDebug() << "measurements are off";
         } else {
             DUMP_MSG(msg);
-            current = msg.bat_current;
+            sample.timestamp = msg.timestamp;
+            sample.current = msg.bat_current;
+            sample.voltage = msg.bat_voltage;
+            sample.temperature = msg.bat_temp;
             return true;
         }
         return false;
@@ -317,7 +317,7 @@ private:
         if (!request_measurements_(period_))
             return;
 
-        mq_ = mq_open(BMEIPC_MQNAME, O_RDONLY);
+        mq_ = mq_open(EmBackend::instance()->mq_name(), O_RDONLY);
         if (!is_opened())
             return;
 
@@ -340,7 +340,11 @@ private:
 
         em_ipc_->close();
 
-        notifier_.reset(0);
+        /* May be closed from a slot of its activated() signal */
+        if (!notifier_.isNull()) {
+            notifier_->setEnabled(false);
+            notifier_.take()->deleteLater();
+        }
         ::mq_close(mq_);
         mq_ = -1;
     }
@@ -352,6 +356,161 @@ private:
 };
 
 
+/*------------ class EmMeasurementHub ------------*/
+
+static unsigned int period_to_bme(QmBattery::Period rate)
+{
+    switch (rate) {
+    case QmBattery::RATE_250ms:
+        return EM_MEASUREMENT_PERIOD_250MS;
+    case QmBattery::RATE_1000ms:
+        return EM_MEASUREMENT_PERIOD_1S;
+    case QmBattery::RATE_5000ms:
+    default:
+        return EM_MEASUREMENT_PERIOD_5S;
+    }
+}
+
+static int period_to_ms(QmBattery::Period rate)
+{
+    switch (rate) {
+    case QmBattery::RATE_250ms:
+        return 250;
+    case QmBattery::RATE_1000ms:
+        return 1000;
+    case QmBattery::RATE_5000ms:
+    default:
+        return 5000;
+    }
+}
+
+EmMeasurementHub *EmMeasurementHub::object_ = 0;
+QMutex EmMeasurementHub::object_mutex_;
+
+EmMeasurementHub::EmMeasurementHub()
+    : QObject(0),
+      rate_(QmBattery::RATE_5000ms)
+{ }
+
+EmMeasurementHub::~EmMeasurementHub() { }
+
+bool EmMeasurementHub::subscribe(EmSampleSink *subscriber,
+                                 QmBattery::Period rate)
+{
+    QMutexLocker locker(&object_mutex_);
+    if (!object_)
+        object_ = new EmMeasurementHub();
+
+    EmMeasurementHub *self = object_;
+    Subscription sub;
+    sub.rate = rate;
+    sub.divider = 1;
+    sub.ticks = 0;
+    self->subscriptions_.insert(subscriber, sub);
+
+    if (!self->restart_()) {
+        self->subscriptions_.remove(subscriber);
+        if (self->subscriptions_.isEmpty())
+            self->release_();
+        else
+            self->restart_();
+        return false;
+    }
+    return true;
+}
+
+bool EmMeasurementHub::unsubscribe(EmSampleSink *subscriber)
+{
+    QMutexLocker locker(&object_mutex_);
+    if (!object_ || !object_->subscriptions_.remove(subscriber))
+        return false;
+
+    if (object_->subscriptions_.isEmpty()) {
+        object_->release_();
+        return true;
+    }
+    /* The fastest subscriber may have gone, slow the session down */
+    return object_->restart_();
+}
+
+void EmMeasurementHub::release_()
+{
+    /* Stop BME streaming now, the object itself may still be in use by
+       onMeasurement() further up the stack */
+    if (!measurements_.isNull())
+        measurements_->close();
+    measurements_.reset(0);
+    object_ = 0;
+    deleteLater();
+}
+
+bool EmMeasurementHub::restart_()
+{
+    QmBattery::Period fastest = QmBattery::RATE_5000ms;
+    QMap<EmSampleSink*, Subscription>::iterator it;
+    for (it = subscriptions_.begin(); it != subscriptions_.end(); ++it) {
+        if (it->rate < fastest)
+            fastest = it->rate;
+    }
+
+    if (measurements_.isNull() || fastest != rate_) {
+        if (!measurements_.isNull())
+            measurements_->close();
+        measurements_.reset(new EmCurrentMeasurement(period_to_bme(fastest)));
+        if (!measurements_->open()) {
+            measurements_.reset(0);
+            return false;
+        }
+        connect(measurements_->notifier(), SIGNAL(activated(int))
+                , this, SLOT(onMeasurement(int)));
+        rate_ = fastest;
+    }
+
+    for (it = subscriptions_.begin(); it != subscriptions_.end(); ++it) {
+        it->divider = period_to_ms(it->rate) / period_to_ms(rate_);
+        it->ticks = 0;
+    }
+    return true;
+}
+
+void EmMeasurementHub::onMeasurement(int /*socket*/)
+{
+    EmSample sample;
+    QList<EmSampleSink*> due;
+
+    {
+        /* Subscriptions change under the lock on the threads of their
+           QmBattery objects */
+        QMutexLocker locker(&object_mutex_);
+
+        if (measurements_.isNull()) {
+            qWarning() << "onMeasurement: null";
+            return;
+        }
+
+        if (!measurements_->measure(sample))
+            return;
+
+        QMap<EmSampleSink*, Subscription>::iterator it;
+        for (it = subscriptions_.begin(); it != subscriptions_.end(); ++it) {
+            if (++it->ticks < it->divider)
+                continue;
+            it->ticks = 0;
+            due << it.key();
+        }
+    }
+
+    /* Subscribers may stop measuring from within their slots */
+    foreach (EmSampleSink *subscriber, due) {
+        {
+            QMutexLocker locker(&object_mutex_);
+            if (!subscriptions_.contains(subscriber))
+                continue;
+        }
+        subscriber->onSample(sample);
+    }
+}
+
 /*------------ class QmBatteryPrivate ------------*/
 QmBatteryPrivate::QmBatteryPrivate()
 	: parent_(0),
@@ -360,31 +519,79 @@ QmBatteryPrivate::QmBatteryPrivate()
       cc_offset_(0),
       prev_cc_restart_count_(-1),
       ipc_(new EmIpc()),
-      events_(new EmEvents())
+      events_(new EmEvents()),
+      measuring_(false),
+      telemetry_(this),
+      telemetry_running_(false),
+      estimator_(new EmUsetimeEstimator()),
+      history_(EmHistory::get_object()),
+      charger_phase_(ChargerSettled),
+      charger_(QmBattery::Unknown),
+      charging_(QmBattery::StateChargingFailed),
+      notified_charger_(QmBattery::Unknown),
+      notified_charging_(QmBattery::StateChargingFailed)
 {
     memset(&stat_, 0, sizeof(stat_));
-    timer = new QTimer();
-    connect(timer, SIGNAL(timeout()), this, SLOT(waitForUSB500mA()));
-    usb100ma_emit_delayed = 0;
+    memset(&notified_stat_, 0, sizeof(notified_stat_));
+    memset(stat_limit_, 0, sizeof(stat_limit_));
+    charger_timer_.setSingleShot(true);
+    charger_timer_.setInterval(CHARGER_SETTLE_TIMEOUT);
+    connect(&charger_timer_, SIGNAL(timeout()), this, SLOT(onChargerTimeout()));
+    stat_timer_.setSingleShot(true);
+    connect(&stat_timer_, SIGNAL(timeout()), this, SLOT(onStatTimeout()));
 }
 
 QmBatteryPrivate::~QmBatteryPrivate() {
-    delete timer;
+    stopEnergyAccounting();
+    if (measuring_)
+        EmMeasurementHub::unsubscribe(this);
+    if (telemetry_running_)
+        EmMeasurementHub::unsubscribe(&telemetry_);
+    EmHistory::unref_object();
 }
 
 bool QmBatteryPrivate::init(QmBattery *parent)
 {
     parent_ = parent;
-    if (!events_->open())
+    if (!openEvents_())
         return false; // error, need to return value
 
+    saveStat_();
+    charger_ = chargerType(stat_[CHARGER_TYPE]);
+    charging_ = chargingState(stat_[CHARGING_STATE]);
+
+    memcpy(&notified_stat_, &stat_, sizeof(notified_stat_));
+    notified_charger_ = charger_;
+    notified_charging_ = charging_;
+    return true;
+}
+
+bool QmBatteryPrivate::openEvents_()
+{
+    if (!events_->open())
+        return false;
+
     connect(events_->notifier(), SIGNAL(activated(int))
             , this, SLOT(onEmEvent(int)));
-
-    saveStat_();
     return true;
 }
 
+void QmBatteryPrivate::onReopenEvents()
+{
+    events_->close();
+    if (!openEvents_()) {
+        QTimer::singleShot(BMECLI_TIMEOUT, this, SLOT(onReopenEvents()));
+        return;
+    }
+
+    /* Whatever changed while BME was away */
+    is_data_actual_ = false;
+    queryStat_();
+    updateCharger_();
+    emitEventBatmon_();
+    notifyStat_();
+}
+
 void QmBatteryPrivate::queryStat_() const
 {
     QDateTime now(QDateTime::currentDateTime());
@@ -438,151 +645,132 @@ int QmBatteryPrivate::getCumulativeBatteryCurrent()
     return getStat(COULOMB_COUNTER) + cc_offset_;
 }
 
-int QmBatteryPrivate::getAverageCurrent(int usageMode,
-					QmBattery::RemainingTimeMode psMode,
-					int defaultCurrent) const
+int QmBatteryPrivate::getAverageCurrent(QmBattery::EnergyInterval usageMode,
+                                        QmBattery::RemainingTimeMode psMode,
+                                        int defaultCurrent) const
 {
-    int result = makeUsetimeQuery(USETIME_METHOD_GET_CURRENT,
-				  usageMode, psMode);
-    if (result < 0)
-	result = defaultCurrent;
-    
-    return result;
+    return estimator_->averageCurrent(usageMode,
+                                      psMode == QmBattery::PowersaveMode,
+                                      defaultCurrent);
 }
 
-int QmBatteryPrivate::getRemainingTime(int usageMode,
-				       QmBattery::RemainingTimeMode psMode,
-				       int defaultCurrent) const
+int QmBatteryPrivate::getRemainingTime(QmBattery::EnergyInterval usageMode,
+                                       QmBattery::RemainingTimeMode psMode,
+                                       int defaultCurrent) const
 {
     int current = getAverageCurrent(usageMode, psMode, defaultCurrent);
+    if (current <= 0)
+        return -1;
 
-    union emsg_usetime_info msg;
-    memset(&msg, 0, sizeof(msg));
-    msg.request.type = EM_BATTERY_USETIME_REQ;
-    msg.request.current = current;
-    if (!ipc_->query(&msg, sizeof(msg.request),
-		     &msg, sizeof(msg.reply))) {
-	qWarning() << "Can't query use time:" << strerror(errno);
-	return -1;
-    }
-
-    qDebug() << __FUNCTION__ << usageMode << psMode
-	     << "current (mA):" << current
-	     << "remaining time (s):" << msg.reply.time;
-    
-    return msg.reply.time;
+    /* mAh * 3600 / mA = s */
+    return getStat(BATTERY_CAPA_NOW) * 3600 / current;
 }
 
-int QmBatteryPrivate::makeUsetimeQuery(const QString& method, int usageMode,
-				       QmBattery::RemainingTimeMode psMode)
-    const
+
+bool QmBatteryPrivate::startCurrentMeasurement(QmBattery::Period rate)
 {
-    int result = -1;
-    
-    QDBusMessage msg = QDBusMessage::createMethodCall(
-	USETIME_SERVICE, USETIME_PATH, USETIME_IF, method);
-    
-    QList<QVariant> args;
-    args << usageMode;
-    if (psMode == QmBattery::PowersaveMode)
-	args << 1;
-    else 
-	args << 0;
-    msg.setArguments(args);
-    
-    QDBusReply<int> tReply = QDBusConnection::systemBus().call(msg);
-    if(tReply.isValid()) {
-	result = tReply.value();
-    } else {
-	/**
-	 * @note The following error means that the usetime package
-	 *       is not installed or that the usetime daemon is not
-	 *       running.
-	 *
-	 * 4 QDBusError::ServiceUnknown
-	 * "org.freedesktop.DBus.Error.ServiceUnknown"
-	 * "The name com.nokia.usetime was not provided by any
-	 * .service files"
-	 */
-	qDebug() << "No use time estimate available"
-		 << method << usageMode << psMode;
-	if (tReply.error().isValid()) {
-	    qDebug() << tReply.error().type()
-		     << tReply.error().name()
-		     << tReply.error().message();
-	}
+    if (measuring_) {
+        qDebug() << "Current Measurement is ongoing."
+                 << " Stop it, to restart new current measurement.";
+        return false;
     }
-    
-    return result;
-}
 
+    measuring_ = EmMeasurementHub::subscribe(this, rate);
+    return measuring_;
+}
 
-bool QmBatteryPrivate::startCurrentMeasurement(QmBattery::Period rate)
+bool QmBatteryPrivate::stopCurrentMeasurement()
 {
-    unsigned int period = 0;
+    if (!measuring_) {
+        qDebug() << "QmBattery::stopCurrentMeasurement: not measuring";
+        return false;
+    }
 
-    switch (rate) {
-    case QmBattery::RATE_250ms:
-        period = EM_MEASUREMENT_PERIOD_250MS;
-        break;
-    case QmBattery::RATE_1000ms:
-        period = EM_MEASUREMENT_PERIOD_1S;
-        break;
-    case QmBattery::RATE_5000ms:
-        period = EM_MEASUREMENT_PERIOD_5S;
-        break;
+    if (!EmMeasurementHub::unsubscribe(this)) {
+        qDebug() << "QmBattery::stopCurrentMeasurement failed";
+        return false;
     }
+    measuring_ = false;
+    return true;
+}
 
-    if (!measurements_.isNull()) {
-        qDebug() << "Current Measurement is ongoing."
-                 << " Stop it, to restart new current measurement.";
+void QmBatteryPrivate::onSample(const EmSample &sample)
+{
+    emit parent_->batteryCurrent(sample.current);
+}
+
+bool QmBatteryPrivate::startTelemetry(QmBattery::Period rate)
+{
+    if (telemetry_running_) {
+        qDebug() << "Telemetry is ongoing.";
         return false;
     }
 
-    measurements_.reset(new EmCurrentMeasurement(period));
-    if (!measurements_->open())
+    telemetry_running_ = EmMeasurementHub::subscribe(&telemetry_, rate);
+    return telemetry_running_;
+}
+
+bool QmBatteryPrivate::stopTelemetry()
+{
+    if (!telemetry_running_)
         return false;
 
-    connect(measurements_->notifier(), SIGNAL(activated(int))
-            , this, SLOT(onMeasurement(int)));
+    telemetry_running_ = false;
+    return EmMeasurementHub::unsubscribe(&telemetry_);
+}
 
-    return true;
+void QmBatteryPrivate::onTelemetry_(const EmSample &sample)
+{
+    QmBattery::Telemetry telemetry;
+    telemetry.timestamp = sample.timestamp.tv_sec * 1000LL
+        + sample.timestamp.tv_usec / 1000;
+    telemetry.current = sample.current;
+    telemetry.voltage = sample.voltage;
+    telemetry.temperature = sample.temperature - 273.15;
+    /* mA * mV = uW */
+    telemetry.power = sample.current * sample.voltage / 1000;
+    emit parent_->telemetry(telemetry);
 }
 
-bool QmBatteryPrivate::stopCurrentMeasurement()
+bool QmBatteryPrivate::startEnergyAccounting(QmBattery::Period rate)
 {
-    measurements_->close();
-    if (measurements_->is_opened()) {
-        qDebug() << "QmBattery::stopCurrentMeasurement failed";
+    if (!energy_.isNull()) {
+        qDebug() << "Energy accounting is ongoing.";
         return false;
     }
-    measurements_.reset(0);
+
+    energy_.reset(new EmEnergyAccounting(this));
+    if (!energy_->start(rate)) {
+        energy_.reset(0);
+        return false;
+    }
+    connect(energy_.data(), SIGNAL(intervalClosed(MeeGo::QmBattery::EnergyRecord)),
+            parent_, SIGNAL(energyIntervalClosed(MeeGo::QmBattery::EnergyRecord)));
     return true;
 }
 
-void QmBatteryPrivate::onMeasurement(int /*socket*/)
+bool QmBatteryPrivate::stopEnergyAccounting()
 {
-    bool rc;
-    int current;
+    if (energy_.isNull())
+        return false;
 
-    if (measurements_.isNull()) {
-        qWarning() << "onMeasurement: null";
-        return;
-    }
+    energy_->stop();
+    energy_.reset(0);
+    return true;
+}
 
-    rc = measurements_->measure(current);
-    emit parent_->batteryCurrent(current);
+QList<QmBattery::EnergyRecord> QmBatteryPrivate::getEnergyRecords() const
+{
+    return EmEnergyAccounting::load();
 }
 
 void QmBatteryPrivate::emitEventBatmon_()
 {
     queryStat_();
 
-    bool is_level_changed 
-        = (saved_stat_[BATTERY_LEVEL_PCT] != stat_[BATTERY_LEVEL_PCT]
-           || saved_stat_[BATTERY_LEVEL_NOW] != stat_[BATTERY_LEVEL_NOW]);
-
-    bool is_state_changed = (saved_stat_[BATTERY_STATE] != stat_[BATTERY_STATE]);
+    QmBattery::StatFields changed = diffStat_(saved_stat_, stat_);
+    bool is_level_changed = changed & QmBattery::StatCapacityLevel;
+    bool is_state_changed = changed & QmBattery::StatBatteryState;
 
     if (is_level_changed || is_state_changed)
         saveStat_();
@@ -595,46 +783,279 @@ void QmBatteryPrivate::emitEventBatmon_()
     }
 
     if (is_state_changed)
-        emit parent_->batteryStateChanged((QmBattery::BatteryState)stat_[BATTERY_STATE]);
+        emit parent_->batteryStateChanged(batteryState(stat_[BATTERY_STATE]));
+}
+
+QmBattery::StatFields QmBatteryPrivate::statField_(int index)
+{
+    switch (index) {
+    case BATTERY_STATE:
+        return QmBattery::StatBatteryState;
+    case BATTERY_LEVEL_NOW:
+    case BATTERY_LEVEL_MAX:
+    case BATTERY_LEVEL_PCT:
+        return QmBattery::StatCapacityLevel;
+    case BATTERY_CAPA_NOW:
+    case BATTERY_CAPA_MAX:
+        return QmBattery::StatCapacity;
+    case BATTERY_VOLT_NOW:
+        return QmBattery::StatVoltage;
+    case BATTERY_CURRENT:
+        return QmBattery::StatCurrent;
+    case COULOMB_COUNTER:
+        return QmBattery::StatCumulativeCurrent;
+    case BATTERY_TEMP:
+        return QmBattery::StatTemperature;
+    case BATTERY_CONDITION:
+        return QmBattery::StatCondition;
+    case CHARGING_TIME:
+        return QmBattery::StatChargingTime;
+    case CHARGING_STATE:
+        /* The charging time is only valid while charging */
+        return QmBattery::StatChargingTime;
+    default:
+        /* The charger type and charging state are debounced, see notifyStat_ */
+        return 0;
+    }
+}
+
+QmBattery::StatFields QmBatteryPrivate::diffStat_(const bmestat_t &from,
+                                                  const bmestat_t &to)
+{
+    QmBattery::StatFields changed;
+    for (int i = 0; i < (int)(sizeof(bmestat_t) / sizeof(from[0])); i++) {
+        if (from[i] != to[i])
+            changed |= statField_(i);
+    }
+    return changed;
+}
+
+QmBattery::Stat QmBatteryPrivate::snapshot_() const
+{
+    QmBattery::Stat stat;
+    stat.chargerType = chargerType(stat_[CHARGER_TYPE]);
+    stat.chargingState = chargingState(stat_[CHARGING_STATE]);
+    stat.batteryState = batteryState(stat_[BATTERY_STATE]);
+    stat.capacityPct = stat_[BATTERY_LEVEL_PCT];
+    stat.capacityBars = stat_[BATTERY_LEVEL_NOW];
+    stat.maxBars = stat_[BATTERY_LEVEL_MAX];
+    stat.capacitymAh = stat_[BATTERY_CAPA_NOW];
+    stat.nominalCapacity = stat_[BATTERY_CAPA_MAX];
+    stat.voltage = stat_[BATTERY_VOLT_NOW];
+    stat.current = stat_[BATTERY_CURRENT];
+    stat.cumulativeCurrent = stat_[COULOMB_COUNTER] + cc_offset_;
+    stat.temperature = stat_[BATTERY_TEMP] - 273; /* K to C */
+    stat.condition = batteryCondition(stat_[BATTERY_CONDITION]);
+    if (stat_[CHARGING_STATE] == CHARGING_STATE_STARTED)
+        stat.chargingTime = stat_[CHARGING_TIME] * 60;
+    else
+        stat.chargingTime = -1;
+    return stat;
 }
 
-void QmBatteryPrivate::waitForUSB500mA()
+QmBattery::Stat QmBatteryPrivate::getStat() const
 {
-    // USB 500 event didn't come. Emit the delayed signals.
-    timer->stop();
-    emit parent_->chargerEvent(parent_->getChargerType());
-    emit parent_->chargingStateChanged(parent_->getChargingState());
+    queryStat_();
+    return snapshot_();
+}
+
+void QmBatteryPrivate::setStatRateLimit(QmBattery::StatFields fields, int interval)
+{
+    for (int i = 0; i < StatFieldCount; i++) {
+        if (fields & (1 << i))
+            stat_limit_[i] = qMax(0, interval);
+    }
+}
+
+void QmBatteryPrivate::notifyStat_()
+{
+    QmBattery::StatFields changed = diffStat_(notified_stat_, stat_);
+    if (charger_ != notified_charger_)
+        changed |= QmBattery::StatChargerType;
+    if (charging_ != notified_charging_)
+        changed |= QmBattery::StatChargingState;
+    if (!changed)
+        return;
+
+    QmBattery::Stat stat = snapshot_();
+    stat.chargerType = charger_;
+    stat.chargingState = charging_;
+    /* Every change goes to the log, rate limits are for the signal only */
+    history_->append(stat);
+
+    QmBattery::StatFields due;
+    int wait = -1;
+    for (int i = 0; i < StatFieldCount; i++) {
+        if (!(changed & (1 << i)))
+            continue;
+
+        int left = 0;
+        if (stat_limit_[i] > 0 && stat_reported_[i].isValid())
+            left = stat_limit_[i] - stat_reported_[i].elapsed();
+        if (left > 0) {
+            wait = (wait < 0) ? left : qMin(wait, left);
+            continue;
+        }
+        due |= (QmBattery::StatField)(1 << i);
+        stat_reported_[i].start();
+    }
+
+    /* The earliest held back field, the others are rescheduled then */
+    if (wait >= 0)
+        stat_timer_.start(wait);
+
+    if (!due)
+        return;
+
+    for (int i = 0; i < (int)(sizeof(bmestat_t) / sizeof(stat_[0])); i++) {
+        if (statField_(i) & due)
+            notified_stat_[i] = stat_[i];
+    }
+    if (due & QmBattery::StatChargerType)
+        notified_charger_ = charger_;
+    if (due & QmBattery::StatChargingState)
+        notified_charging_ = charging_;
+
+    emit parent_->statChanged(due, stat);
+}
+
+void QmBatteryPrivate::onStatTimeout()
+{
+    queryStat_();
+    notifyStat_();
+}
+
+void QmBatteryPrivate::settleCharger_(bool report_charger)
+{
+    charger_phase_ = ChargerSettled;
+
+    /* Emit from the snapshot, the state is consistent with the last event */
+    QmBattery::ChargerType charger = chargerType(stat_[CHARGER_TYPE]);
+    QmBattery::ChargingState charging = chargingState(stat_[CHARGING_STATE]);
+
+    bool is_charger_changed = (charger != charger_);
+    bool is_charging_changed = (charging != charging_);
+    charger_ = charger;
+    charging_ = charging;
+
+    if (is_charger_changed || report_charger)
+        emit parent_->chargerEvent(charger);
+    if (is_charging_changed)
+        emit parent_->chargingStateChanged(charging);
+}
+
+void QmBatteryPrivate::updateCharger_()
+{
+    QmBattery::ChargerType charger = chargerType(stat_[CHARGER_TYPE]);
+
+    if (charger == QmBattery::USB_100mA && charger_ != QmBattery::USB_100mA) {
+        /* Coalesce everything up to USB 500mA or the end of the window */
+        if (charger_phase_ != ChargerPending) {
+            charger_phase_ = ChargerPending;
+            charger_timer_.start();
+        }
+        return;
+    }
+
+    /* Unplugged while pending is still reported, the plug-in may have
+       been seen elsewhere */
+    bool was_pending = (charger_phase_ == ChargerPending);
+    charger_timer_.stop();
+    settleCharger_(was_pending);
+}
+
+void QmBatteryPrivate::onChargerTimeout()
+{
+    /* USB 500mA didn't come, report USB 100mA */
+    settleCharger_(false);
+    notifyStat_();
 }
 
 void QmBatteryPrivate::onEmEvent(int /*socket*/)
 {
-    is_data_actual_ = false;
     int events = events_->read();
-    if (BMEVENT_CHARGER & events) {
-        qDebug() << "BMEVENT_CHARGER";
-        switch (getStat(CHARGER_TYPE)) {
-        case CHARGER_TYPE_USB100MA:
-            timer->start(4000);
-            break;
-        default:
-            if (timer->isActive()) timer->stop();
-            emit parent_->chargerEvent(parent_->getChargerType());
-            if (usb100ma_emit_delayed == 1) {
-                emit parent_->chargingStateChanged(parent_->getChargingState());
-                usb100ma_emit_delayed = 0;
-            }
+    if (events == BMEVENT_ERROR) {
+        if (errno == EIO) {
+            /* BME went away, the socket stays readable until closed */
+            events_->suspend();
+            QTimer::singleShot(BMECLI_TIMEOUT, this, SLOT(onReopenEvents()));
         }
+        return;
     }
-    if (BMEVENT_CHARGE & events) {
-        qDebug() << "BMEVENT_CHARGING";
-        //when usb100ma_emit_delayed is 1, means we missed one charging state signal. when timer is active, means waiting for usb500
-        if (timer->isActive()) { usb100ma_emit_delayed = 1; return;}
-        emit parent_->chargingStateChanged(parent_->getChargingState());
+
+    /* One snapshot per event, everything below works on it */
+    is_data_actual_ = false;
+    queryStat_();
+
+    if ((BMEVENT_CHARGER | BMEVENT_CHARGE) & events) {
+        qDebug() << "BMEVENT_CHARGER/BMEVENT_CHARGING";
+        updateCharger_();
     }
     if (BMEVENT_BATMON & events) {
         qDebug() << "BMEVENT_BATMON";
         emitEventBatmon_();
     }
+    notifyStat_();
+}
+
+QmBattery::ChargerType QmBatteryPrivate::chargerType(int bmeType)
+{
+    switch (bmeType) {
+    case CHARGER_TYPE_USB100MA:
+        return QmBattery::USB_100mA;
+    case CHARGER_TYPE_USB500MA:
+        return QmBattery::USB_500mA;
+    case CHARGER_TYPE_USBWALL:
+    case CHARGER_TYPE_DYNAMO:
+        return QmBattery::Wall;
+    case CHARGER_TYPE_NONE:
+        return QmBattery::None;
+    case CHARGER_TYPE_ERROR:
+    default:
+        return QmBattery::Unknown;
+    }
+}
+
+QmBattery::ChargingState QmBatteryPrivate::chargingState(int bmeState)
+{
+    switch (bmeState) {
+    case CHARGING_STATE_STOPPED:
+        return QmBattery::StateNotCharging;
+    case CHARGING_STATE_STARTED:
+        return QmBattery::StateCharging;
+    case CHARGING_STATE_ERROR:
+    default:
+        return QmBattery::StateChargingFailed;
+    }
+}
+
+QmBattery::BatteryState QmBatteryPrivate::batteryState(int bmeState)
+{
+    switch (bmeState) {
+    case BATTERY_STATE_EMPTY:
+        return QmBattery::StateEmpty;
+    case BATTERY_STATE_LOW:
+        return QmBattery::StateLow;
+    case BATTERY_STATE_OK:
+        return QmBattery::StateOK;
+    case BATTERY_STATE_FULL:
+        return QmBattery::StateFull;
+    case BATTERY_STATE_ERROR:
+    default:
+        return QmBattery::StateError;
+    }
+}
+
+QmBattery::BatteryCondition QmBatteryPrivate::batteryCondition(int bmeCondition)
+{
+    switch (bmeCondition) {
+    case BATTERY_CONDITION_GOOD:
+        return QmBattery::ConditionGood;
+    case BATTERY_CONDITION_POOR:
+        return QmBattery::ConditionPoor;
+    default:
+        return QmBattery::ConditionUnknown;
+    }
 }
 
 /*------------ class QmBattery Implementation ------------*/
@@ -657,6 +1078,14 @@ QmBattery::QmBattery(QObject *parent)
         ("MeeGo::QmBattery::RemainingTimeMode");
     qRegisterMetaType < Period >
         ("MeeGo::QmBattery::Period");
+    qRegisterMetaType < EnergyRecord >
+        ("MeeGo::QmBattery::EnergyRecord");
+    qRegisterMetaType < Telemetry >
+        ("MeeGo::QmBattery::Telemetry");
+    qRegisterMetaType < StatFields >
+        ("MeeGo::QmBattery::StatFields");
+    qRegisterMetaType < Stat >
+        ("MeeGo::QmBattery::Stat");
 
     /* Depreceated, use BatteryState */
     qRegisterMetaType < Level >
@@ -665,6 +1094,16 @@ QmBattery::QmBattery(QObject *parent)
 
 QmBattery::~QmBattery() { }
 
+QmBattery::Stat QmBattery::getStat() const
+{
+    return pimpl_->getStat();
+}
+
+void QmBattery::setStatRateLimit(StatFields fields, int interval)
+{
+    pimpl_->setStatRateLimit(fields, interval);
+}
+
 int QmBattery::getNominalCapacity() const
 {
     return pimpl_->getStat(BATTERY_CAPA_MAX);
@@ -672,19 +1111,7 @@ int QmBattery::getNominalCapacity() const
 
 QmBattery::BatteryState QmBattery::getBatteryState() const
 {
-    switch (pimpl_->getStat(BATTERY_STATE)) {
-    case BATTERY_STATE_EMPTY:
-        return StateEmpty;
-    case BATTERY_STATE_LOW:
-        return StateLow;
-    case BATTERY_STATE_OK:
-        return StateOK;
-    case BATTERY_STATE_FULL:
-        return StateFull;
-    case BATTERY_STATE_ERROR:
-    default:
-        return StateError;
-    }
+    return QmBatteryPrivate::batteryState(pimpl_->getStat(BATTERY_STATE));
 }
 
 int QmBattery::getRemainingCapacitymAh() const
@@ -724,33 +1151,12 @@ int QmBattery::getCumulativeBatteryCurrent() const
 
 QmBattery::ChargerType QmBattery::getChargerType() const
 {
-    switch (pimpl_->getStat(CHARGER_TYPE)) {
-    case CHARGER_TYPE_USB100MA:
-        return USB_100mA;
-    case CHARGER_TYPE_USB500MA:
-        return USB_500mA;
-    case CHARGER_TYPE_USBWALL:
-    case CHARGER_TYPE_DYNAMO:
-        return Wall;
-    case CHARGER_TYPE_NONE:
-        return None;
-    case CHARGER_TYPE_ERROR:
-    default:
-        return Unknown;
-    }
+    return QmBatteryPrivate::chargerType(pimpl_->getStat(CHARGER_TYPE));
 }
 
 QmBattery::ChargingState QmBattery::getChargingState() const
 {
-    switch (pimpl_->getStat(CHARGING_STATE)) {
-    case CHARGING_STATE_STOPPED:
-        return StateNotCharging;
-    case CHARGING_STATE_STARTED:
-        return StateCharging;
-    case CHARGING_STATE_ERROR:
-    default:
-        return StateChargingFailed;
-    }
+    return QmBatteryPrivate::chargingState(pimpl_->getStat(CHARGING_STATE));
 }
 
 int QmBattery::getRemainingChargingTime() const
@@ -772,52 +1178,70 @@ bool QmBattery::stopCurrentMeasurement()
     return pimpl_->stopCurrentMeasurement();
 }
 
+bool QmBattery::startTelemetry(Period rate)
+{
+    return pimpl_->startTelemetry(rate);
+}
+
+bool QmBattery::stopTelemetry()
+{
+    return pimpl_->stopTelemetry();
+}
+
+bool QmBattery::startEnergyAccounting(Period rate)
+{
+    return pimpl_->startEnergyAccounting(rate);
+}
+
+bool QmBattery::stopEnergyAccounting()
+{
+    return pimpl_->stopEnergyAccounting();
+}
+
+QList<QmBattery::EnergyRecord> QmBattery::getEnergyRecords() const
+{
+    return pimpl_->getEnergyRecords();
+}
+
 int QmBattery::getAverageTalkCurrent(RemainingTimeMode mode) const
 {
-    return pimpl_->getAverageCurrent(USETIME_MODE_TALK, mode,
+    return pimpl_->getAverageCurrent(IntervalCall, mode,
 				     DEFAULT_TALK_CURRENT);
 }
 
 int QmBattery::getRemainingTalkTime(QmBattery::RemainingTimeMode mode) const
 {
-    return pimpl_->getRemainingTime(USETIME_MODE_TALK, mode,
+    return pimpl_->getRemainingTime(IntervalCall, mode,
 				    DEFAULT_TALK_CURRENT);
 }
 
 int QmBattery::getAverageActiveCurrent(RemainingTimeMode mode) const
 {
-    return pimpl_->getAverageCurrent(USETIME_MODE_ACTIVE, mode,
+    return pimpl_->getAverageCurrent(IntervalDisplayOn, mode,
 				     DEFAULT_ACTIVE_CURRENT);
 }
 
 int QmBattery::getRemainingActiveTime(RemainingTimeMode mode) const
 {
-    return pimpl_->getRemainingTime(USETIME_MODE_ACTIVE, mode,
+    return pimpl_->getRemainingTime(IntervalDisplayOn, mode,
 				    DEFAULT_ACTIVE_CURRENT);
 }
 
 int QmBattery::getAverageIdleCurrent(RemainingTimeMode mode) const
 {
-	return pimpl_->getAverageCurrent(USETIME_MODE_IDLE, mode,
+	return pimpl_->getAverageCurrent(IntervalIdle, mode,
 					 DEFAULT_IDLE_CURRENT);
 }
 
 int QmBattery::getRemainingIdleTime(QmBattery::RemainingTimeMode mode) const
 {
-	return pimpl_->getRemainingTime(USETIME_MODE_IDLE, mode,
+	return pimpl_->getRemainingTime(IntervalIdle, mode,
 					DEFAULT_IDLE_CURRENT);
 }
 
 QmBattery::BatteryCondition QmBattery::getBatteryCondition() const
 {
-    switch (pimpl_->getStat(BATTERY_CONDITION)) {
-    case BATTERY_CONDITION_GOOD:
-	return ConditionGood;
-    case BATTERY_CONDITION_POOR:
-	return ConditionPoor;
-    default:
-	return ConditionUnknown;
-    }
+    return QmBatteryPrivate::batteryCondition(pimpl_->getStat(BATTERY_CONDITION));
 }
 
 int QmBattery::getBatteryEnergyLevel() const
@@ -151,9 +151,97 @@ public:
         ConditionUnknown = 0xff //!< Battery condition is not known
     };
 
+    //! Device usage the battery energy is attributed to
+    enum EnergyInterval
+    {
+        IntervalIdle = 0,       //!< Display off, no call
+        IntervalDisplayOn,      //!< Display on or dimmed, no call
+        IntervalCall            //!< Call ongoing
+    };
+
+    //! Energy drawn from the battery during one usage interval
+    struct EnergyRecord
+    {
+        uint start;              //!< Interval start (seconds since epoch)
+        int duration;            //!< Interval length (s)
+        EnergyInterval interval; //!< Device usage during the interval
+        double energy;           //!< Energy drawn (mWh), negative when charging
+        int charge;              //!< Coulomb counter change (mAs)
+        bool estimated;          //!< Energy estimated from the coulomb counter only
+        bool powersave;          //!< Power save mode was on during the interval
+    };
+
+    //! One battery measurement, see telemetry
+    struct Telemetry
+    {
+        qint64 timestamp;        //!< Measurement time (ms since epoch)
+        int current;             //!< Battery current (mA), positive when discharging
+        int voltage;             //!< Battery voltage (mV)
+        double temperature;      //!< Battery temperature (degrees Celsius)
+        int power;               //!< Battery power (mW), current times voltage
+    };
+
+    //! Battery status fields, see statChanged
+    enum StatField
+    {
+        StatChargerType        = 0x0001, //!< Stat::chargerType
+        StatChargingState      = 0x0002, //!< Stat::chargingState
+        StatBatteryState       = 0x0004, //!< Stat::batteryState
+        StatCapacityLevel      = 0x0008, //!< Stat::capacityPct, capacityBars and maxBars
+        StatCapacity           = 0x0010, //!< Stat::capacitymAh and nominalCapacity
+        StatVoltage            = 0x0020, //!< Stat::voltage
+        StatCurrent            = 0x0040, //!< Stat::current
+        StatCumulativeCurrent  = 0x0080, //!< Stat::cumulativeCurrent
+        StatTemperature        = 0x0100, //!< Stat::temperature
+        StatCondition          = 0x0200, //!< Stat::condition
+        StatChargingTime       = 0x0400, //!< Stat::chargingTime
+        StatAll                = 0x07ff  //!< All of the above
+    };
+    Q_DECLARE_FLAGS(StatFields, StatField)
+
+    //! Snapshot of the battery status
+    struct Stat
+    {
+        ChargerType chargerType;     //!< See getChargerType()
+        ChargingState chargingState; //!< See getChargingState()
+        BatteryState batteryState;   //!< See getBatteryState()
+        int capacityPct;             //!< See getRemainingCapacityPct()
+        int capacityBars;            //!< See getRemainingCapacityBars()
+        int maxBars;                 //!< See getMaxBars()
+        int capacitymAh;             //!< See getRemainingCapacitymAh()
+        int nominalCapacity;         //!< See getNominalCapacity()
+        int voltage;                 //!< See getVoltage()
+        int current;                 //!< See getBatteryCurrent()
+        int cumulativeCurrent;       //!< See getCumulativeBatteryCurrent()
+        int temperature;             //!< Battery temperature (degrees Celsius)
+        BatteryCondition condition;  //!< See getBatteryCondition()
+        int chargingTime;            //!< See getRemainingChargingTime()
+    };
+
     QmBattery(QObject *parent = 0);
     virtual ~QmBattery();
 
+    /*!
+     * @brief Gets all battery status fields at once.
+     *
+     * @return The battery status, read with a single query
+     */
+    Stat getStat() const;
+
+    /*!
+     * @brief Limits how often statChanged reports the given fields.
+     *
+     * @details A change of a limited field within the interval after the
+     * field was last reported is held back and reported when the interval
+     * has passed, together with whatever else changed by then. Only the
+     * last value is reported.
+     *
+     * @param fields    The fields to limit
+     * @param interval  Minimum time between two reports of the fields (ms),
+     *                  0 removes the limit
+     */
+    void setStatRateLimit(StatFields fields, int interval);
+
     /*!
      * @brief Gets the battery nominal (maximum) capasity.
      *
@@ -253,6 +341,10 @@ public:
     /*!
      * @brief Starts the battery current measurement.
      *
+     * @details All QmBattery instances of a process share one measurement
+     * session with BME, running at the fastest requested rate. Each
+     * instance receives the batteryCurrent signal at its own rate.
+     *
      * @param rate  The rate of sending the signal (batteryCurrent)
      *              Use enums (RATE_250ms, RATE_1000ms, RATE_5000ms)
      *
@@ -269,6 +361,61 @@ public:
      */
     bool stopCurrentMeasurement();
 
+    /*!
+     * @brief Starts the battery telemetry stream.
+     *
+     * @details The telemetry signal carries every measurement BME makes
+     * at the given rate. It shares the measurement session used by
+     * startCurrentMeasurement and startEnergyAccounting, so it costs no
+     * additional BME session.
+     *
+     * @param rate  The rate of sending the signal (telemetry)
+     *
+     * @retval  TRUE   success
+     * @retval  FALSE  failure
+     */
+    bool startTelemetry(Period rate);
+
+    /*!
+     * @brief Stops the battery telemetry stream.
+     *
+     * @retval  TRUE   success
+     * @retval  FALSE  failure
+     */
+    bool stopTelemetry();
+
+    /*!
+     * @brief Starts accounting the battery energy per usage interval.
+     *
+     * @details The energy is integrated from battery current and voltage
+     * measurements and attributed to idle, display-on and call intervals.
+     * Every closed interval is stored persistently and signalled with
+     * energyIntervalClosed. The measurements share the session started by
+     * startCurrentMeasurement.  The stored intervals of the last week are
+     * the basis of the average current and remaining time estimates.
+     *
+     * @param rate  The measurement rate used for integration
+     *
+     * @retval  TRUE   success
+     * @retval  FALSE  failure
+     */
+    bool startEnergyAccounting(Period rate = RATE_5000ms);
+
+    /*!
+     * @brief Stops the energy accounting and stores the ongoing interval.
+     *
+     * @retval  TRUE   success
+     * @retval  FALSE  failure
+     */
+    bool stopEnergyAccounting();
+
+    /*!
+     * @brief Gets the stored energy records, oldest first.
+     *
+     * @return The energy records of all processes of the user
+     */
+    QList<EnergyRecord> getEnergyRecords() const;
+
     /*!
      * @brief Get the average current in talk mode.
      *
@@ -382,6 +529,18 @@ Q_SIGNALS:
      */
     void chargerEvent(MeeGo::QmBattery::ChargerType chargerType);
 
+    /*!
+     * @brief Sent once per BME event with all fields that changed since
+     * they were last reported.
+     *
+     * @details The charger type and charging state follow the same
+     * debouncing as chargerEvent and chargingStateChanged.
+     *
+     * @param changed  The fields that changed
+     * @param stat     The complete battery status
+     */
+    void statChanged(MeeGo::QmBattery::StatFields changed, MeeGo::QmBattery::Stat stat);
+
     /*!
      * @brief Sent at desired interval when battery current measurement is enabled
      * (see startCurrentMeasurement)
@@ -390,6 +549,22 @@ Q_SIGNALS:
      */
     void batteryCurrent(int current);
 
+    /*!
+     * @brief Sent at desired interval when the telemetry stream is enabled
+     * (see startTelemetry)
+     *
+     * @param sample The measurement
+     */
+    void telemetry(MeeGo::QmBattery::Telemetry sample);
+
+    /*!
+     * @brief Sent when an energy accounting interval has been closed
+     * (see startEnergyAccounting)
+     *
+     * @param record The energy drawn during the interval
+     */
+    void energyIntervalClosed(MeeGo::QmBattery::EnergyRecord record);
+
     /*!
      * @deprecated Deprecated, use batteryRemainingCapacityChanged(int, int)
      */
@@ -411,6 +586,8 @@ private:
     QScopedPointer<QmBatteryPrivate> pimpl_;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QmBattery::StatFields)
+
 } // MeeGo namespace
 
 QT_END_HEADER
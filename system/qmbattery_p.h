@@ -38,6 +38,8 @@
 #include <QDateTime>
 #include <QScopedPointer>
 #include <QTimer>
+#include <QMap>
+#include <QMutex>
 
 #include <mqueue.h>
 #include <time.h>
@@ -54,8 +56,66 @@ namespace MeeGo {
 class EmIpc;
 class EmEvents;
 class EmCurrentMeasurement;
+class EmEnergyAccounting;
+class EmUsetimeEstimator;
+class EmHistory;
 
-class QmBatteryPrivate : public QObject
+/* One BME measurement message */
+struct EmSample
+{
+    struct timeval timestamp;
+    int current; /* mA, positive when discharging */
+    int voltage; /* mV */
+    int temperature; /* K */
+};
+
+class EmSampleSink
+{
+public:
+    virtual ~EmSampleSink() { }
+    virtual void onSample(const EmSample &sample) = 0;
+};
+
+/*
+ * Process-wide current measurement session. BME streams measurements to a
+ * single mq, so all sinks of the process share one session running at the
+ * fastest requested period. Every sink gets the stream decimated to its
+ * own period.
+ */
+class EmMeasurementHub : public QObject
+{
+    Q_OBJECT
+
+public:
+    static bool subscribe(EmSampleSink *subscriber, QmBattery::Period rate);
+    static bool unsubscribe(EmSampleSink *subscriber);
+
+private Q_SLOTS:
+    void onMeasurement(int);
+
+private:
+    EmMeasurementHub();
+    ~EmMeasurementHub();
+
+    bool restart_();
+    void release_();
+
+    struct Subscription
+    {
+        QmBattery::Period rate;
+        int divider;
+        int ticks;
+    };
+
+    static EmMeasurementHub *object_;
+    static QMutex object_mutex_;
+
+    QMap<EmSampleSink*, Subscription> subscriptions_;
+    QScopedPointer<EmCurrentMeasurement> measurements_;
+    QmBattery::Period rate_;
+};
+
+class QmBatteryPrivate : public QObject, public EmSampleSink
 {
     Q_OBJECT
     MEEGO_DECLARE_PUBLIC(QmBattery)
@@ -66,28 +126,64 @@ public:
 
     bool init(QmBattery*);
 
+    static QmBattery::ChargerType chargerType(int bmeType);
+    static QmBattery::ChargingState chargingState(int bmeState);
+    static QmBattery::BatteryState batteryState(int bmeState);
+    static QmBattery::BatteryCondition batteryCondition(int bmeCondition);
+
     bool startCurrentMeasurement(QmBattery::Period);
     bool stopCurrentMeasurement();
 
+    bool startTelemetry(QmBattery::Period);
+    bool stopTelemetry();
+
+    bool startEnergyAccounting(QmBattery::Period);
+    bool stopEnergyAccounting();
+    QList<QmBattery::EnergyRecord> getEnergyRecords() const;
+
     int getStat(int) const;
+    QmBattery::Stat getStat() const;
+    void setStatRateLimit(QmBattery::StatFields fields, int interval);
     int getCumulativeBatteryCurrent();
-    int getAverageCurrent(int usageMode, QmBattery::RemainingTimeMode psMode,
-			  int defaultCurrent) const;
-    int getRemainingTime(int usageMode, QmBattery::RemainingTimeMode psMode,
-			 int defaultCurrent) const;
+    int getAverageCurrent(QmBattery::EnergyInterval usageMode,
+                          QmBattery::RemainingTimeMode psMode,
+                          int defaultCurrent) const;
+    int getRemainingTime(QmBattery::EnergyInterval usageMode,
+                         QmBattery::RemainingTimeMode psMode,
+                         int defaultCurrent) const;
 
 private Q_SLOTS:
     void onEmEvent(int);
-    void onMeasurement(int);
-    void waitForUSB500mA();
+    void onChargerTimeout();
+    void onReopenEvents();
+    void onStatTimeout();
 
 private:
+    bool openEvents_();
     void queryStat_() const;
     void emitEventBatmon_();
     void saveStat_();
 
-    int makeUsetimeQuery(const QString& method, int usageMode,
-			 QmBattery::RemainingTimeMode psMode) const;
+    void updateCharger_();
+    void settleCharger_(bool report_charger);
+
+    static QmBattery::StatFields statField_(int index);
+    static QmBattery::StatFields diffStat_(const bmestat_t &from, const bmestat_t &to);
+    QmBattery::Stat snapshot_() const;
+    void notifyStat_();
+
+    void onSample(const EmSample &sample);
+    void onTelemetry_(const EmSample &sample);
+
+    /* Telemetry is a subscription of its own, with its own rate */
+    class TelemetrySink : public EmSampleSink
+    {
+    public:
+        TelemetrySink(QmBatteryPrivate *battery) : battery_(battery) { }
+        void onSample(const EmSample &sample) { battery_->onTelemetry_(sample); }
+    private:
+        QmBatteryPrivate *battery_;
+    };
 
     QmBattery *parent_;
 
@@ -101,9 +197,34 @@ private:
 
     QScopedPointer<EmIpc> ipc_;
     QScopedPointer<EmEvents> events_;
-    QScopedPointer<EmCurrentMeasurement> measurements_;
-    QTimer *timer;
-    int usb100ma_emit_delayed;
+    bool measuring_;
+    TelemetrySink telemetry_;
+    bool telemetry_running_;
+    QScopedPointer<EmEnergyAccounting> energy_;
+    QScopedPointer<EmUsetimeEstimator> estimator_;
+    EmHistory *history_;
+    /*
+     * Charger state machine. The reported charger and charging state only
+     * change when settled; a USB 100mA charger is held pending for a while
+     * as it usually turns into USB 500mA after enumeration.
+     */
+    enum ChargerPhase { ChargerSettled, ChargerPending };
+    ChargerPhase charger_phase_;
+    QmBattery::ChargerType charger_;
+    QmBattery::ChargingState charging_;
+    QTimer charger_timer_;
+    /*
+     * statChanged reports the difference to notified_stat_. Fields with a
+     * rate limit that were reported too recently stay different and are
+     * picked up by stat_timer_.
+     */
+    enum { StatFieldCount = 11 };
+    bmestat_t notified_stat_;
+    QmBattery::ChargerType notified_charger_;
+    QmBattery::ChargingState notified_charging_;
+    int stat_limit_[StatFieldCount];
+    QTime stat_reported_[StatFieldCount];
+    QTimer stat_timer_;
 };
 
 } /* MeeGo */
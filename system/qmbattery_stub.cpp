@@ -35,6 +35,7 @@ namespace MeeGo
     };
 
     QmBattery::QmBattery(QObject *parent)
+        : QObject(parent)
     {
         qWarning() << "QmBattery is not functional because of a missing compile-time dependency. Please compile QmSystem with bmeipc.";
     }
@@ -113,11 +114,80 @@ namespace MeeGo
         return false;
     }
 
+    bool QmBattery::startTelemetry(Period)
+    {
+        return false;
+    }
+
+    bool QmBattery::stopTelemetry()
+    {
+        return false;
+    }
+
+    bool QmBattery::startEnergyAccounting(Period)
+    {
+        return false;
+    }
+
+    bool QmBattery::stopEnergyAccounting()
+    {
+        return false;
+    }
+
+    QList<QmBattery::EnergyRecord> QmBattery::getEnergyRecords() const
+    {
+        return QList<QmBattery::EnergyRecord>();
+    }
+
+    QmBattery::Stat QmBattery::getStat() const
+    {
+        QmBattery::Stat stat;
+        stat.chargerType = QmBattery::Unknown;
+        stat.chargingState = QmBattery::StateChargingFailed;
+        stat.batteryState = QmBattery::StateError;
+        stat.capacityPct = 0;
+        stat.capacityBars = 0;
+        stat.maxBars = 0;
+        stat.capacitymAh = 0;
+        stat.nominalCapacity = 0;
+        stat.voltage = 0;
+        stat.current = 0;
+        stat.cumulativeCurrent = 0;
+        stat.temperature = 0;
+        stat.condition = QmBattery::ConditionUnknown;
+        stat.chargingTime = -1;
+        return stat;
+    }
+
+    void QmBattery::setStatRateLimit(StatFields, int)
+    {
+    }
+
+    int QmBattery::getAverageTalkCurrent(RemainingTimeMode) const
+    {
+        return 0;
+    }
+
     int QmBattery::getRemainingTalkTime(RemainingTimeMode) const
     {
         return 0;
     }
 
+    int QmBattery::getAverageActiveCurrent(RemainingTimeMode) const
+    {
+        return 0;
+    }
+
+    int QmBattery::getRemainingActiveTime(RemainingTimeMode) const
+    {
+        return 0;
+    }
+
+    int QmBattery::getAverageIdleCurrent(RemainingTimeMode) const
+    {
+        return 0;
+    }
+
     int QmBattery::getRemainingIdleTime(RemainingTimeMode mode) const
     {
         return 0;
@@ -0,0 +1,283 @@
+/*!
+ * @file qmbatterybackend.cpp
+ * @brief EmBmeBackend and EmSimBackend
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "qmbatterybackend_p.h"
+#ifdef QMSYSTEM_BME_SIMULATOR
+#include "qmbatterysim_p.h"
+#endif
+
+#include <QDebug>
+#include <QMutex>
+
+extern "C" {
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "bme/bmeipc.h"
+}
+
+namespace MeeGo {
+
+EmBackend *EmBackend::instance()
+{
+    static QMutex mutex;
+    static EmBackend *backend = 0;
+
+    QMutexLocker locker(&mutex);
+    if (!backend) {
+#ifdef QMSYSTEM_BME_SIMULATOR
+        const char *path = getenv(EMSIM_SOCKET_ENV);
+        if (path && *path) {
+            qDebug() << "EM: using the battery simulator at" << path;
+            backend = new EmSimBackend(path);
+            return backend;
+        }
+#endif
+        backend = new EmBmeBackend();
+    }
+    return backend;
+}
+
+/*------------ class EmBmeBackend ------------*/
+
+#ifdef HAVE_BMEIPC
+
+int EmBmeBackend::open()
+{
+    return ::bmeipc_open();
+}
+
+void EmBmeBackend::close(int sd)
+{
+    ::bmeipc_close(sd);
+}
+
+int EmBmeBackend::query(int sd, const void *msg1, int len1,
+                        void *msg2, int len2)
+{
+    return ::bmeipc_query(sd, msg1, len1, msg2, len2);
+}
+
+int EmBmeBackend::eopen(int mask)
+{
+    return ::bmeipc_eopen(mask);
+}
+
+void EmBmeBackend::eclose(int sd)
+{
+    ::bmeipc_eclose(sd);
+}
+
+int EmBmeBackend::eread(int sd)
+{
+    return ::bmeipc_eread(sd);
+}
+
+#else
+
+/* Built without bmeipc, only the simulator is there */
+
+int EmBmeBackend::open()
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+void EmBmeBackend::close(int /*sd*/)
+{ }
+
+int EmBmeBackend::query(int /*sd*/, const void * /*msg1*/, int /*len1*/,
+                        void * /*msg2*/, int /*len2*/)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+int EmBmeBackend::eopen(int /*mask*/)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+void EmBmeBackend::eclose(int /*sd*/)
+{ }
+
+int EmBmeBackend::eread(int /*sd*/)
+{
+    errno = ENOSYS;
+    return BMEVENT_ERROR;
+}
+
+#endif /* HAVE_BMEIPC */
+
+const char *EmBmeBackend::mq_name() const
+{
+    return BMEIPC_MQNAME;
+}
+
+/*------------ class EmSimBackend ------------*/
+
+#ifdef QMSYSTEM_BME_SIMULATOR
+
+static bool write_all(int sd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    while (len > 0) {
+        ssize_t n = ::write(sd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            if (errno == EPIPE || errno == ECONNRESET)
+                errno = EIO;
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool read_all(int sd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    while (len > 0) {
+        ssize_t n = ::read(sd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            /* The simulator went away, same as a BME restart */
+            if (n == 0 || errno == ECONNRESET)
+                errno = EIO;
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool send_message(int sd, quint32 type, const void *payload, quint32 len)
+{
+    emsim_hdr hdr;
+    hdr.type = type;
+    hdr.len = len;
+    return write_all(sd, &hdr, sizeof(hdr))
+        && (len == 0 || write_all(sd, payload, len));
+}
+
+EmSimBackend::EmSimBackend(const QByteArray &path)
+    : path_(path)
+{ }
+
+int EmSimBackend::connect_(quint32 hello, const void *payload, quint32 len)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path_.constData(), sizeof(addr.sun_path) - 1);
+
+    int sd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sd < 0)
+        return -1;
+
+    if (::connect(sd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || !send_message(sd, hello, payload, len)) {
+        int error = errno;
+        ::close(sd);
+        errno = error;
+        return -1;
+    }
+    return sd;
+}
+
+int EmSimBackend::open()
+{
+    return connect_(EMSIM_HELLO_IPC, 0, 0);
+}
+
+void EmSimBackend::close(int sd)
+{
+    ::close(sd);
+}
+
+int EmSimBackend::query(int sd, const void *msg1, int len1,
+                        void *msg2, int len2)
+{
+    if (!send_message(sd, EMSIM_QUERY, msg1, len1))
+        return -1;
+
+    emsim_hdr hdr;
+    if (!read_all(sd, &hdr, sizeof(hdr)))
+        return -1;
+    if (hdr.type != EMSIM_REPLY) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    QByteArray reply(hdr.len, 0);
+    if (hdr.len > 0 && !read_all(sd, reply.data(), hdr.len))
+        return -1;
+
+    if (msg2 && len2 > 0)
+        memcpy(msg2, reply.constData(), qMin<int>(len2, reply.size()));
+    return reply.size();
+}
+
+int EmSimBackend::eopen(int mask)
+{
+    quint32 payload = mask;
+    return connect_(EMSIM_HELLO_EVENTS, &payload, sizeof(payload));
+}
+
+void EmSimBackend::eclose(int sd)
+{
+    ::close(sd);
+}
+
+int EmSimBackend::eread(int sd)
+{
+    emsim_hdr hdr;
+    quint32 events;
+
+    if (!read_all(sd, &hdr, sizeof(hdr)))
+        return BMEVENT_ERROR;
+    if (hdr.type != EMSIM_EVENT || hdr.len != sizeof(events)) {
+        errno = EPROTO;
+        return BMEVENT_ERROR;
+    }
+    if (!read_all(sd, &events, sizeof(events)))
+        return BMEVENT_ERROR;
+    return events;
+}
+
+const char *EmSimBackend::mq_name() const
+{
+    return EMSIM_MQNAME;
+}
+
+#endif /* QMSYSTEM_BME_SIMULATOR */
+
+} /* MeeGo */
@@ -0,0 +1,100 @@
+/*!
+ * @file qmbatterybackend_p.h
+ * @brief Contains the transports used by QmBattery to reach BME
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef QMBATTERYBACKEND_P_H
+#define QMBATTERYBACKEND_P_H
+
+#include <QByteArray>
+
+namespace MeeGo {
+
+/*
+ * The calls EmIpc, EmEvents and EmCurrentMeasurement make to BME. The
+ * semantics follow libbmeipc: descriptors are pollable, errors are
+ * reported through errno and EIO means that the server went away.
+ */
+class EmBackend
+{
+public:
+    virtual ~EmBackend() { }
+
+    /* BME; in CONFIG+=bmesim builds the simulator if EMSIM_SOCKET_ENV
+       is set */
+    static EmBackend *instance();
+
+    virtual int open() = 0;
+    virtual void close(int sd) = 0;
+    virtual int query(int sd, const void *msg1, int len1,
+                      void *msg2, int len2) = 0;
+
+    virtual int eopen(int mask) = 0;
+    virtual void eclose(int sd) = 0;
+    virtual int eread(int sd) = 0;
+
+    virtual const char *mq_name() const = 0;
+};
+
+class EmBmeBackend : public EmBackend
+{
+public:
+    int open();
+    void close(int sd);
+    int query(int sd, const void *msg1, int len1, void *msg2, int len2);
+
+    int eopen(int mask);
+    void eclose(int sd);
+    int eread(int sd);
+
+    const char *mq_name() const;
+};
+
+#ifdef QMSYSTEM_BME_SIMULATOR
+
+/* Talks to the battery simulator over a Unix socket, see qmbatterysim_p.h */
+class EmSimBackend : public EmBackend
+{
+public:
+    EmSimBackend(const QByteArray &path);
+
+    int open();
+    void close(int sd);
+    int query(int sd, const void *msg1, int len1, void *msg2, int len2);
+
+    int eopen(int mask);
+    void eclose(int sd);
+    int eread(int sd);
+
+    const char *mq_name() const;
+
+private:
+    int connect_(quint32 hello, const void *payload, quint32 len);
+
+    QByteArray path_;
+};
+
+#endif /* QMSYSTEM_BME_SIMULATOR */
+
+} /* MeeGo */
+#endif /* QMBATTERYBACKEND_P_H */
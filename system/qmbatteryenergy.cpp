@@ -0,0 +1,365 @@
+/*!
+ * @file qmbatteryenergy.cpp
+ * @brief EmEnergyAccounting
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "qmbatteryenergy_p.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+extern "C" {
+#include <string.h>
+#include <sys/file.h>
+#include <time.h>
+#include "bme/bmeipc.h"
+}
+
+#define ENERGY_DIR ".qmsystem2"
+#define ENERGY_FILE "battery-energy"
+#define ENERGY_MAGIC 0x41454d51 /* "QMEA" */
+#define ENERGY_VERSION 1
+#define ENERGY_MAX_RECORDS 8192
+
+/* Gaps longer than this between two samples are not integrated */
+#define ENERGY_MAX_SAMPLE_GAP 60000 /* ms */
+
+/* Records older than this are not used for estimates */
+#define ESTIMATE_WINDOW (7 * 24 * 3600) /* s */
+/* Less history than this falls back to the default current */
+#define ESTIMATE_MIN_DURATION 600 /* s */
+/* How often the record file is checked for changes */
+#define ESTIMATE_CHECK_TIMEOUT 5 /* s */
+
+namespace MeeGo {
+
+struct EmEnergyHeader
+{
+    quint32 magic;
+    quint32 version;
+};
+
+EmEnergyAccounting::EmEnergyAccounting(QmBatteryPrivate *battery)
+    : QObject(0),
+      battery_(battery),
+      display_state_(QmDisplayState::On),
+      call_state_(QmCallState::None),
+      powersave_(false),
+      running_(false),
+      interval_(QmBattery::IntervalIdle),
+      interval_powersave_(false),
+      start_(0),
+      start_cc_(0),
+      energy_(0),
+      samples_(0),
+      have_last_(false)
+{
+    memset(&last_, 0, sizeof(last_));
+}
+
+EmEnergyAccounting::~EmEnergyAccounting()
+{
+    stop();
+}
+
+bool EmEnergyAccounting::start(QmBattery::Period rate)
+{
+    if (running_)
+        return true;
+
+    if (!EmMeasurementHub::subscribe(this, rate))
+        return false;
+
+    connect(&display_, SIGNAL(displayStateChanged(MeeGo::QmDisplayState::DisplayState)),
+            this, SLOT(onDisplayStateChanged(MeeGo::QmDisplayState::DisplayState)));
+    connect(&call_, SIGNAL(stateChanged(MeeGo::QmCallState::State, MeeGo::QmCallState::Type)),
+            this, SLOT(onCallStateChanged(MeeGo::QmCallState::State, MeeGo::QmCallState::Type)));
+    connect(&device_mode_, SIGNAL(devicePSMStateChanged(MeeGo::QmDeviceMode::PSMState)),
+            this, SLOT(onPSMStateChanged(MeeGo::QmDeviceMode::PSMState)));
+
+    display_state_ = display_.get();
+    call_state_ = call_.getState();
+    powersave_ = device_mode_.getPSMState() == QmDeviceMode::PSMStateOn;
+    running_ = true;
+    openInterval_();
+    return true;
+}
+
+void EmEnergyAccounting::stop()
+{
+    if (!running_)
+        return;
+
+    closeInterval_();
+    EmMeasurementHub::unsubscribe(this);
+    disconnect(&display_, 0, this, 0);
+    disconnect(&call_, 0, this, 0);
+    disconnect(&device_mode_, 0, this, 0);
+    running_ = false;
+}
+
+void EmEnergyAccounting::onSample(const EmSample &sample)
+{
+    if (have_last_) {
+        qint64 dt = (sample.timestamp.tv_sec - last_.timestamp.tv_sec) * 1000LL
+            + (sample.timestamp.tv_usec - last_.timestamp.tv_usec) / 1000;
+        if (dt > 0 && dt <= ENERGY_MAX_SAMPLE_GAP) {
+            /* mW * ms = uJ, 3600 uJ = 1 uWh */
+            double power = last_.current * (double)last_.voltage / 1000.0;
+            energy_ += power * dt / 3600.0;
+            samples_++;
+        }
+    }
+    last_ = sample;
+    have_last_ = true;
+}
+
+QmBattery::EnergyInterval EmEnergyAccounting::classify_() const
+{
+    if (call_state_ == QmCallState::Active || call_state_ == QmCallState::Service)
+        return QmBattery::IntervalCall;
+    if (display_state_ != QmDisplayState::Off)
+        return QmBattery::IntervalDisplayOn;
+    return QmBattery::IntervalIdle;
+}
+
+void EmEnergyAccounting::reopenInterval_()
+{
+    if (classify_() != interval_ || powersave_ != interval_powersave_) {
+        closeInterval_();
+        openInterval_();
+    }
+}
+
+void EmEnergyAccounting::onDisplayStateChanged(MeeGo::QmDisplayState::DisplayState state)
+{
+    display_state_ = state;
+    reopenInterval_();
+}
+
+void EmEnergyAccounting::onCallStateChanged(MeeGo::QmCallState::State state,
+                                            MeeGo::QmCallState::Type /*type*/)
+{
+    call_state_ = state;
+    reopenInterval_();
+}
+
+void EmEnergyAccounting::onPSMStateChanged(MeeGo::QmDeviceMode::PSMState state)
+{
+    powersave_ = (state == QmDeviceMode::PSMStateOn);
+    reopenInterval_();
+}
+
+void EmEnergyAccounting::openInterval_()
+{
+    interval_ = classify_();
+    interval_powersave_ = powersave_;
+    start_ = ::time(0);
+    clock_.start();
+    start_cc_ = battery_->getCumulativeBatteryCurrent();
+    energy_ = 0;
+    samples_ = 0;
+    /* The sample preceding the interval belongs to the previous one */
+    have_last_ = false;
+}
+
+void EmEnergyAccounting::closeInterval_()
+{
+    /* The wall clock may be set meanwhile, only the start is taken from it */
+    qint64 duration = clock_.elapsed() / 1000;
+    if (duration <= 0)
+        return;
+
+    EmEnergyRecord record;
+    memset(&record, 0, sizeof(record));
+    record.start = start_;
+    record.duration = duration;
+    record.charge = battery_->getCumulativeBatteryCurrent() - start_cc_;
+    record.interval = interval_;
+    if (interval_powersave_)
+        record.flags |= EM_ENERGY_FLAG_POWERSAVE;
+
+    if (samples_ > 0) {
+        record.energy = (qint32)energy_;
+    } else {
+        /* mAs * mV = uJ, 3600 uJ = 1 uWh */
+        record.energy = (qint32)(record.charge
+                                 * (double)battery_->getStat(BATTERY_VOLT_NOW) / 3600.0);
+        record.flags |= EM_ENERGY_FLAG_ESTIMATED;
+    }
+
+    append_(record);
+
+    QmBattery::EnergyRecord closed;
+    closed.start = record.start;
+    closed.duration = record.duration;
+    closed.interval = (QmBattery::EnergyInterval)record.interval;
+    closed.energy = record.energy / 1000.0;
+    closed.charge = record.charge;
+    closed.estimated = record.flags & EM_ENERGY_FLAG_ESTIMATED;
+    closed.powersave = record.flags & EM_ENERGY_FLAG_POWERSAVE;
+    emit intervalClosed(closed);
+}
+
+QString EmEnergyAccounting::path_()
+{
+    return QDir::homePath() + "/" ENERGY_DIR "/" ENERGY_FILE;
+}
+
+bool EmEnergyAccounting::append_(const EmEnergyRecord &record)
+{
+    QDir().mkpath(QDir::homePath() + "/" ENERGY_DIR);
+
+    QFile file(path_());
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Can't open" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    /* Several processes may account at the same time */
+    ::flock(file.handle(), LOCK_EX);
+
+    EmEnergyHeader header;
+    if (file.read((char *)&header, sizeof(header)) != sizeof(header)
+        || header.magic != ENERGY_MAGIC || header.version != ENERGY_VERSION) {
+        header.magic = ENERGY_MAGIC;
+        header.version = ENERGY_VERSION;
+        file.resize(0);
+        file.seek(0);
+        file.write((const char *)&header, sizeof(header));
+    }
+
+    qint64 count = (file.size() - sizeof(header)) / sizeof(EmEnergyRecord);
+    if (count >= ENERGY_MAX_RECORDS) {
+        /* Drop the older half to keep the file bounded */
+        qint64 keep = ENERGY_MAX_RECORDS / 2;
+        file.seek(sizeof(header) + (count - keep) * sizeof(EmEnergyRecord));
+        QByteArray tail = file.read(keep * sizeof(EmEnergyRecord));
+        file.seek(sizeof(header));
+        file.write(tail);
+        file.resize(sizeof(header) + tail.size());
+        count = keep;
+    }
+
+    file.seek(sizeof(header) + count * sizeof(EmEnergyRecord));
+    bool ok = file.write((const char *)&record, sizeof(record)) == sizeof(record);
+    file.flush();
+
+    ::flock(file.handle(), LOCK_UN);
+    return ok;
+}
+
+QList<QmBattery::EnergyRecord> EmEnergyAccounting::load()
+{
+    QList<QmBattery::EnergyRecord> records;
+
+    QFile file(path_());
+    if (!file.open(QIODevice::ReadOnly))
+        return records;
+
+    ::flock(file.handle(), LOCK_SH);
+    QByteArray data = file.readAll();
+    ::flock(file.handle(), LOCK_UN);
+
+    if (data.size() < (int)sizeof(EmEnergyHeader))
+        return records;
+
+    const EmEnergyHeader *header = (const EmEnergyHeader *)data.constData();
+    if (header->magic != ENERGY_MAGIC || header->version != ENERGY_VERSION)
+        return records;
+
+    int count = (data.size() - sizeof(EmEnergyHeader)) / sizeof(EmEnergyRecord);
+    const EmEnergyRecord *stored
+        = (const EmEnergyRecord *)(data.constData() + sizeof(EmEnergyHeader));
+    for (int i = 0; i < count; i++) {
+        /* Damaged or written by a later version */
+        if (stored[i].interval > QmBattery::IntervalCall)
+            continue;
+
+        QmBattery::EnergyRecord record;
+        record.start = stored[i].start;
+        record.duration = stored[i].duration;
+        record.interval = (QmBattery::EnergyInterval)stored[i].interval;
+        record.energy = stored[i].energy / 1000.0;
+        record.charge = stored[i].charge;
+        record.estimated = stored[i].flags & EM_ENERGY_FLAG_ESTIMATED;
+        record.powersave = stored[i].flags & EM_ENERGY_FLAG_POWERSAVE;
+        records << record;
+    }
+    return records;
+}
+
+/*------------ class EmUsetimeEstimator ------------*/
+
+EmUsetimeEstimator::EmUsetimeEstimator()
+    : size_(-1)
+{
+    memset(averages_, 0, sizeof(averages_));
+}
+
+void EmUsetimeEstimator::reload_() const
+{
+    QDateTime now(QDateTime::currentDateTime());
+    if (check_expire_.isValid() && now < check_expire_)
+        return;
+    check_expire_ = now.addSecs(ESTIMATE_CHECK_TIMEOUT);
+
+    QFileInfo info(EmEnergyAccounting::path_());
+    QDateTime modified = info.exists() ? info.lastModified() : QDateTime();
+    qint64 size = info.exists() ? info.size() : -1;
+    if (modified == modified_ && size == size_ && modified_.isValid())
+        return;
+    modified_ = modified;
+    size_ = size;
+
+    memset(averages_, 0, sizeof(averages_));
+    uint window_start = now.toTime_t() - ESTIMATE_WINDOW;
+
+    QList<QmBattery::EnergyRecord> records = EmEnergyAccounting::load();
+    foreach (const QmBattery::EnergyRecord &record, records) {
+        /* Charging intervals say nothing about consumption */
+        if (record.start < window_start || record.charge <= 0)
+            continue;
+        if ((uint)record.interval > (uint)QmBattery::IntervalCall)
+            continue;
+        Average &average = averages_[record.interval][record.powersave ? 1 : 0];
+        average.charge += record.charge;
+        average.duration += record.duration;
+    }
+}
+
+int EmUsetimeEstimator::averageCurrent(QmBattery::EnergyInterval interval,
+                                       bool powersave,
+                                       int defaultCurrent) const
+{
+    reload_();
+
+    const Average &average = averages_[interval][powersave ? 1 : 0];
+    if (average.duration < ESTIMATE_MIN_DURATION)
+        return defaultCurrent;
+
+    /* mAs / s = mA */
+    return average.charge / average.duration;
+}
+
+} /* MeeGo */
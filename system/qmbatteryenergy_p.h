@@ -0,0 +1,149 @@
+/*!
+ * @file qmbatteryenergy_p.h
+ * @brief Contains EmEnergyAccounting, which attributes battery energy to
+ * device usage intervals
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef QMBATTERYENERGY_P_H
+#define QMBATTERYENERGY_P_H
+
+#include <QtCore/qobject.h>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QList>
+
+#include "qmbattery.h"
+#include "qmbattery_p.h"
+#include "qmcallstate.h"
+#include "qmdevicemode.h"
+#include "qmdisplaystate.h"
+
+namespace MeeGo {
+
+/* Record as stored in the energy file, native endian */
+struct EmEnergyRecord
+{
+    quint32 start;     /* seconds since epoch */
+    quint32 duration;  /* seconds */
+    qint32 energy;     /* uWh, negative when charging */
+    qint32 charge;     /* mAs, coulomb counter delta */
+    quint8 interval;   /* QmBattery::EnergyInterval */
+    quint8 flags;
+    quint16 reserved;
+};
+
+#define EM_ENERGY_FLAG_ESTIMATED 0x01
+#define EM_ENERGY_FLAG_POWERSAVE 0x02
+
+/*
+ * Integrates battery power from the measurement stream and splits it into
+ * intervals of display-on, call and idle use. Every closed interval is
+ * appended to a per-user record file. The coulomb counter delta of the
+ * interval is recorded as well; it is also used to estimate the energy
+ * when no measurements arrived during the interval.
+ */
+class EmEnergyAccounting : public QObject, public EmSampleSink
+{
+    Q_OBJECT
+    friend class EmUsetimeEstimator;
+
+public:
+    EmEnergyAccounting(QmBatteryPrivate *battery);
+    ~EmEnergyAccounting();
+
+    bool start(QmBattery::Period rate);
+    void stop();
+
+    void onSample(const EmSample &sample);
+
+    static QList<QmBattery::EnergyRecord> load();
+
+Q_SIGNALS:
+    void intervalClosed(MeeGo::QmBattery::EnergyRecord record);
+
+private Q_SLOTS:
+    void onDisplayStateChanged(MeeGo::QmDisplayState::DisplayState state);
+    void onCallStateChanged(MeeGo::QmCallState::State state,
+                            MeeGo::QmCallState::Type type);
+    void onPSMStateChanged(MeeGo::QmDeviceMode::PSMState state);
+
+private:
+    QmBattery::EnergyInterval classify_() const;
+    void openInterval_();
+    void closeInterval_();
+    void reopenInterval_();
+
+    static QString path_();
+    static bool append_(const EmEnergyRecord &record);
+
+    QmBatteryPrivate *battery_;
+    QmDisplayState display_;
+    QmCallState call_;
+    QmDisplayState::DisplayState display_state_;
+    QmCallState::State call_state_;
+    QmDeviceMode device_mode_;
+    bool powersave_;
+
+    bool running_;
+    QmBattery::EnergyInterval interval_;
+    bool interval_powersave_;
+    time_t start_;
+    QElapsedTimer clock_;
+    int start_cc_;
+    double energy_;
+    int samples_;
+    bool have_last_;
+    EmSample last_;
+};
+
+/*
+ * Estimates the average current of a usage mode from the stored energy
+ * records. The averages are recomputed only when the record file changes.
+ */
+class EmUsetimeEstimator
+{
+public:
+    EmUsetimeEstimator();
+
+    int averageCurrent(QmBattery::EnergyInterval interval, bool powersave,
+                       int defaultCurrent) const;
+
+private:
+    void reload_() const;
+
+    struct Average
+    {
+        qint64 charge;   /* mAs */
+        qint64 duration; /* s */
+    };
+
+    mutable Average averages_[QmBattery::IntervalCall + 1][2];
+    /* The file as last loaded; mtime alone has a resolution of 1 s, the
+       records are appended so the size tells the rest */
+    mutable QDateTime modified_;
+    mutable qint64 size_;
+    mutable QDateTime check_expire_;
+};
+
+} /* MeeGo */
+#endif /* QMBATTERYENERGY_P_H */
@@ -0,0 +1,386 @@
+/*!
+ * @file qmbatteryhistory.cpp
+ * @brief QmBatteryHistory and the battery history log writer
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "qmbatteryhistory.h"
+#include "qmbatteryhistory_p.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+}
+
+#define HISTORY_DIR ".qmsystem2"
+#define HISTORY_FILE "battery-history"
+
+/* Records this close in time with the same values are duplicates */
+#define HISTORY_DUPLICATE_WINDOW 1 /* s */
+
+namespace MeeGo {
+
+/* The layout is the file format */
+typedef char EmHistoryRecordSize[sizeof(QmBatteryHistory::Record) == 32 ? 1 : -1];
+typedef char EmHistoryHeaderSize[sizeof(EmHistoryHeader) == 32 ? 1 : -1];
+
+static quint16 record_checksum(const QmBatteryHistory::Record &record)
+{
+    return qChecksum((const char *)&record,
+                     sizeof(record) - sizeof(record.checksum));
+}
+
+static quint16 header_checksum(const EmHistoryHeader &header)
+{
+    return qChecksum((const char *)&header,
+                     sizeof(header) - sizeof(header.checksum));
+}
+
+static bool is_duplicate(const QmBatteryHistory::Record *last,
+                         const QmBatteryHistory::Record &record, int window)
+{
+    return last && window >= 0
+        && record.time - last->time <= (quint32)window
+        && memcmp(&last->current, &record.current,
+                  offsetof(QmBatteryHistory::Record, flags)
+                  - offsetof(QmBatteryHistory::Record, current)) == 0;
+}
+
+static size_t file_size(quint32 capacity)
+{
+    return sizeof(EmHistoryHeader) + capacity * sizeof(QmBatteryHistory::Record);
+}
+
+/*------------ class EmHistoryFile ------------*/
+
+EmHistoryFile::EmHistoryFile()
+    : fd_(-1),
+      base_(0),
+      size_(0),
+      writable_(false)
+{ }
+
+EmHistoryFile::~EmHistoryFile()
+{
+    unmap();
+}
+
+QString EmHistoryFile::default_path()
+{
+    return QDir::homePath() + "/" HISTORY_DIR "/" HISTORY_FILE;
+}
+
+bool EmHistoryFile::map(const QString &path, bool writable)
+{
+    unmap();
+
+    QByteArray name = QFile::encodeName(path);
+    fd_ = ::open(name.constData(), writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+    if (fd_ < 0) {
+        if (writable || errno != ENOENT)
+            qWarning() << "Can't open" << path << strerror(errno);
+        return false;
+    }
+
+    ::flock(fd_, writable ? LOCK_EX : LOCK_SH);
+
+    EmHistoryHeader header;
+    memset(&header, 0, sizeof(header));
+    struct stat st;
+    bool valid = ::fstat(fd_, &st) == 0
+        && ::pread(fd_, &header, sizeof(header), 0) == sizeof(header)
+        && header.magic == HISTORY_MAGIC
+        && header.version == HISTORY_VERSION
+        && header.record_size == sizeof(QmBatteryHistory::Record)
+        && header.capacity > 0
+        && (size_t)st.st_size == file_size(header.capacity);
+
+    if (!valid && writable) {
+        /* New or foreign file, start over */
+        memset(&header, 0, sizeof(header));
+        header.magic = HISTORY_MAGIC;
+        header.version = HISTORY_VERSION;
+        header.record_size = sizeof(QmBatteryHistory::Record);
+        header.capacity = HISTORY_CAPACITY;
+        header.checksum = header_checksum(header);
+        valid = ::ftruncate(fd_, 0) == 0
+            && ::ftruncate(fd_, file_size(header.capacity)) == 0
+            && ::pwrite(fd_, &header, sizeof(header), 0) == sizeof(header);
+    }
+
+    if (valid) {
+        size_ = file_size(header.capacity);
+        void *base = ::mmap(0, size_, writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                            MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED) {
+            qWarning() << "Can't map" << path << strerror(errno);
+            valid = false;
+        } else {
+            base_ = (uchar *)base;
+            writable_ = writable;
+        }
+    }
+
+    if (valid && writable) {
+        /* After a crash the header may lag behind or be torn, trust the records */
+        quint32 seq = recover_();
+        if (seq != header_()->seq || header_checksum(*header_()) != header_()->checksum)
+            commit_(seq);
+    }
+
+    ::flock(fd_, LOCK_UN);
+
+    if (!valid)
+        unmap();
+    return valid;
+}
+
+void EmHistoryFile::unmap()
+{
+    if (base_)
+        ::munmap(base_, size_);
+    if (fd_ >= 0)
+        ::close(fd_);
+    base_ = 0;
+    size_ = 0;
+    fd_ = -1;
+    writable_ = false;
+}
+
+EmHistoryHeader *EmHistoryFile::header_() const
+{
+    return (EmHistoryHeader *)base_;
+}
+
+QmBatteryHistory::Record *EmHistoryFile::slot_(quint32 seq) const
+{
+    QmBatteryHistory::Record *slots
+        = (QmBatteryHistory::Record *)(base_ + sizeof(EmHistoryHeader));
+    return &slots[(seq - 1) % header_()->capacity];
+}
+
+quint32 EmHistoryFile::capacity() const
+{
+    return base_ ? header_()->capacity : 0;
+}
+
+const QmBatteryHistory::Record *EmHistoryFile::record(quint32 seq) const
+{
+    if (!base_ || seq == 0)
+        return 0;
+
+    const QmBatteryHistory::Record *record = slot_(seq);
+    if (record->seq != seq || record_checksum(*record) != record->checksum)
+        return 0;
+    return record;
+}
+
+quint32 EmHistoryFile::recover_() const
+{
+    quint32 last = 0;
+    for (quint32 i = 1; i <= header_()->capacity; i++) {
+        const QmBatteryHistory::Record *candidate = slot_(i);
+        if (candidate->seq > last && record(candidate->seq) == candidate)
+            last = candidate->seq;
+    }
+    return last;
+}
+
+quint32 EmHistoryFile::last_seq() const
+{
+    if (!base_)
+        return 0;
+
+    /* The header may be half way through a commit, the records tell */
+    quint32 seq = header_()->seq;
+    if (seq == 0 || record(seq))
+        return seq;
+    return recover_();
+}
+
+void EmHistoryFile::commit_(quint32 seq)
+{
+    EmHistoryHeader *header = header_();
+    header->seq = seq;
+    header->checksum = header_checksum(*header);
+}
+
+bool EmHistoryFile::append(QmBatteryHistory::Record &record, int window)
+{
+    if (!base_ || !writable_)
+        return false;
+
+    /* Other processes may append at the same time, possibly the same */
+    ::flock(fd_, LOCK_EX);
+
+    if (is_duplicate(this->record(last_seq()), record, window)) {
+        ::flock(fd_, LOCK_UN);
+        return false;
+    }
+
+    record.seq = header_()->seq + 1;
+    record.checksum = record_checksum(record);
+
+    QmBatteryHistory::Record *slot = slot_(record.seq);
+    *slot = record;
+    /* The record must be complete before the header points to it */
+    __sync_synchronize();
+    commit_(record.seq);
+
+    long page = ::sysconf(_SC_PAGESIZE);
+    uchar *start = (uchar *)((quintptr)slot & ~(quintptr)(page - 1));
+    ::msync(start, (uchar *)(slot + 1) - start, MS_ASYNC);
+    ::msync(base_, sizeof(EmHistoryHeader), MS_ASYNC);
+
+    ::flock(fd_, LOCK_UN);
+    return true;
+}
+
+/*------------ class EmHistory ------------*/
+
+EmHistory *EmHistory::object_ = 0;
+QMutex EmHistory::object_mutex_;
+
+EmHistory::EmHistory()
+    : counter_(0),
+      started_(false),
+      mapped_(false)
+{ }
+
+EmHistory *EmHistory::get_object()
+{
+    QMutexLocker locker(&object_mutex_);
+    if (!object_)
+        object_ = new EmHistory();
+    ++object_->counter_;
+    return object_;
+}
+
+void EmHistory::unref_object()
+{
+    QMutexLocker locker(&object_mutex_);
+    if (object_ && --object_->counter_ == 0) {
+        delete object_;
+        object_ = 0;
+    }
+}
+
+void EmHistory::append(const QmBattery::Stat &stat)
+{
+    QMutexLocker locker(&object_mutex_);
+
+    if (!mapped_) {
+        /* Tried once, a read-only home is not retried on every change */
+        mapped_ = true;
+        QDir().mkpath(QDir::homePath() + "/" HISTORY_DIR);
+        file_.map(EmHistoryFile::default_path(), true);
+    }
+
+    QmBatteryHistory::Record record;
+    memset(&record, 0, sizeof(record));
+    record.time = ::time(0);
+    record.current = stat.current;
+    record.cumulativeCurrent = stat.cumulativeCurrent;
+    record.voltage = stat.voltage;
+    record.temperature = stat.temperature * 10;
+    record.capacitymAh = stat.capacitymAh;
+    record.capacityPct = stat.capacityPct;
+    record.chargerType = stat.chargerType;
+    record.chargingState = stat.chargingState;
+    record.batteryState = stat.batteryState;
+
+    if (!started_)
+        record.flags |= QmBatteryHistory::FlagWriterStarted;
+    if (file_.append(record, HISTORY_DUPLICATE_WINDOW))
+        started_ = true;
+}
+
+/*------------ class QmBatteryHistory ------------*/
+
+QmBatteryHistory::QmBatteryHistory(QObject *parent)
+    : QObject(parent),
+      pimpl_(new QmBatteryHistoryPrivate())
+{ }
+
+QmBatteryHistory::~QmBatteryHistory() { }
+
+bool QmBatteryHistory::open(const QString &path)
+{
+    if (!pimpl_->file.map(path.isEmpty() ? EmHistoryFile::default_path() : path, false))
+        return false;
+    refresh();
+    return true;
+}
+
+void QmBatteryHistory::close()
+{
+    pimpl_->file.unmap();
+    pimpl_->first = 1;
+    pimpl_->last = 0;
+}
+
+void QmBatteryHistory::refresh()
+{
+    quint32 last = pimpl_->file.last_seq();
+    quint32 capacity = pimpl_->file.capacity();
+    pimpl_->last = last;
+    pimpl_->first = last > capacity ? last - capacity + 1 : 1;
+}
+
+int QmBatteryHistory::count() const
+{
+    return pimpl_->last + 1 - pimpl_->first;
+}
+
+const QmBatteryHistory::Record *QmBatteryHistory::at(int index) const
+{
+    if (index < 0 || index >= count())
+        return 0;
+    return pimpl_->file.record(pimpl_->first + index);
+}
+
+int QmBatteryHistory::lowerBound(uint time) const
+{
+    /* Overwritten records are the oldest ones, they sort first */
+    int low = 0;
+    int high = count();
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        const Record *record = at(middle);
+        if (!record || record->time < time)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+} /* MeeGo */
@@ -0,0 +1,148 @@
+/*!
+ * @file qmbatteryhistory.h
+ * @brief Contains QmBatteryHistory.
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Nokia Meego
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMBATTERYHISTORY_H
+#define QMBATTERYHISTORY_H
+
+#include <QtCore/qobject.h>
+#include "system_global.h"
+#include <QScopedPointer>
+#include <QString>
+
+QT_BEGIN_HEADER
+
+namespace MeeGo {
+
+class QmBatteryHistoryPrivate;
+
+/*!
+ *
+ * @scope Nokia Meego
+ *
+ * @class QmBatteryHistory
+ * @brief QmBatteryHistory reads the battery history log.
+ *
+ * @details QmBattery appends a record to the log on every battery event.
+ * The log is a file of fixed size records used as a ring, so it holds
+ * the latest few days of history. The file is mapped into memory and the
+ * records are returned as pointers into the mapping, without copying.
+ */
+class MEEGO_SYSTEM_EXPORT QmBatteryHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    //! One history record, as stored in the log (native endian)
+    struct Record
+    {
+        quint32 seq;               //!< Sequence number, 1 for the first record ever written
+        quint32 time;              //!< Seconds since epoch
+        qint32 current;            //!< Battery current (mA), positive when discharging
+        qint32 cumulativeCurrent;  //!< Coulomb counter (mAs), see QmBattery::getCumulativeBatteryCurrent()
+        quint16 voltage;           //!< Battery voltage (mV)
+        qint16 temperature;        //!< Battery temperature (0.1 degrees Celsius)
+        quint16 capacitymAh;       //!< Remaining capacity (mAh)
+        quint8 capacityPct;        //!< Remaining capacity (%)
+        qint8 chargerType;         //!< QmBattery::ChargerType
+        quint8 chargingState;      //!< QmBattery::ChargingState
+        quint8 batteryState;       //!< QmBattery::BatteryState
+        quint16 flags;             //!< Combination of RecordFlag
+        quint16 reserved;
+        quint16 checksum;
+    };
+
+    //! Record flags
+    enum RecordFlag
+    {
+        FlagWriterStarted = 0x0001  //!< First record of a writer, the log may have a gap before it
+    };
+
+    QmBatteryHistory(QObject *parent = 0);
+    virtual ~QmBatteryHistory();
+
+    /*!
+     * @brief Maps the history log for reading.
+     *
+     * @param path  The log file, or the log of the current user if empty
+     *
+     * @retval  TRUE   success
+     * @retval  FALSE  failure
+     */
+    bool open(const QString &path = QString());
+
+    /*!
+     * @brief Unmaps the history log. Pointers returned by at() become invalid.
+     */
+    void close();
+
+    /*!
+     * @brief Takes a new snapshot of the log to see records appended since
+     * the last open() or refresh().
+     */
+    void refresh();
+
+    /*!
+     * @brief Gets the number of records in the snapshot.
+     *
+     * @return The number of records
+     */
+    int count() const;
+
+    /*!
+     * @brief Gets a record of the snapshot, oldest first.
+     *
+     * @details The record points into the mapped log. It stays valid until
+     * the log wraps around to it, so consume the records soon after a
+     * refresh().
+     *
+     * @param index  Index of the record [0 - count() - 1]
+     *
+     * @return The record, or 0 if it has been overwritten or damaged
+     */
+    const Record *at(int index) const;
+
+    /*!
+     * @brief Finds the first record of the snapshot written at or after
+     * the given time.
+     *
+     * @param time  Seconds since epoch
+     *
+     * @return Index of the record, or count() if there is none
+     */
+    int lowerBound(uint time) const;
+
+private:
+    Q_DISABLE_COPY(QmBatteryHistory)
+    QScopedPointer<QmBatteryHistoryPrivate> pimpl_;
+};
+
+} // MeeGo namespace
+
+QT_END_HEADER
+
+#endif /*QMBATTERYHISTORY_H*/
+
+// End of file
@@ -0,0 +1,134 @@
+/*!
+ * @file qmbatteryhistory_p.h
+ * @brief Contains the battery history log file and its writer
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef QMBATTERYHISTORY_P_H
+#define QMBATTERYHISTORY_P_H
+
+#include <QMutex>
+#include <QString>
+
+#include "qmbattery.h"
+#include "qmbatteryhistory.h"
+
+#define HISTORY_MAGIC 0x48424d51 /* "QMBH" */
+#define HISTORY_VERSION 1
+#define HISTORY_CAPACITY 16384 /* records, 512 kB */
+
+namespace MeeGo {
+
+/*
+ * The log is this header followed by a ring of capacity records. Record
+ * number seq lives in slot (seq - 1) % capacity. A record is written
+ * before the header points to it, and both carry a checksum, so a torn
+ * write is detected and the last good record is recovered by scanning.
+ */
+struct EmHistoryHeader
+{
+    quint32 magic;
+    quint16 version;
+    quint16 record_size;
+    quint32 capacity;
+    quint32 seq;         /* last record written, 0 if none */
+    quint32 reserved[3];
+    quint16 pad;
+    quint16 checksum;
+};
+
+class EmHistoryFile
+{
+public:
+    EmHistoryFile();
+    ~EmHistoryFile();
+
+    /* Writable maps create or reinitialize a bad file */
+    bool map(const QString &path, bool writable);
+    void unmap();
+    bool is_mapped() const { return base_ != 0; }
+
+    quint32 capacity() const;
+    quint32 last_seq() const;
+
+    /* The record with this seq, 0 if overwritten or damaged */
+    const QmBatteryHistory::Record *record(quint32 seq) const;
+
+    /*
+     * Assigns seq and checksum. With a window, a record with the values of
+     * the last one and at most window seconds after it is not written
+     * again. Returns false if nothing was written.
+     */
+    bool append(QmBatteryHistory::Record &record, int window = -1);
+
+    static QString default_path();
+
+private:
+    EmHistoryHeader *header_() const;
+    QmBatteryHistory::Record *slot_(quint32 seq) const;
+    quint32 recover_() const;
+    void commit_(quint32 seq);
+
+    int fd_;
+    uchar *base_;
+    size_t size_;
+    bool writable_;
+};
+
+/*
+ * Process-wide writer of the history log, shared by all QmBattery
+ * instances. Identical records from several instances or processes are
+ * written only once. The log is mapped on the first record, most users
+ * of QmBattery never write one.
+ */
+class EmHistory
+{
+public:
+    static EmHistory *get_object();
+    static void unref_object();
+
+    void append(const QmBattery::Stat &stat);
+
+private:
+    EmHistory();
+
+    static EmHistory *object_;
+    static QMutex object_mutex_;
+
+    int counter_;
+    bool started_;
+    bool mapped_;
+    EmHistoryFile file_;
+};
+
+class QmBatteryHistoryPrivate
+{
+public:
+    QmBatteryHistoryPrivate() : first(1), last(0) { }
+
+    EmHistoryFile file;
+    quint32 first;  /* snapshot */
+    quint32 last;
+};
+
+} /* MeeGo */
+#endif /* QMBATTERYHISTORY_P_H */
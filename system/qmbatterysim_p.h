@@ -0,0 +1,86 @@
+/*!
+ * @file qmbatterysim_p.h
+ * @brief Wire protocol between the BME simulator backend and the battery
+ * simulator
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#ifndef QMBATTERYSIM_P_H
+#define QMBATTERYSIM_P_H
+
+#include <QtCore/qglobal.h>
+
+/*
+ * If set, QmBattery talks to the simulator listening on this Unix socket
+ * path instead of BME. Only libraries built with CONFIG+=bmesim look at
+ * it.
+ */
+#define EMSIM_SOCKET_ENV "QMSYSTEM_BME_SIMULATOR"
+
+/* Measurements are streamed to this mq instead of BMEIPC_MQNAME */
+#define EMSIM_MQNAME "/qmsystem2-bmesim"
+
+/*
+ * Every message on the socket is a header followed by len bytes of
+ * payload. A connection starts with a HELLO message telling whether it
+ * carries queries or events. BME messages are carried unmodified.
+ */
+enum emsim_type
+{
+    EMSIM_HELLO_IPC = 1,   /* no payload */
+    EMSIM_HELLO_EVENTS,    /* quint32 event mask */
+    EMSIM_QUERY,           /* BME request */
+    EMSIM_REPLY,           /* BME reply, possibly empty */
+    EMSIM_EVENT,           /* quint32 BMEVENT_* mask */
+    EMSIM_COUNTERS,        /* request: no payload, reply: emsim_counters */
+    EMSIM_INJECT,          /* emsim_inject, reply: no payload */
+    EMSIM_COMMAND          /* a trace command without the time, reply: no payload */
+};
+
+struct emsim_hdr
+{
+    quint32 type;
+    quint32 len;
+};
+
+/* Simulator side statistics, for benchmarks */
+struct emsim_counters
+{
+    quint32 queries;       /* all BME requests */
+    quint32 stat_queries;  /* BME_SYSMSG_GETSTAT requests */
+    quint32 events;        /* events sent to all clients */
+    quint32 measurements;  /* measurement messages sent */
+    quint32 restarts;      /* simulated BME restarts */
+};
+
+/*
+ * Sends count events with the given mask back to back. For BMEVENT_BATMON
+ * the battery level alternates between two values so that every event
+ * carries a change.
+ */
+struct emsim_inject
+{
+    quint32 count;
+    quint32 mask;
+};
+
+#endif /* QMBATTERYSIM_P_H */
@@ -48,16 +48,15 @@ namespace MeeGo {
 
     QmCompassReading QmCompass::get()
     {
+        QmCompassPrivate *priv = reinterpret_cast<QmCompassPrivate*>(priv_ptr);
+        QmCompassReading output;
+        if (priv->cached(priv->cache, &output)) {
+            return output;
+        }
         if(!verifySessionLevel(QmSensor::SessionTypeListen)) {
             return QmCompassReading();
         }
-        QmCompassPrivate *priv = reinterpret_cast<QmCompassPrivate*>(priv_ptr);
-        Compass value = priv->sensorIfc->get();
-        QmCompassReading output;
-        output.timestamp = value.data().timestamp_;
-        output.degrees = value.data().degrees_;
-        output.level = value.data().level_;
-        return output;
+        return priv->convert(priv->sensorIfc->get());
     }
 
     int QmCompass::declinationValue()
@@ -127,6 +127,8 @@ namespace MeeGo {
 
 } // MeeGo namespace
 
+Q_DECLARE_TYPEINFO(MeeGo::QmCompassReading, Q_PRIMITIVE_TYPE);
+
 QT_END_HEADER
 
 #endif
@@ -31,12 +31,25 @@
 #include "qmcompass.h"
 #include "qmsensor.h"
 #include "qmsensor_p.h"
+#include "qmsensorkernels_p.h"
 #include "sensord/compasssensor_i.h"
 #include "sensord/sensormanagerinterface.h"
 
 namespace MeeGo
 {
 
+    template <>
+    struct QmSensorChannels<QmCompassReading>
+    {
+        enum { Count = 1 };
+        static int& at(QmCompassReading& reading, int)
+        {
+            return reading.degrees;
+        }
+        static int period(int) { return 360; }
+        static int lowest(int) { return 0; }
+    };
+
     // ----------------- BEGIN PRIVATE CLASS DEFINITION ----------------- //
 
     class QmCompassPrivate : public QmSensorPrivate
@@ -56,12 +69,17 @@ namespace MeeGo
             closeSession();
         }
 
+        const char* sensorId()
+        {
+            return "compasssensor";
+        }
+
         bool init()
         {
             qDBusRegisterMetaType<Compass>();
             SensorManagerInterface& remoteSensorManager = SensorManagerInterface::instance();
-            remoteSensorManager.loadPlugin("compasssensor");
-            remoteSensorManager.registerSensorInterface<CompassSensorChannelInterface>("compasssensor");
+            remoteSensorManager.loadPlugin(sensorId());
+            remoteSensorManager.registerSensorInterface<CompassSensorChannelInterface>(sensorId());
             initDone_ = true;
             return true;
         }
@@ -69,25 +87,25 @@ namespace MeeGo
         AbstractSensorChannelInterface* controlSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return CompassSensorChannelInterface::controlInterface("compasssensor");
+            return CompassSensorChannelInterface::controlInterface(sensorId());
         }
 
         const AbstractSensorChannelInterface* listenSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return CompassSensorChannelInterface::listenInterface("compasssensor");
+            return CompassSensorChannelInterface::listenInterface(sensorId());
         }
 
 
         bool setupSignals(bool setOn)
         {
-            if (sensorIfc == NULL) {
+            if (source() == NULL) {
                 setError("No session open, unable to (dis)connect signals.");
                 return false;
             }
 
             if (setOn) {
-                bool result = connect(sensorIfc, SIGNAL(dataAvailable(const Compass&)),
+                bool result = connect(source(), SIGNAL(dataAvailable(const Compass&)),
                                       this, SLOT(slotDataAvailable(const Compass&)));
 
                 if (!result) {
@@ -96,7 +114,7 @@ namespace MeeGo
                 }
 
             } else {
-                bool result = disconnect(sensorIfc, SIGNAL(dataAvailable(const Compass&)),
+                bool result = disconnect(source(), SIGNAL(dataAvailable(const Compass&)),
                                   this, SLOT(slotDataAvailable(const Compass&)));
 
                 if (!result) {
@@ -107,6 +125,27 @@ namespace MeeGo
             return true;
         }
 
+        void clearCache()
+        {
+            cache.clear();
+        }
+
+        /**
+         * Converts a sensord reading, turning the azimuth from the x-axis to
+         * the y-axis.
+         */
+        static QmCompassReading convert(const Compass& value)
+        {
+            QmCompassReading output;
+            output.timestamp = value.data().timestamp_;
+            output.degrees = value.data().degrees_;
+            output.level = value.data().level_;
+            kernelCompassAzimuth(&output.degrees, 1);
+            return output;
+        }
+
+        QmSensorCache<QmCompassReading> cache;
+
     Q_SIGNALS:
         void dataAvailable(const MeeGo::QmCompassReading value);
 
@@ -114,12 +153,16 @@ namespace MeeGo
 
         void slotDataAvailable(const Compass& value)
         {
-            QmCompassReading output;
-            output.timestamp = value.data().timestamp_;
-            output.degrees = (value.data().degrees_ + 90) % 360;
-            output.level = value.data().level_;
-            emit dataAvailable(output);
+            QmSensorProbe probe(meter_, value.data().timestamp_);
+            QmCompassReading output = convert(value);
+            cache.store(output);
+            if (decimate(decimator_, output) && !consume(output)) {
+                emit dataAvailable(output);
+            }
         }
+
+    private:
+        QmSensorDecimator<QmCompassReading> decimator_;
     };
 
     // ------------------ END PRIVATE CLASS DEFINITION ------------------ //
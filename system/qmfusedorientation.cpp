@@ -0,0 +1,67 @@
+/*!
+ * @file qmfusedorientation.cpp
+ * @brief QmFusedOrientation
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmfusedorientation.h"
+#include "qmfusedorientation_p.h"
+
+#include <QDebug>
+
+namespace MeeGo {
+
+    QmFusedOrientation::QmFusedOrientation(QObject *parent) : QmSensor(parent)
+    {
+        QmFusedOrientationPrivate *priv = new QmFusedOrientationPrivate(this);
+        connect(priv, SIGNAL(dataAvailable(MeeGo::QmFusedOrientationReading)), this, SIGNAL(dataAvailable(MeeGo::QmFusedOrientationReading)));
+        priv_ptr = priv;
+    }
+
+    QmFusedOrientation::~QmFusedOrientation()
+    {
+
+    }
+
+    QmFusedOrientationReading QmFusedOrientation::orientation()
+    {
+        QmFusedOrientationPrivate *priv = reinterpret_cast<QmFusedOrientationPrivate*>(priv_ptr);
+        QmFusedOrientationReading output;
+        if (priv->cached(priv->cache, &output)) {
+            return output;
+        }
+        return priv->reading(priv->timestamp);
+    }
+
+    void QmFusedOrientation::setSmoothing(float weight)
+    {
+        QmFusedOrientationPrivate *priv = reinterpret_cast<QmFusedOrientationPrivate*>(priv_ptr);
+        priv->fusion.smoothing = qBound(0.01f, weight, 1.0f);
+    }
+
+    float QmFusedOrientation::smoothing()
+    {
+        QmFusedOrientationPrivate *priv = reinterpret_cast<QmFusedOrientationPrivate*>(priv_ptr);
+        return priv->fusion.smoothing;
+    }
+
+}
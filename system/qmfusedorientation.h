@@ -0,0 +1,125 @@
+/*!
+ * @file qmfusedorientation.h
+ * @brief Contains QmFusedOrientation, which provides device orientation fused from accelerometer and magnetometer.
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMFUSEDORIENTATION_H
+#define QMFUSEDORIENTATION_H
+
+#include "system_global.h"
+#include <QtCore/qobject.h>
+#include <qmsensor.h>
+
+QT_BEGIN_HEADER
+
+namespace MeeGo {
+
+    class QmFusedOrientationPrivate;
+
+    /**
+     * Fused orientation estimate
+     */
+    class QmFusedOrientationReading : public QmSensorReading
+    {
+    public:
+        float w;        /**< Quaternion rotating device coordinates to east-north-up world coordinates */
+        float x;
+        float y;
+        float z;
+        float heading;  /**< Direction of the device y-axis from magnetic north, clockwise [0, 360) degrees */
+        float pitch;    /**< Elevation of the device y-axis above the horizon [-90, 90] degrees */
+        float roll;     /**< Rotation around the device y-axis, positive when the x-axis points up [-180, 180] degrees */
+    };
+
+    /**
+     * @scope Internal
+     *
+     * @brief Provides device orientation fused from accelerometer and
+     * magnetometer.
+     *
+     * The orientation is measured from the direction of gravity and of the
+     * magnetic field, and blended into the running estimate with a
+     * complementary filter. It is given as a quaternion and as heading and
+     * tilt angles, in the Nokia Coordinate System described in
+     * #QmAccelerometer.
+     *
+     * The sensor uses the shared accelerometer and magnetometer sessions
+     * of the process, so it adds no sensord sessions of its own when other
+     * clients already use those sensors. An estimate is delivered for each
+     * accelerometer reading once a magnetometer reading has arrived; the
+     * rate follows #setInterval(), which applies to both sensors.
+     *
+     * To get measurements from the daemon, the client must open a
+     * session and call start(). Details can be found from documentation
+     * of #QmSensor.
+     */
+    class MEEGO_SYSTEM_EXPORT QmFusedOrientation : public QmSensor
+    {
+        Q_OBJECT;
+
+    public:
+        /**
+         * Constructor
+         * @param parent Parent QObject.
+         */
+        QmFusedOrientation(QObject *parent = 0);
+
+        /**
+         * Destructor
+         */
+        ~QmFusedOrientation();
+
+        /**
+         * Gets the latest estimate.
+         * @return Latest estimate, or the identity orientation if there is none yet
+         */
+        QmFusedOrientationReading orientation();
+
+        /**
+         * Sets the weight of a new measurement in the estimate. Small values
+         * give a steady but slow estimate, 1 uses the measurements as is.
+         * @param weight Weight (0, 1], default 0.2
+         */
+        void setSmoothing(float weight);
+
+        /**
+         * Returns the weight of a new measurement, see #setSmoothing().
+         * @return Weight
+         */
+        float smoothing();
+
+    Q_SIGNALS:
+        /**
+         * Signals the availability of a new estimate.
+         * @param data The estimate
+         */
+        void dataAvailable(const MeeGo::QmFusedOrientationReading& data);
+    };
+
+} // MeeGo namespace
+
+Q_DECLARE_TYPEINFO(MeeGo::QmFusedOrientationReading, Q_PRIMITIVE_TYPE);
+
+QT_END_HEADER
+
+#endif
@@ -0,0 +1,342 @@
+/*!
+ * @file qmfusedorientation_p.h
+ * @brief Contains QmFusedOrientationPrivate
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMFUSEDORIENTATION_P_H
+#define QMFUSEDORIENTATION_P_H
+
+#include "qmaccelerometer.h"
+#include "qmfusedorientation.h"
+#include "qmmagnetometer.h"
+#include "qmsensor_p.h"
+#include "qmsensorkernels_p.h"
+#include <math.h>
+
+/* Below this length a vector has no usable direction */
+#define FUSION_EPSILON 1e-6f
+
+namespace MeeGo
+{
+    /**
+     * Complementary filter of the device orientation. Each update measures
+     * the orientation from gravity and the magnetic field (TRIAD) and moves
+     * the estimate towards it by the smoothing weight (normalized linear
+     * quaternion interpolation).
+     *
+     * Gravity is taken as the accelerometer reading, which points up when
+     * the device is at rest. East is the field crossed with up, north is
+     * up crossed with east.
+     */
+    class QmOrientationFusion
+    {
+    public:
+        QmOrientationFusion() : smoothing(0.2f)
+        {
+            reset();
+        }
+
+        float smoothing;
+
+        void reset()
+        {
+            hasGravity_ = hasField_ = hasEstimate_ = false;
+            q_[0] = 1;
+            q_[1] = q_[2] = q_[3] = 0;
+        }
+
+        void setGravity(float x, float y, float z)
+        {
+            gravity_[0] = x;
+            gravity_[1] = y;
+            gravity_[2] = z;
+            hasGravity_ = true;
+        }
+
+        void setField(float x, float y, float z)
+        {
+            field_[0] = x;
+            field_[1] = y;
+            field_[2] = z;
+            hasField_ = true;
+        }
+
+        /**
+         * Blends the orientation measured from the latest gravity and field
+         * into the estimate.
+         *
+         * @return \c false if either is missing, or they are parallel
+         */
+        bool update()
+        {
+            float measured[4];
+            if (!hasGravity_ || !hasField_ || !measure(measured)) {
+                return false;
+            }
+
+            if (!hasEstimate_) {
+                for (int i = 0; i < 4; i++) {
+                    q_[i] = measured[i];
+                }
+                hasEstimate_ = true;
+                return true;
+            }
+
+            // q and -q are the same rotation, blend along the short way
+            float dot = 0;
+            for (int i = 0; i < 4; i++) {
+                dot += q_[i] * measured[i];
+            }
+            float sign = dot < 0 ? -1 : 1;
+            for (int i = 0; i < 4; i++) {
+                q_[i] += smoothing * (sign * measured[i] - q_[i]);
+            }
+            normalize(q_, 4);
+            return true;
+        }
+
+        bool hasEstimate() const { return hasEstimate_; }
+
+        /** w, x, y, z */
+        const float* quaternion() const { return q_; }
+
+        float heading() const
+        {
+            float r[3][3];
+            matrix(r);
+            float degrees = atan2f(r[0][1], r[1][1]) * (float)(180 / M_PI);
+            return degrees < 0 ? degrees + 360 : degrees;
+        }
+
+        float pitch() const
+        {
+            float r[3][3];
+            matrix(r);
+            return asinf(qBound(-1.0f, r[2][1], 1.0f)) * (float)(180 / M_PI);
+        }
+
+        float roll() const
+        {
+            float r[3][3];
+            matrix(r);
+            return atan2f(r[2][0], r[2][2]) * (float)(180 / M_PI);
+        }
+
+    private:
+        static float normalize(float *v, int n)
+        {
+            float length = 0;
+            for (int i = 0; i < n; i++) {
+                length += v[i] * v[i];
+            }
+            length = sqrtf(length);
+            if (length > FUSION_EPSILON) {
+                for (int i = 0; i < n; i++) {
+                    v[i] /= length;
+                }
+            }
+            return length;
+        }
+
+        static void cross(const float *a, const float *b, float *out)
+        {
+            out[0] = a[1] * b[2] - a[2] * b[1];
+            out[1] = a[2] * b[0] - a[0] * b[2];
+            out[2] = a[0] * b[1] - a[1] * b[0];
+        }
+
+        bool measure(float *q) const
+        {
+            // Rows are east, north and up in device coordinates, so the
+            // matrix rotates device coordinates to world coordinates
+            float r[3][3];
+            for (int i = 0; i < 3; i++) {
+                r[2][i] = gravity_[i];
+            }
+            if (normalize(r[2], 3) <= FUSION_EPSILON) {
+                return false;
+            }
+            cross(field_, r[2], r[0]);
+            if (normalize(r[0], 3) <= FUSION_EPSILON) {
+                return false;
+            }
+            cross(r[2], r[0], r[1]);
+
+            float trace = r[0][0] + r[1][1] + r[2][2];
+            if (trace > 0) {
+                float s = sqrtf(trace + 1) * 2;
+                q[0] = s / 4;
+                q[1] = (r[2][1] - r[1][2]) / s;
+                q[2] = (r[0][2] - r[2][0]) / s;
+                q[3] = (r[1][0] - r[0][1]) / s;
+            } else if (r[0][0] > r[1][1] && r[0][0] > r[2][2]) {
+                float s = sqrtf(1 + r[0][0] - r[1][1] - r[2][2]) * 2;
+                q[0] = (r[2][1] - r[1][2]) / s;
+                q[1] = s / 4;
+                q[2] = (r[0][1] + r[1][0]) / s;
+                q[3] = (r[0][2] + r[2][0]) / s;
+            } else if (r[1][1] > r[2][2]) {
+                float s = sqrtf(1 + r[1][1] - r[0][0] - r[2][2]) * 2;
+                q[0] = (r[0][2] - r[2][0]) / s;
+                q[1] = (r[0][1] + r[1][0]) / s;
+                q[2] = s / 4;
+                q[3] = (r[1][2] + r[2][1]) / s;
+            } else {
+                float s = sqrtf(1 + r[2][2] - r[0][0] - r[1][1]) * 2;
+                q[0] = (r[1][0] - r[0][1]) / s;
+                q[1] = (r[0][2] + r[2][0]) / s;
+                q[2] = (r[1][2] + r[2][1]) / s;
+                q[3] = s / 4;
+            }
+            normalize(q, 4);
+            return true;
+        }
+
+        void matrix(float r[3][3]) const
+        {
+            float w = q_[0], x = q_[1], y = q_[2], z = q_[3];
+            r[0][0] = 1 - 2 * (y * y + z * z);
+            r[0][1] = 2 * (x * y - w * z);
+            r[0][2] = 2 * (x * z + w * y);
+            r[1][0] = 2 * (x * y + w * z);
+            r[1][1] = 1 - 2 * (x * x + z * z);
+            r[1][2] = 2 * (y * z - w * x);
+            r[2][0] = 2 * (x * z - w * y);
+            r[2][1] = 2 * (y * z + w * x);
+            r[2][2] = 1 - 2 * (x * x + y * y);
+        }
+
+        float gravity_[3];
+        float field_[3];
+        float q_[4];
+        bool hasGravity_;
+        bool hasField_;
+        bool hasEstimate_;
+    };
+
+    /**
+     * Fuses the readings of the accelerometer and magnetometer it owns.
+     */
+    class QmFusedOrientationPrivate : public QmCompositeSensorPrivate
+    {
+        Q_OBJECT;
+        MEEGO_DECLARE_PUBLIC(QmFusedOrientation);
+        DEFINE_PUBLIC_FUNCTION(QmFusedOrientation);
+
+    public:
+        QmAccelerometer accelerometer;
+        QmMagnetometer magnetometer;
+        QmOrientationFusion fusion;
+        QmSensorCache<QmFusedOrientationReading> cache;
+        quint64 timestamp;
+
+        QmFusedOrientationPrivate(QmFusedOrientation *parent) : QmCompositeSensorPrivate(parent), timestamp(0) {
+            pub_ptr = parent;
+            addPart(&accelerometer);
+            addPart(&magnetometer);
+        }
+
+        ~QmFusedOrientationPrivate() {
+            closeSession();
+        }
+
+        const char* sensorId()
+        {
+            return "fusedorientation";
+        }
+
+        void resetState()
+        {
+            fusion.reset();
+            timestamp = 0;
+        }
+
+        void clearCache()
+        {
+            cache.clear();
+        }
+
+        bool setupSignals(bool setOn)
+        {
+            if (setOn) {
+                if (!connect(&accelerometer, SIGNAL(dataAvailable(const MeeGo::QmAccelerometerReading&)),
+                             this, SLOT(slotAcceleration(const MeeGo::QmAccelerometerReading&))) ||
+                    !connect(&magnetometer, SIGNAL(dataAvailable(const MeeGo::QmMagnetometerReading&)),
+                             this, SLOT(slotMagneticField(const MeeGo::QmMagnetometerReading&)))) {
+                    setError("Unable to connect signals");
+                    return false;
+                }
+            } else {
+                disconnect(&accelerometer, 0, this, 0);
+                disconnect(&magnetometer, 0, this, 0);
+            }
+            return true;
+        }
+
+        QmFusedOrientationReading reading(quint64 timestamp)
+        {
+            QmFusedOrientationReading output;
+            output.timestamp = timestamp;
+            const float *q = fusion.quaternion();
+            output.w = q[0];
+            output.x = q[1];
+            output.y = q[2];
+            output.z = q[3];
+            output.heading = fusion.heading();
+            output.pitch = fusion.pitch();
+            output.roll = fusion.roll();
+            return output;
+        }
+
+    Q_SIGNALS:
+        void dataAvailable(const MeeGo::QmFusedOrientationReading& data);
+
+    public Q_SLOTS:
+
+        void slotAcceleration(const MeeGo::QmAccelerometerReading& data)
+        {
+            QmSensorProbe probe(meter_, data.timestamp);
+            fusion.setGravity(data.x, data.y, data.z);
+            if (!fusion.update()) {
+                return;
+            }
+
+            timestamp = data.timestamp;
+            QmFusedOrientationReading output = reading(timestamp);
+            cache.store(output);
+            if (!consume(output)) {
+                emit dataAvailable(output);
+            }
+        }
+
+        void slotMagneticField(const MeeGo::QmMagnetometerReading& data)
+        {
+            // The magnetometer keeps the axes of the sensor, turn them to
+            // the device like the accelerometer readings are
+            int x = data.x;
+            int y = data.y;
+            kernelAccelerometerAxes(&x, &y, 1);
+            fusion.setField(x, y, data.z);
+        }
+    };
+}
+#endif // QMFUSEDORIENTATION_P_H
@@ -0,0 +1,57 @@
+/*!
+ * @file qmgesture.cpp
+ * @brief QmGesture
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmgesture.h"
+#include "qmgesture_p.h"
+
+#include <QDebug>
+
+namespace MeeGo {
+
+    QmGesture::QmGesture(QObject *parent) : QmSensor(parent)
+    {
+        QmGesturePrivate *priv = new QmGesturePrivate(this);
+        connect(priv, SIGNAL(gestureDetected(MeeGo::QmGestureReading)), this, SIGNAL(gestureDetected(MeeGo::QmGestureReading)));
+        priv_ptr = priv;
+    }
+
+    QmGesture::~QmGesture()
+    {
+
+    }
+
+    void QmGesture::setThreshold(Gesture gesture, int value)
+    {
+        QmGesturePrivate *priv = reinterpret_cast<QmGesturePrivate*>(priv_ptr);
+        priv->detector.thresholds[gesture] = qMax(0, value);
+    }
+
+    int QmGesture::threshold(Gesture gesture)
+    {
+        QmGesturePrivate *priv = reinterpret_cast<QmGesturePrivate*>(priv_ptr);
+        return priv->detector.thresholds[gesture];
+    }
+
+}
@@ -0,0 +1,140 @@
+/*!
+ * @file qmgesture.h
+ * @brief Contains QmGesture, which provides shake, tilt and free fall events.
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMGESTURE_H
+#define QMGESTURE_H
+
+#include "system_global.h"
+#include <QtCore/qobject.h>
+#include <qmsensor.h>
+
+QT_BEGIN_HEADER
+
+namespace MeeGo {
+
+    class QmGestureReading;
+
+    /**
+     * @scope Internal
+     *
+     * @brief Provides shake, tilt and free fall events.
+     *
+     * The gestures are detected in the library from the accelerometer
+     * readings, and only the events are delivered. A client interested in
+     * a few gestures gets woken up by those, not by every reading. The
+     * sensor uses the shared accelerometer session of the process and asks
+     * for readings every 20 ms; #setInterval() changes that.
+     *
+     * A gesture is detected when its threshold is crossed:
+     * - #Shake: the acceleration, less gravity, goes past the threshold
+     *   (mG) in alternating directions three times within a second. One
+     *   event is delivered per second of shaking.
+     * - #Tilt: the device turns by the threshold (degrees) to one side
+     *   from the attitude of the previous tilt event, or of the start, and
+     *   is held there.
+     * - #FreeFall: the total acceleration stays below the threshold (mG)
+     *   for 80 ms. One event is delivered per fall.
+     *
+     * The directions are in the Nokia Coordinate System described in
+     * #QmAccelerometer.
+     *
+     * To get events, the client must open a session and call start().
+     * Details can be found from documentation of #QmSensor.
+     */
+    class MEEGO_SYSTEM_EXPORT QmGesture : public QmSensor
+    {
+        Q_OBJECT;
+
+    public:
+        enum Gesture {
+            Shake = 0,  /**< Device shaken back and forth */
+            Tilt,       /**< Device turned to a side and held */
+            FreeFall    /**< Device falling */
+        };
+
+        enum Direction {
+            NoDirection = 0,  /**< Free fall */
+            X,                /**< Shaken along the x-axis */
+            Y,                /**< Shaken along the y-axis */
+            Z,                /**< Shaken along the z-axis */
+            Left,             /**< Tilted left side down */
+            Right,            /**< Tilted right side down */
+            Forward,          /**< Tilted top side down */
+            Back              /**< Tilted top side up */
+        };
+
+        /**
+         * Constructor
+         * @param parent Parent QObject.
+         */
+        QmGesture(QObject *parent = 0);
+
+        /**
+         * Destructor
+         */
+        ~QmGesture();
+
+        /**
+         * Sets the threshold of a gesture.
+         * @param gesture The gesture
+         * @param value Threshold, 0 to not detect the gesture. Defaults are
+         *              1200 mG for shake, 30 degrees for tilt and 300 mG
+         *              for free fall.
+         */
+        void setThreshold(Gesture gesture, int value);
+
+        /**
+         * Returns the threshold of a gesture, see #setThreshold().
+         * @param gesture The gesture
+         * @return Threshold
+         */
+        int threshold(Gesture gesture);
+
+    Q_SIGNALS:
+        /**
+         * Sent when a gesture has been detected.
+         * @param data The gesture
+         */
+        void gestureDetected(const MeeGo::QmGestureReading data);
+    };
+
+    /**
+     * Detected gesture
+     */
+    class QmGestureReading : public QmSensorReading
+    {
+    public:
+        QmGesture::Gesture gesture;
+        QmGesture::Direction direction;
+        int value;  /**< Shake: peak acceleration (mG); tilt: angle (degrees); free fall: duration so far (ms) */
+    };
+
+} // MeeGo namespace
+
+Q_DECLARE_TYPEINFO(MeeGo::QmGestureReading, Q_PRIMITIVE_TYPE);
+
+QT_END_HEADER
+
+#endif
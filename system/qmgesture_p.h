@@ -0,0 +1,317 @@
+/*!
+ * @file qmgesture_p.h
+ * @brief Contains QmGesturePrivate
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMGESTURE_P_H
+#define QMGESTURE_P_H
+
+#include "qmaccelerometer.h"
+#include "qmgesture.h"
+#include "qmsensor_p.h"
+#include <math.h>
+
+/* Accelerometer interval asked for by the gesture sensor, unless the client sets one */
+#define GESTURE_INTERVAL 20 /* ms */
+/* Gestures detected from one reading, at most */
+#define GESTURE_EVENTS_MAX 3
+
+/* Weight of a reading in the gravity estimate */
+#define GESTURE_GRAVITY_WEIGHT 0.1f
+#define SHAKE_PEAKS 3
+#define SHAKE_WINDOW 1000000 /* us */
+#define FREEFALL_DURATION 80000 /* us */
+/* Readings this close to 1 G in length and to the gravity estimate are
+   taken as holding still */
+#define TILT_REST 200 /* mG */
+#define TILT_STEADY 50 /* mG */
+
+namespace MeeGo
+{
+    /**
+     * Detects gestures in a stream of accelerometer readings (mG).
+     *
+     * Gravity is estimated with a low-pass filter of the readings. Shakes
+     * are found in the readings less gravity, tilts in the direction of
+     * gravity, and falls in the length of the readings.
+     */
+    class QmGestureDetector
+    {
+    public:
+        QmGestureDetector()
+        {
+            thresholds[QmGesture::Shake] = 1200;
+            thresholds[QmGesture::Tilt] = 30;
+            thresholds[QmGesture::FreeFall] = 300;
+            reset();
+        }
+
+        /* Indexed by QmGesture::Gesture, 0 to not detect */
+        int thresholds[3];
+
+        void reset()
+        {
+            hasGravity_ = false;
+            peaks_ = 0;
+            peakSign_ = 0;
+            shakeQuiet_ = 0;
+            falling_ = false;
+            hasAttitude_ = false;
+        }
+
+        /**
+         * Adds a reading.
+         *
+         * @param events Room for GESTURE_EVENTS_MAX gestures
+         * @return Number of gestures detected
+         */
+        int add(quint64 timestamp, int x, int y, int z, QmGestureReading *events)
+        {
+            float reading[3] = { (float)x, (float)y, (float)z };
+            for (int i = 0; i < 3; i++) {
+                gravity_[i] = hasGravity_ ? gravity_[i] + GESTURE_GRAVITY_WEIGHT * (reading[i] - gravity_[i])
+                                          : reading[i];
+            }
+            hasGravity_ = true;
+            float length = sqrtf(reading[0] * reading[0] + reading[1] * reading[1] + reading[2] * reading[2]);
+
+            int count = 0;
+            if (thresholds[QmGesture::FreeFall] > 0 && freeFall(timestamp, length, &events[count])) {
+                count++;
+            }
+            if (thresholds[QmGesture::Shake] > 0 && shake(timestamp, reading, &events[count])) {
+                count++;
+            }
+            if (thresholds[QmGesture::Tilt] > 0 && tilt(timestamp, reading, length, &events[count])) {
+                count++;
+            }
+            return count;
+        }
+
+    private:
+        static void event(QmGestureReading *output, quint64 timestamp, QmGesture::Gesture gesture,
+                          QmGesture::Direction direction, int value)
+        {
+            output->timestamp = timestamp;
+            output->gesture = gesture;
+            output->direction = direction;
+            output->value = value;
+        }
+
+        bool freeFall(quint64 timestamp, float length, QmGestureReading *output)
+        {
+            if (length >= thresholds[QmGesture::FreeFall]) {
+                falling_ = false;
+                return false;
+            }
+            if (!falling_) {
+                falling_ = true;
+                fallReported_ = false;
+                fallStart_ = timestamp;
+            }
+            if (fallReported_ || timestamp - fallStart_ < FREEFALL_DURATION) {
+                return false;
+            }
+            fallReported_ = true;
+            event(output, timestamp, QmGesture::FreeFall, QmGesture::NoDirection, (timestamp - fallStart_) / 1000);
+            return true;
+        }
+
+        bool shake(quint64 timestamp, const float *reading, QmGestureReading *output)
+        {
+            if (timestamp < shakeQuiet_) {
+                return false;
+            }
+
+            // The strongest axis of the motion
+            int axis = 0;
+            float motion = 0;
+            for (int i = 0; i < 3; i++) {
+                float value = reading[i] - gravity_[i];
+                if (fabsf(value) > fabsf(motion)) {
+                    motion = value;
+                    axis = i;
+                }
+            }
+            if (fabsf(motion) < thresholds[QmGesture::Shake]) {
+                return false;
+            }
+
+            // A peak counts when it goes the other way than the previous one
+            int sign = motion > 0 ? 1 : -1;
+            if (peaks_ > 0 && timestamp - firstPeak_ > SHAKE_WINDOW) {
+                peaks_ = 0;
+            }
+            if (peaks_ > 0 && sign == peakSign_) {
+                if (fabsf(motion) > strongest_) {
+                    strongest_ = fabsf(motion);
+                    shakeAxis_ = axis;
+                }
+                return false;
+            }
+            if (peaks_ == 0) {
+                firstPeak_ = timestamp;
+                strongest_ = 0;
+            }
+            peaks_++;
+            peakSign_ = sign;
+            if (fabsf(motion) > strongest_) {
+                strongest_ = fabsf(motion);
+                shakeAxis_ = axis;
+            }
+            if (peaks_ < SHAKE_PEAKS) {
+                return false;
+            }
+
+            peaks_ = 0;
+            shakeQuiet_ = firstPeak_ + SHAKE_WINDOW;
+            event(output, timestamp, QmGesture::Shake, (QmGesture::Direction)(QmGesture::X + shakeAxis_),
+                  (int)strongest_);
+            return true;
+        }
+
+        bool tilt(quint64 timestamp, const float *reading, float length, QmGestureReading *output)
+        {
+            // Gravity is known once the device has been held still for a
+            // while, and the estimate has caught up with the readings
+            float moved = 0;
+            for (int i = 0; i < 3; i++) {
+                moved += (reading[i] - gravity_[i]) * (reading[i] - gravity_[i]);
+            }
+            if (fabsf(length - 1000) > TILT_REST || moved > TILT_STEADY * TILT_STEADY) {
+                return false;
+            }
+            float gravity = sqrtf(gravity_[0] * gravity_[0] + gravity_[1] * gravity_[1] + gravity_[2] * gravity_[2]);
+
+            // Turned right or top down when the side goes below the horizon
+            float roll = asinf(qBound(-1.0f, -gravity_[0] / gravity, 1.0f)) * (float)(180 / M_PI);
+            float pitch = asinf(qBound(-1.0f, -gravity_[1] / gravity, 1.0f)) * (float)(180 / M_PI);
+            if (!hasAttitude_) {
+                roll_ = roll;
+                pitch_ = pitch;
+                hasAttitude_ = true;
+                return false;
+            }
+
+            float rolled = roll - roll_;
+            float pitched = pitch - pitch_;
+            if (qMax(fabsf(rolled), fabsf(pitched)) < thresholds[QmGesture::Tilt]) {
+                return false;
+            }
+
+            roll_ = roll;
+            pitch_ = pitch;
+            if (fabsf(rolled) >= fabsf(pitched)) {
+                event(output, timestamp, QmGesture::Tilt, rolled > 0 ? QmGesture::Right : QmGesture::Left,
+                      qRound(fabsf(rolled)));
+            } else {
+                event(output, timestamp, QmGesture::Tilt, pitched > 0 ? QmGesture::Forward : QmGesture::Back,
+                      qRound(fabsf(pitched)));
+            }
+            return true;
+        }
+
+        float gravity_[3];
+        bool hasGravity_;
+
+        int peaks_;
+        int peakSign_;
+        quint64 firstPeak_;
+        float strongest_;
+        int shakeAxis_;
+        quint64 shakeQuiet_;    /* no shakes before this */
+
+        bool falling_;
+        bool fallReported_;
+        quint64 fallStart_;
+
+        /* Attitude at the previous tilt, in degrees */
+        bool hasAttitude_;
+        float roll_;
+        float pitch_;
+    };
+
+    /**
+     * Detects gestures in the readings of the accelerometer it owns.
+     */
+    class QmGesturePrivate : public QmCompositeSensorPrivate
+    {
+        Q_OBJECT;
+        MEEGO_DECLARE_PUBLIC(QmGesture);
+        DEFINE_PUBLIC_FUNCTION(QmGesture);
+
+    public:
+        QmAccelerometer accelerometer;
+        QmGestureDetector detector;
+
+        QmGesturePrivate(QmGesture *parent) : QmCompositeSensorPrivate(parent, GESTURE_INTERVAL) {
+            pub_ptr = parent;
+            addPart(&accelerometer);
+        }
+
+        ~QmGesturePrivate() {
+            closeSession();
+        }
+
+        const char* sensorId()
+        {
+            return "gesture";
+        }
+
+        void resetState()
+        {
+            detector.reset();
+        }
+
+        bool setupSignals(bool setOn)
+        {
+            if (setOn) {
+                if (!connect(&accelerometer, SIGNAL(dataAvailable(const MeeGo::QmAccelerometerReading&)),
+                             this, SLOT(slotAcceleration(const MeeGo::QmAccelerometerReading&)))) {
+                    setError("Unable to connect signals");
+                    return false;
+                }
+            } else {
+                disconnect(&accelerometer, 0, this, 0);
+            }
+            return true;
+        }
+
+    Q_SIGNALS:
+        void gestureDetected(const MeeGo::QmGestureReading data);
+
+    public Q_SLOTS:
+
+        void slotAcceleration(const MeeGo::QmAccelerometerReading& data)
+        {
+            QmSensorProbe probe(meter_, data.timestamp);
+            QmGestureReading events[GESTURE_EVENTS_MAX];
+            int count = detector.add(data.timestamp, data.x, data.y, data.z, events);
+            for (int i = 0; i < count; i++) {
+                if (!consume(events[i])) {
+                    emit gestureDetected(events[i]);
+                }
+            }
+        }
+    };
+}
+#endif // QMGESTURE_P_H
@@ -28,9 +28,91 @@
 #include "qmmagnetometer_p.h"
 
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#include <string.h>
+#include <sys/file.h>
+
+#define CALIBRATION_DIR ".qmsystem2"
+#define CALIBRATION_FILE "magnetometer-calibration"
+#define CALIBRATION_MAGIC 0x434d4d51 /* "QMMC" */
+#define CALIBRATION_VERSION 1
 
 namespace MeeGo {
 
+    /* The calibration file, native endian */
+    struct QmMagneticCorrectionFile
+    {
+        quint32 magic;
+        quint32 version;
+        QmMagneticCorrection correction;
+    };
+
+    static QString calibrationPath()
+    {
+        return QDir::homePath() + "/" CALIBRATION_DIR "/" CALIBRATION_FILE;
+    }
+
+    void QmMagnetometerPrivate::loadCalibration()
+    {
+        calibrationLoaded_ = true;
+
+        QFile file(calibrationPath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            return;
+        }
+
+        QmMagneticCorrectionFile stored;
+        ::flock(file.handle(), LOCK_SH);
+        bool ok = file.read((char *)&stored, sizeof(stored)) == sizeof(stored);
+        ::flock(file.handle(), LOCK_UN);
+
+        if (!ok || stored.magic != CALIBRATION_MAGIC || stored.version != CALIBRATION_VERSION
+            || stored.correction.level < 1 || stored.correction.level > 3) {
+            qWarning() << "Ignoring" << file.fileName();
+            return;
+        }
+        calibration_.restore(stored.correction);
+        savedLevel_ = stored.correction.level;
+    }
+
+    bool QmMagnetometerPrivate::saveCalibration()
+    {
+        QDir().mkpath(QDir::homePath() + "/" CALIBRATION_DIR);
+
+        QFile file(calibrationPath());
+        if (!file.open(QIODevice::ReadWrite)) {
+            qWarning() << "Can't open" << file.fileName() << file.errorString();
+            return false;
+        }
+
+        QmMagneticCorrectionFile stored;
+        memset(&stored, 0, sizeof(stored));
+        stored.magic = CALIBRATION_MAGIC;
+        stored.version = CALIBRATION_VERSION;
+        stored.correction = calibration_.correction;
+
+        /* Other processes may use the magnetometer at the same time */
+        ::flock(file.handle(), LOCK_EX);
+        file.resize(0);
+        bool ok = file.write((const char *)&stored, sizeof(stored)) == sizeof(stored);
+        file.flush();
+        ::flock(file.handle(), LOCK_UN);
+
+        if (ok) {
+            calibrationDirty_ = false;
+            savedLevel_ = stored.correction.level;
+        }
+        return ok;
+    }
+
+    void QmMagnetometerPrivate::removeCalibration()
+    {
+        QFile::remove(calibrationPath());
+        savedLevel_ = 0;
+    }
+
     QmMagnetometer::QmMagnetometer(QObject *parent) : QmSensor(parent)
     {
         QmMagnetometerPrivate *priv = new QmMagnetometerPrivate(this);
@@ -45,32 +127,45 @@ namespace MeeGo {
 
     QmMagnetometerReading QmMagnetometer::magneticField()
     {
+        QmMagnetometerPrivate *priv = reinterpret_cast<QmMagnetometerPrivate*>(priv_ptr);
+        QmMagnetometerReading output;
+        if (priv->cached(priv->cache, &output)) {
+            return output;
+        }
         if(!verifySessionLevel(QmSensor::SessionTypeListen)) {
             return QmMagnetometerReading();
         }
-
-        QmMagnetometerPrivate *priv = reinterpret_cast<QmMagnetometerPrivate*>(priv_ptr);
-        MagneticField value = priv->sensorIfc->magneticField();
-        QmMagnetometerReading output;
-        output.x = value.data().x_;
-        output.y = value.data().y_;
-        output.z = value.data().z_;
-        output.rx = value.data().rx_;
-        output.ry = value.data().ry_;
-        output.rz = value.data().rz_;
-        output.timestamp = value.data().timestamp_;
-        output.level = value.data().level_;
-        return output;
+        return priv->convert(priv->sensorIfc->magneticField());
     }
 
     void QmMagnetometer::reset() {
+        QmMagnetometerPrivate *priv = reinterpret_cast<QmMagnetometerPrivate*>(priv_ptr);
+        priv->resetCalibration();
+
         if(!verifySessionLevel(QmSensor::SessionTypeListen)) {
             return;
         }
 
-        QmMagnetometerPrivate *priv = reinterpret_cast<QmMagnetometerPrivate*>(priv_ptr);
         priv->sensorIfc->reset();
 
     }
 
+    void QmMagnetometer::setCalibration(bool on)
+    {
+        QmMagnetometerPrivate *priv = reinterpret_cast<QmMagnetometerPrivate*>(priv_ptr);
+        priv->setCalibrating(on);
+    }
+
+    bool QmMagnetometer::calibration()
+    {
+        QmMagnetometerPrivate *priv = reinterpret_cast<QmMagnetometerPrivate*>(priv_ptr);
+        return priv->calibrating();
+    }
+
+    int QmMagnetometer::calibrationLevel()
+    {
+        QmMagnetometerPrivate *priv = reinterpret_cast<QmMagnetometerPrivate*>(priv_ptr);
+        return priv->calibrationLevel();
+    }
+
 }
@@ -57,6 +57,20 @@ namespace MeeGo {
      *
      * @brief Provides raw magnetometer measurements.
      *
+     * The x, y and z axes of the measurements are calibrated by the
+     * daemon, and rx, ry and rz are raw. The level is the quality of the
+     * calibration, from 0 for none to 3.
+     *
+     * The library can calibrate the readings as well, see
+     * #setCalibration(). It follows the raw readings while the device is
+     * turned around, and fits them on an ellipsoid, which the offset from
+     * magnetized parts (hard iron) and the distortion by nearby metal
+     * (soft iron) turn the sphere of the earth's field into. Once a good
+     * fit is found, x, y and z are the raw readings corrected back on the
+     * sphere, and the level is that of the fit. The calibration keeps
+     * adapting, and is stored for the user, so that it is in use from the
+     * start next time.
+     *
      * To get measurements from the daemon, the client must open a
      * session and call start (). Details can be found from documentation
      * of #QmSensor.
@@ -85,10 +99,31 @@ namespace MeeGo {
         QmMagnetometerReading magneticField();
 
         /**
-         * Resets the magnetometer calibration back to 0.
+         * Resets the magnetometer calibration back to 0. The calibration
+         * of the library is forgotten as well, also the stored one.
          */
         void reset();
 
+        /**
+         * Sets whether the library calibrates the readings. Default is
+         * \c false, the readings are calibrated by the daemon.
+         * @param on \c true to calibrate in the library
+         */
+        void setCalibration(bool on);
+
+        /**
+         * Returns whether the library calibrates the readings, see
+         * #setCalibration().
+         * @return \c true if it does
+         */
+        bool calibration();
+
+        /**
+         * Returns the quality of the calibration of the library.
+         * @return From 0 while there is no calibration yet, to 3
+         */
+        int calibrationLevel();
+
     Q_SIGNALS:
         /**
          * Signals the availability of new measurement data from the sensor.
@@ -100,6 +135,8 @@ namespace MeeGo {
 
 } // MeeGo namespace
 
+Q_DECLARE_TYPEINFO(MeeGo::QmMagnetometerReading, Q_PRIMITIVE_TYPE);
+
 QT_END_HEADER
 
 #endif
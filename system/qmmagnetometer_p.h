@@ -28,14 +28,41 @@
 #ifndef QMMAGNETOMETER_P_H
 #define QMMAGNETOMETER_P_H
 
+#include <QMutex>
+
 #include "qmmagnetometer.h"
+#include "qmmagnetometercalibration_p.h"
 #include "qmsensor_p.h"
+#include "qmsensorkernels_p.h"
 #include "sensord/magnetometersensor_i.h"
 #include "sensord/sensormanagerinterface.h"
 
+/* Changes of the calibration are stored at most this often, unless the
+   level changes */
+#define CALIBRATION_SAVE_INTERVAL 60000000ULL /* us */
+
 namespace MeeGo
 {
 
+    template <>
+    struct QmSensorChannels<QmMagnetometerReading>
+    {
+        enum { Count = 6 };
+        static int& at(QmMagnetometerReading& reading, int i)
+        {
+            switch (i) {
+                case 0: return reading.x;
+                case 1: return reading.y;
+                case 2: return reading.z;
+                case 3: return reading.rx;
+                case 4: return reading.ry;
+                default: return reading.rz;
+            }
+        }
+        static int period(int) { return 0; }
+        static int lowest(int) { return 0; }
+    };
+
     class QmMagnetometerPrivate  :public QmSensorPrivate
     {
         Q_OBJECT;
@@ -45,20 +72,31 @@ namespace MeeGo
     public:
         MagnetometerSensorChannelInterface* sensorIfc;
 
-        QmMagnetometerPrivate(QmMagnetometer* parent) : QmSensorPrivate(parent), sensorIfc(NULL) {
+        QmMagnetometerPrivate(QmMagnetometer* parent)
+            : QmSensorPrivate(parent), sensorIfc(NULL), calibrating_(false), calibrationLoaded_(false),
+              calibrationDirty_(false), savedLevel_(0), savedAt_(0) {
             pub_ptr = parent;
         }
 
         ~QmMagnetometerPrivate() {
             closeSession();
+            QMutexLocker locker(&calibrationMutex_);
+            if (calibrationDirty_) {
+                saveCalibration();
+            }
+        }
+
+        const char* sensorId()
+        {
+            return "magnetometersensor";
         }
 
         bool init()
         {
             qDBusRegisterMetaType<MagneticField>();
             SensorManagerInterface& remoteSensorManager = SensorManagerInterface::instance();
-            remoteSensorManager.loadPlugin("magnetometersensor");
-            remoteSensorManager.registerSensorInterface<MagnetometerSensorChannelInterface>("magnetometersensor");
+            remoteSensorManager.loadPlugin(sensorId());
+            remoteSensorManager.registerSensorInterface<MagnetometerSensorChannelInterface>(sensorId());
             initDone_ = true;
             return true;
         }
@@ -66,30 +104,30 @@ namespace MeeGo
         AbstractSensorChannelInterface* controlSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return MagnetometerSensorChannelInterface::controlInterface("magnetometersensor");
+            return MagnetometerSensorChannelInterface::controlInterface(sensorId());
         }
 
         const AbstractSensorChannelInterface* listenSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return MagnetometerSensorChannelInterface::listenInterface("magnetometersensor");
+            return MagnetometerSensorChannelInterface::listenInterface(sensorId());
         }
         bool setupSignals(bool setOn)
         {
-            MEEGO_PUBLIC(QmMagnetometer)
-            if(!pub->verifySessionLevel(QmSensor::SessionTypeListen)) {
+            if (source() == NULL) {
+                setError("No session open, unable to (dis)connect signals.");
                 return false;
             }
 
             if (setOn) {
-                if (!connect(sensorIfc, SIGNAL(dataAvailable(const MagneticField&)),
+                if (!connect(source(), SIGNAL(dataAvailable(const MagneticField&)),
                              this, SLOT(slotDataAvailable(const MagneticField&)))) {
                     setError("Unable to connect signals");
                     return false;
                 }
 
             } else {
-                if (!disconnect(sensorIfc, SIGNAL(dataAvailable(const MagneticField&)),
+                if (!disconnect(source(), SIGNAL(dataAvailable(const MagneticField&)),
                              this, SLOT(slotDataAvailable(const MagneticField&)))) {
                     setError("Unable to disconnect signals");
                     return false;
@@ -98,12 +136,12 @@ namespace MeeGo
             return true;
         }
 
-    Q_SIGNALS:
-        void dataAvailable(const MeeGo::QmMagnetometerReading &data);
-
-        public Q_SLOTS:
+        void clearCache()
+        {
+            cache.clear();
+        }
 
-        void slotDataAvailable(const MagneticField& data)
+        static QmMagnetometerReading convert(const MagneticField& data)
         {
             QmMagnetometerReading output;
             output.x = data.data().x_;
@@ -114,9 +152,114 @@ namespace MeeGo
             output.rz = data.data().rz_;
             output.timestamp = data.data().timestamp_;
             output.level = data.data().level_;
+            return output;
+        }
+
+        QmSensorCache<QmMagnetometerReading> cache;
+
+        void setCalibrating(bool on)
+        {
+            QMutexLocker locker(&calibrationMutex_);
+            if (on && !calibrationLoaded_) {
+                loadCalibration();
+            }
+            if (!on && calibrationDirty_) {
+                saveCalibration();
+            }
+            calibrating_ = on;
+        }
 
-            emit dataAvailable(output);
+        bool calibrating()
+        {
+            QMutexLocker locker(&calibrationMutex_);
+            return calibrating_;
         }
+
+        int calibrationLevel()
+        {
+            QMutexLocker locker(&calibrationMutex_);
+            return calibration_.correction.level;
+        }
+
+        /* Forgets the calibration, also the stored one */
+        void resetCalibration()
+        {
+            QMutexLocker locker(&calibrationMutex_);
+            calibration_.reset();
+            calibrationLoaded_ = true;
+            calibrationDirty_ = false;
+            removeCalibration();
+        }
+
+        /**
+         * Learns from the raw axes of a reading, and replaces its axes
+         * with the corrected raw ones once there is a correction.
+         */
+        void correct(QmMagnetometerReading *output)
+        {
+            QMutexLocker locker(&calibrationMutex_);
+            if (!calibrating_) {
+                return;
+            }
+
+            if (calibration_.add(output->rx, output->ry, output->rz)) {
+                calibrationDirty_ = true;
+                if (calibration_.correction.level != savedLevel_
+                    || output->timestamp - savedAt_ >= CALIBRATION_SAVE_INTERVAL) {
+                    saveCalibration();
+                    savedAt_ = output->timestamp;
+                }
+            }
+
+            const QmMagneticCorrection &correction = calibration_.correction;
+            if (!correction.level) {
+                return;
+            }
+            output->x = output->rx;
+            output->y = output->ry;
+            output->z = output->rz;
+            kernelMagneticCorrection(&output->x, &output->y, &output->z, 1, correction.offset, correction.matrix);
+            output->level = correction.level;
+        }
+
+    Q_SIGNALS:
+        void dataAvailable(const MeeGo::QmMagnetometerReading &data);
+
+        public Q_SLOTS:
+
+        void slotDataAvailable(const MagneticField& data)
+        {
+            QmSensorProbe probe(meter_, data.data().timestamp_);
+            QmMagnetometerReading output = convert(data);
+            correct(&output);
+            cache.store(output);
+            if (!decimate(decimator_, output)) {
+                return;
+            }
+
+            filter(&output, 1);
+            if (!consume(output)) {
+                emit dataAvailable(output);
+            }
+        }
+
+    private:
+        /* In qmmagnetometer.cpp, called with calibrationMutex_ held */
+        void loadCalibration();
+        bool saveCalibration();
+        void removeCalibration();
+
+        QmSensorDecimator<QmMagnetometerReading> decimator_;
+
+        /* The readings are corrected on the thread of the sensor, see
+           QmSensor::setDeliveryThread() */
+        QMutex calibrationMutex_;
+        QmMagneticCalibration calibration_;
+        bool calibrating_;
+        bool calibrationLoaded_;
+        bool calibrationDirty_;     /* changed since stored */
+        int savedLevel_;
+        quint64 savedAt_;
     };
 
 
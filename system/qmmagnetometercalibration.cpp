@@ -0,0 +1,363 @@
+/*!
+ * @file qmmagnetometercalibration.cpp
+ * @brief Magnetometer hard and soft iron calibration
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmmagnetometercalibration_p.h"
+#include "qmsensorkernels_p.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace MeeGo {
+
+    /* Solves a x = b in place, a is n x n. False if a is singular. */
+    static bool solve(double (*a)[9], double *b, int n)
+    {
+        double largest = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                largest = fmax(largest, fabs(a[i][j]));
+            }
+        }
+
+        for (int col = 0; col < n; col++) {
+            int pivot = col;
+            for (int row = col + 1; row < n; row++) {
+                if (fabs(a[row][col]) > fabs(a[pivot][col])) {
+                    pivot = row;
+                }
+            }
+            if (fabs(a[pivot][col]) <= largest * 1e-12) {
+                return false;
+            }
+            if (pivot != col) {
+                for (int j = 0; j < n; j++) {
+                    double swap = a[col][j];
+                    a[col][j] = a[pivot][j];
+                    a[pivot][j] = swap;
+                }
+                double swap = b[col];
+                b[col] = b[pivot];
+                b[pivot] = swap;
+            }
+            for (int row = col + 1; row < n; row++) {
+                double factor = a[row][col] / a[col][col];
+                for (int j = col; j < n; j++) {
+                    a[row][j] -= factor * a[col][j];
+                }
+                b[row] -= factor * b[col];
+            }
+        }
+
+        for (int row = n - 1; row >= 0; row--) {
+            double sum = b[row];
+            for (int j = row + 1; j < n; j++) {
+                sum -= a[row][j] * b[j];
+            }
+            b[row] = sum / a[row][row];
+        }
+        return true;
+    }
+
+    /*
+     * Eigenvalues and eigenvectors of a symmetric 3 x 3 matrix by Jacobi
+     * rotations. The eigenvectors are the columns of vectors.
+     */
+    static void eigen(const double (*m)[3], double *values, double (*vectors)[3])
+    {
+        double a[3][3];
+        memcpy(a, m, sizeof(a));
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                vectors[i][j] = i == j ? 1 : 0;
+            }
+        }
+
+        for (int sweep = 0; sweep < 50; sweep++) {
+            double off = fabs(a[0][1]) + fabs(a[0][2]) + fabs(a[1][2]);
+            if (off <= 1e-15 * (fabs(a[0][0]) + fabs(a[1][1]) + fabs(a[2][2]))) {
+                break;
+            }
+            for (int p = 0; p < 2; p++) {
+                for (int q = p + 1; q < 3; q++) {
+                    if (a[p][q] == 0) {
+                        continue;
+                    }
+                    double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                    double t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+                    double c = 1 / sqrt(t * t + 1);
+                    double s = t * c;
+                    for (int k = 0; k < 3; k++) {
+                        double akp = a[k][p];
+                        double akq = a[k][q];
+                        a[k][p] = c * akp - s * akq;
+                        a[k][q] = s * akp + c * akq;
+                    }
+                    for (int k = 0; k < 3; k++) {
+                        double apk = a[p][k];
+                        double aqk = a[q][k];
+                        a[p][k] = c * apk - s * aqk;
+                        a[q][k] = s * apk + c * aqk;
+                    }
+                    for (int k = 0; k < 3; k++) {
+                        double vkp = vectors[k][p];
+                        double vkq = vectors[k][q];
+                        vectors[k][p] = c * vkp - s * vkq;
+                        vectors[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < 3; i++) {
+            values[i] = a[i][i];
+        }
+    }
+
+    void QmMagneticCalibration::reset()
+    {
+        memset(&correction, 0, sizeof(correction));
+        for (int i = 0; i < 3; i++) {
+            correction.matrix[i * 4] = 1;
+        }
+        scale_ = 0;
+        memset(normal_, 0, sizeof(normal_));
+        memset(rhs_, 0, sizeof(rhs_));
+        accepted_ = 0;
+        sinceFit_ = 0;
+        hasLast_ = false;
+        checkCount_ = 0;
+        checkNext_ = 0;
+    }
+
+    void QmMagneticCalibration::restore(const QmMagneticCorrection &stored)
+    {
+        correction = stored;
+    }
+
+    bool QmMagneticCalibration::add(int x, int y, int z)
+    {
+        float sample[3] = { (float)x, (float)y, (float)z };
+        if (!hasLast_) {
+            scale_ = fmax(sqrt((double)x * x + (double)y * y + (double)z * z), 1.0);
+        } else {
+            // Still devices would fill the fit with one point
+            double step = 0;
+            for (int i = 0; i < 3; i++) {
+                step += (sample[i] - last_[i]) * (double)(sample[i] - last_[i]);
+            }
+            if (step < CALIBRATION_STEP * CALIBRATION_STEP * scale_ * scale_) {
+                return false;
+            }
+        }
+
+        for (int i = 0; i < 3; i++) {
+            if (!hasLast_) {
+                low_[i] = high_[i] = sample[i];
+            } else {
+                low_[i] += (1 - CALIBRATION_FORGET) * (sample[i] - low_[i]);
+                high_[i] += (1 - CALIBRATION_FORGET) * (sample[i] - high_[i]);
+                low_[i] = fminf(low_[i], sample[i]);
+                high_[i] = fmaxf(high_[i], sample[i]);
+            }
+            last_[i] = sample[i];
+            check_[checkNext_][i] = sample[i];
+        }
+        hasLast_ = true;
+        checkNext_ = (checkNext_ + 1) % CALIBRATION_CHECK;
+        checkCount_ = checkCount_ < CALIBRATION_CHECK ? checkCount_ + 1 : CALIBRATION_CHECK;
+
+        double u = x / scale_;
+        double v = y / scale_;
+        double w = z / scale_;
+        const double row[9] = { u * u - w * w, v * v - w * w, 2 * v * w, 2 * u * w, 2 * u * v,
+                                2 * u, 2 * v, 2 * w, 1 };
+        const double target = -3 * w * w;
+        for (int i = 0; i < 9; i++) {
+            for (int j = 0; j < 9; j++) {
+                normal_[i][j] = CALIBRATION_FORGET * normal_[i][j] + row[i] * row[j];
+            }
+            rhs_[i] = CALIBRATION_FORGET * rhs_[i] + row[i] * target;
+        }
+        accepted_++;
+        sinceFit_++;
+
+        if (accepted_ < CALIBRATION_MIN_SAMPLES || sinceFit_ < CALIBRATION_FIT_EVERY) {
+            return false;
+        }
+        sinceFit_ = 0;
+
+        QmMagneticCorrection candidate;
+        if (!fit(&candidate)) {
+            return false;
+        }
+
+        // The one in use is rated again, the surroundings may have changed
+        float fitted = spread(candidate);
+        if (correction.level) {
+            float current = spread(correction);
+            if (current <= fitted) {
+                // Kept while no better one is found, whatever its level
+                int level = levelOf(current) > 1 ? levelOf(current) : 1;
+                bool changed = level != correction.level;
+                correction.level = level;
+                return changed;
+            }
+        }
+        candidate.level = levelOf(fitted);
+        if (!candidate.level) {
+            return false;
+        }
+        correction = candidate;
+        return true;
+    }
+
+    bool QmMagneticCalibration::fit(QmMagneticCorrection *result) const
+    {
+        double a[9][9];
+        double p[9];
+        memcpy(a, normal_, sizeof(a));
+        memcpy(p, rhs_, sizeof(p));
+        if (!solve(a, p, 9)) {
+            return false;
+        }
+
+        // a (x^2 - z^2) + b (y^2 - z^2) + 2f yz + 2g xz + 2h xy
+        //   + 2p x + 2q y + 2r z + d = -3 z^2
+        const double quadric[3][3] = {
+            { p[0], p[4], p[3] },
+            { p[4], p[1], p[2] },
+            { p[3], p[2], 3 - p[0] - p[1] }
+        };
+
+        // Center c = -A^-1 (p, q, r)
+        double system[9][9];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                system[i][j] = quadric[i][j];
+            }
+        }
+        double center[3] = { -p[5], -p[6], -p[7] };
+        if (!solve(system, center, 3)) {
+            return false;
+        }
+
+        // (v - c)' A (v - c) = c' A c - d
+        double k = -p[8];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                k += center[i] * quadric[i][j] * center[j];
+            }
+        }
+        if (k == 0) {
+            return false;
+        }
+        double shape[3][3];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                shape[i][j] = quadric[i][j] / k;
+            }
+        }
+
+        double values[3];
+        double vectors[3][3];
+        eigen(shape, values, vectors);
+        double smallest = fmin(values[0], fmin(values[1], values[2]));
+        double largest = fmax(values[0], fmax(values[1], values[2]));
+        if (smallest <= 0 || largest > CALIBRATION_MAX_RATIO * CALIBRATION_MAX_RATIO * smallest) {
+            return false;
+        }
+
+        // Radius of the sphere of the same volume; the samples must span
+        // about half its diameter on each axis
+        double radius = pow(values[0] * values[1] * values[2], -1.0 / 6);
+        double field = radius * scale_;
+        for (int i = 0; i < 3; i++) {
+            if (high_[i] - low_[i] < field) {
+                return false;
+            }
+        }
+
+        // The square root of the shape, scaled to determinant 1
+        double roots[3];
+        for (int i = 0; i < 3; i++) {
+            roots[i] = sqrt(values[i]) * radius;
+        }
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                double sum = 0;
+                for (int e = 0; e < 3; e++) {
+                    sum += vectors[i][e] * roots[e] * vectors[j][e];
+                }
+                result->matrix[i * 3 + j] = (float)sum;
+            }
+            result->offset[i] = (float)(center[i] * scale_);
+        }
+        result->level = 0;
+        return true;
+    }
+
+    float QmMagneticCalibration::spread(const QmMagneticCorrection &candidate) const
+    {
+        if (checkCount_ < 2) {
+            return 1;
+        }
+
+        int x[CALIBRATION_CHECK];
+        int y[CALIBRATION_CHECK];
+        int z[CALIBRATION_CHECK];
+        for (int i = 0; i < checkCount_; i++) {
+            x[i] = (int)check_[i][0];
+            y[i] = (int)check_[i][1];
+            z[i] = (int)check_[i][2];
+        }
+        kernelMagneticCorrection(x, y, z, checkCount_, candidate.offset, candidate.matrix);
+
+        double sum = 0;
+        double squares = 0;
+        for (int i = 0; i < checkCount_; i++) {
+            double length = sqrt((double)x[i] * x[i] + (double)y[i] * y[i] + (double)z[i] * z[i]);
+            sum += length;
+            squares += length * length;
+        }
+        double mean = sum / checkCount_;
+        if (mean <= 0) {
+            return 1;
+        }
+        double variance = fmax(squares / checkCount_ - mean * mean, 0);
+        return (float)(sqrt(variance) / mean);
+    }
+
+    int QmMagneticCalibration::levelOf(float spread)
+    {
+        if (spread < CALIBRATION_LEVEL3) {
+            return 3;
+        }
+        if (spread < CALIBRATION_LEVEL2) {
+            return 2;
+        }
+        if (spread < CALIBRATION_LEVEL1) {
+            return 1;
+        }
+        return 0;
+    }
+
+} // MeeGo namespace
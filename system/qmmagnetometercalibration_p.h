@@ -0,0 +1,125 @@
+/*!
+ * @file qmmagnetometercalibration_p.h
+ * @brief Contains the magnetometer hard and soft iron calibration
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMMAGNETOMETERCALIBRATION_P_H
+#define QMMAGNETOMETERCALIBRATION_P_H
+
+/* Weight left to the earlier samples by each accepted sample */
+#define CALIBRATION_FORGET 0.995
+/* Samples closer than this to the previous accepted one, relative to the
+   first sample, are skipped */
+#define CALIBRATION_STEP 0.05
+/* Accepted samples before the first fit, and between the fits */
+#define CALIBRATION_MIN_SAMPLES 100
+#define CALIBRATION_FIT_EVERY 25
+/* Longest to shortest axis of the fitted ellipsoid, at most */
+#define CALIBRATION_MAX_RATIO 2.0
+/* Latest accepted samples kept for rating the fits */
+#define CALIBRATION_CHECK 64
+/* Spread of the corrected field strength, relative to its mean, for the
+   levels 3, 2 and 1; fits with more are dropped */
+#define CALIBRATION_LEVEL3 0.02
+#define CALIBRATION_LEVEL2 0.04
+#define CALIBRATION_LEVEL1 0.08
+
+namespace MeeGo
+{
+    /*
+     * Correction of raw magnetometer readings, v = matrix (v - offset).
+     * Stored as is in the calibration file, native endian.
+     */
+    struct QmMagneticCorrection
+    {
+        float offset[3];   /* nT, hard iron */
+        float matrix[9];   /* row by row, soft iron, determinant 1 */
+        int level;         /* 0 for none, up to 3 */
+    };
+
+    /*
+     * Fits an ellipsoid to a stream of raw magnetometer readings, and
+     * turns it into the correction that maps it on a sphere of the same
+     * volume.
+     *
+     * The fit is the linear least squares fit of a quadric whose
+     * coefficients of x^2, y^2 and z^2 add up to 3. Its normal equations
+     * are summed up sample by sample with a forgetting factor, so memory
+     * use is fixed and the fit follows changes in the surroundings of the
+     * magnetometer. The fit is solved every CALIBRATION_FIT_EVERY accepted
+     * samples, and taken when it is an ellipsoid, covered by the samples,
+     * and rates better on the latest samples than the correction in use.
+     */
+    class QmMagneticCalibration
+    {
+    public:
+        QmMagneticCalibration()
+        {
+            reset();
+        }
+
+        /* In use, level 0 if none */
+        QmMagneticCorrection correction;
+
+        /* Forgets the samples and the correction */
+        void reset();
+
+        /* Takes a correction, for example one stored earlier */
+        void restore(const QmMagneticCorrection &stored);
+
+        /**
+         * Adds a raw reading (nT).
+         *
+         * @return \c true if the correction changed
+         */
+        bool add(int x, int y, int z);
+
+        /* Spread of the corrected field strength on the latest samples,
+           relative to its mean */
+        float spread(const QmMagneticCorrection &candidate) const;
+
+        static int levelOf(float spread);
+
+    private:
+        bool fit(QmMagneticCorrection *result) const;
+
+        double scale_;          /* samples are divided by this */
+        double normal_[9][9];   /* normal equations of the fit */
+        double rhs_[9];
+        int accepted_;
+        int sinceFit_;
+
+        bool hasLast_;
+        float last_[3];
+
+        /* Range of the samples on each axis, forgotten like the samples */
+        float low_[3];
+        float high_[3];
+
+        float check_[CALIBRATION_CHECK][3];
+        int checkCount_;
+        int checkNext_;
+    };
+
+} // MeeGo namespace
+
+#endif // QMMAGNETOMETERCALIBRATION_P_H
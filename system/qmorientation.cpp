@@ -44,11 +44,14 @@ namespace MeeGo {
 
     QmOrientationReading QmOrientation::orientation()
     {
+        QmOrientationPrivate *priv = reinterpret_cast<QmOrientationPrivate*>(priv_ptr);
+        QmOrientationReading output;
+        if (priv->cached(priv->cache, &output)) {
+            return output;
+        }
         if(!verifySessionLevel(QmSensor::SessionTypeListen)) {
             return QmOrientationReading();
         }
-
-        QmOrientationPrivate *priv = reinterpret_cast<QmOrientationPrivate*>(priv_ptr);
         return priv->orientation();
     }
 
@@ -158,6 +158,8 @@ namespace MeeGo {
 
 } // MeeGo namespace
 
+Q_DECLARE_TYPEINFO(MeeGo::QmOrientationReading, Q_PRIMITIVE_TYPE);
+
 QT_END_HEADER
 
 #endif
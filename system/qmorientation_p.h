@@ -54,42 +54,47 @@ namespace MeeGo
             closeSession();
         }
 
+        const char* sensorId()
+        {
+            return "orientationsensor";
+        }
+
         bool init()
         {
             qDBusRegisterMetaType<Unsigned>();
             SensorManagerInterface& remoteSensorManager = SensorManagerInterface::instance();
-            remoteSensorManager.loadPlugin("orientationsensor");
-            remoteSensorManager.registerSensorInterface<OrientationSensorChannelInterface>("orientationsensor");
+            remoteSensorManager.loadPlugin(sensorId());
+            remoteSensorManager.registerSensorInterface<OrientationSensorChannelInterface>(sensorId());
             initDone_ = true;
             return true;
         }
 
         AbstractSensorChannelInterface* controlSession() {
             if (!initDone_) { if (!init()) return NULL; }
-            return OrientationSensorChannelInterface::controlInterface("orientationsensor");
+            return OrientationSensorChannelInterface::controlInterface(sensorId());
         }
 
         const AbstractSensorChannelInterface* listenSession() {
             if (!initDone_) { if (!init()) return NULL; }
-            return OrientationSensorChannelInterface::listenInterface("orientationsensor");
+            return OrientationSensorChannelInterface::listenInterface(sensorId());
         }
 
         bool setupSignals(bool setOn)
         {
-            if (sensorIfc == NULL) {
+            if (source() == NULL) {
                 setError("No session open, unable to (dis)connect signals.");
                 return false;
             }
 
             if (setOn) {
-                if( !connect(sensorIfc, SIGNAL(orientationChanged(const Unsigned&)),
+                if( !connect(source(), SIGNAL(orientationChanged(const Unsigned&)),
                              this, SLOT(slotOrientationChanged(const Unsigned&)))) {
                     setError("Signal connect error");
                     return false;
                 }
 
             } else {
-                if( !disconnect(sensorIfc, SIGNAL(orientationChanged(const Unsigned&)),
+                if( !disconnect(source(), SIGNAL(orientationChanged(const Unsigned&)),
                              this, SLOT(slotOrientationChanged(const Unsigned&)))) {
                     setError("Signal disconnect error");
                     return false;
@@ -127,16 +132,27 @@ namespace MeeGo
             return output;
         }
 
+        void clearCache()
+        {
+            cache.clear();
+        }
+
+        QmSensorCache<QmOrientationReading> cache;
+
     Q_SIGNALS:
         void orientationChanged(const MeeGo::QmOrientationReading orientation);
 
     public Q_SLOTS:
         void slotOrientationChanged(const Unsigned& orientation)
         {
+            QmSensorProbe probe(meter_, orientation.UnsignedData().timestamp_);
             QmOrientationReading output;
             output.value = poseDataToOrientation((PoseData::Orientation)orientation.UnsignedData().value_);
             output.timestamp = orientation.UnsignedData().timestamp_;
-            emit orientationChanged(output);
+            cache.store(output);
+            if (!consume(output)) {
+                emit orientationChanged(output);
+            }
         }
     };
 
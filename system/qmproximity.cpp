@@ -46,13 +46,15 @@ namespace MeeGo {
 
     QmProximityReading QmProximity::get()
     {
+        QmProximityPrivate *priv = reinterpret_cast<QmProximityPrivate*>(priv_ptr);
+        QmProximityReading output;
+        if (priv->cached(priv->cache, &output)) {
+            return output;
+        }
         if(!verifySessionLevel(QmSensor::SessionTypeListen)) {
             return QmProximityReading();
         }
-        
-        QmProximityPrivate *priv = reinterpret_cast<QmProximityPrivate*>(priv_ptr);
         Unsigned value = priv->sensorIfc->proximity();
-        QmProximityReading output;
         output.timestamp = value.UnsignedData().timestamp_;
         output.value = value.UnsignedData().value_;
         return output;
@@ -51,12 +51,17 @@ namespace MeeGo
             closeSession();
         }
 
+        const char* sensorId()
+        {
+            return "proximitysensor";
+        }
+
         bool init()
         {
             qDBusRegisterMetaType<Unsigned>();
             SensorManagerInterface& remoteSensorManager = SensorManagerInterface::instance();
-            qDebug() << "Loading plugin: " << remoteSensorManager.loadPlugin("proximitysensor");
-            remoteSensorManager.registerSensorInterface<ProximitySensorChannelInterface>("proximitysensor");
+            qDebug() << "Loading plugin: " << remoteSensorManager.loadPlugin(sensorId());
+            remoteSensorManager.registerSensorInterface<ProximitySensorChannelInterface>(sensorId());
             initDone_ = true;
             return true;
         }
@@ -64,32 +69,32 @@ namespace MeeGo
         AbstractSensorChannelInterface* controlSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return ProximitySensorChannelInterface::controlInterface("proximitysensor");
+            return ProximitySensorChannelInterface::controlInterface(sensorId());
         }
 
         const AbstractSensorChannelInterface* listenSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return ProximitySensorChannelInterface::listenInterface("proximitysensor");
+            return ProximitySensorChannelInterface::listenInterface(sensorId());
         }
 
         bool setupSignals(bool setOn)
         {
 
-            if (sensorIfc == NULL) {
+            if (source() == NULL) {
                 setError("No session open, unable to (dis)connect signals.");
                 return false;
             }
 
             if (setOn) {
-                if (!connect(sensorIfc, SIGNAL(dataAvailable(const Unsigned&)),
+                if (!connect(source(), SIGNAL(dataAvailable(const Unsigned&)),
                         this, SLOT(slotProximityChanged(const Unsigned&)))) {
                     setError("Unable to connect signals");
                     return false;
                 }
 
             } else {
-                if (!disconnect(sensorIfc, SIGNAL(dataAvailable(const Unsigned&)),
+                if (!disconnect(source(), SIGNAL(dataAvailable(const Unsigned&)),
                         this, SLOT(slotProximityChanged(const Unsigned&)))) {
                     setError("Unable to disconnect signals");
                     return false;
@@ -98,16 +103,27 @@ namespace MeeGo
             return true;
         }
 
+        void clearCache()
+        {
+            cache.clear();
+        }
+
+        QmSensorCache<QmProximityReading> cache;
+
     Q_SIGNALS:
         void ProximityChanged(const MeeGo::QmProximityReading value);
 
     public Q_SLOTS:
         void slotProximityChanged(const Unsigned& value)
         {
+            QmSensorProbe probe(meter_, value.UnsignedData().timestamp_);
             QmProximityReading output;
             output.timestamp = value.UnsignedData().timestamp_;
             output.value = value.UnsignedData().value_;
-            emit ProximityChanged(output);
+            cache.store(output);
+            if (!consume(output)) {
+                emit ProximityChanged(output);
+            }
         }
     };
 
@@ -34,6 +34,7 @@ namespace MeeGo {
     {
         QmRotationPrivate *priv = new QmRotationPrivate(this);
         connect(priv, SIGNAL(dataAvailable(const MeeGo::QmRotationReading&)), this, SIGNAL(dataAvailable(const MeeGo::QmRotationReading&)));
+        connect(priv, SIGNAL(dataAvailable(const QVector<MeeGo::QmRotationReading>&)), this, SIGNAL(dataAvailable(const QVector<MeeGo::QmRotationReading>&)));
         priv_ptr = priv;
     }
 
@@ -41,21 +42,29 @@ namespace MeeGo {
     {
     }
 
-    QmRotationReading QmRotation::rotation()
+    void QmRotation::setBatchSize(int samples, int timeout)
     {
-        if(!verifySessionLevel(QmSensor::SessionTypeListen)) {
-            return QmRotationReading();
-        }
+        QmRotationPrivate *priv = reinterpret_cast<QmRotationPrivate*>(priv_ptr);
+        priv->setBatch(samples, timeout);
+    }
 
+    int QmRotation::batchSize()
+    {
         QmRotationPrivate *priv = reinterpret_cast<QmRotationPrivate*>(priv_ptr);
+        return priv->batchSize();
+    }
 
+    QmRotationReading QmRotation::rotation()
+    {
+        QmRotationPrivate *priv = reinterpret_cast<QmRotationPrivate*>(priv_ptr);
         QmRotationReading output;
-        XYZ data = priv->sensorIfc->rotation();
-        output.timestamp = data.XYZData().timestamp_;
-        output.x = data.x();
-        output.y = data.y();
-        output.z = data.z();
-        return output;
+        if (priv->cached(priv->cache, &output)) {
+            return output;
+        }
+        if(!verifySessionLevel(QmSensor::SessionTypeListen)) {
+            return QmRotationReading();
+        }
+        return priv->convert(priv->sensorIfc->rotation());
     }
 
     bool QmRotation::hasZ()
@@ -30,6 +30,7 @@
 #define QMROTATION_H
 
 #include <QtCore/qobject.h>
+#include <QtCore/qvector.h>
 #include <qmsensor.h>
 
 QT_BEGIN_HEADER
@@ -115,6 +116,26 @@ namespace MeeGo {
          */
         ~QmRotation();
 
+        /**
+         * Switches between per-reading and batched delivery. In batch mode
+         * readings are collected and delivered through
+         * dataAvailable(const QVector<MeeGo::QmRotationReading>&) once \c samples
+         * readings have been collected, or \c timeout milliseconds after the
+         * first of them arrived, whichever comes first. The per-reading
+         * signal is not emitted in batch mode. Readings still pending are
+         * delivered when the sensor is stopped.
+         *
+         * @param samples Readings per batch, 0 or 1 for per-reading delivery
+         * @param timeout Maximum delivery delay in milliseconds, 0 for none
+         */
+        void setBatchSize(int samples, int timeout = 0);
+
+        /**
+         * Returns the number of readings per batch.
+         * @return Readings per batch, 0 for per-reading delivery
+         */
+        int batchSize();
+
         /**
          * Gets the previous measured rotation.
          * @return Previous measured rotation, or XYZ(0,0,0,0) if no
@@ -137,10 +158,18 @@ namespace MeeGo {
          */
         void dataAvailable(const MeeGo::QmRotationReading& data);
 
+        /**
+         * Signals a batch of measurement data, see setBatchSize().
+         * @param data Readings in the order of measurement
+         */
+        void dataAvailable(const QVector<MeeGo::QmRotationReading>& data);
+
     };
 
 } // MeeGo namespace
 
+Q_DECLARE_TYPEINFO(MeeGo::QmRotationReading, Q_PRIMITIVE_TYPE);
+
 QT_END_HEADER
 
 #endif
@@ -30,6 +30,7 @@
 
 #include "qmrotation.h"
 #include "qmsensor_p.h"
+#include "qmsensorkernels_p.h"
 #include "sensord/rotationsensor_i.h"
 #include "sensord/sensormanagerinterface.h"
 #include <math.h>
@@ -37,6 +38,19 @@
 namespace MeeGo
 {
 
+    template <>
+    struct QmSensorChannels<QmRotationReading>
+    {
+        enum { Count = 3 };
+        static int& at(QmRotationReading& reading, int i)
+        {
+            return i == 0 ? reading.x : i == 1 ? reading.y : reading.z;
+        }
+        // X is limited to [-90, 90], Y and Z wrap around at [-179, 180]
+        static int period(int i) { return i == 0 ? 0 : 360; }
+        static int lowest(int) { return -179; }
+    };
+
     class QmRotationPrivate : public QmSensorPrivate
     {
         Q_OBJECT;
@@ -54,12 +68,17 @@ namespace MeeGo
             closeSession();
         }
 
+        const char* sensorId()
+        {
+            return "rotationsensor";
+        }
+
         bool init()
         {
             qDBusRegisterMetaType<XYZ>();
             SensorManagerInterface& remoteSensorManager = SensorManagerInterface::instance();
-            remoteSensorManager.loadPlugin("rotationsensor");
-            remoteSensorManager.registerSensorInterface<RotationSensorChannelInterface>("rotationsensor");
+            remoteSensorManager.loadPlugin(sensorId());
+            remoteSensorManager.registerSensorInterface<RotationSensorChannelInterface>(sensorId());
             initDone_ = true;
             return true;
         }
@@ -67,31 +86,31 @@ namespace MeeGo
         AbstractSensorChannelInterface* controlSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return RotationSensorChannelInterface::controlInterface("rotationsensor");
+            return RotationSensorChannelInterface::controlInterface(sensorId());
         }
 
         const AbstractSensorChannelInterface* listenSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return RotationSensorChannelInterface::listenInterface("rotationsensor");
+            return RotationSensorChannelInterface::listenInterface(sensorId());
         }
 
         bool setupSignals(bool setOn)
         {
-            MEEGO_PUBLIC(QmRotation);
-            if(!pub->verifySessionLevel(QmSensor::SessionTypeListen)) {
+            if (source() == NULL) {
+                setError("No session open, unable to (dis)connect signals.");
                 return false;
             }
 
             if (setOn) {
-                if (!connect(sensorIfc, SIGNAL(dataAvailable(const XYZ&)),
+                if (!connect(source(), SIGNAL(dataAvailable(const XYZ&)),
                              this, SLOT(slotDataAvailable(const XYZ&)))) {
                     setError("Unable to connect signals");
                     return false;
                 }
 
             } else {
-                if (!disconnect(sensorIfc, SIGNAL(dataAvailable(const XYZ&)),
+                if (!disconnect(source(), SIGNAL(dataAvailable(const XYZ&)),
                              this, SLOT(slotDataAvailable(const XYZ&)))) {
                     setError("Unable to disconnect signals");
                     return false;
@@ -100,42 +119,72 @@ namespace MeeGo
             return true;
         }
 
+        void clearCache()
+        {
+            cache.clear();
+        }
+
+        /**
+         * Converts a sensord reading to the axes and ranges of QmRotationReading.
+         */
+        static QmRotationReading convert(const XYZ& data)
+        {
+            QmRotationReading output;
+            output.timestamp = data.XYZData().timestamp_;
+            output.x = data.x();
+            output.y = data.y();
+            output.z = data.z();
+            kernelRotationAxes(&output.x, &output.y, &output.z, 1);
+            return output;
+        }
+
+        QmSensorCache<QmRotationReading> cache;
+
+    protected:
+        void reserveBatch(int samples)
+        {
+            batch_.reserve(samples);
+        }
+
+        void flushBatch()
+        {
+            if (!batch_.isEmpty()) {
+                filter(batch_.data(), batch_.count());
+                emit dataAvailable(batch_.readings());
+                batch_.clear();
+            }
+        }
+
     Q_SIGNALS:
         void dataAvailable(const MeeGo::QmRotationReading& data);
+        void dataAvailable(const QVector<MeeGo::QmRotationReading>& data);
 
     public Q_SLOTS:
 
         void slotDataAvailable(const XYZ& data)
         {
-            QmRotationReading output;
-            output.timestamp = data.XYZData().timestamp_;
-
-            // Mangle X to definition...
-            if (abs(data.y()) <= 90)
-            {
-                output.x = -data.y();
-            }
-            else
-            {
-                output.x = (data.y()<0 ? 1 : -1) * 180 + data.y();
+            QmSensorProbe probe(meter_, data.XYZData().timestamp_);
+            QmRotationReading output = convert(data);
+            cache.store(output);
+            if (!decimate(decimator_, output)) {
+                return;
             }
 
-            // Mangle Y to definition
-            if (abs(data.y()) <= 90)
-            {
-                output.y = data.x();
-            }
-            else
-            {
-                output.y = (data.x()>0 ? 1 : -1) * (180-abs(data.x()));
+            // Batches are filtered as a whole when they are delivered
+            if (batching() && !ring_.isOpen()) {
+                batchAppended(batch_.append(output));
+                return;
             }
 
-            // ..and finally match z=0 to north.
-            output.z = (((data.z() + 180) + 90) % 360) - 180;
-
-
-            emit dataAvailable(output);
+            filter(&output, 1);
+            if (!consume(output)) {
+                emit dataAvailable(output);
+            }
         }
+
+    private:
+        QmSensorDecimator<QmRotationReading> decimator_;
+        QmSensorBatch<QmRotationReading> batch_;
     };
 
 
@@ -26,10 +26,16 @@
  */
 #include "qmsensor.h"
 #include "qmsensor_p.h"
+#include "qmsensortrace_p.h"
 #include "system_global.h"
 #include "sensord/sensormanagerinterface.h"
 #include <QDebug>
 
+extern "C" {
+#include <string.h>
+#include <time.h>
+}
+
 #define GET_SENSOR_PTR_PTR(name) AbstractSensorChannelInterface** name = getSensorIfcPtr();
 #define GET_SENSOR_PTR(name) AbstractSensorChannelInterface* name = *getSensorIfcPtr();
 #define GET_PRIVATE_PTR(name) QmSensorPrivate* name = (QmSensorPrivate*)getPrivatePtr();
@@ -37,11 +43,118 @@
 
 namespace MeeGo {
 
+    QString QmSensorStatistics::toString() const
+    {
+        QString jitters;
+        for (int i = 0; i < JitterBuckets; i++) {
+            jitters += QString(i ? " %1" : "%1").arg(jitter[i]);
+        }
+        return QString("interval %1 ms, received %2, dropped %3, gaps %4 (longest %5 us), "
+                       "jitter [%6], handling %7 us (longest %8 us)")
+            .arg(interval).arg(received).arg(dropped).arg(gaps).arg(longestGap)
+            .arg(jitters).arg(handlingTime / 1000).arg(longestHandling / 1000);
+    }
+
     // ----------------- BEGIN PRIVATE CLASS DEFINITION ----------------- //
 
-    QmSensorPrivate::QmSensorPrivate(QmSensor *sensor) : QObject(sensor), sessionType_(QmSensor::SessionTypeNone), initDone_(false), running_(false)
+    QmSensorMeter::QmSensorMeter() : sequence_(0)
+    {
+        memset(&statistics_, 0, sizeof(statistics_));
+        restart();
+    }
+
+    qint64 QmSensorMeter::now()
+    {
+        struct timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return (qint64)time.tv_sec * 1000000000 + time.tv_nsec;
+    }
+
+    void QmSensorMeter::begin()
+    {
+        sequence_ = sequence_ + 1;
+        __sync_synchronize();
+    }
+
+    void QmSensorMeter::end()
+    {
+        __sync_synchronize();
+        sequence_ = sequence_ + 1;
+    }
+
+    void QmSensorMeter::reset()
+    {
+        // The interval is a setting, not a statistic
+        begin();
+        int interval = statistics_.interval;
+        memset(&statistics_, 0, sizeof(statistics_));
+        statistics_.interval = interval;
+        restart();
+        end();
+    }
+
+    void QmSensorMeter::restart()
+    {
+        previousTimestamp_ = 0;
+        previousArrival_ = 0;
+    }
+
+    void QmSensorMeter::setInterval(int interval)
+    {
+        begin();
+        statistics_.interval = interval;
+        end();
+    }
+
+    void QmSensorMeter::add(quint64 timestamp, qint64 arrival, qint64 duration)
+    {
+        begin();
+        statistics_.received++;
+        statistics_.handlingTime += duration;
+        statistics_.longestHandling = qMax(statistics_.longestHandling, (quint64)duration);
+
+        qint64 interval = (qint64)statistics_.interval * 1000;
+        if (interval > 0 && previousArrival_) {
+            qint64 deviation = qAbs((arrival - previousArrival_) / 1000 - interval);
+            int bucket = 0;
+            while (bucket < QmSensorStatistics::JitterBuckets - 1 && deviation >= (250 << bucket)) {
+                bucket++;
+            }
+            statistics_.jitter[bucket]++;
+        }
+        if (interval > 0 && previousTimestamp_ && timestamp > previousTimestamp_
+            && timestamp - previousTimestamp_ > (quint64)interval * 2) {
+            statistics_.gaps++;
+            statistics_.longestGap = qMax(statistics_.longestGap, timestamp - previousTimestamp_);
+        }
+        previousTimestamp_ = timestamp;
+        previousArrival_ = arrival;
+        end();
+    }
+
+    void QmSensorMeter::load(QmSensorStatistics *output) const
+    {
+        for (;;) {
+            unsigned int before = sequence_;
+            __sync_synchronize();
+            if (before & 1) {
+                continue;
+            }
+            *output = statistics_;
+            __sync_synchronize();
+            if (sequence_ == before) {
+                return;
+            }
+        }
+    }
+
+    QmSensorPrivate::QmSensorPrivate(QmSensor *sensor) : QObject(sensor), sessionType_(QmSensor::SessionTypeNone), session_(NULL), initDone_(false), running_(false),
+                                                         decimation_(QmSensor::DecimationLast), decimationInterval_(0),
+                                                         batchSize_(0), batchTimeout_(0), callFilter_(NULL)
     {
         connect(this, SIGNAL(errorSignal(QString)), sensor, SIGNAL(errorSignal(QString)));
+        batchTimer_.setSingleShot(true);
+        connect(&batchTimer_, SIGNAL(timeout()), this, SLOT(slotBatchTimeout()));
     }
 
     QmSensorPrivate::~QmSensorPrivate() {}
@@ -53,6 +166,13 @@ namespace MeeGo {
 
     QmSensor::SessionType QmSensorPrivate::requestSession(QmSensor::SessionType type) {
 
+        if (replay_) {
+            // Replayed sensors don't talk to sensord
+            closeSession();
+            sessionType_ = type;
+            return type;
+        }
+
         if (!initDone_) {
             if (!init()) return QmSensor::SessionTypeNone;
         }
@@ -79,7 +199,8 @@ namespace MeeGo {
             switch (type) {
                 case QmSensor::SessionTypeControl:
                 {
-                    *sensorIfcPtr = controlSession();
+                    session_ = QmSensorSession::attach(this, QmSensor::SessionTypeControl);
+                    *sensorIfcPtr = session_ ? session_->interface() : NULL;
                     if (*sensorIfcPtr != NULL) {
                         sessionType_ = QmSensor::SessionTypeControl;
                     } else {
@@ -90,7 +211,8 @@ namespace MeeGo {
                 }
                 case QmSensor::SessionTypeListen:
                 {
-                    *sensorIfcPtr = const_cast<AbstractSensorChannelInterface*>(listenSession());
+                    session_ = QmSensorSession::attach(this, QmSensor::SessionTypeListen);
+                    *sensorIfcPtr = session_ ? session_->interface() : NULL;
                     if (*sensorIfcPtr) {
                         sessionType_ = QmSensor::SessionTypeListen;
                     } else {
@@ -114,20 +236,40 @@ namespace MeeGo {
     void QmSensorPrivate::closeSession()
     {
         GET_SENSOR_PTR_PTR(sensorIfc);
-        if (*sensorIfc) {
-            stop();
-            delete *sensorIfc;
-            *sensorIfc = NULL;
+        if (session_) {
+            // The session is closed when the last sensor detaches
+            session_->detach(this);
+            session_ = NULL;
         }
+        *sensorIfc = NULL;
         sessionType_ = QmSensor::SessionTypeNone;
     }
 
+    QObject* QmSensorPrivate::source()
+    {
+        if (replay_) {
+            return replay_;
+        }
+        return *getSensorIfcPtr();
+    }
+
+    void QmSensorPrivate::setupTaps(bool setOn)
+    {
+        QObject *readings = source();
+        for (int i = 0; i < TapCount; i++) {
+            if (taps_[i] && readings) {
+                taps_[i]->setup(readings, setOn);
+            }
+        }
+    }
+
     bool QmSensorPrivate::start()
     {
-        GET_SENSOR_PTR(sensorIfc);
-        if (sensorIfc) {
-            // XXX: Check for valid D-Bus reply, set error.
-            sensorIfc->start();
+        if (replay_ && sessionType_ != QmSensor::SessionTypeNone) {
+            return true;
+        }
+        if (session_) {
+            session_->start(this);
         } else {
             setError("Unable to start, no open session");
             return false;
@@ -137,10 +279,11 @@ namespace MeeGo {
 
     bool QmSensorPrivate::stop()
     {
-        GET_SENSOR_PTR(sensorIfc);
-        if (sensorIfc) {
-            // XXX: Check for valid D-Bus reply, set error.
-            sensorIfc->stop();
+        if (replay_ && sessionType_ != QmSensor::SessionTypeNone) {
+            return true;
+        }
+        if (session_) {
+            session_->stop(this);
         } else {
             setError("Unable to stop, no open session");
             return false;
@@ -150,35 +293,160 @@ namespace MeeGo {
 
     int QmSensorPrivate::interval()
     {
-        GET_SENSOR_PTR(sensorIfc);
-        if (sensorIfc) {
-            return sensorIfc->interval();
+        if (session_) {
+            return session_->interval(this);
         }
         return 0;
     }
 
     void QmSensorPrivate::setInterval(int value)
     {
-        GET_SENSOR_PTR(sensorIfc);
-        if (sensorIfc) {
-            sensorIfc->setInterval(value);
+        if (session_) {
+            session_->setInterval(this, value);
+        }
+    }
+
+    int QmSensorPrivate::requestedInterval()
+    {
+        if (session_) {
+            return session_->requestedInterval(this);
         }
+        return 0;
     }
 
     bool QmSensorPrivate::standbyOverride()
     {
-        GET_SENSOR_PTR(sensorIfc);
-        if (sensorIfc) {
-            return sensorIfc->standbyOverride();
+        if (session_) {
+            return session_->standbyOverride(this);
         }
         return false;
     }
 
     void QmSensorPrivate::setStandbyOverride(bool value)
     {
-        GET_SENSOR_PTR(sensorIfc);
-        if (sensorIfc) {
-            sensorIfc->setStandbyOverride(value);
+        if (session_) {
+            session_->setStandbyOverride(this, value);
+        }
+    }
+
+    void QmSensorPrivate::setBatch(int samples, int timeout)
+    {
+        // The batch and its timer belong to the data slot
+        if (elsewhere()) {
+            callOnThread(CallSetBatch, samples, timeout);
+            return;
+        }
+
+        // Deliver what has been collected with the old settings
+        batchTimer_.stop();
+        flushBatch();
+
+        batchSize_ = samples > 1 ? samples : 0;
+        batchTimeout_ = timeout > 0 ? timeout : 0;
+        if (batchSize_) {
+            reserveBatch(batchSize_);
+        }
+    }
+
+    int QmSensorPrivate::batchSize()
+    {
+        return batchSize_;
+    }
+
+    void QmSensorPrivate::batchAppended(int count)
+    {
+        if (count >= batchSize_) {
+            batchTimer_.stop();
+            flushBatch();
+        } else if (count == 1 && batchTimeout_) {
+            batchTimer_.start(batchTimeout_);
+        }
+    }
+
+    void QmSensorPrivate::slotBatchTimeout()
+    {
+        flushBatch();
+    }
+
+    void QmSensorPrivate::moveToDeliveryThread(QThread *thread)
+    {
+        // Not a child, as it is a member
+        batchTimer_.moveToThread(thread);
+    }
+
+    int QmSensorPrivate::callOnThread(ThreadCall call, int argument, int second)
+    {
+        QMutexLocker locker(&callMutex_);
+        callArgument_ = argument;
+        callSecond_ = second;
+        callFilter_ = NULL;
+        return invokeCall(call);
+    }
+
+    int QmSensorPrivate::callOnThread(ThreadCall call, QmSensorFilter *filter)
+    {
+        QMutexLocker locker(&callMutex_);
+        callArgument_ = 0;
+        callSecond_ = 0;
+        callFilter_ = filter;
+        return invokeCall(call);
+    }
+
+    int QmSensorPrivate::invokeCall(ThreadCall call)
+    {
+        if (!thread()->isRunning()) {
+            setError("Unable to call, delivery thread not running");
+            return 0;
+        }
+        call_ = call;
+        callResult_ = 0;
+        QMetaObject::invokeMethod(this, "slotThreadCall", Qt::BlockingQueuedConnection);
+        return callResult_;
+    }
+
+    void QmSensorPrivate::slotThreadCall()
+    {
+        GET_PUBLIC_PTR(pub);
+        switch (call_) {
+            case CallRequestSession:
+                callResult_ = pub->requestSession((QmSensor::SessionType)callArgument_);
+                break;
+            case CallStart:
+                callResult_ = pub->start();
+                break;
+            case CallStop:
+                callResult_ = pub->stop();
+                break;
+            case CallInterval:
+                callResult_ = pub->interval();
+                break;
+            case CallSetInterval:
+                pub->setInterval(callArgument_);
+                break;
+            case CallStandbyOverride:
+                callResult_ = pub->standbyOverride();
+                break;
+            case CallSetStandbyOverride:
+                pub->setStandbyOverride(callArgument_);
+                break;
+            case CallResetStatistics:
+                pub->resetStatistics();
+                break;
+            case CallSetConsumerMode:
+                callResult_ = pub->setConsumerMode(callArgument_);
+                break;
+            case CallSetDecimation:
+                pub->setDecimation((QmSensor::DecimationMode)callArgument_);
+                break;
+            case CallAddFilter:
+                pub->addFilter(callFilter_);
+                break;
+            case CallRemoveFilter:
+                pub->removeFilter(callFilter_);
+                break;
+            case CallSetBatch:
+                setBatch(callArgument_, callSecond_);
+                break;
         }
     }
 
@@ -188,6 +456,191 @@ namespace MeeGo {
         emit errorSignal(errorString_);
     }
 
+    QmSensorTapChannel::QmSensorTapChannel(int tap, int sensor, QmSensorPrivate *sensorPriv)
+        : tap_(tap), sensor_(sensor), sensorPriv_(sensorPriv)
+    {
+        // The parent is set on the thread of the sensor, see attach()
+        moveToThread(sensorPriv->thread());
+    }
+
+    bool QmSensorTapChannel::setup(QObject *source, bool setOn)
+    {
+        return traceConnect(source, sensor_, this, setOn);
+    }
+
+    Qt::ConnectionType QmSensorTapChannel::connection() const
+    {
+        // A thread that is not running runs nothing of the sensor meanwhile
+        if (thread() == QThread::currentThread() || !thread()->isRunning()) {
+            return Qt::DirectConnection;
+        }
+        return Qt::BlockingQueuedConnection;
+    }
+
+    void QmSensorTapChannel::invoke(const char *member, QGenericArgument argument)
+    {
+        QMetaObject::invokeMethod(this, member, connection(), argument);
+    }
+
+    void QmSensorTapChannel::invoke(const char *member, QGenericReturnArgument result)
+    {
+        QMetaObject::invokeMethod(this, member, connection(), result);
+    }
+
+    bool QmSensorTapChannel::attach()
+    {
+        if (sensorPriv_->taps_[tap_]) {
+            return false;
+        }
+        setParent(sensorPriv_);
+        sensorPriv_->taps_[tap_] = this;
+        QObject *readings = sensorPriv_->source();
+        if (sensorPriv_->running_ && readings) {
+            setup(readings, true);
+        }
+        return true;
+    }
+
+    void QmSensorTapChannel::detach()
+    {
+        if (sensorPriv_->taps_[tap_] == this) {
+            QObject *readings = sensorPriv_->source();
+            if (sensorPriv_->running_ && readings) {
+                setup(readings, false);
+            }
+            sensorPriv_->taps_[tap_] = NULL;
+        }
+        deleteLater();
+    }
+
+    QmCompositeSensorPrivate::QmCompositeSensorPrivate(QmSensor *parent, int defaultInterval)
+        : QmSensorPrivate(parent), defaultInterval_(defaultInterval), interval_(0), sensorIfc_(NULL)
+    {
+    }
+
+    QmCompositeSensorPrivate::~QmCompositeSensorPrivate() {}
+
+    bool QmCompositeSensorPrivate::init()
+    {
+        initDone_ = true;
+        return true;
+    }
+
+    AbstractSensorChannelInterface** QmCompositeSensorPrivate::getSensorIfcPtr()
+    {
+        return &sensorIfc_;
+    }
+
+    AbstractSensorChannelInterface* QmCompositeSensorPrivate::controlSession()
+    {
+        return NULL;
+    }
+
+    const AbstractSensorChannelInterface* QmCompositeSensorPrivate::listenSession()
+    {
+        return NULL;
+    }
+
+    void QmCompositeSensorPrivate::addPart(QmSensor *part)
+    {
+        parts_.append(part);
+    }
+
+    QmSensor::SessionType QmCompositeSensorPrivate::requestSession(QmSensor::SessionType type)
+    {
+        closeSession();
+        if (type == QmSensor::SessionTypeNone) {
+            return QmSensor::SessionTypeNone;
+        }
+
+        // The session is the weakest one of the parts
+        QmSensor::SessionType composite = type;
+        foreach (QmSensor *part, parts_) {
+            QmSensor::SessionType partType = part->requestSession(type);
+            if (partType == QmSensor::SessionTypeNone) {
+                setError(part->lastError());
+                closeSession();
+                return QmSensor::SessionTypeNone;
+            }
+            composite = qMin(composite, partType);
+        }
+
+        sessionType_ = composite;
+        int value = interval_ ? interval_ : defaultInterval_;
+        if (value) {
+            foreach (QmSensor *part, parts_) {
+                part->setInterval(value);
+            }
+        }
+        return sessionType_;
+    }
+
+    void QmCompositeSensorPrivate::closeSession()
+    {
+        foreach (QmSensor *part, parts_) {
+            part->requestSession(QmSensor::SessionTypeNone);
+        }
+        resetState();
+        sessionType_ = QmSensor::SessionTypeNone;
+    }
+
+    bool QmCompositeSensorPrivate::start()
+    {
+        for (int i = 0; i < parts_.size(); i++) {
+            if (!parts_[i]->start()) {
+                setError("Unable to start, no open session");
+                while (i-- > 0) {
+                    parts_[i]->stop();
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool QmCompositeSensorPrivate::stop()
+    {
+        bool stopped = true;
+        foreach (QmSensor *part, parts_) {
+            stopped = part->stop() && stopped;
+        }
+        return stopped;
+    }
+
+    int QmCompositeSensorPrivate::interval()
+    {
+        return parts_.isEmpty() ? 0 : parts_.first()->interval();
+    }
+
+    void QmCompositeSensorPrivate::setInterval(int value)
+    {
+        // Kept for the next session, the parts forget it when theirs closes
+        interval_ = value > 0 ? value : 0;
+        foreach (QmSensor *part, parts_) {
+            part->setInterval(value);
+        }
+    }
+
+    bool QmCompositeSensorPrivate::standbyOverride()
+    {
+        return parts_.isEmpty() ? false : parts_.first()->standbyOverride();
+    }
+
+    void QmCompositeSensorPrivate::setStandbyOverride(bool value)
+    {
+        foreach (QmSensor *part, parts_) {
+            part->setStandbyOverride(value);
+        }
+    }
+
+    void QmCompositeSensorPrivate::moveToDeliveryThread(QThread *thread)
+    {
+        QmSensorPrivate::moveToDeliveryThread(thread);
+        foreach (QmSensor *part, parts_) {
+            part->setDeliveryThread(thread);
+        }
+    }
+
     // ------------------ END PRIVATE CLASS DEFINITION ------------------ //
 
     QmSensor::QmSensor(QObject *parent = 0) : QObject(parent)
@@ -196,6 +649,11 @@ namespace MeeGo {
 
     QmSensor::~QmSensor()
     {
+        MEEGO_PRIVATE(QmSensor);
+        // The session is closed on the thread it was opened on
+        if (priv->elsewhere()) {
+            priv->callOnThread(QmSensorPrivate::CallRequestSession, SessionTypeNone);
+        }
         MEEGO_UNINITIALIZE(QmSensor);
     }
 
@@ -207,10 +665,18 @@ namespace MeeGo {
 
     bool QmSensor::start() {
         MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            return priv->callOnThread(QmSensorPrivate::CallStart);
+        }
         if (priv->running_) return true;
+        // A reading from before the sensor was stopped is out of date
+        priv->clearCache();
         if (priv->start()) {
             priv->running_ = true;
+            priv->meter_.restart();
+            priv->meter_.setInterval(priv->session_ ? priv->session_->sessionInterval() : priv->interval());
             priv->setupSignals(true);
+            priv->setupTaps(true);
             return true;
         }
         return false;
@@ -219,6 +685,9 @@ namespace MeeGo {
     bool QmSensor::stop()
     {
         MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            return priv->callOnThread(QmSensorPrivate::CallStop);
+        }
         if (!priv->running_) return true;
 
         if (priv->stop()) {
@@ -226,6 +695,11 @@ namespace MeeGo {
 
             // Unbind signals, in case another listener keeps session open
             priv->setupSignals(false);
+            priv->setupTaps(false);
+
+            // Deliver the readings of an incomplete batch
+            priv->batchTimer_.stop();
+            priv->flushBatch();
             return true;
         }
         return false;
@@ -240,6 +714,9 @@ namespace MeeGo {
     QmSensor::SessionType QmSensor::requestSession(SessionType type)
     {
         MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            return (SessionType)priv->callOnThread(QmSensorPrivate::CallRequestSession, type);
+        }
 
         stop();
         priv->requestSession(type);
@@ -254,7 +731,9 @@ namespace MeeGo {
 
     bool QmSensor::verifySessionLevel(QmSensor::SessionType type)
     {
-        return ((bool)(type <= sessionType()));
+        // A replayed sensor has no sensord interface to call
+        MEEGO_PRIVATE(QmSensor);
+        return ((bool)(type <= sessionType())) && !priv->replay_;
     }
 
     QString QmSensor::lastError() const
@@ -266,24 +745,161 @@ namespace MeeGo {
     int QmSensor::interval()
     {
         MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            return priv->callOnThread(QmSensorPrivate::CallInterval);
+        }
         return priv->interval();
     }
 
     void QmSensor::setInterval(int value)
     {
         MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            priv->callOnThread(QmSensorPrivate::CallSetInterval, value);
+            return;
+        }
         priv->setInterval(value);
     }
 
     bool QmSensor::standbyOverride()
     {
         MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            return priv->callOnThread(QmSensorPrivate::CallStandbyOverride);
+        }
         return priv->standbyOverride();
     }
 
     void QmSensor::setStandbyOverride(bool value)
     {
         MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            priv->callOnThread(QmSensorPrivate::CallSetStandbyOverride, value);
+            return;
+        }
         priv->setStandbyOverride(value);
     }
+
+    bool QmSensor::setDeliveryThread(QThread *thread)
+    {
+        MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            priv->setError("Unable to move, not on the thread of the sensor");
+            return false;
+        }
+        if (!thread) {
+            priv->setError("Unable to move, no thread");
+            return false;
+        }
+        if (priv->sessionType() != SessionTypeNone) {
+            priv->setError("Unable to move, session open");
+            return false;
+        }
+        if (parent()) {
+            // moveToThread() would only print a warning
+            priv->setError("Unable to move, sensor has a parent");
+            return false;
+        }
+
+        // The private, and the channels that are its children, go along
+        moveToThread(thread);
+        if (QObject::thread() != thread) {
+            priv->setError("Unable to move to the thread");
+            return false;
+        }
+        priv->moveToDeliveryThread(thread);
+        return true;
+    }
+
+    bool QmSensor::setConsumerMode(int capacity)
+    {
+        MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            return priv->callOnThread(QmSensorPrivate::CallSetConsumerMode, capacity);
+        }
+        if (capacity <= 0) {
+            priv->ring_.close();
+            return true;
+        }
+        if (!priv->ring_.open(capacity)) {
+            priv->setError("Unable to set up consumer ring");
+            return false;
+        }
+        return true;
+    }
+
+    bool QmSensor::consumerMode()
+    {
+        MEEGO_PRIVATE(QmSensor);
+        return priv->ring_.isOpen();
+    }
+
+    int QmSensor::consumerFd()
+    {
+        MEEGO_PRIVATE(QmSensor);
+        return priv->ring_.fd();
+    }
+
+    void QmSensor::setDecimation(DecimationMode mode)
+    {
+        MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            priv->callOnThread(QmSensorPrivate::CallSetDecimation, mode);
+            return;
+        }
+        priv->decimation_ = mode;
+    }
+
+    QmSensor::DecimationMode QmSensor::decimation()
+    {
+        MEEGO_PRIVATE(QmSensor);
+        return priv->decimation_;
+    }
+
+    void QmSensor::addFilter(QmSensorFilter *filter)
+    {
+        MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            priv->callOnThread(QmSensorPrivate::CallAddFilter, filter);
+            return;
+        }
+        if (filter && !priv->filters_.contains(filter)) {
+            priv->filters_.append(filter);
+        }
+    }
+
+    void QmSensor::removeFilter(QmSensorFilter *filter)
+    {
+        MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            priv->callOnThread(QmSensorPrivate::CallRemoveFilter, filter);
+            return;
+        }
+        priv->filters_.removeAll(filter);
+    }
+
+    QmSensorStatistics QmSensor::statistics()
+    {
+        MEEGO_PRIVATE(QmSensor);
+        QmSensorStatistics statistics;
+        priv->meter_.load(&statistics);
+        statistics.dropped = priv->ring_.dropped();
+        return statistics;
+    }
+
+    void QmSensor::resetStatistics()
+    {
+        MEEGO_PRIVATE(QmSensor);
+        if (priv->elsewhere()) {
+            priv->callOnThread(QmSensorPrivate::CallResetStatistics);
+            return;
+        }
+        priv->meter_.reset();
+    }
+
+    int QmSensor::readRing(void *readings, int size, int max)
+    {
+        MEEGO_PRIVATE(QmSensor);
+        return priv->ring_.pop(readings, size, max);
+    }
 }
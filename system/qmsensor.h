@@ -34,20 +34,27 @@
 #ifndef QMSENSOR_H
 #define QMSENSOR_H
 #include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
 #include "system_global.h"
 
 QT_BEGIN_HEADER;
 
 namespace MeeGo {
     class QmSensorPrivate;
+    class QmSensorFilter;
 
     /**
      * Basic sensor reading.
+     *
+     * The readings of all sensors derive from this class and are copied as
+     * bytes into the consumer ring, the latest reading of the getters and
+     * queued signals, so they have no virtual functions and nothing to
+     * construct or destroy.
      */
     class QmSensorReading
     {
     public:
-        quint64 timestamp;
+        quint64 timestamp;  /**< Time of measurement in us */
     };
 
     /**
@@ -59,6 +66,42 @@ namespace MeeGo {
         int value;
     };
 
+    /**
+     * How a sensor has been receiving its readings, see
+     * QmSensor::statistics(). Times are measured when the readings reach
+     * the sensor, before conversion, decimation and filtering.
+     *
+     * Jitter and gaps are measured against the interval of the session,
+     * and are meaningful for the sensors with a continuous sample stream.
+     */
+    class MEEGO_SYSTEM_EXPORT QmSensorStatistics
+    {
+    public:
+        enum {
+            JitterBuckets = 8
+        };
+
+        int interval;               /**< Interval of the session in ms, 0 if not known */
+        quint64 received;           /**< Readings received from sensord */
+        quint64 dropped;            /**< Readings dropped in consumer mode because the ring was full, since it was switched on */
+        quint64 gaps;               /**< Readings more than twice the interval after the previous one */
+        quint64 longestGap;         /**< Longest of the gaps in us, by the reading timestamps */
+        /**
+         * Readings by how far the time between their arrivals differed
+         * from the interval: less than 0.25, 0.5, 1, 2, 4, 8 and 16 ms,
+         * and more.
+         */
+        quint64 jitter[JitterBuckets];
+        quint64 handlingTime;       /**< Time spent converting and delivering the readings in ns */
+        quint64 longestHandling;    /**< Longest time spent on one reading in ns */
+
+        /**
+         * Returns the statistics as one line of text, for logs.
+         * @return Text
+         */
+        QString toString() const;
+    };
+
     /**
      * @scope Internal
      *
@@ -78,6 +121,11 @@ namespace MeeGo {
      * no measurement is done and the previous measured value may be
      * undefined or outdated.
      *
+     * While this client is running, the accessor functions return the
+     * latest measurement delivered to it without a call to the server,
+     * and may be called from any thread. Before the first measurement
+     * after start(), and while stopped, they ask the server.
+     *
      * Sample use of sensor class ALSSensor:
      * @code
      * #include <qmals.h>
@@ -118,6 +166,17 @@ namespace MeeGo {
             SessionTypeControl  /**< Control session */
         };
 
+        /**
+         * Ways to reduce the shared sample stream to the interval asked for,
+         * see #setDecimation().
+         */
+        enum DecimationMode {
+            DecimationOff,      /**< Deliver every sample of the session */
+            DecimationLast,     /**< Deliver the latest sample of each interval */
+            DecimationAverage,  /**< Deliver the average of each interval */
+            DecimationMaxAbs    /**< Deliver the value furthest from zero in each interval, per axis */
+        };
+
         virtual ~QmSensor();
 
         /**
@@ -217,6 +276,131 @@ namespace MeeGo {
          */
         void setStandbyOverride(bool value);
 
+        /**
+         * Moves the delivery of readings to a thread, for example a worker
+         * that processes them. The sessions of the sensor are then opened
+         * on that thread: readings are received there from sensord and the
+         * data signals are emitted there, so they reach receivers on that
+         * thread by direct calls and never wait for the event loop of the
+         * thread that created the sensor.
+         *
+         * Call before a session is requested, from the thread the sensor
+         * lives on. Like QObject::moveToThread(), this is refused for a
+         * sensor with a parent. The thread must run an event loop. requestSession(),
+         * start(), stop(), resetStatistics(), setConsumerMode(),
+         * setDecimation(), addFilter(), removeFilter(), the interval and
+         * standby override functions and the setBatchSize() of the sensors
+         * that have one may be called from any thread afterwards; they are
+         * carried out on the delivery thread and wait for it.
+         * Delete the sensor with deleteLater(), or make sure no signal is
+         * being delivered.
+         *
+         * @param thread The thread
+         * @return \c false if a session is open, the sensor has a parent
+         *         or it lives on another thread
+         */
+        bool setDeliveryThread(QThread *thread);
+
+        /**
+         * Returns how the readings of this sensor have been received since
+         * it was created, or since #resetStatistics(). May be called from
+         * any thread.
+         *
+         * @return Statistics
+         */
+        QmSensorStatistics statistics();
+
+        /**
+         * Sets the statistics back to zero, see #statistics().
+         */
+        void resetStatistics();
+
+        /**
+         * Sets how readings are reduced when this client asked for a longer
+         * interval than another client of the same sensor. The sensord
+         * session runs at the shortest interval requested in the process;
+         * each client still receives readings at the interval it set with
+         * #setInterval(), combined as selected here. The default is
+         * #DecimationLast.
+         *
+         * Applies to the sensors with a continuous sample stream:
+         * QmAccelerometer, QmCompass, QmMagnetometer and QmRotation.
+         * Angles are averaged across their wrap-around point.
+         *
+         * @param mode Decimation mode
+         */
+        void setDecimation(DecimationMode mode);
+
+        /**
+         * Returns the decimation mode, see #setDecimation().
+         * @return Decimation mode
+         */
+        DecimationMode decimation();
+
+        /**
+         * Attaches a filter to the readings of this sensor. Filters run in
+         * the order they were added, after decimation, see #setDecimation().
+         * Applies to the XYZ sensors QmAccelerometer, QmMagnetometer and
+         * QmRotation. The filter is not owned by the sensor; a deleted
+         * filter is skipped.
+         *
+         * @param filter Filter to add
+         */
+        void addFilter(QmSensorFilter *filter);
+
+        /**
+         * Detaches a filter added with #addFilter().
+         *
+         * @param filter Filter to remove
+         */
+        void removeFilter(QmSensorFilter *filter);
+
+        /**
+         * Switches consumer mode on or off. In consumer mode readings are not
+         * emitted as signals. They are stored in a lock-free ring instead,
+         * which one other thread may drain with read() without any locking
+         * or event loop round trip. The thread owning the sensor object
+         * fills the ring; readings that don't fit are dropped.
+         *
+         * The consumer thread must not be reading while the mode is changed.
+         *
+         * @param capacity Number of readings the ring holds, rounded up to
+         *                 a power of two, or 0 to switch consumer mode off
+         * @return \c true on success, \c false on error
+         */
+        bool setConsumerMode(int capacity);
+
+        /**
+         * Returns whether the sensor is in consumer mode.
+         * @return \c True in consumer mode
+         */
+        bool consumerMode();
+
+        /**
+         * Returns a descriptor that becomes readable when readings are
+         * waiting in the consumer ring. Call read() until it returns 0
+         * before waiting on the descriptor again, for example with poll().
+         *
+         * @return File descriptor, or -1 when not in consumer mode
+         */
+        int consumerFd();
+
+        /**
+         * Takes readings from the consumer ring, oldest first. The reading
+         * type must be the one of the sensor's data signal, for example
+         * QmAccelerometerReading for QmAccelerometer.
+         *
+         * @param readings Array for at least \c max readings
+         * @param max Maximum number of readings to take
+         * @return Number of readings taken, or -1 when not in consumer mode
+         *         or when the reading type does not match
+         */
+        template <typename Reading>
+        int read(Reading *readings, int max)
+        {
+            return readRing(readings, sizeof(Reading), max);
+        }
+
     Q_SIGNALS:
         /**
          * Emitted when an error occurs. See #lastError().
@@ -231,9 +415,19 @@ namespace MeeGo {
         QmSensor(QObject *parent);
         MEEGO_DECLARE_PROTECTED(QmSensor);
 
+    private:
+        friend class QmSensorReplay;
+        friend class QmSensorRecorder;
+        friend class QmSensorGovernor;
+
+        int readRing(void *readings, int size, int max);
+
     };
 } // MeeGo namespace
 
+Q_DECLARE_TYPEINFO(MeeGo::QmSensorReading, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(MeeGo::QmIntReading, Q_PRIMITIVE_TYPE);
+
 QT_END_HEADER
 
 #endif
@@ -28,28 +28,416 @@
 #ifndef QMSENSOR_P_H
 #define QMSENSOR_P_H
 
+#include <QList>
+#include <QMutex>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+#include <QVarLengthArray>
+#include <QVector>
+
 #include "sensord/abstractsensor_i.h"
 #include "qmsensor.h"
+#include "qmsensorfilter.h"
+#include "qmsensorring_p.h"
+#include "qmsensorsession_p.h"
 
-#define DEFINE_GENERIC_FUNCTIONS(Class) \
+#define DEFINE_PUBLIC_FUNCTION(Class) \
         private: \
-        AbstractSensorChannelInterface** getSensorIfcPtr() \
-        { \
-            return (AbstractSensorChannelInterface**)&sensorIfc; \
-        } \
-        \
         QmSensor* getPublicPtr() \
         { \
             MEEGO_PUBLIC(Class); \
             return pub; \
         }
 
+#define DEFINE_GENERIC_FUNCTIONS(Class) \
+        DEFINE_PUBLIC_FUNCTION(Class) \
+        AbstractSensorChannelInterface** getSensorIfcPtr() \
+        { \
+            return (AbstractSensorChannelInterface**)&sensorIfc; \
+        }
+
 namespace MeeGo 
 {
+    /**
+     * Readings collected for batched delivery. The buffer keeps its
+     * capacity from one batch to the next, so batching does not allocate
+     * unless a receiver holds on to a delivered batch.
+     */
+    template <typename Reading>
+    class QmSensorBatch
+    {
+    public:
+        void reserve(int size)
+        {
+            readings_.reserve(size);
+        }
+
+        int append(const Reading& reading)
+        {
+            readings_.append(reading);
+            return readings_.size();
+        }
+
+        const QVector<Reading>& readings() const
+        {
+            return readings_;
+        }
+
+        Reading* data()
+        {
+            return readings_.data();
+        }
+
+        int count() const
+        {
+            return readings_.size();
+        }
+
+        bool isEmpty() const
+        {
+            return readings_.isEmpty();
+        }
+
+        void clear()
+        {
+            // Unlike clear(), resize() keeps the reserved capacity
+            readings_.resize(0);
+        }
+
+    private:
+        QVector<Reading> readings_;
+    };
+
+    /**
+     * The latest reading of a sensor, for the getters. One thread stores,
+     * any thread loads without locking: a sequence number that is odd
+     * during a store tells the readers to retry.
+     */
+    template <typename Reading>
+    class QmSensorCache
+    {
+    public:
+        QmSensorCache() : sequence_(0), valid_(false) {}
+
+        void store(const Reading& reading)
+        {
+            write(&reading);
+        }
+
+        void clear()
+        {
+            write(NULL);
+        }
+
+        /**
+         * @return \c false if there is no reading
+         */
+        bool load(Reading *output) const
+        {
+            for (;;) {
+                unsigned int before = sequence_;
+                __sync_synchronize();
+                if (before & 1) {
+                    continue;
+                }
+                bool valid = valid_;
+                if (valid) {
+                    *output = reading_;
+                }
+                __sync_synchronize();
+                if (sequence_ == before) {
+                    return valid;
+                }
+            }
+        }
+
+    private:
+        void write(const Reading *reading)
+        {
+            sequence_ = sequence_ + 1;
+            __sync_synchronize();
+            valid_ = reading != NULL;
+            if (reading) {
+                reading_ = *reading;
+            }
+            __sync_synchronize();
+            sequence_ = sequence_ + 1;
+        }
+
+        volatile unsigned int sequence_;
+        bool valid_;
+        Reading reading_;
+    };
+
+    /**
+     * Describes the channels of a reading type for QmSensorDecimator.
+     * Specializations provide:
+     *
+     * - \c Count, the number of channels
+     * - \c at(reading, i), a reference to channel \c i
+     * - \c period(i), 360 for angles and 0 for other channels
+     * - \c lowest(i), the lowest value of an angle
+     *
+     * Fields that are not channels, such as a calibration level, are taken
+     * from the latest reading.
+     */
+    template <typename Reading>
+    struct QmSensorChannels;
+
+    /**
+     * Moves an angle channel by whole turns to the nearest of \c reference,
+     * so that angles can be averaged and interpolated across the
+     * wrap-around point. Other channels are returned as is.
+     */
+    template <typename Channels>
+    inline int unwrapChannel(int value, int reference, int i)
+    {
+        int period = Channels::period(i);
+        if (!period) {
+            return value;
+        }
+        int delta = ((value - reference) % period + period) % period;
+        return reference + (delta > period / 2 ? delta - period : delta);
+    }
+
+    /**
+     * Moves an angle channel back to its range, see unwrapChannel().
+     */
+    template <typename Channels>
+    inline int wrapChannel(int value, int i)
+    {
+        int period = Channels::period(i);
+        if (!period) {
+            return value;
+        }
+        int lowest = Channels::lowest(i);
+        return lowest + ((value - lowest) % period + period) % period;
+    }
+
+    /**
+     * Reduces a sample stream to one reading per interval, see
+     * QmSensor::setDecimation(). Intervals are measured with the sample
+     * timestamps. An interval starts where the previous one was due to end,
+     * so the delivery rate is exact on average.
+     */
+    template <typename Reading>
+    class QmSensorDecimator
+    {
+    public:
+        typedef QmSensorChannels<Reading> Channels;
+
+        QmSensorDecimator() : mode_(QmSensor::DecimationOff), period_(0), count_(0), due_(0)
+        {
+            for (int i = 0; i < Channels::Count; i++) {
+                first_[i] = sum_[i] = peak_[i] = 0;
+            }
+        }
+
+        /**
+         * Adds a reading to the current interval.
+         *
+         * @param reading The new reading. Replaced by the reading to deliver
+         *                when \c true is returned.
+         * @param mode How to combine the readings of an interval
+         * @param period Length of the interval in microseconds, 0 for none
+         * @return \c true if a reading is to be delivered
+         */
+        bool add(Reading& reading, QmSensor::DecimationMode mode, quint64 period)
+        {
+            if (mode == QmSensor::DecimationOff || period == 0) {
+                return true;
+            }
+            if (mode != mode_ || period != period_) {
+                mode_ = mode;
+                period_ = period;
+                count_ = 0;
+                due_ = 0;
+            }
+
+            for (int i = 0; i < Channels::Count; i++) {
+                int value = Channels::at(reading, i);
+                if (count_ == 0) {
+                    first_[i] = value;
+                    sum_[i] = 0;
+                    peak_[i] = value;
+                }
+                // Averages angles across the wrap-around point correctly
+                sum_[i] += unwrapChannel<Channels>(value, first_[i], i);
+                if (qAbs(value) > qAbs(peak_[i])) {
+                    peak_[i] = value;
+                }
+            }
+            count_++;
+
+            if (reading.timestamp < due_) {
+                return false;
+            }
+            if (due_ && reading.timestamp < due_ + period_) {
+                due_ += period_;
+            } else {
+                // First reading, or the stream had a gap
+                due_ = reading.timestamp + period_;
+            }
+
+            if (mode_ == QmSensor::DecimationAverage) {
+                for (int i = 0; i < Channels::Count; i++) {
+                    Channels::at(reading, i) = wrapChannel<Channels>(qRound((double)sum_[i] / count_), i);
+                }
+            } else if (mode_ == QmSensor::DecimationMaxAbs) {
+                for (int i = 0; i < Channels::Count; i++) {
+                    Channels::at(reading, i) = peak_[i];
+                }
+            }
+            count_ = 0;
+            return true;
+        }
+
+    private:
+        QmSensor::DecimationMode mode_;
+        quint64 period_;
+        int count_;
+        quint64 due_;
+        int first_[Channels::Count];
+        qint64 sum_[Channels::Count];
+        int peak_[Channels::Count];
+    };
+
+    /**
+     * The counters behind QmSensor::statistics(). The thread of the sensor
+     * updates them, any thread loads them: a sequence number that is odd
+     * during an update tells the readers to retry, as in QmSensorCache.
+     */
+    class QmSensorMeter
+    {
+    public:
+        QmSensorMeter();
+
+        /* Monotonic time in ns */
+        static qint64 now();
+
+        void reset();
+
+        /* Forgets the previous reading, after the sensor was stopped */
+        void restart();
+
+        /* Interval of the session in ms, 0 if not known */
+        void setInterval(int interval);
+
+        /**
+         * Counts a reading.
+         *
+         * @param timestamp Timestamp of the reading in us
+         * @param arrival When it arrived, see #now()
+         * @param duration How long it took to handle in ns
+         */
+        void add(quint64 timestamp, qint64 arrival, qint64 duration);
+
+        void load(QmSensorStatistics *output) const;
+
+    private:
+        void begin();
+        void end();
+
+        volatile unsigned int sequence_;
+        QmSensorStatistics statistics_;
+        quint64 previousTimestamp_;
+        qint64 previousArrival_;
+    };
+
+    /**
+     * Counts a reading in the meter of its sensor and times the handling
+     * of it, until it goes out of scope. To be declared first in the data
+     * slot.
+     */
+    class QmSensorProbe
+    {
+    public:
+        QmSensorProbe(QmSensorMeter& meter, quint64 timestamp)
+            : meter_(meter), timestamp_(timestamp), arrival_(QmSensorMeter::now()) {}
+
+        ~QmSensorProbe()
+        {
+            meter_.add(timestamp_, arrival_, QmSensorMeter::now() - arrival_);
+        }
+
+    private:
+        QmSensorMeter& meter_;
+        quint64 timestamp_;
+        qint64 arrival_;
+    };
+
+    class QmSensorPrivate;
+
+    /**
+     * Takes the sensord readings of a sensor besides the sensor itself,
+     * for a QmSensorRecorder or a QmSensorGovernor. It connects to the
+     * same signals as the sensor does, see QmSensorPrivate::source(), while
+     * the sensor runs.
+     *
+     * Once attached, the channel is a child of the private of its sensor,
+     * so it lives on the delivery thread of the sensor and is gone with
+     * the sensor; the recorder or governor keeps a QPointer to it. It is
+     * used from there through #invoke().
+     */
+    class QmSensorTapChannel : public QObject
+    {
+        Q_OBJECT;
+
+    public:
+        /**
+         * @param tap QmSensorPrivate::Tap of the channel
+         * @param sensor QmTraceSensor of the sensor
+         * @param sensorPriv The private of the sensor
+         */
+        QmSensorTapChannel(int tap, int sensor, QmSensorPrivate *sensorPriv);
+
+        /**
+         * Connects to or disconnects from the source of the readings,
+         * like QmSensorPrivate::setupSignals().
+         */
+        virtual bool setup(QObject *source, bool setOn);
+
+        /**
+         * Calls a slot on the thread of the sensor and waits for it to
+         * return, see QmSensor::setDeliveryThread().
+         */
+        void invoke(const char *member, QGenericArgument argument = QGenericArgument(0));
+        void invoke(const char *member, QGenericReturnArgument result);
+
+    public Q_SLOTS:
+        /**
+         * Takes the place of the channel in the sensor, and connects if the
+         * sensor runs.
+         *
+         * @return \c false if another channel has the place
+         */
+        virtual bool attach();
+
+        /**
+         * Disconnects, leaves the place in the sensor and deletes the
+         * channel once the slots already queued for it have run.
+         */
+        virtual void detach();
+
+    protected:
+        int tap_;
+        int sensor_;
+        QmSensorPrivate *sensorPriv_;
+
+    private:
+        Qt::ConnectionType connection() const;
+    };
+
     class QmSensorPrivate : public QObject
     {
         Q_OBJECT;
         MEEGO_DECLARE_PUBLIC(QmSensor)
+        friend class QmSensorSession;
+        friend class QmSensorReplay;
+        friend class QmSensorRecorder;
+        friend class QmSensorGovernor;
+        friend class QmSensorTapChannel;
 
     public:
 
@@ -57,21 +445,94 @@ namespace MeeGo
         ~QmSensorPrivate();
 
         QmSensor::SessionType sessionType();
-        QmSensor::SessionType requestSession(QmSensor::SessionType type);
-        void closeSession();
+        virtual QmSensor::SessionType requestSession(QmSensor::SessionType type);
+        virtual void closeSession();
 
         virtual bool start();
         virtual bool stop();
 
-        int interval();
-        void setInterval(int value);
+        virtual int interval();
+        virtual void setInterval(int value);
 
-        bool standbyOverride();
-        void setStandbyOverride(bool value);
+        /* The interval set for this sensor, 0 if it runs at the one of
+           the session */
+        int requestedInterval();
+
+        virtual bool standbyOverride();
+        virtual void setStandbyOverride(bool value);
+
+        /**
+         * Gets the latest reading for a getter.
+         *
+         * @return \c false if the sensor is not running or has not
+         *         delivered a reading since it was started; the getter
+         *         asks sensord then.
+         */
+        template <typename Reading>
+        bool cached(const QmSensorCache<Reading>& cache, Reading *output) const
+        {
+            return running_ && cache.load(output);
+        }
+
+        /**
+         * Sets up batched delivery, see QmAccelerometer::setBatchSize().
+         * Carried out on the thread of the sensor.
+         *
+         * @param samples Readings per batch, 0 for per-reading delivery
+         * @param timeout Maximum age of the first reading in a batch in ms, 0 for none
+         */
+        void setBatch(int samples, int timeout);
+        int batchSize();
+
+        /**
+         * Moves what the sensor owns, besides its children, to the thread,
+         * see QmSensor::setDeliveryThread(). Sensors built on other sensors
+         * move those too.
+         */
+        virtual void moveToDeliveryThread(QThread *thread);
+
+        /**
+         * Tells whether the caller is on another thread than the sensor.
+         * The sessions of the sensor are then used through #callOnThread().
+         */
+        bool elsewhere() const
+        {
+            return thread() != QThread::currentThread();
+        }
+
+        /* Functions that use the session, or change what the data slot uses */
+        enum ThreadCall {
+            CallRequestSession,
+            CallStart,
+            CallStop,
+            CallInterval,
+            CallSetInterval,
+            CallStandbyOverride,
+            CallSetStandbyOverride,
+            CallResetStatistics,
+            CallSetConsumerMode,
+            CallSetDecimation,
+            CallAddFilter,
+            CallRemoveFilter,
+            CallSetBatch
+        };
+
+        /**
+         * Calls a function of the public class, or #setBatch(), on the
+         * thread of the sensor and waits for it to return.
+         *
+         * @return What the function returned, 0 if the thread is not running
+         */
+        int callOnThread(ThreadCall call, int argument = 0, int second = 0);
+        int callOnThread(ThreadCall call, QmSensorFilter *filter);
 
     Q_SIGNALS:
         void errorSignal(QString error);
 
+    private Q_SLOTS:
+        void slotBatchTimeout();
+        void slotThreadCall();
+
     protected:
 
         /**
@@ -80,6 +541,14 @@ namespace MeeGo
          * @return \c true on success, \c false on failure.
          */
         virtual bool init() = 0;
+
+        /**
+         * Returns the name of the sensor in sensord, for example
+         * \c "accelerometersensor". Sensor objects with the same name
+         * share one session.
+         */
+        virtual const char* sensorId() = 0;
+
         /**
         * Returns a base class pointer to the SensorChannelInterface held by the
         * child class.
@@ -94,7 +563,8 @@ namespace MeeGo
          * of this class.
          *
          * Do not implement this directly, but add macro
-         * \c DEFINE_GENERIC_FUNCTIONS to the child class definition.
+         * \c DEFINE_GENERIC_FUNCTIONS, or \c DEFINE_PUBLIC_FUNCTION for a
+         * QmCompositeSensorPrivate, to the child class definition.
          */
          virtual QmSensor* getPublicPtr() = 0;
 
@@ -117,6 +587,13 @@ namespace MeeGo
          */
         virtual const AbstractSensorChannelInterface* listenSession() = 0;
 
+        /**
+         * Returns the object whose signals deliver the sensord readings:
+         * the channel of an attached QmSensorReplay, or the sensord
+         * interface of the open session. NULL if there is neither.
+         */
+        QObject* source();
+
         /**
          * Setup signals connections for sensor. Bind sensor interface to
          * QmSensor subclass.
@@ -128,14 +605,215 @@ namespace MeeGo
          */
         virtual bool setupSignals(bool setOn) = 0;
 
+        /**
+         * Connects the channels of an attached QmSensorRecorder and
+         * QmSensorGovernor to the source of the readings, like
+         * #setupSignals().
+         */
+        void setupTaps(bool setOn);
+
+        /**
+         * Allocates room for a batch of \c samples readings. Sensors that
+         * support batched delivery keep a QmSensorBatch and implement this
+         * together with #flushBatch().
+         */
+        virtual void reserveBatch(int samples) { Q_UNUSED(samples); }
+
+        /**
+         * Emits the readings collected so far, if any, and empties the batch.
+         */
+        virtual void flushBatch() {}
+
+        /**
+         * Forgets the latest reading. Sensors with a getter keep a
+         * QmSensorCache, store each reading in it from the data slot and
+         * implement this.
+         */
+        virtual void clearCache() {}
+
+        /**
+         * Tells whether readings should be collected instead of emitted.
+         */
+        bool batching() const { return batchSize_ > 0; }
+
+        /**
+         * To be called after a reading has been added to the batch.
+         *
+         * @param count Number of readings in the batch
+         */
+        void batchAppended(int count);
+
+        /**
+         * Stores the reading in the consumer ring when in consumer mode.
+         * To be called from the data slot before the reading is emitted.
+         *
+         * @return \c true if the reading was taken and must not be emitted
+         */
+        template <typename Reading>
+        bool consume(const Reading& reading)
+        {
+            // Fails to compile for readings that don't fit a ring slot; an
+            // enum, unlike a local typedef, is not warned about when unused
+            enum { ReadingFitsRingSlot = sizeof(char[sizeof(Reading) <= SENSOR_RING_SLOT ? 1 : -1]) };
+            if (!ring_.isOpen()) {
+                return false;
+            }
+            ring_.push(&reading, sizeof(reading));
+            return true;
+        }
+
+        QmSensorRing ring_;
+
+        /**
+         * Runs the reading through the decimation filter of this sensor.
+         * To be called from the data slot before the reading is stored or
+         * emitted.
+         *
+         * @return \c true if \c reading is to be delivered
+         */
+        template <typename Reading>
+        bool decimate(QmSensorDecimator<Reading>& decimator, Reading& reading)
+        {
+            return decimator.add(reading, decimation_, (quint64)decimationInterval_ * 1000);
+        }
+
+        QmSensor::DecimationMode decimation_;
+
+        /**
+         * Runs the readings through the attached filters, in place. The
+         * first three channels of the reading are filtered.
+         */
+        template <typename Reading>
+        void filter(Reading *readings, int count)
+        {
+            if (filters_.isEmpty()) {
+                return;
+            }
+
+            typedef QmSensorChannels<Reading> Channels;
+            QVarLengthArray<float, 64> x(count), y(count), z(count);
+            for (int i = 0; i < count; i++) {
+                x[i] = Channels::at(readings[i], 0);
+                y[i] = Channels::at(readings[i], 1);
+                z[i] = Channels::at(readings[i], 2);
+            }
+            foreach (QPointer<QmSensorFilter> stage, filters_) {
+                if (stage) {
+                    stage->process(x.data(), y.data(), z.data(), count);
+                }
+            }
+            for (int i = 0; i < count; i++) {
+                Channels::at(readings[i], 0) = qRound(x[i]);
+                Channels::at(readings[i], 1) = qRound(y[i]);
+                Channels::at(readings[i], 2) = qRound(z[i]);
+            }
+        }
+
+        QList<QPointer<QmSensorFilter> > filters_;
+
+        /* Statistics of the readings, counted with a QmSensorProbe */
+        QmSensorMeter meter_;
+
+        /**
+         * The interval of this sensor when it is longer than the one of
+         * the session, 0 otherwise. Maintained by the session.
+         */
+        int decimationInterval_;
+
         QmSensor::SessionType sessionType_;
+        QmSensorSession* session_;
+        /* Replay channel, set by QmSensorReplay::attach() */
+        QPointer<QObject> replay_;
+        /* Channels set by QmSensorRecorder::attach() and QmSensorGovernor::attach() */
+        enum Tap {
+            TapRecorder,
+            TapGovernor,
+            TapCount
+        };
+        QPointer<QmSensorTapChannel> taps_[TapCount];
         bool initDone_;
 
         void setError(QString error);
         QString errorString_;
         bool running_;
+
+    private:
+        int batchSize_;
+        int batchTimeout_;
+        QTimer batchTimer_;
+
+        int invokeCall(ThreadCall call);
+
+        /* A call waiting to be made on the thread of the sensor */
+        QMutex callMutex_;
+        ThreadCall call_;
+        int callArgument_;
+        int callSecond_;
+        QmSensorFilter *callFilter_;
+        int callResult_;
     };
-    
+
+    /**
+     * Private base of a sensor that has no sensord channel of its own but
+     * is computed from other sensors it owns, its parts. Sessions, running
+     * state, interval and standby override are passed on to the parts.
+     *
+     * A subclass adds its parts with #addPart() in its constructor, closes
+     * the session in its destructor and adds \c DEFINE_PUBLIC_FUNCTION to
+     * its definition.
+     */
+    class QmCompositeSensorPrivate : public QmSensorPrivate
+    {
+        Q_OBJECT;
+
+    public:
+
+        /**
+         * @param defaultInterval Interval for the parts when the client has
+         *        set none, 0 for the one of their sessions
+         */
+        QmCompositeSensorPrivate(QmSensor *parent, int defaultInterval = 0);
+        ~QmCompositeSensorPrivate();
+
+        QmSensor::SessionType requestSession(QmSensor::SessionType type);
+        void closeSession();
+
+        bool start();
+        bool stop();
+
+        int interval();
+        void setInterval(int value);
+
+        bool standbyOverride();
+        void setStandbyOverride(bool value);
+
+        void moveToDeliveryThread(QThread *thread);
+
+    protected:
+
+        bool init();
+
+        AbstractSensorChannelInterface** getSensorIfcPtr();
+        AbstractSensorChannelInterface* controlSession();
+        const AbstractSensorChannelInterface* listenSession();
+
+        void addPart(QmSensor *part);
+
+        /**
+         * Forgets what was computed from the readings of the parts. Called
+         * when the session is closed.
+         */
+        virtual void resetState() {}
+
+    private:
+        QList<QmSensor*> parts_;
+        int defaultInterval_;
+        /* The interval set by the client, 0 if none */
+        int interval_;
+        /* Always NULL, there is no sensord channel */
+        AbstractSensorChannelInterface* sensorIfc_;
+    };
+
 } // MeeGo namespace
 
 #endif 
@@ -0,0 +1,105 @@
+/*!
+ * @file qmsensorarena.cpp
+ * @brief Registration of the sensor reading types
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QMetaType>
+#include <QVector>
+
+#include "qmaccelerometer.h"
+#include "qmals.h"
+#include "qmcompass.h"
+#include "qmfusedorientation.h"
+#include "qmgesture.h"
+#include "qmmagnetometer.h"
+#include "qmorientation.h"
+#include "qmproximity.h"
+#include "qmrotation.h"
+#include "qmsensorarena_p.h"
+#include "qmsensorring_p.h"
+#include "qmsensorsynchronizer.h"
+#include "qmtap.h"
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+#define IS_BYTE_COPIED_READING(T) (__is_base_of(QmSensorReading, T) && !__is_polymorphic(T) \
+                                   && __has_trivial_copy(T) && __has_trivial_destructor(T))
+#else
+#define IS_BYTE_COPIED_READING(T) true
+#endif
+
+/*
+ * A reading derives from QmSensorReading, has no virtual functions and is
+ * copied and destroyed trivially. The timestamp of the base is then first
+ * and the fields of the reading follow it, as the base is plain data with
+ * no padding to reuse. The consumer ring hands the readings out as bytes,
+ * so this layout is part of its ABI.
+ */
+typedef char QmSensorReadingSize[sizeof(MeeGo::QmSensorReading) == sizeof(quint64) ? 1 : -1];
+
+#define ASSERT_READING(T) \
+    typedef char T##IsByteCopied[IS_BYTE_COPIED_READING(T) ? 1 : -1]
+
+/* The readings of QmSensor classes fit in a slot of the consumer ring */
+#define ASSERT_SENSOR_READING(T) \
+    ASSERT_READING(T); \
+    typedef char T##FitsRingSlot[sizeof(T) <= SENSOR_RING_SLOT ? 1 : -1]
+
+namespace MeeGo {
+
+    ASSERT_SENSOR_READING(QmAccelerometerReading);
+    ASSERT_SENSOR_READING(QmCompassReading);
+    ASSERT_SENSOR_READING(QmFusedOrientationReading);
+    ASSERT_SENSOR_READING(QmGestureReading);
+    ASSERT_SENSOR_READING(QmIntReading);
+    ASSERT_SENSOR_READING(QmMagnetometerReading);
+    ASSERT_SENSOR_READING(QmOrientationReading);
+    ASSERT_SENSOR_READING(QmRotationReading);
+    ASSERT_SENSOR_READING(QmTapReading);
+    ASSERT_READING(QmSynchronizedReading);
+
+    template <typename T>
+    static void registerType(const char *name)
+    {
+        QMetaType::registerType(name, QmSensorArena<T>::destroy, QmSensorArena<T>::construct);
+    }
+
+    void registerSensorTypes()
+    {
+        // By the names in the signal signatures
+        registerType<QmAccelerometerReading>("MeeGo::QmAccelerometerReading");
+        registerType<QVector<QmAccelerometerReading> >("QVector<MeeGo::QmAccelerometerReading>");
+        registerType<QmCompassReading>("MeeGo::QmCompassReading");
+        registerType<QmFusedOrientationReading>("MeeGo::QmFusedOrientationReading");
+        registerType<QmGestureReading>("MeeGo::QmGestureReading");
+        registerType<QmIntReading>("MeeGo::QmIntReading");
+        registerType<QmIntReading>("MeeGo::QmAlsReading");
+        registerType<QmIntReading>("MeeGo::QmProximityReading");
+        registerType<QmMagnetometerReading>("MeeGo::QmMagnetometerReading");
+        registerType<QmOrientationReading>("MeeGo::QmOrientationReading");
+        registerType<QmRotationReading>("MeeGo::QmRotationReading");
+        registerType<QVector<QmRotationReading> >("QVector<MeeGo::QmRotationReading>");
+        registerType<QmSynchronizedReading>("MeeGo::QmSynchronizedReading");
+        registerType<QmTapReading>("MeeGo::QmTapReading");
+    }
+
+    /* Run when the library is loaded */
+    static const bool sensorTypesRegistered = (registerSensorTypes(), true);
+
+} // MeeGo namespace
@@ -0,0 +1,139 @@
+/*!
+ * @file qmsensorarena_p.h
+ * @brief Contains QmSensorArena
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORARENA_P_H
+#define QMSENSORARENA_P_H
+
+#include <QtCore/qatomic.h>
+#include <new>
+
+/* Copies of one type in queued signals at a time before falling back to
+   the heap, a power of two */
+#define SENSOR_ARENA_SLOTS 256
+
+namespace MeeGo
+{
+    /**
+     * Room for the copies of a reading type that Qt makes for queued
+     * signals and QVariants. The reading types are registered with
+     * #construct() and #destroy(), see qmsensorarena.cpp, so a reading
+     * emitted to another thread is copied into a slot taken here, and the
+     * slot is given back once the receiver has been called.
+     *
+     * Slots are taken on the emitting thread and given back on the
+     * receiving one, without locking. When the receiver falls behind by
+     * more than SENSOR_ARENA_SLOTS readings, the copies go to the heap.
+     */
+    template <typename T>
+    class QmSensorArena
+    {
+    public:
+        /* The QMetaType constructor: a copy of copy, or a default one */
+        static void *construct(const void *copy)
+        {
+            void *slot = take();
+            if (copy) {
+                return new (slot) T(*static_cast<const T*>(copy));
+            }
+            return new (slot) T();
+        }
+
+        /* The QMetaType destructor */
+        static void destroy(void *object)
+        {
+            static_cast<T*>(object)->~T();
+            give(object);
+        }
+
+        static bool owns(const void *object)
+        {
+            const Slot *slot = static_cast<const Slot*>(object);
+            return slot >= slots_ && slot < slots_ + SENSOR_ARENA_SLOTS;
+        }
+
+        /* Slots taken, for tests */
+        static int used()
+        {
+            int count = 0;
+            for (int i = 0; i < SENSOR_ARENA_SLOTS; i++) {
+                count += (int)used_[i];
+            }
+            return count;
+        }
+
+    private:
+        union Slot {
+            char bytes[sizeof(T)];
+            double align;
+            void *alignPointer;
+            qint64 alignLong;
+        };
+
+        static void *take()
+        {
+            // Slots are given back about in the order they were taken, so
+            // the one after the previous is usually free
+            unsigned start = (unsigned)next_.fetchAndAddRelaxed(1);
+            for (unsigned i = 0; i < SENSOR_ARENA_SLOTS; i++) {
+                unsigned slot = (start + i) % SENSOR_ARENA_SLOTS;
+                if (used_[slot].testAndSetAcquire(0, 1)) {
+                    return &slots_[slot];
+                }
+            }
+            return ::operator new(sizeof(T));
+        }
+
+        static void give(void *object)
+        {
+            if (!owns(object)) {
+                ::operator delete(object);
+                return;
+            }
+            used_[static_cast<Slot*>(object) - slots_].fetchAndStoreRelease(0);
+        }
+
+        /* Plain data, zeroed before any code runs */
+        static Slot slots_[SENSOR_ARENA_SLOTS];
+        static QBasicAtomicInt used_[SENSOR_ARENA_SLOTS];
+        static QBasicAtomicInt next_;
+    };
+
+    template <typename T>
+    typename QmSensorArena<T>::Slot QmSensorArena<T>::slots_[SENSOR_ARENA_SLOTS];
+
+    template <typename T>
+    QBasicAtomicInt QmSensorArena<T>::used_[SENSOR_ARENA_SLOTS];
+
+    template <typename T>
+    QBasicAtomicInt QmSensorArena<T>::next_;
+
+    /**
+     * Registers the reading types of the sensors, and their batches, for
+     * queued signals with the constructors of QmSensorArena. Done when the
+     * library is loaded, so it comes before any registration by the
+     * clients, which would copy to the heap.
+     */
+    void registerSensorTypes();
+}
+#endif // QMSENSORARENA_P_H
@@ -0,0 +1,147 @@
+/*!
+ * @file qmsensorfilter.cpp
+ * @brief QmSensorFilter
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmsensorfilter.h"
+#include "qmsensorkernels_p.h"
+
+#include <string.h>
+
+/* Samples per pass of the high-pass filter */
+#define HIGHPASS_CHUNK 64
+
+namespace MeeGo {
+
+    class QmSensorFilterPrivate
+    {
+    public:
+        QmSensorFilter::Type type;
+        float parameter;
+        int window;
+        bool primed;
+
+        /* Per axis */
+        float state[3];
+        float sum[3];
+        float history[3][KERNEL_AVERAGE_MAX];
+
+        void prime(int axis, float value)
+        {
+            state[axis] = value;
+            sum[axis] = value * window;
+            for (int i = 0; i < KERNEL_AVERAGE_MAX; i++) {
+                history[axis][i] = value;
+            }
+        }
+
+        void process(int axis, float *data, int count)
+        {
+            switch (type) {
+                case QmSensorFilter::LowPass:
+                    kernelLowPass(data, count, parameter, &state[axis]);
+                    break;
+                case QmSensorFilter::HighPass:
+                {
+                    float low[HIGHPASS_CHUNK];
+                    for (int done = 0; done < count; done += HIGHPASS_CHUNK) {
+                        int n = qMin(count - done, HIGHPASS_CHUNK);
+                        memcpy(low, data + done, n * sizeof(float));
+                        kernelLowPass(low, n, parameter, &state[axis]);
+                        for (int i = 0; i < n; i++) {
+                            data[done + i] -= low[i];
+                        }
+                    }
+                    break;
+                }
+                case QmSensorFilter::MovingAverage:
+                    kernelMovingAverage(data, count, window, history[axis], &sum[axis]);
+                    break;
+                case QmSensorFilter::Median:
+                    kernelMedian(data, count, window, history[axis]);
+                    break;
+            }
+        }
+    };
+
+    QmSensorFilter::QmSensorFilter(Type type, float parameter, QObject *parent)
+        : QObject(parent),
+          pimpl_(new QmSensorFilterPrivate)
+    {
+        pimpl_->type = type;
+        switch (type) {
+            case LowPass:
+            case HighPass:
+                pimpl_->parameter = qBound(0.001f, parameter, 1.0f);
+                pimpl_->window = 1;
+                break;
+            case MovingAverage:
+                pimpl_->window = qBound(1, qRound(parameter), KERNEL_AVERAGE_MAX);
+                pimpl_->parameter = pimpl_->window;
+                break;
+            case Median:
+                pimpl_->window = qBound(1, qRound(parameter), KERNEL_MEDIAN_MAX) | 1;
+                pimpl_->parameter = pimpl_->window;
+                break;
+        }
+        reset();
+    }
+
+    QmSensorFilter::~QmSensorFilter()
+    {
+    }
+
+    QmSensorFilter::Type QmSensorFilter::type() const
+    {
+        return pimpl_->type;
+    }
+
+    float QmSensorFilter::parameter() const
+    {
+        return pimpl_->parameter;
+    }
+
+    void QmSensorFilter::reset()
+    {
+        pimpl_->primed = false;
+    }
+
+    void QmSensorFilter::process(float *x, float *y, float *z, int count)
+    {
+        if (count <= 0) {
+            return;
+        }
+
+        float *axes[3] = { x, y, z };
+        for (int axis = 0; axis < 3; axis++) {
+            if (!pimpl_->primed) {
+                pimpl_->prime(axis, axes[axis][0]);
+            }
+            pimpl_->process(axis, axes[axis], count);
+        }
+        pimpl_->primed = true;
+    }
+
+    bool QmSensorFilter::isVectorized()
+    {
+        return kernelsVectorized();
+    }
+
+} // MeeGo namespace
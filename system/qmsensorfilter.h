@@ -0,0 +1,131 @@
+/*!
+ * @file qmsensorfilter.h
+ * @brief Contains QmSensorFilter, which smooths or detrends XYZ sensor readings.
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORFILTER_H
+#define QMSENSORFILTER_H
+
+#include "system_global.h"
+#include <QtCore/qobject.h>
+#include <QScopedPointer>
+
+QT_BEGIN_HEADER
+
+namespace MeeGo {
+
+    class QmSensorFilterPrivate;
+
+    /**
+     * @scope Internal
+     *
+     * @brief Smooths or detrends XYZ sensor readings.
+     *
+     * A filter is attached to QmAccelerometer, QmMagnetometer or
+     * QmRotation with QmSensor::addFilter(). The readings are then filtered
+     * before they are delivered; several filters run in the order they were
+     * added. With batched delivery, see QmAccelerometer::setBatchSize(),
+     * the whole batch is filtered at once with kernels vectorized for SSE2
+     * or NEON where available.
+     *
+     * A filter keeps the state of one stream, so attach it to one sensor
+     * only. It can also be used on its own through process().
+     *
+     * Rotation angles are filtered as plain numbers, so the jump at the
+     * wrap-around point is smoothed over as well.
+     */
+    class MEEGO_SYSTEM_EXPORT QmSensorFilter : public QObject
+    {
+        Q_OBJECT;
+
+    public:
+        /** Filter types */
+        enum Type {
+            LowPass,        /**< First order IIR low-pass, y += alpha * (x - y) */
+            HighPass,       /**< Input minus its LowPass, for example acceleration without gravity */
+            MovingAverage,  /**< Mean of the last n samples */
+            Median          /**< Median of the last n samples, removes spikes */
+        };
+
+        /**
+         * Constructor
+         * @param type Filter type
+         * @param parameter For LowPass and HighPass the smoothing factor
+         *                  alpha in (0, 1], smaller is smoother. For
+         *                  MovingAverage the window [1, 64], for Median the
+         *                  odd window [1, 15], in samples. Values out of
+         *                  range are clamped.
+         * @param parent Parent QObject.
+         */
+        QmSensorFilter(Type type, float parameter, QObject *parent = 0);
+
+        /**
+         * Destructor
+         */
+        ~QmSensorFilter();
+
+        /**
+         * Returns the filter type.
+         * @return Filter type
+         */
+        Type type() const;
+
+        /**
+         * Returns the filter parameter after clamping.
+         * @return Smoothing factor or window
+         */
+        float parameter() const;
+
+        /**
+         * Forgets the past samples. The next sample fills the state, as if
+         * the stream had held that value forever.
+         */
+        void reset();
+
+        /**
+         * Filters a batch of samples in place. The samples are given as
+         * structure of arrays.
+         *
+         * @param x Values of the x axis
+         * @param y Values of the y axis
+         * @param z Values of the z axis
+         * @param count Number of samples
+         */
+        void process(float *x, float *y, float *z, int count);
+
+        /**
+         * Tells whether the filters run on vectorized kernels.
+         * @return \c true with SSE2 or NEON, \c false with the scalar kernels
+         */
+        static bool isVectorized();
+
+    private:
+        Q_DISABLE_COPY(QmSensorFilter)
+        QScopedPointer<QmSensorFilterPrivate> pimpl_;
+    };
+
+} // MeeGo namespace
+
+QT_END_HEADER
+
+#endif
@@ -0,0 +1,321 @@
+/*!
+ * @file qmsensorgovernor.cpp
+ * @brief QmSensorGovernor
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmsensorgovernor.h"
+#include "qmsensorgovernor_p.h"
+#include "qmsensor_p.h"
+#include "qmsensortrace_p.h"
+
+namespace MeeGo {
+
+    /* Readings of each governed sensor differ by this much on motion, indexed by QmTraceSensor */
+    static const int governor_thresholds[TraceCompass + 1] = {
+        GOVERNOR_THRESHOLD_ACCELERATION,
+        GOVERNOR_THRESHOLD_ANGLE,
+        GOVERNOR_THRESHOLD_FIELD,
+        GOVERNOR_THRESHOLD_ANGLE
+    };
+
+    // ----------------- BEGIN PRIVATE CLASS DEFINITION ----------------- //
+
+    QmSensorGovernorChannel::QmSensorGovernorChannel(int sensor, QmSensorGovernorPrivate *governor,
+                                                     QmSensorPrivate *sensorPriv)
+        : QmSensorTapChannel(QmSensorPrivate::TapGovernor, sensor, sensorPriv), governor_(governor),
+          running_(false), paused_(false), applied_(0), saved_(0)
+    {
+        motion.threshold = governor_thresholds[sensor];
+        motion.angles = sensor == TraceRotation || sensor == TraceCompass;
+    }
+
+    bool QmSensorGovernorChannel::setup(QObject *source, bool setOn)
+    {
+        if (!setOn) {
+            running_ = false;
+            paused_ = false;
+            return QmSensorTapChannel::setup(source, false);
+        }
+
+        running_ = true;
+        applied_ = 0;
+        motion.reset();
+        if (!QmSensorTapChannel::setup(source, true)) {
+            return false;
+        }
+        apply();
+        return true;
+    }
+
+    void QmSensorGovernorChannel::apply()
+    {
+        if (!running_) {
+            return;
+        }
+
+        // Clients that asked to run in standby are left to motion alone
+        bool standby = !sensorPriv_->standbyOverride();
+        bool pause = standby && governor_->displayOff();
+        if (pause != paused_) {
+            paused_ = pause;
+            if (pause) {
+                sensorPriv_->stop();
+            } else {
+                // Whatever moved meanwhile went unseen
+                motion.reset();
+                applied_ = 0;
+                sensorPriv_->start();
+            }
+        }
+
+        int interval = standby && governor_->throttled() ? motion.slowest : motion.interval();
+        if (interval != applied_) {
+            applied_ = interval;
+            sensorPriv_->setInterval(interval);
+        }
+    }
+
+    void QmSensorGovernorChannel::release()
+    {
+        if (paused_) {
+            paused_ = false;
+            sensorPriv_->start();
+        }
+        // 0 hands the sensor back to the interval of the session
+        if (applied_) {
+            sensorPriv_->setInterval(saved_);
+        }
+    }
+
+    void QmSensorGovernorChannel::configure()
+    {
+        // The governor waits in invoke() meanwhile
+        motion.fastest = governor_->fastest;
+        motion.slowest = governor_->slowest;
+        motion.settleTime = governor_->settleTime * 1000ULL;
+        motion.reset();
+        apply();
+    }
+
+    void QmSensorGovernorChannel::setThreshold(int value)
+    {
+        motion.threshold = value;
+    }
+
+    bool QmSensorGovernorChannel::attach()
+    {
+        saved_ = sensorPriv_->requestedInterval();
+        return QmSensorTapChannel::attach();
+    }
+
+    void QmSensorGovernorChannel::detach()
+    {
+        release();
+        QmSensorTapChannel::detach();
+        // Applies the governor queued meanwhile find the channel stopped
+        running_ = false;
+    }
+
+    void QmSensorGovernorChannel::add(quint64 timestamp, int a, int b, int c)
+    {
+        int values[GOVERNOR_CHANNELS] = { a, b, c };
+        if (motion.add(timestamp, values, sensor_ == TraceCompass ? 1 : GOVERNOR_CHANNELS)) {
+            apply();
+        }
+    }
+
+    void QmSensorGovernorChannel::slotXyz(const XYZ& data)
+    {
+        add(data.XYZData().timestamp_, data.x(), data.y(), data.z());
+    }
+
+    void QmSensorGovernorChannel::slotMagneticField(const MagneticField& data)
+    {
+        add(data.data().timestamp_, data.data().x_, data.data().y_, data.data().z_);
+    }
+
+    void QmSensorGovernorChannel::slotCompass(const Compass& data)
+    {
+        add(data.data().timestamp_, data.data().degrees_, 0, 0);
+    }
+
+    QmSensorGovernorPrivate::QmSensorGovernorPrivate()
+        : fastest(GOVERNOR_FASTEST), slowest(GOVERNOR_SLOWEST), settleTime(GOVERNOR_SETTLE_TIME)
+    {
+        display_ = displayState_.get();
+        user_ = activity_.get();
+        connect(&displayState_, SIGNAL(displayStateChanged(MeeGo::QmDisplayState::DisplayState)),
+                this, SLOT(slotDisplayStateChanged(MeeGo::QmDisplayState::DisplayState)));
+        connect(&activity_, SIGNAL(activityChanged(MeeGo::QmActivity::Activity)),
+                this, SLOT(slotActivityChanged(MeeGo::QmActivity::Activity)));
+    }
+
+    bool QmSensorGovernorPrivate::displayOff() const
+    {
+        return display_ == QmDisplayState::Off;
+    }
+
+    bool QmSensorGovernorPrivate::throttled() const
+    {
+        return display_ == QmDisplayState::Dimmed || user_ == QmActivity::Inactive;
+    }
+
+    QmSensorGovernorChannel *QmSensorGovernorPrivate::channel(QObject *governor) const
+    {
+        QmSensorGovernorChannel *channel = qobject_cast<QmSensorGovernorChannel*>(governor);
+        return channel && channels.contains(channel) ? channel : NULL;
+    }
+
+    void QmSensorGovernorPrivate::configureAll()
+    {
+        foreach (QPointer<QmSensorGovernorChannel> channel, channels) {
+            if (channel) {
+                channel->invoke("configure");
+            }
+        }
+    }
+
+    void QmSensorGovernorPrivate::slotDisplayStateChanged(MeeGo::QmDisplayState::DisplayState state)
+    {
+        display_ = state;
+        foreach (QPointer<QmSensorGovernorChannel> channel, channels) {
+            if (channel) {
+                QMetaObject::invokeMethod(channel, "apply");
+            }
+        }
+    }
+
+    void QmSensorGovernorPrivate::slotActivityChanged(MeeGo::QmActivity::Activity activity)
+    {
+        user_ = activity;
+        foreach (QPointer<QmSensorGovernorChannel> channel, channels) {
+            if (channel) {
+                QMetaObject::invokeMethod(channel, "apply");
+            }
+        }
+    }
+
+    // ----------------- BEGIN PUBLIC CLASS DEFINITION ----------------- //
+
+    QmSensorGovernor::QmSensorGovernor(QObject *parent) : QObject(parent)
+    {
+        MEEGO_INITIALIZE(QmSensorGovernor);
+    }
+
+    QmSensorGovernor::~QmSensorGovernor()
+    {
+        MEEGO_PRIVATE(QmSensorGovernor);
+        // The channels belong to the sensors, but point to the governor
+        foreach (QPointer<QmSensorGovernorChannel> channel, priv->channels) {
+            if (channel) {
+                channel->invoke("detach");
+            }
+        }
+        MEEGO_UNINITIALIZE(QmSensorGovernor);
+    }
+
+    bool QmSensorGovernor::attach(QmSensor *sensor)
+    {
+        MEEGO_PRIVATE(QmSensorGovernor);
+        QmSensorPrivate *sensorPriv = sensor->priv_func();
+        int id = traceSensor(sensorPriv->sensorId());
+        if (id < 0 || id > TraceCompass) {
+            return false;
+        }
+
+        detach(sensor);
+        QmSensorGovernorChannel *channel = new QmSensorGovernorChannel(id, priv, sensorPriv);
+        channel->invoke("configure");
+        bool attached = false;
+        channel->invoke("attach", Q_RETURN_ARG(bool, attached));
+        if (!attached) {
+            // Governed by another governor
+            channel->deleteLater();
+            return false;
+        }
+        priv->channels.append(channel);
+        return true;
+    }
+
+    void QmSensorGovernor::detach(QmSensor *sensor)
+    {
+        MEEGO_PRIVATE(QmSensorGovernor);
+        QmSensorGovernorChannel *channel = priv->channel(sensor->priv_func()->taps_[QmSensorPrivate::TapGovernor]);
+        if (channel) {
+            priv->channels.removeAll(channel);
+            channel->invoke("detach");
+        }
+    }
+
+    void QmSensorGovernor::setRange(int fastest, int slowest)
+    {
+        MEEGO_PRIVATE(QmSensorGovernor);
+        priv->fastest = qMax(fastest, 1);
+        priv->slowest = qMax(slowest, priv->fastest);
+        priv->configureAll();
+    }
+
+    int QmSensorGovernor::fastest() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorGovernor);
+        return priv->fastest;
+    }
+
+    int QmSensorGovernor::slowest() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorGovernor);
+        return priv->slowest;
+    }
+
+    bool QmSensorGovernor::setMotionThreshold(QmSensor *sensor, int value)
+    {
+        MEEGO_PRIVATE(QmSensorGovernor);
+        QmSensorGovernorChannel *channel = priv->channel(sensor->priv_func()->taps_[QmSensorPrivate::TapGovernor]);
+        if (!channel) {
+            return false;
+        }
+        channel->invoke("setThreshold", Q_ARG(int, qMax(value, 0)));
+        return true;
+    }
+
+    int QmSensorGovernor::motionThreshold(QmSensor *sensor) const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorGovernor);
+        QmSensorGovernorChannel *channel = priv->channel(sensor->priv_func()->taps_[QmSensorPrivate::TapGovernor]);
+        return channel ? channel->motion.threshold : -1;
+    }
+
+    void QmSensorGovernor::setSettleTime(int ms)
+    {
+        MEEGO_PRIVATE(QmSensorGovernor);
+        priv->settleTime = qMax(ms, 0);
+        priv->configureAll();
+    }
+
+    int QmSensorGovernor::settleTime() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorGovernor);
+        return priv->settleTime;
+    }
+
+}
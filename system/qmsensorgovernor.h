@@ -0,0 +1,166 @@
+/*!
+ * @file qmsensorgovernor.h
+ * @brief Contains QmSensorGovernor, which adapts the interval of sensors to motion and display state.
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORGOVERNOR_H
+#define QMSENSORGOVERNOR_H
+
+#include "system_global.h"
+#include <QtCore/qobject.h>
+#include <qmsensor.h>
+
+QT_BEGIN_HEADER
+
+namespace MeeGo {
+
+    class QmSensorGovernorPrivate;
+
+    /**
+     * @scope Internal
+     *
+     * @brief Adapts the interval of sensors to motion and display state.
+     *
+     * The governor sets the interval of the attached sensors for clients
+     * that don't tune it themselves. A sensor runs at the fastest interval
+     * while its readings change, and its interval is doubled each time the
+     * readings have stayed within the motion threshold for the settle time,
+     * up to the slowest interval. Motion is noticed at the interval the
+     * sensor runs at, so the slowest interval bounds the reaction time.
+     *
+     * The display and user activity are followed as well:
+     * - While the display is off, the attached sensors are paused: their
+     *   share of the sensord session is stopped, and started again when
+     *   the display comes back. They stay running for the client.
+     * - While the display is dimmed or the user is inactive, they run at
+     *   the slowest interval.
+     *
+     * Sensors with standby override set, see
+     * QmSensor::setStandbyOverride(), are neither paused nor slowed down
+     * by the display and activity; only motion changes their interval.
+     *
+     * Applies to the sensors with a continuous sample stream:
+     * QmAccelerometer, QmCompass, QmMagnetometer and QmRotation. While a
+     * sensor is attached, the governor owns its interval.
+     *
+     * @code
+     * QmSensorGovernor governor;
+     * governor.setRange(20, 500);
+     * QmAccelerometer accelerometer;
+     * accelerometer.requestSession(QmSensor::SessionTypeListen);
+     * governor.attach(&accelerometer);
+     * accelerometer.start();
+     * @endcode
+     */
+    class MEEGO_SYSTEM_EXPORT QmSensorGovernor : public QObject
+    {
+        Q_OBJECT;
+
+    public:
+        /**
+         * Constructor
+         * @param parent Parent QObject.
+         */
+        QmSensorGovernor(QObject *parent = 0);
+
+        /**
+         * Destructor. Detaches the sensors.
+         */
+        ~QmSensorGovernor();
+
+        /**
+         * Starts governing the interval of a sensor.
+         * @param sensor The sensor
+         * @return \c false if the sensor type has no continuous stream, or
+         *         the sensor is attached to another governor
+         */
+        bool attach(QmSensor *sensor);
+
+        /**
+         * Stops governing a sensor. A paused sensor is resumed, and the
+         * interval it had when it was attached is set back.
+         * @param sensor The sensor
+         */
+        void detach(QmSensor *sensor);
+
+        /**
+         * Sets the range of intervals.
+         * @param fastest Interval while in motion in ms, default is 20
+         * @param slowest Interval at rest in ms, default is 500
+         */
+        void setRange(int fastest, int slowest);
+
+        /**
+         * Returns the interval while in motion, see #setRange().
+         * @return Interval in ms
+         */
+        int fastest() const;
+
+        /**
+         * Returns the interval at rest, see #setRange().
+         * @return Interval in ms
+         */
+        int slowest() const;
+
+        /**
+         * Sets how much a reading of an attached sensor may differ from
+         * the previous one, in any channel, without being taken as motion.
+         * Kept until the sensor is detached.
+         * @param sensor The sensor
+         * @param value Threshold in the unit of its readings. Defaults are
+         *              50 mG for QmAccelerometer, 2000 nT for QmMagnetometer
+         *              and 3 degrees for QmRotation and QmCompass.
+         * @return \c false if the sensor is not attached to this governor
+         */
+        bool setMotionThreshold(QmSensor *sensor, int value);
+
+        /**
+         * Returns the motion threshold of a sensor, see #setMotionThreshold().
+         * @param sensor The sensor
+         * @return Threshold, -1 if the sensor is not attached to this governor
+         */
+        int motionThreshold(QmSensor *sensor) const;
+
+        /**
+         * Sets how long the readings must stay still before the interval
+         * is doubled.
+         * @param ms Settle time in ms, default is 2000
+         */
+        void setSettleTime(int ms);
+
+        /**
+         * Returns the settle time, see #setSettleTime().
+         * @return Settle time in ms
+         */
+        int settleTime() const;
+
+    private:
+        Q_DISABLE_COPY(QmSensorGovernor)
+        MEEGO_DECLARE_PRIVATE(QmSensorGovernor)
+    };
+
+} // MeeGo namespace
+
+QT_END_HEADER
+
+#endif
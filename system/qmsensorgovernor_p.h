@@ -0,0 +1,206 @@
+/*!
+ * @file qmsensorgovernor_p.h
+ * @brief Contains QmSensorGovernorPrivate
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORGOVERNOR_P_H
+#define QMSENSORGOVERNOR_P_H
+
+#include <QList>
+#include <QPointer>
+
+#include "qmactivity.h"
+#include "qmdisplaystate.h"
+#include "qmsensor_p.h"
+#include "qmsensorgovernor.h"
+#include "sensord/accelerometersensor_i.h"
+#include "sensord/compasssensor_i.h"
+#include "sensord/magnetometersensor_i.h"
+
+#define GOVERNOR_FASTEST 20 /* ms */
+#define GOVERNOR_SLOWEST 500 /* ms */
+/* Default motion thresholds, in the units of the readings */
+#define GOVERNOR_THRESHOLD_ACCELERATION 50 /* mG */
+#define GOVERNOR_THRESHOLD_FIELD 2000 /* nT, about 2 degrees of turn */
+#define GOVERNOR_THRESHOLD_ANGLE 3 /* degrees, QmRotation and QmCompass */
+#define GOVERNOR_SETTLE_TIME 2000 /* ms */
+/* Channels of a reading compared for motion, at most */
+#define GOVERNOR_CHANNELS 3
+
+namespace MeeGo
+{
+    class QmSensorGovernorPrivate;
+
+    /**
+     * Picks the interval for a stream of readings: the fastest one on
+     * motion, doubled after each settle time without motion, up to the
+     * slowest one.
+     */
+    class QmIntervalGovernor
+    {
+    public:
+        QmIntervalGovernor()
+            : fastest(GOVERNOR_FASTEST), slowest(GOVERNOR_SLOWEST), threshold(GOVERNOR_THRESHOLD_ACCELERATION),
+              settleTime(GOVERNOR_SETTLE_TIME * 1000ULL), angles(false)
+        {
+            reset();
+        }
+
+        int fastest;            /* ms */
+        int slowest;            /* ms */
+        int threshold;
+        quint64 settleTime;     /* us */
+        bool angles;            /* channels wrap around at 360 */
+
+        void reset()
+        {
+            hasLast_ = false;
+            interval_ = fastest;
+        }
+
+        int interval() const
+        {
+            return interval_;
+        }
+
+        /**
+         * Adds a reading.
+         *
+         * @return \c true if the interval changed
+         */
+        bool add(quint64 timestamp, const int *values, int count)
+        {
+            bool moved = !hasLast_;
+            for (int i = 0; i < count; i++) {
+                int delta = qAbs(values[i] - last_[i]);
+                if (angles) {
+                    delta = qMin(delta % 360, 360 - delta % 360);
+                }
+                if (hasLast_ && delta > threshold) {
+                    moved = true;
+                }
+                last_[i] = values[i];
+            }
+            hasLast_ = true;
+
+            int interval = interval_;
+            if (moved) {
+                interval = fastest;
+                settled_ = timestamp;
+            } else if (timestamp - settled_ >= settleTime) {
+                interval = qMin(interval * 2, slowest);
+                settled_ = timestamp;
+            }
+            if (interval == interval_) {
+                return false;
+            }
+            interval_ = interval;
+            return true;
+        }
+
+    private:
+        bool hasLast_;
+        int last_[GOVERNOR_CHANNELS];
+        quint64 settled_;
+        int interval_;
+    };
+
+    /**
+     * Governs the interval of one sensor by the motion in its sensord
+     * readings.
+     */
+    class QmSensorGovernorChannel : public QmSensorTapChannel
+    {
+        Q_OBJECT;
+
+    public:
+        QmSensorGovernorChannel(int sensor, QmSensorGovernorPrivate *governor, QmSensorPrivate *sensorPriv);
+
+        bool setup(QObject *source, bool setOn);
+
+        QmIntervalGovernor motion;
+
+    public Q_SLOTS:
+        /* Pauses, resumes and sets the interval as the governor says. Runs
+           on the thread of the sensor, see QmSensor::setDeliveryThread() */
+        void apply();
+
+        /* Takes the settings of the governor and applies them */
+        void configure();
+        void setThreshold(int value);
+
+        bool attach();
+        /* Resumes and sets back the interval the sensor had, and detaches */
+        void detach();
+
+        void slotXyz(const XYZ& data);
+        void slotMagneticField(const MagneticField& data);
+        void slotCompass(const Compass& data);
+
+    private:
+        void add(quint64 timestamp, int a, int b, int c);
+        void release();
+
+        QmSensorGovernorPrivate *governor_;
+        bool running_;
+        bool paused_;
+        int applied_;       /* interval last set, 0 for none */
+        int saved_;         /* interval the sensor asked for before it was
+                               attached, 0 for none */
+    };
+
+    class QmSensorGovernorPrivate : public QObject
+    {
+        Q_OBJECT;
+        MEEGO_DECLARE_PUBLIC(QmSensorGovernor)
+
+    public:
+        QmSensorGovernorPrivate();
+
+        int fastest;
+        int slowest;
+        int settleTime;
+
+        /* The channel among the ones here, NULL if not one of them */
+        QmSensorGovernorChannel *channel(QObject *governor) const;
+
+        bool displayOff() const;
+        bool throttled() const;
+
+        /* Has each channel take the settings */
+        void configureAll();
+
+        /* Channels of the governed sensors */
+        QList<QPointer<QmSensorGovernorChannel> > channels;
+
+    public Q_SLOTS:
+        void slotDisplayStateChanged(MeeGo::QmDisplayState::DisplayState state);
+        void slotActivityChanged(MeeGo::QmActivity::Activity activity);
+
+    private:
+        QmDisplayState displayState_;
+        QmActivity activity_;
+        QmDisplayState::DisplayState display_;
+        QmActivity::Activity user_;
+    };
+}
+#endif // QMSENSORGOVERNOR_P_H
@@ -0,0 +1,535 @@
+/*!
+ * @file qmsensorkernels.cpp
+ * @brief Sensor filter and conversion kernels
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmsensorkernels_p.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Samples per pass of the windowed kernels */
+#define KERNEL_CHUNK 64
+
+#if defined(__SSE2__)
+
+#include <emmintrin.h>
+#define KERNELS_VECTORIZED
+
+typedef __m128 v4;
+
+static inline v4 v_load(const float *p) { return _mm_loadu_ps(p); }
+static inline void v_store(float *p, v4 v) { _mm_storeu_ps(p, v); }
+static inline v4 v_set1(float f) { return _mm_set1_ps(f); }
+static inline v4 v_add(v4 a, v4 b) { return _mm_add_ps(a, b); }
+static inline v4 v_sub(v4 a, v4 b) { return _mm_sub_ps(a, b); }
+static inline v4 v_mul(v4 a, v4 b) { return _mm_mul_ps(a, b); }
+static inline v4 v_min(v4 a, v4 b) { return _mm_min_ps(a, b); }
+static inline v4 v_max(v4 a, v4 b) { return _mm_max_ps(a, b); }
+/* The lanes of yes where a < b, of no elsewhere */
+static inline v4 v_lt_select(v4 a, v4 b, v4 yes, v4 no)
+{
+    v4 mask = _mm_cmplt_ps(a, b);
+    return _mm_or_ps(_mm_and_ps(mask, yes), _mm_andnot_ps(mask, no));
+}
+/* Moves the lanes up by one or two, shifting in zeros */
+static inline v4 v_shift1(v4 v) { return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)); }
+static inline v4 v_shift2(v4 v) { return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)); }
+/* Broadcasts the last lane */
+static inline v4 v_splat3(v4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+static inline float v_lane3(v4 v) { return _mm_cvtss_f32(v_splat3(v)); }
+
+typedef __m128i i4;
+
+static inline i4 i_load(const int *p) { return _mm_loadu_si128((const __m128i *)p); }
+static inline void i_store(int *p, i4 v) { _mm_storeu_si128((__m128i *)p, v); }
+static inline i4 i_set1(int n) { return _mm_set1_epi32(n); }
+static inline i4 i_add(i4 a, i4 b) { return _mm_add_epi32(a, b); }
+static inline i4 i_sub(i4 a, i4 b) { return _mm_sub_epi32(a, b); }
+static inline i4 i_and(i4 a, i4 b) { return _mm_and_si128(a, b); }
+static inline i4 i_or(i4 a, i4 b) { return _mm_or_si128(a, b); }
+/* All ones in the lanes where a > b */
+static inline i4 i_gt(i4 a, i4 b) { return _mm_cmpgt_epi32(a, b); }
+/* The lanes of a where the mask is set, of b elsewhere */
+static inline i4 i_select(i4 mask, i4 a, i4 b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+static inline i4 i_abs(i4 v) { i4 sign = _mm_srai_epi32(v, 31); return _mm_sub_epi32(_mm_xor_si128(v, sign), sign); }
+static inline bool i_any(i4 mask) { return _mm_movemask_epi8(mask) != 0; }
+static inline v4 i_tofloat(i4 v) { return _mm_cvtepi32_ps(v); }
+/* Rounds towards zero */
+static inline i4 v_toint(v4 v) { return _mm_cvttps_epi32(v); }
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+#include <arm_neon.h>
+#define KERNELS_VECTORIZED
+
+typedef float32x4_t v4;
+
+static inline v4 v_load(const float *p) { return vld1q_f32(p); }
+static inline void v_store(float *p, v4 v) { vst1q_f32(p, v); }
+static inline v4 v_set1(float f) { return vdupq_n_f32(f); }
+static inline v4 v_add(v4 a, v4 b) { return vaddq_f32(a, b); }
+static inline v4 v_sub(v4 a, v4 b) { return vsubq_f32(a, b); }
+static inline v4 v_mul(v4 a, v4 b) { return vmulq_f32(a, b); }
+static inline v4 v_min(v4 a, v4 b) { return vminq_f32(a, b); }
+static inline v4 v_max(v4 a, v4 b) { return vmaxq_f32(a, b); }
+static inline v4 v_lt_select(v4 a, v4 b, v4 yes, v4 no) { return vbslq_f32(vcltq_f32(a, b), yes, no); }
+static inline v4 v_shift1(v4 v) { return vextq_f32(vdupq_n_f32(0), v, 3); }
+static inline v4 v_shift2(v4 v) { return vextq_f32(vdupq_n_f32(0), v, 2); }
+static inline v4 v_splat3(v4 v) { return vdupq_lane_f32(vget_high_f32(v), 1); }
+static inline float v_lane3(v4 v) { return vgetq_lane_f32(v, 3); }
+
+typedef int32x4_t i4;
+
+static inline i4 i_load(const int *p) { return vld1q_s32(p); }
+static inline void i_store(int *p, i4 v) { vst1q_s32(p, v); }
+static inline i4 i_set1(int n) { return vdupq_n_s32(n); }
+static inline i4 i_add(i4 a, i4 b) { return vaddq_s32(a, b); }
+static inline i4 i_sub(i4 a, i4 b) { return vsubq_s32(a, b); }
+static inline i4 i_and(i4 a, i4 b) { return vandq_s32(a, b); }
+static inline i4 i_or(i4 a, i4 b) { return vorrq_s32(a, b); }
+static inline i4 i_gt(i4 a, i4 b) { return vreinterpretq_s32_u32(vcgtq_s32(a, b)); }
+static inline i4 i_select(i4 mask, i4 a, i4 b) { return vbslq_s32(vreinterpretq_u32_s32(mask), a, b); }
+static inline i4 i_abs(i4 v) { return vabsq_s32(v); }
+static inline bool i_any(i4 mask)
+{
+    uint32x2_t halves = vorr_u32(vget_low_u32(vreinterpretq_u32_s32(mask)),
+                                 vget_high_u32(vreinterpretq_u32_s32(mask)));
+    return (vget_lane_u32(halves, 0) | vget_lane_u32(halves, 1)) != 0;
+}
+static inline v4 i_tofloat(i4 v) { return vcvtq_f32_s32(v); }
+static inline i4 v_toint(v4 v) { return vcvtq_s32_f32(v); }
+
+#endif
+
+namespace MeeGo {
+
+    bool kernelsVectorized()
+    {
+#ifdef KERNELS_VECTORIZED
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /*------------ scalar ------------*/
+
+    void kernelLowPassScalar(float *data, int count, float alpha, float *state)
+    {
+        float y = *state;
+        for (int i = 0; i < count; i++) {
+            y += alpha * (data[i] - y);
+            data[i] = y;
+        }
+        *state = y;
+    }
+
+    static float sumOf(const float *data, int count)
+    {
+        float sum = 0;
+        for (int i = 0; i < count; i++) {
+            sum += data[i];
+        }
+        return sum;
+    }
+
+    void kernelMovingAverageScalar(float *data, int count, int window, float *history, float *sum)
+    {
+        float scratch[KERNEL_AVERAGE_MAX + KERNEL_CHUNK];
+        const float scale = 1.0f / window;
+
+        for (int done = 0; done < count; ) {
+            int n = count - done < KERNEL_CHUNK ? count - done : KERNEL_CHUNK;
+            memcpy(scratch, history, window * sizeof(float));
+            memcpy(scratch + window, data + done, n * sizeof(float));
+
+            float s = *sum;
+            for (int i = 0; i < n; i++) {
+                s += scratch[window + i] - scratch[i];
+                data[done + i] = s * scale;
+            }
+
+            memcpy(history, scratch + n, window * sizeof(float));
+            // Recomputed so that rounding errors don't pile up over time
+            *sum = sumOf(history, window);
+            done += n;
+        }
+    }
+
+    void kernelMedianScalar(float *data, int count, int window, float *history)
+    {
+        float scratch[KERNEL_MEDIAN_MAX + KERNEL_CHUNK];
+        float sorted[KERNEL_MEDIAN_MAX];
+        const int past = window - 1;
+
+        for (int done = 0; done < count; ) {
+            int n = count - done < KERNEL_CHUNK ? count - done : KERNEL_CHUNK;
+            memcpy(scratch, history, past * sizeof(float));
+            memcpy(scratch + past, data + done, n * sizeof(float));
+
+            for (int i = 0; i < n; i++) {
+                for (int j = 0; j < window; j++) {
+                    float value = scratch[i + j];
+                    int k = j;
+                    for (; k > 0 && sorted[k - 1] > value; k--) {
+                        sorted[k] = sorted[k - 1];
+                    }
+                    sorted[k] = value;
+                }
+                data[done + i] = sorted[window / 2];
+            }
+
+            memcpy(history, scratch + n, past * sizeof(float));
+            done += n;
+        }
+    }
+
+    void kernelAccelerometerAxesScalar(int *x, int *y, int count)
+    {
+        for (int i = 0; i < count; i++) {
+            int xi = x[i];
+            x[i] = -y[i];
+            y[i] = xi;
+        }
+    }
+
+    void kernelRotationAxesScalar(int *x, int *y, int *z, int count)
+    {
+        // Selections between two computed values, which compile to
+        // conditional moves; the modulo by a constant is a multiplication
+        for (int i = 0; i < count; i++) {
+            int xi = x[i];
+            int yi = y[i];
+            bool mirror = abs(yi) > 90;
+            int mirroredX = yi < 0 ? yi + 180 : yi - 180;
+            int mirroredY = xi > 0 ? 180 - xi : -180 - xi;
+            x[i] = mirror ? mirroredX : -yi;
+            y[i] = mirror ? mirroredY : xi;
+            z[i] = ((z[i] + 270) % 360) - 180;
+        }
+    }
+
+    void kernelCompassAzimuthScalar(int *degrees, int count)
+    {
+        for (int i = 0; i < count; i++) {
+            degrees[i] = (degrees[i] + 90) % 360;
+        }
+    }
+
+    static inline int roundAway(float value)
+    {
+        return (int)(value + (value < 0 ? -0.5f : 0.5f));
+    }
+
+    void kernelMagneticCorrectionScalar(int *x, int *y, int *z, int count, const float *offset, const float *matrix)
+    {
+        for (int i = 0; i < count; i++) {
+            float dx = x[i] - offset[0];
+            float dy = y[i] - offset[1];
+            float dz = z[i] - offset[2];
+            x[i] = roundAway(matrix[0] * dx + matrix[1] * dy + matrix[2] * dz);
+            y[i] = roundAway(matrix[3] * dx + matrix[4] * dy + matrix[5] * dz);
+            z[i] = roundAway(matrix[6] * dx + matrix[7] * dy + matrix[8] * dz);
+        }
+    }
+
+#ifdef KERNELS_VECTORIZED
+
+    /*------------ vectorized ------------*/
+
+    void kernelLowPass(float *data, int count, float alpha, float *state)
+    {
+        if (count < 8) {
+            kernelLowPassScalar(data, count, alpha, state);
+            return;
+        }
+
+        // Four steps of the recurrence at once:
+        //   y[i] = beta^(i+1) y[-1] + sum over j <= i of alpha beta^(i-j) x[j]
+        const float beta = 1 - alpha;
+        float decay[4];
+        float gain[4][4];
+        float power = 1;
+        for (int i = 0; i < 4; i++) {
+            power *= beta;
+            decay[i] = power;
+        }
+        for (int j = 0; j < 4; j++) {
+            float weight = alpha;
+            for (int i = 0; i < 4; i++) {
+                gain[j][i] = i < j ? 0 : weight;
+                if (i >= j) {
+                    weight *= beta;
+                }
+            }
+        }
+        const v4 vdecay = v_load(decay);
+        const v4 g0 = v_load(gain[0]);
+        const v4 g1 = v_load(gain[1]);
+        const v4 g2 = v_load(gain[2]);
+        const v4 g3 = v_load(gain[3]);
+
+        v4 y = v_set1(*state);
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            v4 out = v_mul(vdecay, y);
+            out = v_add(out, v_mul(g0, v_set1(data[i])));
+            out = v_add(out, v_mul(g1, v_set1(data[i + 1])));
+            out = v_add(out, v_mul(g2, v_set1(data[i + 2])));
+            out = v_add(out, v_mul(g3, v_set1(data[i + 3])));
+            v_store(data + i, out);
+            y = v_splat3(out);
+        }
+
+        float last = v_lane3(y);
+        kernelLowPassScalar(data + i, count - i, alpha, &last);
+        *state = last;
+    }
+
+    void kernelMovingAverage(float *data, int count, int window, float *history, float *sum)
+    {
+        float scratch[KERNEL_AVERAGE_MAX + KERNEL_CHUNK];
+        const float scale = 1.0f / window;
+        const v4 vscale = v_set1(scale);
+
+        for (int done = 0; done < count; ) {
+            int n = count - done < KERNEL_CHUNK ? count - done : KERNEL_CHUNK;
+            memcpy(scratch, history, window * sizeof(float));
+            memcpy(scratch + window, data + done, n * sizeof(float));
+
+            // The running sum moves by the entering minus the leaving
+            // sample; four of those moves are summed with a prefix scan.
+            v4 s = v_set1(*sum);
+            int i = 0;
+            for (; i + 4 <= n; i += 4) {
+                v4 delta = v_sub(v_load(scratch + window + i), v_load(scratch + i));
+                delta = v_add(delta, v_shift1(delta));
+                delta = v_add(delta, v_shift2(delta));
+                v4 sums = v_add(s, delta);
+                v_store(data + done + i, v_mul(sums, vscale));
+                s = v_splat3(sums);
+            }
+
+            float tail = v_lane3(s);
+            for (; i < n; i++) {
+                tail += scratch[window + i] - scratch[i];
+                data[done + i] = tail * scale;
+            }
+
+            memcpy(history, scratch + n, window * sizeof(float));
+            *sum = sumOf(history, window);
+            done += n;
+        }
+    }
+
+    void kernelMedian(float *data, int count, int window, float *history)
+    {
+        float scratch[KERNEL_MEDIAN_MAX + KERNEL_CHUNK];
+        const int past = window - 1;
+
+        for (int done = 0; done < count; ) {
+            int n = count - done < KERNEL_CHUNK ? count - done : KERNEL_CHUNK;
+            memcpy(scratch, history, past * sizeof(float));
+            memcpy(scratch + past, data + done, n * sizeof(float));
+
+            // Four windows side by side, sorted with an odd-even
+            // transposition network of min/max operations
+            int i = 0;
+            for (; i + 4 <= n; i += 4) {
+                v4 v[KERNEL_MEDIAN_MAX];
+                for (int j = 0; j < window; j++) {
+                    v[j] = v_load(scratch + i + j);
+                }
+                for (int pass = 0; pass < window; pass++) {
+                    for (int j = pass & 1; j + 1 < window; j += 2) {
+                        v4 low = v_min(v[j], v[j + 1]);
+                        v[j + 1] = v_max(v[j], v[j + 1]);
+                        v[j] = low;
+                    }
+                }
+                v_store(data + done + i, v[window / 2]);
+            }
+
+            if (i < n) {
+                // The scalar kernel picks up with the window before sample i
+                float tail[KERNEL_MEDIAN_MAX];
+                memcpy(tail, scratch + i, past * sizeof(float));
+                kernelMedianScalar(data + done + i, n - i, window, tail);
+            }
+
+            memcpy(history, scratch + n, past * sizeof(float));
+            done += n;
+        }
+    }
+
+    void kernelAccelerometerAxes(int *x, int *y, int count)
+    {
+        const i4 zero = i_set1(0);
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            i4 xi = i_load(x + i);
+            i_store(x + i, i_sub(zero, i_load(y + i)));
+            i_store(y + i, xi);
+        }
+        kernelAccelerometerAxesScalar(x + i, y + i, count - i);
+    }
+
+    /*
+     * Angles plus the offset between -360 and 720 wrap with one compare,
+     * like the modulo does there. Groups with angles outside of that are
+     * left to the scalar kernel.
+     */
+    static inline i4 wrapAngles(i4 angles, i4 *outside)
+    {
+        *outside = i_or(i_gt(i_set1(-359), angles), i_gt(angles, i_set1(719)));
+        return i_sub(angles, i_and(i_gt(angles, i_set1(359)), i_set1(360)));
+    }
+
+    void kernelRotationAxes(int *x, int *y, int *z, int count)
+    {
+        const i4 zero = i_set1(0);
+        const i4 full = i_set1(360);
+        const i4 half = i_set1(180);
+        const i4 right = i_set1(90);
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            i4 outside;
+            i4 zi = wrapAngles(i_add(i_load(z + i), i_set1(270)), &outside);
+            if (i_any(outside)) {
+                kernelRotationAxesScalar(x + i, y + i, z + i, 4);
+                continue;
+            }
+
+            i4 xi = i_load(x + i);
+            i4 yi = i_load(y + i);
+            i4 mirror = i_gt(i_abs(yi), right);
+            i4 mirroredX = i_add(i_sub(yi, half), i_and(i_gt(zero, yi), full));
+            i4 mirroredY = i_sub(i_add(i_sub(zero, half), i_and(i_gt(xi, zero), full)), xi);
+            i_store(x + i, i_select(mirror, mirroredX, i_sub(zero, yi)));
+            i_store(y + i, i_select(mirror, mirroredY, xi));
+            i_store(z + i, i_sub(zi, half));
+        }
+        kernelRotationAxesScalar(x + i, y + i, z + i, count - i);
+    }
+
+    void kernelCompassAzimuth(int *degrees, int count)
+    {
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            i4 outside;
+            i4 turned = wrapAngles(i_add(i_load(degrees + i), i_set1(90)), &outside);
+            if (i_any(outside)) {
+                kernelCompassAzimuthScalar(degrees + i, 4);
+            } else {
+                i_store(degrees + i, turned);
+            }
+        }
+        kernelCompassAzimuthScalar(degrees + i, count - i);
+    }
+
+    static inline i4 roundAway(v4 value)
+    {
+        return v_toint(v_add(value, v_lt_select(value, v_set1(0), v_set1(-0.5f), v_set1(0.5f))));
+    }
+
+    void kernelMagneticCorrection(int *x, int *y, int *z, int count, const float *offset, const float *matrix)
+    {
+        // Four samples at once, one row of the matrix per axis
+        const v4 ox = v_set1(offset[0]);
+        const v4 oy = v_set1(offset[1]);
+        const v4 oz = v_set1(offset[2]);
+        v4 m[9];
+        for (int j = 0; j < 9; j++) {
+            m[j] = v_set1(matrix[j]);
+        }
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            v4 dx = v_sub(i_tofloat(i_load(x + i)), ox);
+            v4 dy = v_sub(i_tofloat(i_load(y + i)), oy);
+            v4 dz = v_sub(i_tofloat(i_load(z + i)), oz);
+            i_store(x + i, roundAway(v_add(v_add(v_mul(m[0], dx), v_mul(m[1], dy)), v_mul(m[2], dz))));
+            i_store(y + i, roundAway(v_add(v_add(v_mul(m[3], dx), v_mul(m[4], dy)), v_mul(m[5], dz))));
+            i_store(z + i, roundAway(v_add(v_add(v_mul(m[6], dx), v_mul(m[7], dy)), v_mul(m[8], dz))));
+        }
+
+        // The rest one sample at a time, one column of the matrix per
+        // axis. Streams are corrected a reading at a time, so this is the
+        // common case.
+        const float columns[3][4] = {
+            { matrix[0], matrix[3], matrix[6], 0 },
+            { matrix[1], matrix[4], matrix[7], 0 },
+            { matrix[2], matrix[5], matrix[8], 0 }
+        };
+        const v4 c0 = v_load(columns[0]);
+        const v4 c1 = v_load(columns[1]);
+        const v4 c2 = v_load(columns[2]);
+        for (; i < count; i++) {
+            v4 dx = v_set1(x[i] - offset[0]);
+            v4 dy = v_set1(y[i] - offset[1]);
+            v4 dz = v_set1(z[i] - offset[2]);
+            int out[4];
+            i_store(out, roundAway(v_add(v_add(v_mul(c0, dx), v_mul(c1, dy)), v_mul(c2, dz))));
+            x[i] = out[0];
+            y[i] = out[1];
+            z[i] = out[2];
+        }
+    }
+
+#else
+
+    void kernelAccelerometerAxes(int *x, int *y, int count)
+    {
+        kernelAccelerometerAxesScalar(x, y, count);
+    }
+
+    void kernelRotationAxes(int *x, int *y, int *z, int count)
+    {
+        kernelRotationAxesScalar(x, y, z, count);
+    }
+
+    void kernelCompassAzimuth(int *degrees, int count)
+    {
+        kernelCompassAzimuthScalar(degrees, count);
+    }
+
+    void kernelMagneticCorrection(int *x, int *y, int *z, int count, const float *offset, const float *matrix)
+    {
+        kernelMagneticCorrectionScalar(x, y, z, count, offset, matrix);
+    }
+
+    void kernelLowPass(float *data, int count, float alpha, float *state)
+    {
+        kernelLowPassScalar(data, count, alpha, state);
+    }
+
+    void kernelMovingAverage(float *data, int count, int window, float *history, float *sum)
+    {
+        kernelMovingAverageScalar(data, count, window, history, sum);
+    }
+
+    void kernelMedian(float *data, int count, int window, float *history)
+    {
+        kernelMedianScalar(data, count, window, history);
+    }
+
+#endif
+
+} // MeeGo namespace
@@ -0,0 +1,99 @@
+/*!
+ * @file qmsensorkernels_p.h
+ * @brief Contains the sensor filter and conversion kernels
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORKERNELS_P_H
+#define QMSENSORKERNELS_P_H
+
+/* Longest windows of the moving average and median kernels */
+#define KERNEL_AVERAGE_MAX 64
+#define KERNEL_MEDIAN_MAX 15
+
+/*
+ * The kernels filter one axis of a batch of samples in place. The state
+ * is carried from one call to the next by the caller, so a stream can be
+ * filtered in batches of any size, down to single samples.
+ *
+ * Each kernel has a vectorized implementation, on SSE2 or NEON, and a
+ * plain scalar one. The plain function names pick the vectorized one when
+ * the library was built with vector support.
+ */
+namespace MeeGo
+{
+    /* True if the kernels run on SSE2 or NEON */
+    bool kernelsVectorized();
+
+    /*
+     * First order IIR low-pass, y[i] = y[i-1] + alpha * (x[i] - y[i-1]).
+     * state holds y[-1].
+     */
+    void kernelLowPass(float *data, int count, float alpha, float *state);
+    void kernelLowPassScalar(float *data, int count, float alpha, float *state);
+
+    /*
+     * Mean of the last window samples. history holds the last window
+     * inputs, oldest first, and sum their sum.
+     */
+    void kernelMovingAverage(float *data, int count, int window, float *history, float *sum);
+    void kernelMovingAverageScalar(float *data, int count, int window, float *history, float *sum);
+
+    /*
+     * Median of the last window samples, window odd. history holds the
+     * last window - 1 inputs, oldest first.
+     */
+    void kernelMedian(float *data, int count, int window, float *history);
+    void kernelMedianScalar(float *data, int count, int window, float *history);
+
+    /*
+     * The conversions of sensord readings to the axes of the sensor
+     * classes, on the axes of a batch of samples in place. They give the
+     * same results as the per-sample remapping of the sensor classes did,
+     * for any input, without branches.
+     */
+
+    /* QmAccelerometer: x = -y, y = x */
+    void kernelAccelerometerAxes(int *x, int *y, int count);
+    void kernelAccelerometerAxesScalar(int *x, int *y, int count);
+
+    /*
+     * QmRotation: x and y are mirrored into [-90, 90] when |y| is over 90,
+     * z = 0 is turned to north.
+     */
+    void kernelRotationAxes(int *x, int *y, int *z, int count);
+    void kernelRotationAxesScalar(int *x, int *y, int *z, int count);
+
+    /* QmCompass: the azimuth is turned from the x-axis to the y-axis */
+    void kernelCompassAzimuth(int *degrees, int count);
+    void kernelCompassAzimuthScalar(int *degrees, int count);
+
+    /*
+     * QmMagnetometer: hard and soft iron correction,
+     * v = matrix (v - offset), rounded half away from zero. offset has the
+     * three axes and matrix is 3x3, row by row.
+     */
+    void kernelMagneticCorrection(int *x, int *y, int *z, int count, const float *offset, const float *matrix);
+    void kernelMagneticCorrectionScalar(int *x, int *y, int *z, int count, const float *offset, const float *matrix);
+
+} // MeeGo namespace
+
+#endif // QMSENSORKERNELS_P_H
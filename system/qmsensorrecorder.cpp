@@ -0,0 +1,348 @@
+/*!
+ * @file qmsensorrecorder.cpp
+ * @brief QmSensorRecorder
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmsensorrecorder.h"
+#include "qmsensorrecorder_p.h"
+#include "qmsensor_p.h"
+
+#include <QDebug>
+
+extern "C" {
+#include <string.h>
+}
+
+namespace MeeGo {
+
+    // ----------------- BEGIN PRIVATE CLASS DEFINITION ----------------- //
+
+    QmSensorTraceWriter::QmSensorTraceWriter()
+        : frontSize_(0), flushSize_(RECORDER_FLUSH_SIZE), flushRequests_(0), flushes_(0),
+          stopping_(false), open_(false), recorded_(0), dropped_(0), written_(0)
+    {
+    }
+
+    QmSensorTraceWriter::~QmSensorTraceWriter()
+    {
+        close();
+    }
+
+    bool QmSensorTraceWriter::open(const QString &path, int bufferSize)
+    {
+        close();
+
+        file_.setFileName(path);
+        if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+            qWarning() << "Can't open" << path << file_.errorString();
+            return false;
+        }
+
+        QmTraceHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = TRACE_MAGIC;
+        header.version = TRACE_VERSION;
+        header.encoding = TraceEncodingDelta;
+        if (file_.write((const char *)&header, sizeof(header)) != sizeof(header)) {
+            qWarning() << "Can't write" << path << file_.errorString();
+            file_.close();
+            return false;
+        }
+
+        // Half of the buffer is appended to while the other half is written
+        int half = qMax(bufferSize / 2, TRACE_ENCODED_MAX);
+        mutex_.lock();
+        coder_.reset();
+        front_.resize(half);
+        back_.resize(half);
+        frontSize_ = 0;
+        flushSize_ = qMin(RECORDER_FLUSH_SIZE, half / 2);
+        flushRequests_ = 0;
+        flushes_ = 0;
+        stopping_ = false;
+        open_ = true;
+        recorded_ = 0;
+        dropped_ = 0;
+        written_ = sizeof(header);
+        mutex_.unlock();
+
+        start();
+        return true;
+    }
+
+    void QmSensorTraceWriter::close()
+    {
+        if (!file_.isOpen()) {
+            return;
+        }
+
+        mutex_.lock();
+        open_ = false;
+        stopping_ = true;
+        wake_.wakeOne();
+        mutex_.unlock();
+
+        // The writer empties the buffer before it returns
+        wait();
+        file_.close();
+        front_.clear();
+        back_.clear();
+    }
+
+    void QmSensorTraceWriter::append(const QmTraceRecord &record)
+    {
+        QMutexLocker locker(&mutex_);
+        if (!open_) {
+            return;
+        }
+        if (frontSize_ + TRACE_ENCODED_MAX > front_.size()) {
+            // The coder has not seen the record, the next one is encoded
+            // against the last one written
+            dropped_++;
+            return;
+        }
+
+        int before = frontSize_;
+        frontSize_ += coder_.encode(record, (uchar *)front_.data() + frontSize_);
+        recorded_++;
+        if (before < flushSize_ && frontSize_ >= flushSize_) {
+            wake_.wakeOne();
+        }
+    }
+
+    void QmSensorTraceWriter::flush()
+    {
+        QMutexLocker locker(&mutex_);
+        if (!open_) {
+            return;
+        }
+        int request = ++flushRequests_;
+        wake_.wakeOne();
+        while (flushes_ - request < 0) {
+            done_.wait(&mutex_);
+        }
+    }
+
+    int QmSensorTraceWriter::recorded() const
+    {
+        QMutexLocker locker(&mutex_);
+        return recorded_;
+    }
+
+    int QmSensorTraceWriter::dropped() const
+    {
+        QMutexLocker locker(&mutex_);
+        return dropped_;
+    }
+
+    qint64 QmSensorTraceWriter::written() const
+    {
+        QMutexLocker locker(&mutex_);
+        return written_;
+    }
+
+    void QmSensorTraceWriter::run()
+    {
+        QMutexLocker locker(&mutex_);
+        for (;;) {
+            if (frontSize_ < flushSize_ && flushes_ == flushRequests_ && !stopping_) {
+                wake_.wait(&mutex_, RECORDER_FLUSH_INTERVAL);
+            }
+
+            int request = flushRequests_;
+            bool stopping = stopping_;
+            int size = frontSize_;
+            qSwap(front_, back_);
+            frontSize_ = 0;
+
+            // Appending goes on into the other buffer meanwhile
+            locker.unlock();
+            qint64 result = size ? file_.write(back_.constData(), size) : 0;
+            if (result < size) {
+                qWarning() << "Can't write" << file_.fileName() << file_.errorString();
+            }
+            locker.relock();
+
+            written_ += qMax(result, (qint64)0);
+            flushes_ = request;
+            done_.wakeAll();
+            if (stopping) {
+                break;
+            }
+        }
+    }
+
+    void QmSensorRecorderChannel::record(quint64 timestamp, qint32 a, qint32 b, qint32 c)
+    {
+        QmTraceRecord record;
+        memset(&record, 0, sizeof(record));
+        record.timestamp = timestamp;
+        record.sensor = sensor_;
+        record.values[0] = a;
+        record.values[1] = b;
+        record.values[2] = c;
+        writer_->append(record);
+    }
+
+    void QmSensorRecorderChannel::slotXyz(const XYZ& data)
+    {
+        record(data.XYZData().timestamp_, data.x(), data.y(), data.z());
+    }
+
+    void QmSensorRecorderChannel::slotMagneticField(const MagneticField& data)
+    {
+        QmTraceRecord record;
+        memset(&record, 0, sizeof(record));
+        record.timestamp = data.data().timestamp_;
+        record.sensor = sensor_;
+        record.values[0] = data.data().x_;
+        record.values[1] = data.data().y_;
+        record.values[2] = data.data().z_;
+        record.values[3] = data.data().rx_;
+        record.values[4] = data.data().ry_;
+        record.values[5] = data.data().rz_;
+        record.values[6] = data.data().level_;
+        writer_->append(record);
+    }
+
+    void QmSensorRecorderChannel::slotCompass(const Compass& data)
+    {
+        record(data.data().timestamp_, data.data().degrees_, data.data().level_);
+    }
+
+    void QmSensorRecorderChannel::slotUnsigned(const Unsigned& data)
+    {
+        record(data.UnsignedData().timestamp_, data.UnsignedData().value_);
+    }
+
+    void QmSensorRecorderChannel::slotTap(const Tap& data)
+    {
+        record(data.tapData().timestamp_, data.tapData().direction_, data.tapData().type_);
+    }
+
+    // ----------------- BEGIN PUBLIC CLASS DEFINITION ----------------- //
+
+    QmSensorRecorder::QmSensorRecorder(QObject *parent) : QObject(parent)
+    {
+        MEEGO_INITIALIZE(QmSensorRecorder);
+    }
+
+    QmSensorRecorder::~QmSensorRecorder()
+    {
+        MEEGO_PRIVATE(QmSensorRecorder);
+        // The channels belong to the sensors, but point to the writer
+        foreach (QPointer<QmSensorRecorderChannel> channel, priv->channels) {
+            if (channel) {
+                channel->invoke("detach");
+            }
+        }
+        close();
+        MEEGO_UNINITIALIZE(QmSensorRecorder);
+    }
+
+    bool QmSensorRecorder::open(const QString &path)
+    {
+        MEEGO_PRIVATE(QmSensorRecorder);
+        return priv->writer.open(path, priv->bufferSize);
+    }
+
+    void QmSensorRecorder::close()
+    {
+        MEEGO_PRIVATE(QmSensorRecorder);
+        priv->writer.close();
+    }
+
+    bool QmSensorRecorder::isOpen() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorRecorder);
+        return priv->writer.isOpen();
+    }
+
+    bool QmSensorRecorder::attach(QmSensor *sensor)
+    {
+        MEEGO_PRIVATE(QmSensorRecorder);
+        QmSensorPrivate *sensorPriv = sensor->priv_func();
+        int id = traceSensor(sensorPriv->sensorId());
+        if (id < 0) {
+            return false;
+        }
+
+        detach(sensor);
+        QmSensorRecorderChannel *channel = new QmSensorRecorderChannel(id, &priv->writer, sensorPriv);
+        bool attached = false;
+        channel->invoke("attach", Q_RETURN_ARG(bool, attached));
+        if (!attached) {
+            // Recorded by another recorder
+            channel->deleteLater();
+            return false;
+        }
+        priv->channels.append(channel);
+        return true;
+    }
+
+    void QmSensorRecorder::detach(QmSensor *sensor)
+    {
+        MEEGO_PRIVATE(QmSensorRecorder);
+        QmSensorRecorderChannel *channel = qobject_cast<QmSensorRecorderChannel*>(sensor->priv_func()->taps_[QmSensorPrivate::TapRecorder]);
+        if (channel && priv->channels.removeAll(channel)) {
+            channel->invoke("detach");
+        }
+    }
+
+    void QmSensorRecorder::setBufferSize(int bytes)
+    {
+        MEEGO_PRIVATE(QmSensorRecorder);
+        priv->bufferSize = bytes;
+    }
+
+    int QmSensorRecorder::bufferSize() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorRecorder);
+        return priv->bufferSize;
+    }
+
+    void QmSensorRecorder::flush()
+    {
+        MEEGO_PRIVATE(QmSensorRecorder);
+        priv->writer.flush();
+    }
+
+    int QmSensorRecorder::recorded() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorRecorder);
+        return priv->writer.recorded();
+    }
+
+    int QmSensorRecorder::dropped() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorRecorder);
+        return priv->writer.dropped();
+    }
+
+    qint64 QmSensorRecorder::written() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorRecorder);
+        return priv->writer.written();
+    }
+
+}
@@ -0,0 +1,165 @@
+/*!
+ * @file qmsensorrecorder.h
+ * @brief Contains QmSensorRecorder, which records the readings of sensors into a trace.
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORRECORDER_H
+#define QMSENSORRECORDER_H
+
+#include "system_global.h"
+#include <QtCore/qobject.h>
+#include <QString>
+#include <qmsensor.h>
+
+QT_BEGIN_HEADER
+
+namespace MeeGo {
+
+    class QmSensorRecorderPrivate;
+
+    /**
+     * @scope Internal
+     *
+     * @brief Records the readings of sensors into a trace.
+     *
+     * The recorder takes the sensord readings of the attached sensors, as
+     * they arrive and before any conversion, decimation or filtering, and
+     * writes them to a trace file that QmSensorReplay plays back.
+     *
+     * The readings are delta encoded into a buffer of bounded size, which
+     * a background thread writes to the file. Recording costs little time
+     * in the thread of the sensors and a few bytes per reading. When the
+     * file can't keep up and the buffer is full, readings are dropped and
+     * counted, see #dropped().
+     *
+     * A sensor is recorded while it is running. Attach one sensor object
+     * per sensord sensor, sensor objects of the same sensor share their
+     * readings.
+     *
+     * @code
+     * QmSensorRecorder recorder;
+     * recorder.open("/tmp/walk.trace");
+     * QmAccelerometer accelerometer;
+     * recorder.attach(&accelerometer);
+     * accelerometer.requestSession(QmSensor::SessionTypeListen);
+     * accelerometer.start();
+     * @endcode
+     */
+    class MEEGO_SYSTEM_EXPORT QmSensorRecorder : public QObject
+    {
+        Q_OBJECT;
+
+    public:
+        /**
+         * Constructor
+         * @param parent Parent QObject.
+         */
+        QmSensorRecorder(QObject *parent = 0);
+
+        /**
+         * Destructor. Closes the trace.
+         */
+        ~QmSensorRecorder();
+
+        /**
+         * Creates a trace file, replacing any earlier one, and starts
+         * recording into it. A trace being recorded is closed first.
+         * @param path The trace file
+         * @return \c false if the file can't be written
+         */
+        bool open(const QString &path);
+
+        /**
+         * Writes the buffered readings and closes the trace. The attached
+         * sensors stay attached.
+         */
+        void close();
+
+        /**
+         * Returns whether a trace is being recorded.
+         * @return \c true if open
+         */
+        bool isOpen() const;
+
+        /**
+         * Records the readings of a sensor from now on, while it runs.
+         * @param sensor The sensor
+         * @return \c false if the sensor type can't be recorded, or the
+         *         sensor is attached to another recorder
+         */
+        bool attach(QmSensor *sensor);
+
+        /**
+         * Stops recording the readings of a sensor.
+         * @param sensor The sensor
+         */
+        void detach(QmSensor *sensor);
+
+        /**
+         * Sets the size of the buffer. Takes effect when the next trace is
+         * opened.
+         * @param bytes Buffer size, default is 64 kB
+         */
+        void setBufferSize(int bytes);
+
+        /**
+         * Returns the size of the buffer, see #setBufferSize().
+         * @return Buffer size in bytes
+         */
+        int bufferSize() const;
+
+        /**
+         * Writes the buffered readings to the file, and waits until they
+         * are written.
+         */
+        void flush();
+
+        /**
+         * Returns the number of readings recorded into the trace.
+         * @return Number of readings
+         */
+        int recorded() const;
+
+        /**
+         * Returns the number of readings dropped because the buffer was
+         * full.
+         * @return Number of readings
+         */
+        int dropped() const;
+
+        /**
+         * Returns the number of bytes written to the file, header included.
+         * @return Size of the trace
+         */
+        qint64 written() const;
+
+    private:
+        Q_DISABLE_COPY(QmSensorRecorder)
+        MEEGO_DECLARE_PRIVATE(QmSensorRecorder)
+    };
+
+} // MeeGo namespace
+
+QT_END_HEADER
+
+#endif
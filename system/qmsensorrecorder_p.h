@@ -0,0 +1,137 @@
+/*!
+ * @file qmsensorrecorder_p.h
+ * @brief Contains QmSensorRecorderPrivate
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORRECORDER_P_H
+#define QMSENSORRECORDER_P_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QPointer>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "qmsensor_p.h"
+#include "qmsensorrecorder.h"
+#include "qmsensortrace_p.h"
+#include "sensord/accelerometersensor_i.h"
+#include "sensord/alssensor_i.h"
+#include "sensord/compasssensor_i.h"
+#include "sensord/magnetometersensor_i.h"
+#include "sensord/tapsensor_i.h"
+
+#define RECORDER_BUFFER_SIZE 65536
+/* The writer wakes up when this much is buffered, or after the interval */
+#define RECORDER_FLUSH_SIZE 4096
+#define RECORDER_FLUSH_INTERVAL 1000 /* ms */
+
+namespace MeeGo
+{
+    /**
+     * Encodes records into a buffer and writes them to the trace file in
+     * its own thread. Records are appended to one buffer while the other
+     * one is being written; a record that doesn't fit is dropped.
+     */
+    class QmSensorTraceWriter : public QThread
+    {
+    public:
+        QmSensorTraceWriter();
+        ~QmSensorTraceWriter();
+
+        bool open(const QString &path, int bufferSize);
+        void close();
+        bool isOpen() const { return file_.isOpen(); }
+
+        /* Any thread */
+        void append(const QmTraceRecord &record);
+        void flush();
+        int recorded() const;
+        int dropped() const;
+        qint64 written() const;
+
+    protected:
+        void run();
+
+    private:
+        QFile file_;
+        QmTraceCoder coder_;
+
+        mutable QMutex mutex_;
+        QWaitCondition wake_;
+        QWaitCondition done_;
+        QByteArray front_;      /* being appended to */
+        int frontSize_;
+        QByteArray back_;       /* being written */
+        int flushSize_;
+        int flushRequests_;
+        int flushes_;
+        bool stopping_;
+        bool open_;
+
+        int recorded_;
+        int dropped_;
+        qint64 written_;
+    };
+
+    /**
+     * Records the sensord readings of one sensor.
+     */
+    class QmSensorRecorderChannel : public QmSensorTapChannel
+    {
+        Q_OBJECT;
+
+    public:
+        QmSensorRecorderChannel(int sensor, QmSensorTraceWriter *writer, QmSensorPrivate *sensorPriv)
+            : QmSensorTapChannel(QmSensorPrivate::TapRecorder, sensor, sensorPriv), writer_(writer) {}
+
+    public Q_SLOTS:
+        void slotXyz(const XYZ& data);
+        void slotMagneticField(const MagneticField& data);
+        void slotCompass(const Compass& data);
+        void slotUnsigned(const Unsigned& data);
+        void slotTap(const Tap& data);
+
+    private:
+        void record(quint64 timestamp, qint32 a, qint32 b = 0, qint32 c = 0);
+
+        QmSensorTraceWriter *writer_;
+    };
+
+    class QmSensorRecorderPrivate : public QObject
+    {
+        Q_OBJECT;
+        MEEGO_DECLARE_PUBLIC(QmSensorRecorder)
+
+    public:
+        QmSensorRecorderPrivate() : bufferSize(RECORDER_BUFFER_SIZE) {}
+
+        QmSensorTraceWriter writer;
+        int bufferSize;
+
+        /* Channels of the attached sensors */
+        QList<QPointer<QmSensorRecorderChannel> > channels;
+    };
+}
+#endif // QMSENSORRECORDER_P_H
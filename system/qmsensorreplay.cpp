@@ -0,0 +1,248 @@
+/*!
+ * @file qmsensorreplay.cpp
+ * @brief QmSensorReplay
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmsensorreplay.h"
+#include "qmsensorreplay_p.h"
+#include "qmsensor_p.h"
+
+namespace MeeGo {
+
+    // ----------------- BEGIN PRIVATE CLASS DEFINITION ----------------- //
+
+    void QmSensorReplayChannel::deliver(const QmTraceRecord& record)
+    {
+        const qint32 *v = record.values;
+        switch (sensor_) {
+            case TraceAccelerometer:
+            case TraceRotation:
+                emit dataAvailable(XYZ(TimedXyzData(record.timestamp, v[0], v[1], v[2])));
+                break;
+            case TraceMagnetometer:
+                emit dataAvailable(MagneticField(CalibratedMagneticFieldData(record.timestamp, v[0], v[1], v[2],
+                                                                             v[3], v[4], v[5], v[6])));
+                break;
+            case TraceCompass:
+                emit dataAvailable(Compass(CompassData(record.timestamp, v[0], v[1])));
+                break;
+            case TraceAls:
+                emit ALSChanged(Unsigned(TimedUnsigned(record.timestamp, v[0])));
+                break;
+            case TraceProximity:
+                emit dataAvailable(Unsigned(TimedUnsigned(record.timestamp, v[0])));
+                break;
+            case TraceOrientation:
+                emit orientationChanged(Unsigned(TimedUnsigned(record.timestamp, v[0])));
+                break;
+            case TraceTap:
+                emit dataAvailable(Tap(TapData(record.timestamp, (TapData::Direction)v[0], (TapData::Type)v[1])));
+                break;
+        }
+    }
+
+    QmSensorReplayPrivate::QmSensorReplayPrivate()
+        : position(0), rate(1), running(false), origin(0)
+    {
+        for (int i = 0; i < TraceSensorCount; i++) {
+            channels[i] = NULL;
+        }
+        timer.setSingleShot(true);
+        connect(&timer, SIGNAL(timeout()), this, SLOT(slotTimeout()));
+    }
+
+    void QmSensorReplayPrivate::deliver(int count)
+    {
+        for (int i = 0; i < count && position < records.size(); i++) {
+            const QmTraceRecord& record = records[position++];
+            if (channels[record.sensor]) {
+                channels[record.sensor]->deliver(record);
+            }
+        }
+    }
+
+    void QmSensorReplayPrivate::schedule()
+    {
+        if (rate <= 0) {
+            // Return to the event loop now and then, for the receivers
+            deliver(REPLAY_CHUNK);
+        } else {
+            qint64 now = clock.elapsed();
+            qint64 due = 0;
+            while (position < records.size()) {
+                // Readings of different sensors may be slightly out of order
+                qint64 recorded = qMax((qint64)0, (qint64)(records[position].timestamp - origin));
+                due = (qint64)(recorded / 1000 / rate);
+                if (due > now) {
+                    break;
+                }
+                deliver(1);
+            }
+            if (position < records.size()) {
+                timer.start(due - now);
+                return;
+            }
+        }
+
+        if (position < records.size()) {
+            timer.start(0);
+        } else {
+            MEEGO_PUBLIC(QmSensorReplay);
+            running = false;
+            emit pub->finished();
+        }
+    }
+
+    void QmSensorReplayPrivate::slotTimeout()
+    {
+        if (running) {
+            schedule();
+        }
+    }
+
+    // ----------------- BEGIN PUBLIC CLASS DEFINITION ----------------- //
+
+    QmSensorReplay::QmSensorReplay(QObject *parent) : QObject(parent)
+    {
+        MEEGO_INITIALIZE(QmSensorReplay);
+    }
+
+    QmSensorReplay::~QmSensorReplay()
+    {
+        MEEGO_PRIVATE(QmSensorReplay);
+        foreach (QPointer<QmSensor> sensor, priv->sensors) {
+            if (sensor) {
+                detach(sensor);
+            }
+        }
+        MEEGO_UNINITIALIZE(QmSensorReplay);
+    }
+
+    bool QmSensorReplay::open(const QString &path)
+    {
+        MEEGO_PRIVATE(QmSensorReplay);
+        stop();
+        priv->position = 0;
+        return traceLoad(path, &priv->records);
+    }
+
+    int QmSensorReplay::count() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorReplay);
+        return priv->records.size();
+    }
+
+    int QmSensorReplay::position() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorReplay);
+        return priv->position;
+    }
+
+    bool QmSensorReplay::attach(QmSensor *sensor)
+    {
+        MEEGO_PRIVATE(QmSensorReplay);
+        QmSensorPrivate *sensorPriv = sensor->priv_func();
+        int id = traceSensor(sensorPriv->sensorId());
+        if (id < 0) {
+            return false;
+        }
+
+        sensor->closeSession();
+        if (!priv->channels[id]) {
+            priv->channels[id] = new QmSensorReplayChannel(id, priv);
+        }
+        sensorPriv->replay_ = priv->channels[id];
+        if (!priv->sensors.contains(sensor)) {
+            priv->sensors.append(sensor);
+        }
+        return true;
+    }
+
+    void QmSensorReplay::detach(QmSensor *sensor)
+    {
+        MEEGO_PRIVATE(QmSensorReplay);
+        sensor->closeSession();
+        sensor->priv_func()->replay_ = NULL;
+        priv->sensors.removeAll(sensor);
+    }
+
+    void QmSensorReplay::setRate(double rate)
+    {
+        MEEGO_PRIVATE(QmSensorReplay);
+        priv->rate = qMax(0.0, rate);
+        if (priv->running && priv->position < priv->records.size()) {
+            // Continue at the new pace from the next reading
+            priv->origin = priv->records[priv->position].timestamp;
+            priv->clock.start();
+            priv->timer.start(0);
+        }
+    }
+
+    double QmSensorReplay::rate() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorReplay);
+        return priv->rate;
+    }
+
+    bool QmSensorReplay::start()
+    {
+        MEEGO_PRIVATE(QmSensorReplay);
+        if (priv->position >= priv->records.size()) {
+            return false;
+        }
+        priv->running = true;
+        priv->origin = priv->records[priv->position].timestamp;
+        priv->clock.start();
+        priv->timer.start(0);
+        return true;
+    }
+
+    void QmSensorReplay::stop()
+    {
+        MEEGO_PRIVATE(QmSensorReplay);
+        priv->running = false;
+        priv->timer.stop();
+    }
+
+    bool QmSensorReplay::isRunning() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorReplay);
+        return priv->running;
+    }
+
+    int QmSensorReplay::step(int max)
+    {
+        MEEGO_PRIVATE(QmSensorReplay);
+        int before = priv->position;
+        priv->deliver(max);
+        return priv->position - before;
+    }
+
+    void QmSensorReplay::rewind()
+    {
+        MEEGO_PRIVATE(QmSensorReplay);
+        stop();
+        priv->position = 0;
+    }
+
+}
@@ -0,0 +1,180 @@
+/*!
+ * @file qmsensorreplay.h
+ * @brief Contains QmSensorReplay, which feeds recorded sensor traces to the sensor classes.
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORREPLAY_H
+#define QMSENSORREPLAY_H
+
+#include "system_global.h"
+#include <QtCore/qobject.h>
+#include <QString>
+#include <qmsensor.h>
+
+QT_BEGIN_HEADER
+
+namespace MeeGo {
+
+    class QmSensorReplayPrivate;
+
+    /**
+     * @scope Internal
+     *
+     * @brief Feeds recorded sensor traces to the sensor classes.
+     *
+     * A replay reads a trace of sensord readings from a file and delivers
+     * them to the attached sensors in place of sensord. The readings go
+     * through the same conversion, decimation, filtering and delivery as
+     * live ones, so sensor code can be tested and benchmarked without
+     * sensord, and with the same input on every run.
+     *
+     * Attach the sensors first, then request a session and start them as
+     * usual. The readings are delivered at the pace they were recorded,
+     * scaled by #setRate(), or as fast as possible. Alternatively, step()
+     * delivers readings without an event loop.
+     *
+     * A replayed sensor has no sensord session: interval, standby override
+     * and other settings of sensord have no effect, and the getters return
+     * the latest replayed reading only.
+     *
+     * @code
+     * QmSensorReplay replay;
+     * replay.open("/tmp/walk.trace");
+     * QmAccelerometer accelerometer;
+     * replay.attach(&accelerometer);
+     * accelerometer.requestSession(QmSensor::SessionTypeListen);
+     * accelerometer.start();
+     * replay.start();
+     * @endcode
+     */
+    class MEEGO_SYSTEM_EXPORT QmSensorReplay : public QObject
+    {
+        Q_OBJECT;
+
+    public:
+        /**
+         * Constructor
+         * @param parent Parent QObject.
+         */
+        QmSensorReplay(QObject *parent = 0);
+
+        /**
+         * Destructor. The attached sensors are detached.
+         */
+        ~QmSensorReplay();
+
+        /**
+         * Reads a trace and rewinds to its beginning.
+         * @param path The trace file
+         * @return \c false if the file can't be read or is not a trace
+         */
+        bool open(const QString &path);
+
+        /**
+         * Returns the number of readings in the trace, including those of
+         * sensors that are not attached.
+         * @return Number of readings
+         */
+        int count() const;
+
+        /**
+         * Returns the number of readings replayed since the last rewind.
+         * @return Index of the next reading
+         */
+        int position() const;
+
+        /**
+         * Makes a sensor take its readings from this replay. An open
+         * session of the sensor is closed.
+         * @param sensor The sensor
+         * @return \c false if the sensor type can't be replayed
+         */
+        bool attach(QmSensor *sensor);
+
+        /**
+         * Gives a sensor back to sensord. Its session is closed.
+         * @param sensor The sensor
+         */
+        void detach(QmSensor *sensor);
+
+        /**
+         * Sets the replay speed.
+         * @param rate 1 for the recorded pace, 2 for twice as fast, and so
+         *             on. 0 for as fast as possible. Default is 1.
+         */
+        void setRate(double rate);
+
+        /**
+         * Returns the replay speed, see #setRate().
+         * @return Speed
+         */
+        double rate() const;
+
+        /**
+         * Starts or continues the replay from the current position. Needs
+         * an event loop.
+         * @return \c false if there are no readings left
+         */
+        bool start();
+
+        /**
+         * Pauses the replay.
+         */
+        void stop();
+
+        /**
+         * Returns whether the replay is running.
+         * @return \c true if started and not finished
+         */
+        bool isRunning() const;
+
+        /**
+         * Replays readings right away, regardless of their timestamps.
+         * @param max Maximum number of readings
+         * @return Number of readings replayed, less than \c max at the end
+         *         of the trace
+         */
+        int step(int max);
+
+        /**
+         * Goes back to the first reading.
+         */
+        void rewind();
+
+    Q_SIGNALS:
+        /**
+         * Emitted when the last reading has been delivered by a running
+         * replay.
+         */
+        void finished();
+
+    private:
+        Q_DISABLE_COPY(QmSensorReplay)
+        MEEGO_DECLARE_PRIVATE(QmSensorReplay)
+    };
+
+} // MeeGo namespace
+
+QT_END_HEADER
+
+#endif
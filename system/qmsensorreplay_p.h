@@ -0,0 +1,103 @@
+/*!
+ * @file qmsensorreplay_p.h
+ * @brief Contains QmSensorReplayPrivate
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORREPLAY_P_H
+#define QMSENSORREPLAY_P_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+#include "qmsensorreplay.h"
+#include "qmsensortrace_p.h"
+#include "sensord/accelerometersensor_i.h"
+#include "sensord/alssensor_i.h"
+#include "sensord/compasssensor_i.h"
+#include "sensord/magnetometersensor_i.h"
+#include "sensord/tapsensor_i.h"
+
+/* Readings replayed per event loop round when going as fast as possible */
+#define REPLAY_CHUNK 256
+
+namespace MeeGo
+{
+    /**
+     * Stands in for the sensord interface of one sensor. It has the data
+     * signals of the sensord interfaces, so the data slots of the sensors
+     * connect to it unchanged, see QmSensorPrivate::source().
+     */
+    class QmSensorReplayChannel : public QObject
+    {
+        Q_OBJECT;
+
+    public:
+        QmSensorReplayChannel(int sensor, QObject *parent) : QObject(parent), sensor_(sensor) {}
+
+        void deliver(const QmTraceRecord& record);
+
+    Q_SIGNALS:
+        void dataAvailable(const XYZ& data);
+        void dataAvailable(const MagneticField& data);
+        void dataAvailable(const Compass& data);
+        void dataAvailable(const Unsigned& data);
+        void dataAvailable(const Tap& data);
+        void ALSChanged(const Unsigned& data);
+        void orientationChanged(const Unsigned& data);
+
+    private:
+        int sensor_;
+    };
+
+    class QmSensorReplayPrivate : public QObject
+    {
+        Q_OBJECT;
+        MEEGO_DECLARE_PUBLIC(QmSensorReplay)
+
+    public:
+        QmSensorReplayPrivate();
+
+        QVector<QmTraceRecord> records;
+        int position;
+        double rate;
+        bool running;
+
+        /* Indexed by QmTraceSensor, created on attach */
+        QmSensorReplayChannel *channels[TraceSensorCount];
+        QList<QPointer<QmSensor> > sensors;
+
+        /* The replay clock starts at the timestamp of reading origin */
+        QElapsedTimer clock;
+        quint64 origin;
+        QTimer timer;
+
+        void deliver(int count);
+        void schedule();
+
+    public Q_SLOTS:
+        void slotTimeout();
+    };
+}
+#endif // QMSENSORREPLAY_P_H
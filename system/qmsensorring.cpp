@@ -0,0 +1,162 @@
+/*!
+ * @file qmsensorring.cpp
+ * @brief QmSensorRing
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmsensorring_p.h"
+
+#include <QDebug>
+
+extern "C" {
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+}
+
+namespace MeeGo {
+
+    QmSensorRing::QmSensorRing()
+        : slots_(0), mask_(0), fd_(-1), head_(0), size_(0), dropped_(0), tail_(0)
+    {
+    }
+
+    QmSensorRing::~QmSensorRing()
+    {
+        close();
+    }
+
+    bool QmSensorRing::open(int capacity)
+    {
+        close();
+
+        quint32 size = 1;
+        while (size < (quint32)capacity && size < 0x10000) {
+            size <<= 1;
+        }
+
+        void *slots = 0;
+        if (posix_memalign(&slots, SENSOR_RING_SLOT, size * SENSOR_RING_SLOT) != 0) {
+            qWarning() << "Can't allocate sensor ring of" << size << "readings";
+            return false;
+        }
+
+        fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd_ < 0) {
+            qWarning() << "Can't create eventfd:" << strerror(errno);
+            free(slots);
+            return false;
+        }
+
+        slots_ = (char*)slots;
+        mask_ = size - 1;
+        head_ = 0;
+        tail_ = 0;
+        size_ = 0;
+        dropped_ = 0;
+        return true;
+    }
+
+    void QmSensorRing::close()
+    {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        free(slots_);
+        slots_ = 0;
+        mask_ = 0;
+    }
+
+    void QmSensorRing::wakeup()
+    {
+        quint64 one = 1;
+        if (::write(fd_, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+            qWarning() << "Can't signal sensor ring:" << strerror(errno);
+        }
+    }
+
+    bool QmSensorRing::push(const void *reading, int size)
+    {
+        Q_ASSERT(size <= SENSOR_RING_SLOT);
+        quint32 head = head_;
+        if (head - tail_ > mask_) {
+            dropped_++;
+            return false;
+        }
+
+        memcpy(slots_ + (head & mask_) * SENSOR_RING_SLOT, reading, size);
+        size_ = size;
+
+        // The reading must be complete before the consumer can see it, and
+        // the consumer must see it before we decide whether to wake it up.
+        __sync_synchronize();
+        head_ = head + 1;
+        __sync_synchronize();
+
+        if (tail_ == head) {
+            wakeup();
+        }
+        return true;
+    }
+
+    int QmSensorRing::pop(void *readings, int size, int max)
+    {
+        if (!slots_) {
+            return -1;
+        }
+
+        quint32 tail = tail_;
+        quint32 head = head_;
+        if (head == tail) {
+            // Reset the eventfd and look again, a reading pushed in between
+            // has either been seen now or will signal the descriptor again.
+            quint64 count;
+            if (::read(fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                qWarning() << "Can't read sensor ring eventfd:" << strerror(errno);
+            }
+            __sync_synchronize();
+            head = head_;
+            if (head == tail) {
+                return 0;
+            }
+        }
+        __sync_synchronize();
+
+        if (size != size_) {
+            return -1;
+        }
+
+        quint32 count = qMin((quint32)qMax(max, 0), head - tail);
+        char *out = (char*)readings;
+        for (quint32 i = 0; i < count; i++) {
+            memcpy(out + i * size, slots_ + ((tail + i) & mask_) * SENSOR_RING_SLOT, size);
+        }
+
+        // Release the slots only after they have been copied out, and
+        // publish the new tail before the next look at head_.
+        __sync_synchronize();
+        tail_ = tail + count;
+        __sync_synchronize();
+        return count;
+    }
+
+} // MeeGo namespace
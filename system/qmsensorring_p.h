@@ -0,0 +1,109 @@
+/*!
+ * @file qmsensorring_p.h
+ * @brief Contains QmSensorRing
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORRING_P_H
+#define QMSENSORRING_P_H
+
+#include <QtCore/qglobal.h>
+
+/* Bytes per reading, one cache line */
+#define SENSOR_RING_SLOT 64
+
+namespace MeeGo
+{
+    /**
+     * Lock-free ring of readings for one producer and one consumer thread.
+     *
+     * The producer is the thread of the sensor object, the consumer may be
+     * any single thread. The readings are trivially copyable and copied in and out
+     * with memcpy. The eventfd becomes readable when a reading is stored
+     * in an empty ring; the consumer pops until pop() returns 0 and then
+     * waits on the descriptor.
+     *
+     * The producer and consumer indices live on cache lines of their own so
+     * the two threads don't contend for them.
+     */
+    class QmSensorRing
+    {
+    public:
+        QmSensorRing();
+        ~QmSensorRing();
+
+        /**
+         * Allocates the ring and the eventfd. Not thread safe, the consumer
+         * must not be running.
+         *
+         * @param capacity Readings to hold, rounded up to a power of two
+         * @return \c true on success, \c false on failure.
+         */
+        bool open(int capacity);
+        void close();
+
+        bool isOpen() const { return slots_ != 0; }
+        int fd() const { return fd_; }
+        int capacity() const { return slots_ ? mask_ + 1 : 0; }
+
+        /**
+         * Producer side. Stores a copy of the reading.
+         *
+         * @return \c false if the ring was full and the reading was dropped
+         */
+        bool push(const void *reading, int size);
+
+        /**
+         * Consumer side. Copies out up to \c max readings, oldest first.
+         *
+         * @return Number of readings, or -1 if the ring is not open or
+         *         holds readings of a different size
+         */
+        int pop(void *readings, int size, int max);
+
+        /**
+         * Returns the number of readings dropped because the ring was full.
+         */
+        quint32 dropped() const { return dropped_; }
+
+    private:
+        Q_DISABLE_COPY(QmSensorRing)
+
+        void wakeup();
+
+        char *slots_;
+        quint32 mask_;
+        int fd_;
+
+        /* Producer */
+        volatile quint32 head_;
+        volatile int size_;
+        quint32 dropped_;
+        char producerPad_[SENSOR_RING_SLOT - 3 * sizeof(quint32)];
+
+        /* Consumer */
+        volatile quint32 tail_;
+        char consumerPad_[SENSOR_RING_SLOT - sizeof(quint32)];
+    };
+
+} // MeeGo namespace
+
+#endif // QMSENSORRING_P_H
@@ -0,0 +1,200 @@
+/*!
+ * @file qmsensorsession.cpp
+ * @brief QmSensorSession
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmsensorsession_p.h"
+#include "qmsensor_p.h"
+
+#include <QThread>
+
+namespace MeeGo {
+
+    QHash<QByteArray, QmSensorSession*> QmSensorSession::sessions_;
+    QMutex QmSensorSession::sessionsMutex_;
+
+    QmSensorSession::QmSensorSession(const QByteArray &key, AbstractSensorChannelInterface *interface,
+                                     QmSensor::SessionType type)
+        : key_(key), interface_(interface), type_(type), interval_(-1), standbyOverride_(false)
+    {
+    }
+
+    QmSensorSession::~QmSensorSession()
+    {
+        delete interface_;
+    }
+
+    QByteArray QmSensorSession::key(QmSensorPrivate *sensor, QmSensor::SessionType type)
+    {
+        return QByteArray(sensor->sensorId())
+            + ':' + QByteArray::number((int)type)
+            + ':' + QByteArray::number((quintptr)QThread::currentThread());
+    }
+
+    QmSensorSession* QmSensorSession::attach(QmSensorPrivate *sensor, QmSensor::SessionType type)
+    {
+        QMutexLocker locker(&sessionsMutex_);
+
+        QmSensorSession *session = sessions_.value(key(sensor, type));
+        if (!session && type == QmSensor::SessionTypeListen) {
+            session = sessions_.value(key(sensor, QmSensor::SessionTypeControl));
+        }
+
+        if (!session) {
+            AbstractSensorChannelInterface *interface = NULL;
+            if (type == QmSensor::SessionTypeControl) {
+                interface = sensor->controlSession();
+            } else {
+                interface = const_cast<AbstractSensorChannelInterface*>(sensor->listenSession());
+            }
+            if (!interface) {
+                return NULL;
+            }
+            session = new QmSensorSession(key(sensor, type), interface, type);
+            sessions_.insert(session->key_, session);
+        }
+
+        session->subscribers_.insert(sensor);
+        return session;
+    }
+
+    void QmSensorSession::detach(QmSensorPrivate *sensor)
+    {
+        stop(sensor);
+
+        QMutexLocker locker(&sessionsMutex_);
+        subscribers_.remove(sensor);
+        intervals_.remove(sensor);
+        standbyOverrides_.remove(sensor);
+        sensor->decimationInterval_ = 0;
+
+        if (subscribers_.isEmpty()) {
+            sessions_.remove(key_);
+            delete this;
+        } else {
+            negotiate();
+        }
+    }
+
+    void QmSensorSession::start(QmSensorPrivate *sensor)
+    {
+        if (running_.contains(sensor)) {
+            return;
+        }
+        running_.insert(sensor);
+        negotiate();
+        if (running_.size() == 1) {
+            // XXX: Check for valid D-Bus reply, set error.
+            interface_->start();
+        }
+    }
+
+    void QmSensorSession::stop(QmSensorPrivate *sensor)
+    {
+        if (!running_.remove(sensor)) {
+            return;
+        }
+        if (running_.isEmpty()) {
+            // XXX: Check for valid D-Bus reply, set error.
+            interface_->stop();
+        } else {
+            negotiate();
+        }
+    }
+
+    int QmSensorSession::interval(QmSensorPrivate *sensor)
+    {
+        int value = intervals_.value(sensor, 0);
+        return value > 0 ? value : sessionInterval();
+    }
+
+    void QmSensorSession::setInterval(QmSensorPrivate *sensor, int value)
+    {
+        if (value > 0) {
+            intervals_.insert(sensor, value);
+        } else {
+            intervals_.remove(sensor);
+        }
+        negotiate();
+    }
+
+    int QmSensorSession::requestedInterval(QmSensorPrivate *sensor)
+    {
+        return intervals_.value(sensor, 0);
+    }
+
+    int QmSensorSession::sessionInterval()
+    {
+        return interval_ > 0 ? interval_ : interface_->interval();
+    }
+
+    bool QmSensorSession::standbyOverride(QmSensorPrivate *sensor)
+    {
+        return standbyOverrides_.contains(sensor);
+    }
+
+    void QmSensorSession::setStandbyOverride(QmSensorPrivate *sensor, bool value)
+    {
+        if (value) {
+            standbyOverrides_.insert(sensor);
+        } else {
+            standbyOverrides_.remove(sensor);
+        }
+        negotiate();
+    }
+
+    void QmSensorSession::negotiate()
+    {
+        // Started sensors decide. Before any has started all attached ones
+        // do, so settings made before start() take effect as they always have.
+        int interval = 0;
+        bool standbyOverride = false;
+        foreach (QmSensorPrivate *sensor, subscribers_) {
+            if (!running_.isEmpty() && !running_.contains(sensor)) {
+                continue;
+            }
+            int value = intervals_.value(sensor, 0);
+            if (value > 0 && (interval == 0 || value < interval)) {
+                interval = value;
+            }
+            standbyOverride = standbyOverride || standbyOverrides_.contains(sensor);
+        }
+
+        // Sensors that asked for longer intervals decimate on their own
+        foreach (QmSensorPrivate *sensor, subscribers_) {
+            int value = intervals_.value(sensor, 0);
+            sensor->decimationInterval_ = (interval > 0 && value > interval) ? value : 0;
+            if (interval > 0) {
+                sensor->meter_.setInterval(interval);
+            }
+        }
+
+        // 0 leaves the choice to sensord
+        if (interval != qMax(interval_, 0)) {
+            interface_->setInterval(interval);
+            interval_ = interval;
+        }
+        if (standbyOverride != standbyOverride_) {
+            interface_->setStandbyOverride(standbyOverride);
+            standbyOverride_ = standbyOverride;
+        }
+    }
+
+} // MeeGo namespace
@@ -0,0 +1,127 @@
+/*!
+ * @file qmsensorsession_p.h
+ * @brief Contains QmSensorSession
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORSESSION_P_H
+#define QMSENSORSESSION_P_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+
+#include "qmsensor.h"
+
+class AbstractSensorChannelInterface;
+
+namespace MeeGo
+{
+    class QmSensorPrivate;
+
+    /**
+     * A sensord session shared by all sensor objects of one kind in the
+     * process. Every sample crosses the IPC once and reaches the attached
+     * sensor objects through the signals of the one channel interface.
+     *
+     * Sessions are shared per thread, as the channel interface lives on
+     * the thread that opened it. A listener may attach to a control
+     * session, but a control request never attaches to a listen session.
+     *
+     * The channel runs while at least one attached sensor is started, at
+     * the shortest interval any of the started sensors asked for. Standby
+     * override is on if any of them asked for it.
+     */
+    class QmSensorSession
+    {
+    public:
+        /**
+         * Attaches the sensor to the session of its kind, opening the
+         * session if there is none.
+         *
+         * @return The session, or NULL if one could not be opened
+         */
+        static QmSensorSession* attach(QmSensorPrivate *sensor, QmSensor::SessionType type);
+
+        /**
+         * Stops and detaches the sensor. The last sensor to detach closes
+         * the session and deletes it.
+         */
+        void detach(QmSensorPrivate *sensor);
+
+        AbstractSensorChannelInterface* interface() { return interface_; }
+        QmSensor::SessionType type() const { return type_; }
+        int subscribers() const { return subscribers_.size(); }
+
+        void start(QmSensorPrivate *sensor);
+        void stop(QmSensorPrivate *sensor);
+
+        /**
+         * Returns the interval the sensor asked for, or the one of the
+         * channel if it did not ask for any.
+         */
+        int interval(QmSensorPrivate *sensor);
+        void setInterval(QmSensorPrivate *sensor, int value);
+
+        /**
+         * Returns the interval the sensor asked for, 0 if none.
+         */
+        int requestedInterval(QmSensorPrivate *sensor);
+
+        /**
+         * Returns the interval the channel runs at.
+         */
+        int sessionInterval();
+
+        bool standbyOverride(QmSensorPrivate *sensor);
+        void setStandbyOverride(QmSensorPrivate *sensor, bool value);
+
+    private:
+        QmSensorSession(const QByteArray &key, AbstractSensorChannelInterface *interface,
+                        QmSensor::SessionType type);
+        ~QmSensorSession();
+        Q_DISABLE_COPY(QmSensorSession)
+
+        static QByteArray key(QmSensorPrivate *sensor, QmSensor::SessionType type);
+
+        void negotiate();
+
+        static QHash<QByteArray, QmSensorSession*> sessions_;
+        static QMutex sessionsMutex_;
+
+        QByteArray key_;
+        AbstractSensorChannelInterface *interface_;
+        QmSensor::SessionType type_;
+
+        QSet<QmSensorPrivate*> subscribers_;
+        QSet<QmSensorPrivate*> running_;
+        QHash<QmSensorPrivate*, int> intervals_;
+        QSet<QmSensorPrivate*> standbyOverrides_;
+
+        // As last set on the channel, to avoid needless D-Bus calls
+        int interval_;
+        bool standbyOverride_;
+    };
+
+} // MeeGo namespace
+
+#endif // QMSENSORSESSION_P_H
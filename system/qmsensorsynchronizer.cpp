@@ -0,0 +1,290 @@
+/*!
+ * @file qmsensorsynchronizer.cpp
+ * @brief QmSensorSynchronizer
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include "qmsensorsynchronizer.h"
+#include "qmsensorsynchronizer_p.h"
+
+#include <QMetaType>
+
+#define SYNC_DEFAULT_LATENCY 50 /* ms */
+
+namespace MeeGo {
+
+    // ----------------- BEGIN PRIVATE CLASS DEFINITION ----------------- //
+
+    QmSensorSynchronizerPrivate::QmSensorSynchronizerPrivate()
+        : accelerometer(NULL), magnetometer(NULL), rotationSensor(NULL),
+          sources(0), interval(0), latency(SYNC_DEFAULT_LATENCY * 1000), last(0)
+    {
+    }
+
+    void QmSensorSynchronizerPrivate::attach(QmSensor *previous, QmSensor *sensor, QmSensorSynchronizer::Source source)
+    {
+        if (previous) {
+            disconnect(previous, 0, this, 0);
+        }
+        sources &= ~source;
+        reset();
+        if (!sensor) {
+            return;
+        }
+
+        sources |= source;
+        connect(sensor, SIGNAL(destroyed(QObject*)), this, SLOT(slotDestroyed(QObject*)));
+        switch (source) {
+            case QmSensorSynchronizer::Acceleration:
+                connect(sensor, SIGNAL(dataAvailable(const MeeGo::QmAccelerometerReading&)),
+                        this, SLOT(slotAcceleration(const MeeGo::QmAccelerometerReading&)));
+                connect(sensor, SIGNAL(dataAvailable(const QVector<MeeGo::QmAccelerometerReading>&)),
+                        this, SLOT(slotAcceleration(const QVector<MeeGo::QmAccelerometerReading>&)));
+                break;
+            case QmSensorSynchronizer::MagneticField:
+                connect(sensor, SIGNAL(dataAvailable(const MeeGo::QmMagnetometerReading&)),
+                        this, SLOT(slotMagneticField(const MeeGo::QmMagnetometerReading&)));
+                break;
+            case QmSensorSynchronizer::Rotation:
+                connect(sensor, SIGNAL(dataAvailable(const MeeGo::QmRotationReading&)),
+                        this, SLOT(slotRotation(const MeeGo::QmRotationReading&)));
+                connect(sensor, SIGNAL(dataAvailable(const QVector<MeeGo::QmRotationReading>&)),
+                        this, SLOT(slotRotation(const QVector<MeeGo::QmRotationReading>&)));
+                break;
+        }
+    }
+
+    void QmSensorSynchronizerPrivate::reset()
+    {
+        acceleration.clear();
+        magneticField.clear();
+        rotation.clear();
+        last = 0;
+    }
+
+    quint64 QmSensorSynchronizerPrivate::nextFrame() const
+    {
+        if (!interval) {
+            // Follow the first attached stream
+            if (sources & QmSensorSynchronizer::Acceleration) {
+                return acceleration.after(last);
+            }
+            if (sources & QmSensorSynchronizer::Rotation) {
+                return rotation.after(last);
+            }
+            return magneticField.after(last);
+        }
+
+        // The first reading of any stream after the last frame
+        quint64 following = 0;
+        quint64 candidates[3] = { acceleration.after(last), magneticField.after(last), rotation.after(last) };
+        for (int i = 0; i < 3; i++) {
+            if (candidates[i] && (!following || candidates[i] < following)) {
+                following = candidates[i];
+            }
+        }
+        if (!last) {
+            return following;
+        }
+
+        // When every stream has paused for longer than the latency, start
+        // over after the pause
+        quint64 next = last + interval;
+        if (following > next + latency) {
+            next = following;
+        }
+        return next;
+    }
+
+    void QmSensorSynchronizerPrivate::align()
+    {
+        for (;;) {
+            quint64 time = nextFrame();
+            if (!time) {
+                return;
+            }
+
+            bool complete = true;
+            bool full = false;
+            quint64 newest = 0;
+            if (sources & QmSensorSynchronizer::Acceleration) {
+                complete = complete && !acceleration.isEmpty() && acceleration.newest() >= time;
+                full = full || acceleration.isFull();
+                newest = qMax(newest, acceleration.isEmpty() ? 0 : acceleration.newest());
+            }
+            if (sources & QmSensorSynchronizer::MagneticField) {
+                complete = complete && !magneticField.isEmpty() && magneticField.newest() >= time;
+                full = full || magneticField.isFull();
+                newest = qMax(newest, magneticField.isEmpty() ? 0 : magneticField.newest());
+            }
+            if (sources & QmSensorSynchronizer::Rotation) {
+                complete = complete && !rotation.isEmpty() && rotation.newest() >= time;
+                full = full || rotation.isFull();
+                newest = qMax(newest, rotation.isEmpty() ? 0 : rotation.newest());
+            }
+            if (!complete && !full && newest < time + latency) {
+                return;
+            }
+
+            QmSynchronizedReading frame;
+            frame.timestamp = time;
+            frame.sources = 0;
+            frame.acceleration = QmAccelerometerReading();
+            frame.magneticField = QmMagnetometerReading();
+            frame.rotation = QmRotationReading();
+            if ((sources & QmSensorSynchronizer::Acceleration) && !acceleration.isEmpty()) {
+                frame.acceleration = acceleration.sample(time);
+                frame.sources |= QmSensorSynchronizer::Acceleration;
+            }
+            if ((sources & QmSensorSynchronizer::MagneticField) && !magneticField.isEmpty()) {
+                frame.magneticField = magneticField.sample(time);
+                frame.sources |= QmSensorSynchronizer::MagneticField;
+            }
+            if ((sources & QmSensorSynchronizer::Rotation) && !rotation.isEmpty()) {
+                frame.rotation = rotation.sample(time);
+                frame.sources |= QmSensorSynchronizer::Rotation;
+            }
+
+            acceleration.discard(time);
+            magneticField.discard(time);
+            rotation.discard(time);
+            last = time;
+
+            emit frameAvailable(frame);
+        }
+    }
+
+    void QmSensorSynchronizerPrivate::slotAcceleration(const MeeGo::QmAccelerometerReading& data)
+    {
+        acceleration.append(data);
+        align();
+    }
+
+    void QmSensorSynchronizerPrivate::slotAcceleration(const QVector<MeeGo::QmAccelerometerReading>& data)
+    {
+        for (int i = 0; i < data.size(); i++) {
+            acceleration.append(data[i]);
+            align();
+        }
+    }
+
+    void QmSensorSynchronizerPrivate::slotMagneticField(const MeeGo::QmMagnetometerReading& data)
+    {
+        magneticField.append(data);
+        align();
+    }
+
+    void QmSensorSynchronizerPrivate::slotRotation(const MeeGo::QmRotationReading& data)
+    {
+        rotation.append(data);
+        align();
+    }
+
+    void QmSensorSynchronizerPrivate::slotRotation(const QVector<MeeGo::QmRotationReading>& data)
+    {
+        for (int i = 0; i < data.size(); i++) {
+            rotation.append(data[i]);
+            align();
+        }
+    }
+
+    void QmSensorSynchronizerPrivate::slotDestroyed(QObject *sensor)
+    {
+        // Only the QObject part is left, compare addresses
+        if (sensor == accelerometer) {
+            attach(NULL, NULL, QmSensorSynchronizer::Acceleration);
+            accelerometer = NULL;
+        } else if (sensor == magnetometer) {
+            attach(NULL, NULL, QmSensorSynchronizer::MagneticField);
+            magnetometer = NULL;
+        } else if (sensor == rotationSensor) {
+            attach(NULL, NULL, QmSensorSynchronizer::Rotation);
+            rotationSensor = NULL;
+        }
+    }
+
+    // ----------------- BEGIN PUBLIC CLASS DEFINITION ----------------- //
+
+    QmSensorSynchronizer::QmSensorSynchronizer(QObject *parent) : QObject(parent)
+    {
+        MEEGO_INITIALIZE(QmSensorSynchronizer);
+        connect(priv, SIGNAL(frameAvailable(MeeGo::QmSynchronizedReading)), this, SIGNAL(frameAvailable(MeeGo::QmSynchronizedReading)));
+    }
+
+    QmSensorSynchronizer::~QmSensorSynchronizer()
+    {
+        MEEGO_UNINITIALIZE(QmSensorSynchronizer);
+    }
+
+    void QmSensorSynchronizer::setAccelerometer(QmAccelerometer *sensor)
+    {
+        MEEGO_PRIVATE(QmSensorSynchronizer);
+        priv->attach(priv->accelerometer, sensor, Acceleration);
+        priv->accelerometer = sensor;
+    }
+
+    void QmSensorSynchronizer::setMagnetometer(QmMagnetometer *sensor)
+    {
+        MEEGO_PRIVATE(QmSensorSynchronizer);
+        priv->attach(priv->magnetometer, sensor, MagneticField);
+        priv->magnetometer = sensor;
+    }
+
+    void QmSensorSynchronizer::setRotation(QmRotation *sensor)
+    {
+        MEEGO_PRIVATE(QmSensorSynchronizer);
+        priv->attach(priv->rotationSensor, sensor, Rotation);
+        priv->rotationSensor = sensor;
+    }
+
+    void QmSensorSynchronizer::setInterval(int value)
+    {
+        MEEGO_PRIVATE(QmSensorSynchronizer);
+        priv->interval = (quint64)qMax(0, value) * 1000;
+        priv->reset();
+    }
+
+    int QmSensorSynchronizer::interval() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorSynchronizer);
+        return priv->interval / 1000;
+    }
+
+    void QmSensorSynchronizer::setLatency(int value)
+    {
+        MEEGO_PRIVATE(QmSensorSynchronizer);
+        priv->latency = (quint64)qMax(0, value) * 1000;
+    }
+
+    int QmSensorSynchronizer::latency() const
+    {
+        MEEGO_PRIVATE_CONST(QmSensorSynchronizer);
+        return priv->latency / 1000;
+    }
+
+    void QmSensorSynchronizer::reset()
+    {
+        MEEGO_PRIVATE(QmSensorSynchronizer);
+        priv->reset();
+    }
+
+}
@@ -0,0 +1,171 @@
+/*!
+ * @file qmsensorsynchronizer.h
+ * @brief Contains QmSensorSynchronizer, which aligns the readings of several sensors in time.
+
+   <p>
+   @copyright (C) 2009-2011 Nokia Corporation
+   @license LGPL Lesser General Public License
+
+   @scope Internal
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORSYNCHRONIZER_H
+#define QMSENSORSYNCHRONIZER_H
+
+#include "system_global.h"
+#include <QtCore/qobject.h>
+#include <qmaccelerometer.h>
+#include <qmmagnetometer.h>
+#include <qmrotation.h>
+
+QT_BEGIN_HEADER
+
+namespace MeeGo {
+
+    class QmSensorSynchronizerPrivate;
+
+    /**
+     * Readings of several sensors at one point of time. The timestamp of
+     * the frame is also the timestamp of each reading in it.
+     */
+    class QmSynchronizedReading : public QmSensorReading
+    {
+    public:
+        int sources;                            /**< Combination of QmSensorSynchronizer::Source, the readings set in this frame */
+        QmAccelerometerReading acceleration;
+        QmMagnetometerReading magneticField;
+        QmRotationReading rotation;
+    };
+
+    /**
+     * @scope Internal
+     *
+     * @brief Aligns the readings of several sensors in time.
+     *
+     * Each sensor delivers readings at its own rate and with its own delay.
+     * The synchronizer buffers the streams of the attached sensors and
+     * delivers frames, in which the reading of every sensor is linearly
+     * interpolated to the time of the frame. Rotation angles are
+     * interpolated across the wrap-around point.
+     *
+     * The frames follow the readings of the first attached sensor of
+     * accelerometer, rotation and magnetometer, or a fixed timebase set
+     * with #setInterval(). On a fixed timebase, a pause of all sensors
+     * longer than #latency() starts the timebase over after the pause.
+     *
+     * A frame is delivered as soon as every sensor has a reading at or
+     * after its time. A sensor that lags behind by more than #latency()
+     * does not hold the others back: its latest reading is used as is, or
+     * it is left out of the frame if it has not delivered anything yet.
+     * Each stream buffers at most 64 readings; when one is full, the
+     * pending frames are delivered without waiting.
+     *
+     * The sensors are used as they are configured by the application,
+     * which opens their sessions and starts them. Readings read through
+     * QmSensor::read() in consumer mode do not reach the synchronizer.
+     */
+    class MEEGO_SYSTEM_EXPORT QmSensorSynchronizer : public QObject
+    {
+        Q_OBJECT;
+
+    public:
+        /** Sensors of a frame */
+        enum Source {
+            Acceleration = 0x1,     /**< QmAccelerometer */
+            MagneticField = 0x2,    /**< QmMagnetometer */
+            Rotation = 0x4          /**< QmRotation */
+        };
+
+        /**
+         * Constructor
+         * @param parent Parent QObject.
+         */
+        QmSensorSynchronizer(QObject *parent = 0);
+
+        /**
+         * Destructor
+         */
+        ~QmSensorSynchronizer();
+
+        /**
+         * Attaches an accelerometer, replacing the previous one.
+         * @param sensor The sensor, NULL to detach
+         */
+        void setAccelerometer(QmAccelerometer *sensor);
+
+        /**
+         * Attaches a magnetometer, replacing the previous one.
+         * @param sensor The sensor, NULL to detach
+         */
+        void setMagnetometer(QmMagnetometer *sensor);
+
+        /**
+         * Attaches a rotation sensor, replacing the previous one.
+         * @param sensor The sensor, NULL to detach
+         */
+        void setRotation(QmRotation *sensor);
+
+        /**
+         * Sets the timebase of the frames.
+         * @param value Interval between frames in ms, 0 to follow the
+         *              readings of the first sensor. Default is 0.
+         */
+        void setInterval(int value);
+
+        /**
+         * Returns the interval between frames, see #setInterval().
+         * @return Interval in ms
+         */
+        int interval() const;
+
+        /**
+         * Sets how long a frame waits for a sensor that lags behind. Longer
+         * waits deliver more complete frames later.
+         * @param value Latency in ms, default 50
+         */
+        void setLatency(int value);
+
+        /**
+         * Returns the latency, see #setLatency().
+         * @return Latency in ms
+         */
+        int latency() const;
+
+        /**
+         * Drops the buffered readings. The next frame starts a new timebase.
+         */
+        void reset();
+
+    Q_SIGNALS:
+        /**
+         * Signals the availability of a new frame.
+         * @param frame The frame
+         */
+        void frameAvailable(const MeeGo::QmSynchronizedReading& frame);
+
+    private:
+        Q_DISABLE_COPY(QmSensorSynchronizer)
+        MEEGO_DECLARE_PRIVATE(QmSensorSynchronizer)
+    };
+
+} // MeeGo namespace
+
+Q_DECLARE_TYPEINFO(MeeGo::QmSynchronizedReading, Q_PRIMITIVE_TYPE);
+
+QT_END_HEADER
+
+#endif
@@ -0,0 +1,199 @@
+/*!
+ * @file qmsensorsynchronizer_p.h
+ * @brief Contains QmSensorSynchronizerPrivate
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORSYNCHRONIZER_P_H
+#define QMSENSORSYNCHRONIZER_P_H
+
+#include "qmaccelerometer_p.h"
+#include "qmmagnetometer_p.h"
+#include "qmrotation_p.h"
+#include "qmsensorsynchronizer.h"
+
+#include <QVector>
+
+/* Readings buffered per stream */
+#define SYNC_BUFFER_MAX 64
+
+namespace MeeGo
+{
+    /**
+     * Readings of one stream in time order, for interpolation at any time
+     * between the oldest and the newest. The buffer has a fixed capacity
+     * and drops the oldest reading when full.
+     */
+    template <typename Reading>
+    class QmSensorAlignBuffer
+    {
+    public:
+        typedef QmSensorChannels<Reading> Channels;
+
+        QmSensorAlignBuffer() : first_(0), count_(0) {}
+
+        void clear()
+        {
+            first_ = count_ = 0;
+        }
+
+        bool isEmpty() const { return count_ == 0; }
+        bool isFull() const { return count_ == SYNC_BUFFER_MAX; }
+        int count() const { return count_; }
+
+        const Reading& at(int i) const
+        {
+            return readings_[(first_ + i) % SYNC_BUFFER_MAX];
+        }
+
+        quint64 oldest() const { return at(0).timestamp; }
+        quint64 newest() const { return at(count_ - 1).timestamp; }
+
+        /**
+         * Adds a reading. Readings that are not newer than the newest one
+         * are dropped.
+         */
+        void append(const Reading& reading)
+        {
+            if (count_ && reading.timestamp <= newest()) {
+                return;
+            }
+            if (count_ == SYNC_BUFFER_MAX) {
+                first_ = (first_ + 1) % SYNC_BUFFER_MAX;
+                count_--;
+            }
+            readings_[(first_ + count_) % SYNC_BUFFER_MAX] = reading;
+            count_++;
+        }
+
+        /**
+         * Returns the timestamp of the first reading after \c time, 0 if
+         * there is none.
+         */
+        quint64 after(quint64 time) const
+        {
+            for (int i = 0; i < count_; i++) {
+                if (at(i).timestamp > time) {
+                    return at(i).timestamp;
+                }
+            }
+            return 0;
+        }
+
+        /**
+         * Returns the reading at \c time, interpolated between the readings
+         * around it. Before the oldest and after the newest reading, that
+         * reading is held. Fields that are not channels are taken from the
+         * nearer reading.
+         */
+        Reading sample(quint64 time) const
+        {
+            int next = 0;
+            while (next < count_ && at(next).timestamp < time) {
+                next++;
+            }
+
+            Reading output;
+            if (next == 0 || next == count_) {
+                output = at(next == 0 ? 0 : count_ - 1);
+            } else {
+                Reading a = at(next - 1);
+                Reading b = at(next);
+                double f = (double)(time - a.timestamp) / (b.timestamp - a.timestamp);
+                output = f < 0.5 ? a : b;
+                for (int i = 0; i < Channels::Count; i++) {
+                    int from = Channels::at(a, i);
+                    int to = unwrapChannel<Channels>(Channels::at(b, i), from, i);
+                    Channels::at(output, i) = wrapChannel<Channels>(from + qRound(f * (to - from)), i);
+                }
+            }
+            output.timestamp = time;
+            return output;
+        }
+
+        /**
+         * Drops the readings that are not needed for interpolation at
+         * \c time or later.
+         */
+        void discard(quint64 time)
+        {
+            while (count_ > 1 && at(1).timestamp <= time) {
+                first_ = (first_ + 1) % SYNC_BUFFER_MAX;
+                count_--;
+            }
+        }
+
+    private:
+        Reading readings_[SYNC_BUFFER_MAX];
+        int first_;
+        int count_;
+    };
+
+    class QmSensorSynchronizerPrivate : public QObject
+    {
+        Q_OBJECT;
+        MEEGO_DECLARE_PUBLIC(QmSensorSynchronizer)
+
+    public:
+        QmSensorSynchronizerPrivate();
+
+        /* Cleared when the sensor is destroyed */
+        QmAccelerometer *accelerometer;
+        QmMagnetometer *magnetometer;
+        QmRotation *rotationSensor;
+
+        QmSensorAlignBuffer<QmAccelerometerReading> acceleration;
+        QmSensorAlignBuffer<QmMagnetometerReading> magneticField;
+        QmSensorAlignBuffer<QmRotationReading> rotation;
+
+        /* Attached streams, QmSensorSynchronizer::Source */
+        int sources;
+        /* Microseconds, like the timestamps */
+        quint64 interval;
+        quint64 latency;
+        /* Time of the last frame, 0 before the first */
+        quint64 last;
+
+        void attach(QmSensor *previous, QmSensor *sensor, QmSensorSynchronizer::Source source);
+        void reset();
+
+        /**
+         * Delivers the frames that are complete or have waited long
+         * enough.
+         */
+        void align();
+
+    private:
+        quint64 nextFrame() const;
+
+    Q_SIGNALS:
+        void frameAvailable(const MeeGo::QmSynchronizedReading& frame);
+
+    public Q_SLOTS:
+        void slotAcceleration(const MeeGo::QmAccelerometerReading& data);
+        void slotAcceleration(const QVector<MeeGo::QmAccelerometerReading>& data);
+        void slotMagneticField(const MeeGo::QmMagnetometerReading& data);
+        void slotRotation(const MeeGo::QmRotationReading& data);
+        void slotRotation(const QVector<MeeGo::QmRotationReading>& data);
+        void slotDestroyed(QObject *sensor);
+    };
+}
+#endif // QMSENSORSYNCHRONIZER_P_H
@@ -0,0 +1,277 @@
+/*!
+ * @file qmsensortrace.cpp
+ * @brief Sensor trace file reading and writing
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+#include "qmsensortrace_p.h"
+
+#include <QDebug>
+#include <QFile>
+
+extern "C" {
+#include <string.h>
+}
+
+namespace MeeGo {
+
+/* The layout is the file format */
+typedef char QmTraceHeaderSize[sizeof(QmTraceHeader) == 16 ? 1 : -1];
+typedef char QmTraceRecordSize[sizeof(QmTraceRecord) == 40 ? 1 : -1];
+
+/* Indexed by QmTraceSensor */
+static const char *const trace_sensor_ids[TraceSensorCount] = {
+    "accelerometersensor",
+    "rotationsensor",
+    "magnetometersensor",
+    "compasssensor",
+    "alssensor",
+    "proximitysensor",
+    "orientationsensor",
+    "tapsensor"
+};
+
+/* The sensord interface signal of each sensor, indexed by QmTraceSensor */
+static const struct {
+    const char *signal;
+    const char *slot;
+} trace_sensor_signals[TraceSensorCount] = {
+    { SIGNAL(dataAvailable(const XYZ&)), SLOT(slotXyz(const XYZ&)) },
+    { SIGNAL(dataAvailable(const XYZ&)), SLOT(slotXyz(const XYZ&)) },
+    { SIGNAL(dataAvailable(const MagneticField&)), SLOT(slotMagneticField(const MagneticField&)) },
+    { SIGNAL(dataAvailable(const Compass&)), SLOT(slotCompass(const Compass&)) },
+    { SIGNAL(ALSChanged(const Unsigned&)), SLOT(slotUnsigned(const Unsigned&)) },
+    { SIGNAL(dataAvailable(const Unsigned&)), SLOT(slotUnsigned(const Unsigned&)) },
+    { SIGNAL(orientationChanged(const Unsigned&)), SLOT(slotUnsigned(const Unsigned&)) },
+    { SIGNAL(dataAvailable(const Tap&)), SLOT(slotTap(const Tap&)) }
+};
+
+/* Indexed by QmTraceSensor */
+static const int trace_sensor_values[TraceSensorCount] = { 3, 3, 7, 2, 1, 1, 1, 2 };
+
+int traceValues(int sensor)
+{
+    return trace_sensor_values[sensor];
+}
+
+static uchar *put_varint(uchar *out, quint64 value)
+{
+    while (value >= 0x80) {
+        *out++ = (uchar)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uchar)value;
+    return out;
+}
+
+/* Returns the bytes read, 0 if the data ends first, -1 if too long */
+static int get_varint(const uchar *in, int size, quint64 *value)
+{
+    *value = 0;
+    for (int i = 0; i < 10; i++) {
+        if (i == size)
+            return 0;
+        *value |= (quint64)(in[i] & 0x7f) << (7 * i);
+        if (!(in[i] & 0x80))
+            return i + 1;
+    }
+    return -1;
+}
+
+static quint64 zigzag(qint64 value)
+{
+    return ((quint64)value << 1) ^ (quint64)(value >> 63);
+}
+
+static qint64 unzigzag(quint64 value)
+{
+    return (qint64)(value >> 1) ^ -(qint64)(value & 1);
+}
+
+/*------------ class QmTraceCoder ------------*/
+
+void QmTraceCoder::reset()
+{
+    memset(timestamp_, 0, sizeof(timestamp_));
+    memset(step_, 0, sizeof(step_));
+    memset(values_, 0, sizeof(values_));
+}
+
+int QmTraceCoder::encode(const QmTraceRecord &record, uchar *out)
+{
+    int sensor = record.sensor;
+    uchar *end = out;
+    *end++ = (uchar)sensor;
+
+    /* Steady intervals make the step change close to 0 */
+    quint64 step = record.timestamp - timestamp_[sensor];
+    end = put_varint(end, zigzag((qint64)(step - step_[sensor])));
+    timestamp_[sensor] = record.timestamp;
+    step_[sensor] = step;
+
+    qint32 *previous = values_[sensor];
+    for (int i = 0; i < trace_sensor_values[sensor]; i++) {
+        end = put_varint(end, zigzag((qint64)record.values[i] - previous[i]));
+        previous[i] = record.values[i];
+    }
+    return end - out;
+}
+
+int QmTraceCoder::decode(const uchar *in, int size, QmTraceRecord *record)
+{
+    if (size == 0)
+        return 0;
+    int sensor = in[0];
+    if (sensor >= TraceSensorCount)
+        return -1;
+
+    /* Nothing changes until the whole record is there */
+    qint64 changes[1 + TRACE_VALUES];
+    int count = 1 + trace_sensor_values[sensor];
+    int used = 1;
+    for (int i = 0; i < count; i++) {
+        quint64 value;
+        int length = get_varint(in + used, size - used, &value);
+        if (length <= 0)
+            return length;
+        changes[i] = unzigzag(value);
+        used += length;
+    }
+
+    memset(record, 0, sizeof(*record));
+    record->sensor = sensor;
+    step_[sensor] += (quint64)changes[0];
+    timestamp_[sensor] += step_[sensor];
+    record->timestamp = timestamp_[sensor];
+    qint32 *previous = values_[sensor];
+    for (int i = 0; i < trace_sensor_values[sensor]; i++) {
+        previous[i] = (qint32)(previous[i] + changes[1 + i]);
+        record->values[i] = previous[i];
+    }
+    return used;
+}
+
+int traceSensor(const char *sensorId)
+{
+    for (int i = 0; i < TraceSensorCount; i++) {
+        if (strcmp(sensorId, trace_sensor_ids[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+bool traceConnect(QObject *source, int sensor, QObject *receiver, bool setOn)
+{
+    if (setOn) {
+        return QObject::connect(source, trace_sensor_signals[sensor].signal,
+                                receiver, trace_sensor_signals[sensor].slot);
+    }
+    return QObject::disconnect(source, trace_sensor_signals[sensor].signal,
+                               receiver, trace_sensor_signals[sensor].slot);
+}
+
+bool traceLoad(const QString &path, QVector<QmTraceRecord> *records)
+{
+    records->clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Can't open" << path << file.errorString();
+        return false;
+    }
+
+    QmTraceHeader header;
+    if (file.read((char *)&header, sizeof(header)) != sizeof(header)
+        || header.magic != TRACE_MAGIC
+        || header.version != TRACE_VERSION
+        || (header.encoding != TraceEncodingRaw && header.encoding != TraceEncodingDelta)) {
+        qWarning() << path << "is not a sensor trace";
+        return false;
+    }
+
+    if (header.encoding == TraceEncodingDelta) {
+        QByteArray data = file.readAll();
+        const uchar *in = (const uchar *)data.constData();
+        int size = data.size();
+        QmTraceCoder coder;
+        QmTraceRecord record;
+        int used;
+        /* A record torn by a crash of the writer ends the trace */
+        while ((used = coder.decode(in, size, &record)) > 0) {
+            records->append(record);
+            in += used;
+            size -= used;
+        }
+        if (used < 0)
+            qWarning() << path << "is damaged after" << records->size() << "records";
+        return true;
+    }
+
+    /* A record torn by a crash of the writer is dropped */
+    qint64 count = (file.size() - sizeof(header)) / sizeof(QmTraceRecord);
+    records->resize(count);
+    qint64 size = count * sizeof(QmTraceRecord);
+    if (file.read((char *)records->data(), size) != size) {
+        records->clear();
+        return false;
+    }
+
+    /* Records of unknown sensors would index past the channel table */
+    int kept = 0;
+    for (int i = 0; i < records->size(); i++) {
+        if ((*records)[i].sensor < TraceSensorCount)
+            (*records)[kept++] = (*records)[i];
+    }
+    records->resize(kept);
+    return true;
+}
+
+bool traceSave(const QString &path, const QVector<QmTraceRecord> &records,
+               QmTraceEncoding encoding)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Can't open" << path << file.errorString();
+        return false;
+    }
+
+    QmTraceHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.encoding = encoding;
+    if (file.write((const char *)&header, sizeof(header)) != sizeof(header))
+        return false;
+
+    if (encoding == TraceEncodingDelta) {
+        QByteArray data(records.size() * TRACE_ENCODED_MAX, 0);
+        uchar *out = (uchar *)data.data();
+        QmTraceCoder coder;
+        for (int i = 0; i < records.size(); i++)
+            out += coder.encode(records[i], out);
+        qint64 size = out - (uchar *)data.data();
+        return file.write(data.constData(), size) == size;
+    }
+
+    qint64 size = records.size() * sizeof(QmTraceRecord);
+    return file.write((const char *)records.constData(), size) == size;
+}
+
+} /* MeeGo */
@@ -0,0 +1,140 @@
+/*!
+ * @file qmsensortrace_p.h
+ * @brief Contains the sensor trace file format
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   @scope Private
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#ifndef QMSENSORTRACE_P_H
+#define QMSENSORTRACE_P_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#define TRACE_MAGIC 0x54534d51 /* "QMST" */
+#define TRACE_VERSION 1
+#define TRACE_VALUES 7
+
+/* Bytes of a record in the delta encoding, at most */
+#define TRACE_ENCODED_MAX 48
+
+namespace MeeGo {
+
+/* Record encodings, see QmTraceHeader */
+enum QmTraceEncoding
+{
+    TraceEncodingRaw = 0,   /* QmTraceRecord as is */
+    TraceEncodingDelta = 1  /* QmTraceCoder */
+};
+
+/*
+ * Sensors of a trace. The values of a record are those of the sensord
+ * data type of the sensor, before any conversion by the sensor classes:
+ *
+ *   accelerometer, rotation  XYZ            x, y, z
+ *   magnetometer             MagneticField  x, y, z, rx, ry, rz, level
+ *   compass                  Compass        degrees, level
+ *   als, proximity,
+ *   orientation              Unsigned       value
+ *   tap                      Tap            direction, type
+ */
+enum QmTraceSensor
+{
+    TraceAccelerometer,
+    TraceRotation,
+    TraceMagnetometer,
+    TraceCompass,
+    TraceAls,
+    TraceProximity,
+    TraceOrientation,
+    TraceTap,
+    TraceSensorCount
+};
+
+/*
+ * A trace is this header followed by records in time order, in the
+ * native byte order of the device that wrote it.
+ */
+struct QmTraceHeader
+{
+    quint32 magic;
+    quint16 version;
+    quint16 encoding;
+    quint32 reserved[2];
+};
+
+struct QmTraceRecord
+{
+    quint64 timestamp;      /* us, as given by sensord */
+    quint8 sensor;          /* QmTraceSensor */
+    quint8 reserved[3];
+    qint32 values[TRACE_VALUES];
+};
+
+/*
+ * The delta encoding. A record is the sensor byte followed by zigzag
+ * varints: the change of the timestamp step, then the change of each
+ * value used by the sensor, both from the previous record of the same
+ * sensor. A steady stream of a device at rest takes a few bytes per
+ * reading. Encoder and decoder each keep the previous records.
+ */
+class QmTraceCoder
+{
+public:
+    QmTraceCoder() { reset(); }
+
+    void reset();
+
+    /* Writes at most TRACE_ENCODED_MAX bytes; returns the bytes written */
+    int encode(const QmTraceRecord &record, uchar *out);
+
+    /* Returns the bytes read, 0 if the data ends inside the record, -1 if it is not a record */
+    int decode(const uchar *in, int size, QmTraceRecord *record);
+
+private:
+    quint64 timestamp_[TraceSensorCount];
+    quint64 step_[TraceSensorCount];
+    qint32 values_[TraceSensorCount][TRACE_VALUES];
+};
+
+/* The number of values used by a sensor, see QmTraceSensor */
+int traceValues(int sensor);
+
+/* The sensor of a sensord sensor id, -1 if it is not traced */
+int traceSensor(const char *sensorId);
+
+/*
+ * Connects the sensord interface signal of the sensor to the slot of its
+ * data type in the receiver, or disconnects it: slotXyz(const XYZ&),
+ * slotMagneticField(const MagneticField&), slotCompass(const Compass&),
+ * slotUnsigned(const Unsigned&) or slotTap(const Tap&).
+ */
+bool traceConnect(QObject *source, int sensor, QObject *receiver, bool setOn);
+
+/* Reads a whole trace; returns false if the file is missing or not a trace */
+bool traceLoad(const QString &path, QVector<QmTraceRecord> *records);
+
+/* Writes a whole trace */
+bool traceSave(const QString &path, const QVector<QmTraceRecord> &records,
+               QmTraceEncoding encoding = TraceEncodingRaw);
+
+} /* MeeGo */
+#endif /* QMSENSORTRACE_P_H */
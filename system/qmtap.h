@@ -134,6 +134,8 @@ namespace MeeGo {
 
 } // MeeGo namespace
 
+Q_DECLARE_TYPEINFO(MeeGo::QmTapReading, Q_PRIMITIVE_TYPE);
+
 QT_END_HEADER
 
 #endif
@@ -51,12 +51,17 @@ namespace MeeGo
             closeSession();
         }
 
+        const char* sensorId()
+        {
+            return "tapsensor";
+        }
+
         bool init()
         {
             qDBusRegisterMetaType<Tap>();
             SensorManagerInterface& remoteSensorManager = SensorManagerInterface::instance();
-            remoteSensorManager.loadPlugin("tapsensor");
-            remoteSensorManager.registerSensorInterface<TapSensorChannelInterface>("tapsensor");
+            remoteSensorManager.loadPlugin(sensorId());
+            remoteSensorManager.registerSensorInterface<TapSensorChannelInterface>(sensorId());
             initDone_ = true;
             return true;
         }
@@ -64,33 +69,33 @@ namespace MeeGo
         AbstractSensorChannelInterface* controlSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return TapSensorChannelInterface::controlInterface("tapsensor");
+            return TapSensorChannelInterface::controlInterface(sensorId());
         }
 
         const AbstractSensorChannelInterface* listenSession()
         {
             if (!initDone_) { if (!init()) return NULL; }
-            return TapSensorChannelInterface::listenInterface("tapsensor");
+            return TapSensorChannelInterface::listenInterface(sensorId());
         }
 
         bool setupSignals(bool setOn)
         {
 
-            if (sensorIfc == NULL) {
+            if (source() == NULL) {
                 setError("No session open, unable to (dis)connect signals.");
                 return false;
             }
 
             if (setOn) {
 
-                if (!connect(sensorIfc, SIGNAL(dataAvailable(const Tap&)),
+                if (!connect(source(), SIGNAL(dataAvailable(const Tap&)),
                         this, SLOT(slotTapped(const Tap&)))) {
                     setError("Unable to connect signals");
                     return false;
                 }
 
             } else {
-                if (!disconnect(sensorIfc, SIGNAL(dataAvailable(const Tap&)),
+                if (!disconnect(source(), SIGNAL(dataAvailable(const Tap&)),
                         this, SLOT(slotTapped(const Tap&)))) {
                     setError("Unable to disconnect signals");
                     return false;
@@ -106,12 +111,15 @@ namespace MeeGo
 
         void slotTapped(const Tap& tap)
         {
+            QmSensorProbe probe(meter_, tap.tapData().timestamp_);
             QmTapReading output;
             output.timestamp = tap.tapData().timestamp_;
             output.direction = (QmTap::Direction)(tap.tapData().direction_);
             output.type = (QmTap::Type)(tap.tapData().type_);
 
-            emit tapped(output);
+            if (!consume(output)) {
+                emit tapped(output);
+            }
         }
     };
 }
@@ -39,6 +39,8 @@ HEADERS += mainpage.h \
     qmals.h \
     qmals_p.h \
     qmbattery.h \
+    qmbatteryhistory.h \
+    qmbatteryhistory_p.h \
     qmcabc.h \
     qmcallstate.h \
     qmcallstate_p.h \
@@ -48,6 +50,10 @@ HEADERS += mainpage.h \
     qmdevicemode_p.h \
     qmdisplaystate.h \
     qmdisplaystate_p.h \
+    qmfusedorientation.h \
+    qmfusedorientation_p.h \
+    qmgesture.h \
+    qmgesture_p.h \
     qmheartbeat.h \
     qmheartbeat_p.h \
     qmipcinterface_p.h \
@@ -58,6 +64,7 @@ HEADERS += mainpage.h \
     qmlocks_p.h \
     qmmagnetometer.h \
     qmmagnetometer_p.h \
+    qmmagnetometercalibration_p.h \
     qmorientation.h \
     qmorientation_p.h \
     qmproximity.h \
@@ -66,6 +73,20 @@ HEADERS += mainpage.h \
     qmrotation_p.h \
     qmsensor.h \
     qmsensor_p.h \
+    qmsensorarena_p.h \
+    qmsensorfilter.h \
+    qmsensorgovernor.h \
+    qmsensorgovernor_p.h \
+    qmsensorkernels_p.h \
+    qmsensorrecorder.h \
+    qmsensorrecorder_p.h \
+    qmsensorreplay.h \
+    qmsensorreplay_p.h \
+    qmsensorring_p.h \
+    qmsensorsession_p.h \
+    qmsensorsynchronizer.h \
+    qmsensorsynchronizer_p.h \
+    qmsensortrace_p.h \
     qmsysteminformation.h \
     qmsysteminformation_p.h \
     qmsystemstate.h \
@@ -84,11 +105,14 @@ HEADERS += mainpage.h \
 SOURCES += qmactivity.cpp \
     qmaccelerometer.cpp \ 
     qmals.cpp \
+    qmbatteryhistory.cpp \
     qmcabc.cpp \
     qmcallstate.cpp \
     qmcompass.cpp \
     qmdevicemode.cpp \
     qmdisplaystate.cpp \
+    qmfusedorientation.cpp \
+    qmgesture.cpp \
     qmheartbeat.cpp \
     qmipcinterface.cpp \
     qmkeys.cpp \
@@ -102,19 +126,53 @@ SOURCES += qmactivity.cpp \
     qmproximity.cpp \
     qmtime.cpp \
     qmsensor.cpp \
+    qmsensorarena.cpp \
+    qmsensorfilter.cpp \
+    qmsensorgovernor.cpp \
+    qmsensorkernels.cpp \
+    qmsensorrecorder.cpp \
+    qmsensorreplay.cpp \
+    qmsensorring.cpp \
+    qmsensorsession.cpp \
+    qmsensorsynchronizer.cpp \
+    qmsensortrace.cpp \
     qmrotation.cpp \
     qmmagnetometer.cpp \
+    qmmagnetometercalibration.cpp \
     qmwatchdog.cpp \
     qmusbmode.cpp
 
 linux-g++-maemo {
     message("Compiling with bmeipc support")
+    DEFINES += HAVE_BMEIPC
     PKGCONFIG += bmeipc
-    HEADERS += qmbattery_p.h
-    SOURCES += qmbattery.cpp
 } else {
     message("Compiling without bmeipc support")
-    SOURCES += qmbattery_stub.cpp 
+}
+
+bmesim {
+    # For tests and benchmarks only, QmBattery can be pointed at
+    # tests/battery_simulator with $QMSYSTEM_BME_SIMULATOR
+    message("Compiling with the battery simulator backend")
+    DEFINES += QMSYSTEM_BME_SIMULATOR
+}
+
+linux-g++-maemo|bmesim {
+    HEADERS += qmbattery_p.h \
+        qmbatterybackend_p.h \
+        qmbatteryenergy_p.h \
+        qmbatterysim_p.h
+    SOURCES += qmbattery.cpp \
+        qmbatterybackend.cpp \
+        qmbatteryenergy.cpp
+    !linux-g++-maemo {
+        # The BME wire definitions shared with the battery simulator,
+        # which is QmBattery's only backend then
+        INCLUDEPATH += bmewire
+        LIBS += -lrt
+    }
+} else {
+    SOURCES += qmbattery_stub.cpp
 }
 
 contextsubscriber { 
@@ -35,10 +35,22 @@ class SignalDump : public QObject {
     Q_OBJECT
 
 public:
-    SignalDump(QObject *parent = NULL) : QObject(parent) {}
+    SignalDump(QObject *parent = NULL) : QObject(parent), batches(0), largestBatch(0), emptyBatches(0) {}
+
+    int batches;
+    int largestBatch;
+    int emptyBatches;
 
 public slots:
     void receive(const MeeGo::QmAccelerometerReading&) {}
+
+    void receiveBatch(const QVector<MeeGo::QmAccelerometerReading>& data) {
+        batches++;
+        largestBatch = qMax(largestBatch, data.size());
+        if (data.isEmpty()) {
+            emptyBatches++;
+        }
+    }
 };
 
 class TestClass : public QObject
@@ -70,6 +82,70 @@ private slots:
         QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
     }
 
+    void testBatch() {
+        QCOMPARE(sensor->batchSize(), 0);
+        QVERIFY(connect(sensor, SIGNAL(dataAvailable(const QVector<MeeGo::QmAccelerometerReading>&)),
+                &signalDump, SLOT(receiveBatch(const QVector<MeeGo::QmAccelerometerReading>&))));
+
+        sensor->setBatchSize(10, 100);
+        QCOMPARE(sensor->batchSize(), 10);
+
+        QVERIFY2(sensor->start(), sensor->lastError().toLocal8Bit());
+        QTest::qWait(500);
+        QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
+
+        QVERIFY(signalDump.largestBatch <= 10);
+        QCOMPARE(signalDump.emptyBatches, 0);
+
+        sensor->setBatchSize(1);
+        QCOMPARE(sensor->batchSize(), 0);
+    }
+
+    void testStatistics() {
+        sensor->resetStatistics();
+        QmSensorStatistics statistics = sensor->statistics();
+        QCOMPARE(statistics.received, (quint64)0);
+
+        sensor->setInterval(20);
+        QVERIFY2(sensor->start(), sensor->lastError().toLocal8Bit());
+        QTest::qWait(1000);
+        QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
+
+        statistics = sensor->statistics();
+        QCOMPARE(statistics.interval, 20);
+        QVERIFY(statistics.received > 0);
+        QVERIFY(statistics.longestHandling <= statistics.handlingTime);
+        quint64 measured = 0;
+        for (int i = 0; i < QmSensorStatistics::JitterBuckets; i++) {
+            measured += statistics.jitter[i];
+        }
+        // All but the first reading after start
+        QCOMPARE(measured, statistics.received - 1);
+        sensor->setInterval(0);
+    }
+
+    void testSharedSession() {
+        MeeGo::QmAccelerometer *other = new MeeGo::QmAccelerometer();
+        QVERIFY2(other->requestSession(MeeGo::QmSensor::SessionTypeListen) != MeeGo::QmSensor::SessionTypeNone,
+                 other->lastError().toLocal8Bit());
+
+        sensor->setInterval(100);
+        other->setInterval(20);
+        QVERIFY2(sensor->start(), sensor->lastError().toLocal8Bit());
+        QVERIFY2(other->start(), other->lastError().toLocal8Bit());
+
+        // Each sees its own request while the session runs at the faster one
+        QCOMPARE(sensor->interval(), 100);
+        QCOMPARE(other->interval(), 20);
+
+        // Deleting one leaves the other running on the shared session
+        delete other;
+        QVERIFY(sensor->isRunning());
+        QCOMPARE(sensor->interval(), 100);
+        QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
+        sensor->setInterval(0);
+    }
+
     void cleanupTestCase() {
         delete sensor;
     }
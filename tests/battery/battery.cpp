@@ -36,6 +36,7 @@ public:
     SignalDump(QObject *parent = NULL) : QObject(parent), batteryCurrentSignal(false) {}
 
     bool batteryCurrentSignal;
+    QList<MeeGo::QmBattery::Telemetry> telemetry;
 
 public slots:
     void slotChargingStateChanged(MeeGo::QmBattery::ChargingState){}
@@ -43,6 +44,8 @@ public slots:
     void slotBatteryStateChanged(MeeGo::QmBattery::BatteryState){}
     void slotBatteryRemainingCapacityChanged(int, int){}
     void slotBatteryCurrent(int) { batteryCurrentSignal = true; }
+    void slotStatChanged(MeeGo::QmBattery::StatFields, MeeGo::QmBattery::Stat){}
+    void slotTelemetry(MeeGo::QmBattery::Telemetry sample) { telemetry << sample; }
     
     /* Depreciated */
     void slotBatteryEnergyLevelChanged(int){}
@@ -190,6 +193,22 @@ private slots:
         (void)result;
     }
 
+    void testGetStat() {
+        MeeGo::QmBattery::Stat stat = battery->getStat();
+        QCOMPARE(stat.capacityPct, battery->getRemainingCapacityPct());
+        QCOMPARE(stat.nominalCapacity, battery->getNominalCapacity());
+        QCOMPARE(stat.maxBars, battery->getMaxBars());
+        QCOMPARE(stat.batteryState, battery->getBatteryState());
+        QCOMPARE(stat.condition, battery->getBatteryCondition());
+    }
+
+    void testConnectStatChanged() {
+        QVERIFY(connect(battery,
+                        SIGNAL(statChanged(MeeGo::QmBattery::StatFields, MeeGo::QmBattery::Stat)),
+                        &signalDump,
+                        SLOT(slotStatChanged(MeeGo::QmBattery::StatFields, MeeGo::QmBattery::Stat))));
+    }
+
     void testStartCurrentMeasurementMs250() {
         signalDump.batteryCurrentSignal = false;
         bool result = battery->startCurrentMeasurement(MeeGo::QmBattery::RATE_250ms);
@@ -241,6 +260,21 @@ private slots:
         QVERIFY(!signalDump.batteryCurrentSignal);
     }
 
+    void testTelemetry() {
+        QVERIFY(connect(battery, SIGNAL(telemetry(MeeGo::QmBattery::Telemetry)),
+                        &signalDump, SLOT(slotTelemetry(MeeGo::QmBattery::Telemetry))));
+        signalDump.telemetry.clear();
+        QVERIFY(battery->startTelemetry(MeeGo::QmBattery::RATE_250ms));
+        QVERIFY(battery->startTelemetry(MeeGo::QmBattery::RATE_250ms) == false);
+        QTest::qWait(1000);
+        QVERIFY(battery->stopTelemetry());
+        QVERIFY(signalDump.telemetry.count() > 0);
+        foreach (const MeeGo::QmBattery::Telemetry &sample, signalDump.telemetry) {
+            QVERIFY(sample.voltage > 0);
+            QCOMPARE(sample.power, sample.current * sample.voltage / 1000);
+        }
+    }
+
     void cleanupTestCase() {
         delete battery;
     }
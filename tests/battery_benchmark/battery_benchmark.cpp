@@ -0,0 +1,207 @@
+/**
+ * @file battery_benchmark.cpp
+ * @brief QmBattery benchmarks against the battery simulator
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QDir>
+#include <QFile>
+#include <QLocalSocket>
+#include <QObject>
+#include <QProcess>
+#include <QTest>
+#include <QTime>
+#include <qmbattery.h>
+
+#include "qmbatterysim_p.h"
+
+extern "C" {
+#include "bme/bmeipc.h"
+}
+
+#define SIMULATOR "battery-simulator"
+#define GETTER_CALLS 1000
+#define INJECTED_EVENTS 1000
+
+class StatCounter : public QObject
+{
+    Q_OBJECT
+
+public:
+    StatCounter() : levelChanges(0) {}
+
+    int levelChanges;
+
+public slots:
+    void slotStatChanged(MeeGo::QmBattery::StatFields changed, MeeGo::QmBattery::Stat) {
+        if (changed & MeeGo::QmBattery::StatCapacityLevel)
+            levelChanges++;
+    }
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QProcess simulator;
+    QString socketPath;
+    MeeGo::QmBattery *battery;
+
+    bool request(quint32 type, const void *payload, quint32 len,
+                 void *reply, quint32 replyLen)
+    {
+        QLocalSocket socket;
+        socket.connectToServer(socketPath);
+        if (!socket.waitForConnected(1000))
+            return false;
+
+        emsim_hdr hdr;
+        hdr.type = EMSIM_HELLO_IPC;
+        hdr.len = 0;
+        socket.write((const char *)&hdr, sizeof(hdr));
+        hdr.type = type;
+        hdr.len = len;
+        socket.write((const char *)&hdr, sizeof(hdr));
+        socket.write((const char *)payload, len);
+
+        while (socket.bytesAvailable() < (qint64)(sizeof(hdr) + replyLen)) {
+            if (!socket.waitForReadyRead(10000))
+                return false;
+        }
+        socket.read((char *)&hdr, sizeof(hdr));
+        return hdr.type == EMSIM_REPLY && hdr.len == replyLen
+            && socket.read((char *)reply, replyLen) == (qint64)replyLen;
+    }
+
+    emsim_counters counters()
+    {
+        emsim_counters result;
+        memset(&result, 0, sizeof(result));
+        if (!request(EMSIM_COUNTERS, 0, 0, &result, sizeof(result)))
+            qWarning() << "Can't read the simulator counters";
+        return result;
+    }
+
+private slots:
+    void initTestCase() {
+        socketPath = qgetenv(EMSIM_SOCKET_ENV);
+        if (socketPath.isEmpty()) {
+            socketPath = QDir::tempPath() + "/battery-benchmark.sock";
+            simulator.start(SIMULATOR, QStringList() << socketPath);
+            QVERIFY(simulator.waitForStarted());
+            /* Wait for the socket */
+            for (int i = 0; i < 50 && !QFile::exists(socketPath); i++)
+                QTest::qWait(100);
+            qputenv(EMSIM_SOCKET_ENV, socketPath.toLocal8Bit());
+        }
+
+        battery = new MeeGo::QmBattery();
+        QVERIFY(battery);
+    }
+
+    void benchmarkGetterLatency() {
+        QBENCHMARK {
+            battery->getRemainingCapacityPct();
+        }
+    }
+
+    void benchmarkCacheHitRate() {
+        emsim_counters before = counters();
+        for (int i = 0; i < GETTER_CALLS; i++) {
+            battery->getRemainingCapacityPct();
+            battery->getVoltage();
+            battery->getChargerType();
+        }
+        emsim_counters after = counters();
+
+        quint32 misses = after.stat_queries - before.stat_queries;
+        qDebug() << "cache hit rate:"
+                 << 100.0 * (3 * GETTER_CALLS - misses) / (3 * GETTER_CALLS) << "%";
+        /* The cache expires once in a few seconds */
+        QVERIFY(misses <= 2);
+    }
+
+    void benchmarkEventThroughput() {
+        emsim_counters before = counters();
+
+        emsim_inject inject;
+        inject.count = INJECTED_EVENTS;
+        inject.mask = BMEVENT_BATMON;
+
+        QTime elapsed;
+        elapsed.start();
+        QVERIFY(request(EMSIM_INJECT, &inject, sizeof(inject), 0, 0));
+
+        /* Every event is followed by one stat query */
+        emsim_counters now;
+        do {
+            QTest::qWait(10);
+            now = counters();
+        } while (now.stat_queries - before.stat_queries < INJECTED_EVENTS
+                 && elapsed.elapsed() < 30000);
+
+        QCOMPARE(now.events - before.events, (quint32)INJECTED_EVENTS);
+        QVERIFY(now.stat_queries - before.stat_queries >= INJECTED_EVENTS);
+        qDebug() << "event throughput:"
+                 << INJECTED_EVENTS * 1000.0 / qMax(1, elapsed.elapsed()) << "events/s";
+    }
+
+    void benchmarkCoalescedNotifications() {
+        StatCounter counter;
+        QVERIFY(connect(battery,
+                        SIGNAL(statChanged(MeeGo::QmBattery::StatFields, MeeGo::QmBattery::Stat)),
+                        &counter,
+                        SLOT(slotStatChanged(MeeGo::QmBattery::StatFields, MeeGo::QmBattery::Stat))));
+        battery->setStatRateLimit(MeeGo::QmBattery::StatCapacityLevel, 1000);
+
+        emsim_counters before = counters();
+        emsim_inject inject;
+        inject.count = INJECTED_EVENTS;
+        inject.mask = BMEVENT_BATMON;
+        QVERIFY(request(EMSIM_INJECT, &inject, sizeof(inject), 0, 0));
+
+        QTime elapsed;
+        elapsed.start();
+        while (counters().stat_queries - before.stat_queries < INJECTED_EVENTS
+               && elapsed.elapsed() < 30000)
+            QTest::qWait(10);
+        /* Let the held back change through */
+        QTest::qWait(1100);
+
+        int reported = counter.levelChanges;
+        qDebug() << INJECTED_EVENTS << "level changes reported" << reported << "times in"
+                 << elapsed.elapsed() << "ms";
+        QVERIFY(reported > 0);
+        QVERIFY(reported <= elapsed.elapsed() / 1000 + 1);
+
+        battery->setStatRateLimit(MeeGo::QmBattery::StatCapacityLevel, 0);
+    }
+
+    void cleanupTestCase() {
+        delete battery;
+        if (simulator.state() != QProcess::NotRunning) {
+            simulator.terminate();
+            simulator.waitForFinished();
+        }
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "battery_benchmark.moc"
@@ -0,0 +1,8 @@
+QT += network
+QT -= gui
+SOURCES += battery_benchmark.cpp
+
+!linux-g++-maemo: INCLUDEPATH += ../../system/bmewire
+TARGET = battery-benchmark-test
+
+include(../common-install.pri)
@@ -0,0 +1,9 @@
+QT += network
+QT -= gui
+SOURCES += main.cpp
+
+LIBS += -lrt
+!linux-g++-maemo: INCLUDEPATH += ../../system/bmewire
+TARGET = battery-simulator
+
+include(../common-install.pri)
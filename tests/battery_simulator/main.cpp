@@ -0,0 +1,501 @@
+/**
+ * @file main.cpp
+ * @brief Scriptable BME simulator for QmBattery tests and benchmarks
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+
+/*
+ * Usage: battery-simulator [-s speed] [-l] <socket> [trace]
+ *
+ * Listens on <socket>; run the client with QMSYSTEM_BME_SIMULATOR=<socket>
+ * against a libqmsystem2 built with CONFIG+=bmesim.
+ * The trace is replayed from the start, -s scales time, -l loops it. Every
+ * line is "<ms> <command>", where ms is the offset from the start:
+ *
+ *   <ms> stat NAME=value ...             set bmestat fields, e.g. CHARGER_TYPE=1
+ *   <ms> event charger|charge|batmon ... send the events
+ *   <ms> meas <mA> <mV> <K>              set the measured values
+ *   <ms> restart                         drop all clients, like a BME restart
+ *
+ * Lines starting with '#' are ignored. Clients can run the same commands,
+ * without the time, with EMSIM_COMMAND.
+ */
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMap>
+#include <QStringList>
+#include <QTime>
+#include <QTimer>
+
+#include "qmbatterysim_p.h"
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <string.h>
+#include <sys/time.h>
+#include "bme/bmeipc.h"
+#include "bme/bmemsg.h"
+#include "bme/em_isi.h"
+}
+
+#define MQ_MAXMSG 10
+
+struct StatName
+{
+    const char *name;
+    int index;
+};
+
+static const StatName stat_names[] = {
+    { "CHARGER_TYPE", CHARGER_TYPE },
+    { "CHARGING_STATE", CHARGING_STATE },
+    { "BATTERY_STATE", BATTERY_STATE },
+    { "BATTERY_LEVEL_NOW", BATTERY_LEVEL_NOW },
+    { "BATTERY_LEVEL_MAX", BATTERY_LEVEL_MAX },
+    { "BATTERY_LEVEL_PCT", BATTERY_LEVEL_PCT },
+    { "BATTERY_CAPA_NOW", BATTERY_CAPA_NOW },
+    { "BATTERY_CAPA_MAX", BATTERY_CAPA_MAX },
+    { "BATTERY_VOLT_NOW", BATTERY_VOLT_NOW },
+    { "BATTERY_CURRENT", BATTERY_CURRENT },
+    { "COULOMB_COUNTER", COULOMB_COUNTER },
+    { "BATTERY_TEMP", BATTERY_TEMP },
+    { "BATTERY_CONDITION", BATTERY_CONDITION },
+    { "CHARGING_TIME", CHARGING_TIME },
+    { 0, 0 }
+};
+
+static int period_to_ms(int period)
+{
+    switch (period) {
+    case EM_MEASUREMENT_PERIOD_250MS:
+        return 250;
+    case EM_MEASUREMENT_PERIOD_1S:
+        return 1000;
+    case EM_MEASUREMENT_PERIOD_5S:
+    default:
+        return 5000;
+    }
+}
+
+struct TraceLine
+{
+    qint64 at;      /* ms from the start */
+    QStringList command;
+};
+
+class Client
+{
+public:
+    Client() : hello(0), mask(0), elements(0) { }
+
+    QByteArray buffer;
+    quint32 hello;
+    quint32 mask;      /* events connections */
+    int elements;      /* measurement request elements still to come */
+};
+
+class BatterySimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    BatterySimulator(double speed, bool loop)
+        : speed_(speed),
+          loop_(loop),
+          next_(0),
+          mq_(-1),
+          current_(100),
+          voltage_(3900),
+          temp_(300)
+    {
+        memset(&stat_, 0, sizeof(stat_));
+        memset(&counters_, 0, sizeof(counters_));
+
+        stat_[CHARGER_TYPE] = CHARGER_TYPE_NONE;
+        stat_[CHARGING_STATE] = CHARGING_STATE_STOPPED;
+        stat_[BATTERY_STATE] = BATTERY_STATE_OK;
+        stat_[BATTERY_LEVEL_NOW] = 6;
+        stat_[BATTERY_LEVEL_MAX] = 8;
+        stat_[BATTERY_LEVEL_PCT] = 75;
+        stat_[BATTERY_CAPA_NOW] = 1000;
+        stat_[BATTERY_CAPA_MAX] = 1320;
+        stat_[BATTERY_VOLT_NOW] = 3900;
+        stat_[BATTERY_TEMP] = 300;
+        stat_[BATTERY_CONDITION] = BATTERY_CONDITION_GOOD;
+
+        trace_timer_.setSingleShot(true);
+        connect(&trace_timer_, SIGNAL(timeout()), this, SLOT(onTrace()));
+        connect(&meas_timer_, SIGNAL(timeout()), this, SLOT(onMeasure()));
+        connect(&server_, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+    }
+
+    ~BatterySimulator()
+    {
+        if (mq_ >= 0) {
+            ::mq_close(mq_);
+            ::mq_unlink(EMSIM_MQNAME);
+        }
+    }
+
+    bool load(const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qWarning() << "Can't open" << path << file.errorString();
+            return false;
+        }
+
+        int number = 0;
+        while (!file.atEnd()) {
+            QString line = QString::fromLocal8Bit(file.readLine()).trimmed();
+            number++;
+            if (line.isEmpty() || line.startsWith('#'))
+                continue;
+
+            QStringList words = line.split(QRegExp("\\s+"));
+            bool ok;
+            TraceLine trace;
+            trace.at = words.takeFirst().toLongLong(&ok);
+            if (!ok || words.isEmpty()) {
+                qWarning() << path << number << ": bad line" << line;
+                return false;
+            }
+            trace.command = words;
+            trace_ << trace;
+        }
+        return true;
+    }
+
+    bool start(const QString &name)
+    {
+        struct mq_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.mq_maxmsg = MQ_MAXMSG;
+        attr.mq_msgsize = sizeof(bmeipc_meas_t);
+
+        ::mq_unlink(EMSIM_MQNAME);
+        mq_ = ::mq_open(EMSIM_MQNAME, O_WRONLY | O_CREAT | O_NONBLOCK, 0600, &attr);
+        if (mq_ < 0) {
+            qWarning() << "Can't create" << EMSIM_MQNAME << strerror(errno);
+            return false;
+        }
+
+        QLocalServer::removeServer(name);
+        if (!server_.listen(name)) {
+            qWarning() << "Can't listen on" << name << server_.errorString();
+            return false;
+        }
+
+        started_.start();
+        schedule_();
+        return true;
+    }
+
+private Q_SLOTS:
+    void onNewConnection()
+    {
+        while (QLocalSocket *socket = server_.nextPendingConnection()) {
+            clients_.insert(socket, Client());
+            connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+            connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+        }
+    }
+
+    void onDisconnected()
+    {
+        QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+        clients_.remove(socket);
+        socket->deleteLater();
+    }
+
+    void onReadyRead()
+    {
+        QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+        if (!clients_.contains(socket))
+            return;
+
+        Client &client = clients_[socket];
+        client.buffer += socket->readAll();
+
+        while (client.buffer.size() >= (int)sizeof(emsim_hdr)) {
+            emsim_hdr hdr;
+            memcpy(&hdr, client.buffer.constData(), sizeof(hdr));
+            if (client.buffer.size() < (int)(sizeof(hdr) + hdr.len))
+                break;
+
+            QByteArray payload = client.buffer.mid(sizeof(hdr), hdr.len);
+            client.buffer.remove(0, sizeof(hdr) + hdr.len);
+            handle_(socket, client, hdr.type, payload);
+        }
+    }
+
+    void onTrace()
+    {
+        qint64 elapsed = started_.elapsed() * speed_;
+        while (next_ < trace_.size() && trace_[next_].at <= elapsed)
+            execute_(trace_[next_++].command);
+        schedule_();
+    }
+
+    void onMeasure()
+    {
+        bmeipc_meas_t msg;
+        memset(&msg, 0, sizeof(msg));
+        ::gettimeofday(&msg.timestamp, 0);
+        msg.bat_current = current_;
+        msg.bat_voltage = voltage_;
+        msg.bat_temp = temp_;
+        msg.state = MEASUREMENTS_ON;
+
+        /* A full mq means the client is not reading, drop like BME does */
+        if (::mq_send(mq_, (const char *)&msg, sizeof(msg), 0) == 0)
+            counters_.measurements++;
+    }
+
+private:
+    void schedule_()
+    {
+        if (next_ >= trace_.size()) {
+            if (!loop_ || trace_.isEmpty())
+                return;
+            next_ = 0;
+            started_.start();
+        }
+        qint64 delay = trace_[next_].at / speed_ - started_.elapsed();
+        trace_timer_.start(qMax<qint64>(delay, 0));
+    }
+
+    void reply_(QLocalSocket *socket, const void *payload, quint32 len)
+    {
+        emsim_hdr hdr;
+        hdr.type = EMSIM_REPLY;
+        hdr.len = len;
+        socket->write((const char *)&hdr, sizeof(hdr));
+        if (len > 0)
+            socket->write((const char *)payload, len);
+    }
+
+    void handle_(QLocalSocket *socket, Client &client, quint32 type,
+                 const QByteArray &payload)
+    {
+        switch (type) {
+        case EMSIM_HELLO_IPC:
+            client.hello = type;
+            break;
+        case EMSIM_HELLO_EVENTS:
+            client.hello = type;
+            if (payload.size() == sizeof(quint32))
+                memcpy(&client.mask, payload.constData(), sizeof(quint32));
+            break;
+        case EMSIM_QUERY:
+            query_(socket, client, payload);
+            break;
+        case EMSIM_COUNTERS:
+            reply_(socket, &counters_, sizeof(counters_));
+            break;
+        case EMSIM_INJECT: {
+            emsim_inject inject;
+            memset(&inject, 0, sizeof(inject));
+            memcpy(&inject, payload.constData(), qMin<int>(payload.size(), sizeof(inject)));
+            int level = stat_[BATTERY_LEVEL_PCT];
+            for (quint32 i = 0; i < inject.count; i++) {
+                if (inject.mask & BMEVENT_BATMON)
+                    stat_[BATTERY_LEVEL_PCT] = (i & 1) ? level : level - 1;
+                send_events_(inject.mask);
+            }
+            reply_(socket, 0, 0);
+            break;
+        }
+        case EMSIM_COMMAND: {
+            QString line = QString::fromLocal8Bit(payload).trimmed();
+            if (!line.isEmpty())
+                execute_(line.split(QRegExp("\\s+")));
+            reply_(socket, 0, 0);
+            break;
+        }
+        default:
+            /* Out of sync, drop whatever is buffered */
+            qWarning() << "Unknown message type" << type;
+            client.buffer.clear();
+        }
+    }
+
+    void query_(QLocalSocket *socket, Client &client, const QByteArray &payload)
+    {
+        counters_.queries++;
+
+        if (client.elements > 0) {
+            struct emsg_measurement_req_elem elem;
+            memset(&elem, 0, sizeof(elem));
+            memcpy(&elem, payload.constData(), qMin<int>(payload.size(), sizeof(elem)));
+            if (elem.type == EM_MEASUREMENT_TYPE_CURRENT) {
+                meas_timer_.start(qMax(1, (int)(period_to_ms(elem.period) / speed_)));
+            }
+            client.elements--;
+            reply_(socket, 0, 0);
+            return;
+        }
+
+        bmeipc_msg_t request;
+        memset(&request, 0, sizeof(request));
+        memcpy(&request, payload.constData(), qMin<int>(payload.size(), sizeof(request)));
+
+        if (request.type == BME_SYSMSG_GETSTAT) {
+            counters_.stat_queries++;
+            reply_(socket, &stat_, sizeof(stat_));
+        } else if (request.type == EM_MEASUREMENT_REQ) {
+            struct emsg_measurement_req req;
+            memset(&req, 0, sizeof(req));
+            memcpy(&req, payload.constData(), qMin<int>(payload.size(), sizeof(req)));
+            if (req.measurement_action == EM_MEASUREMENT_ACTION_START) {
+                client.elements = req.channel_count;
+            } else {
+                meas_timer_.stop();
+            }
+            reply_(socket, 0, 0);
+        } else {
+            reply_(socket, 0, 0);
+        }
+    }
+
+    void send_events_(quint32 events)
+    {
+        QMap<QLocalSocket*, Client>::iterator it;
+        for (it = clients_.begin(); it != clients_.end(); ++it) {
+            quint32 mask = events & it.value().mask;
+            if (it.value().hello != EMSIM_HELLO_EVENTS || !mask)
+                continue;
+
+            emsim_hdr hdr;
+            hdr.type = EMSIM_EVENT;
+            hdr.len = sizeof(mask);
+            it.key()->write((const char *)&hdr, sizeof(hdr));
+            it.key()->write((const char *)&mask, sizeof(mask));
+            counters_.events++;
+        }
+    }
+
+    void execute_(const QStringList &command)
+    {
+        const QString &verb = command.first();
+
+        if (verb == "stat") {
+            for (int i = 1; i < command.size(); i++) {
+                QStringList pair = command[i].split('=');
+                const StatName *stat = stat_names;
+                while (stat->name && (pair.size() != 2 || pair[0] != stat->name))
+                    stat++;
+                if (!stat->name) {
+                    qWarning() << "Unknown stat" << command[i];
+                    continue;
+                }
+                stat_[stat->index] = pair[1].toInt();
+            }
+        } else if (verb == "event") {
+            quint32 events = 0;
+            for (int i = 1; i < command.size(); i++) {
+                if (command[i] == "charger")
+                    events |= BMEVENT_CHARGER;
+                else if (command[i] == "charge")
+                    events |= BMEVENT_CHARGE;
+                else if (command[i] == "batmon")
+                    events |= BMEVENT_BATMON;
+                else
+                    qWarning() << "Unknown event" << command[i];
+            }
+            send_events_(events);
+        } else if (verb == "meas" && command.size() == 4) {
+            current_ = command[1].toInt();
+            voltage_ = command[2].toInt();
+            temp_ = command[3].toInt();
+        } else if (verb == "restart") {
+            counters_.restarts++;
+            meas_timer_.stop();
+            /* Clients see EOF, the coulomb counter starts over */
+            stat_[COULOMB_COUNTER] = 0;
+            foreach (QLocalSocket *socket, clients_.keys())
+                socket->disconnectFromServer();
+        } else {
+            qWarning() << "Unknown command" << command.join(" ");
+        }
+    }
+
+    QLocalServer server_;
+    QMap<QLocalSocket*, Client> clients_;
+
+    double speed_;
+    bool loop_;
+    QList<TraceLine> trace_;
+    int next_;
+    QTime started_;
+    QTimer trace_timer_;
+
+    bmestat_t stat_;
+    emsim_counters counters_;
+
+    mqd_t mq_;
+    QTimer meas_timer_;
+    int current_;
+    int voltage_;
+    int temp_;
+};
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    args.removeFirst();
+
+    double speed = 1.0;
+    bool loop = false;
+    while (!args.isEmpty() && args.first().startsWith('-')) {
+        QString option = args.takeFirst();
+        if (option == "-s" && !args.isEmpty()) {
+            speed = args.takeFirst().toDouble();
+        } else if (option == "-l") {
+            loop = true;
+        } else {
+            args.clear();
+            break;
+        }
+    }
+
+    if (args.isEmpty() || args.size() > 2 || speed <= 0) {
+        qWarning("Usage: battery-simulator [-s speed] [-l] <socket> [trace]");
+        return EXIT_FAILURE;
+    }
+
+    BatterySimulator simulator(speed, loop);
+    if (args.size() == 2 && !simulator.load(args[1]))
+        return EXIT_FAILURE;
+    if (!simulator.start(args[0]))
+        return EXIT_FAILURE;
+
+    return app.exec();
+}
+
+#include "main.moc"
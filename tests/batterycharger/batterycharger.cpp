@@ -0,0 +1,199 @@
+/**
+ * @file batterycharger.cpp
+ * @brief QmBattery charger event tests against the battery simulator
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QDir>
+#include <QFile>
+#include <QLocalSocket>
+#include <QObject>
+#include <QProcess>
+#include <QTest>
+#include <qmbattery.h>
+
+#include "qmbatterysim_p.h"
+
+extern "C" {
+#include "bme/bmeipc.h"
+}
+
+#define SIMULATOR "battery-simulator"
+#define REPLY_TIMEOUT 2000 /* ms */
+/* As in qmbattery.cpp */
+#define CHARGER_SETTLE_TIMEOUT 4000 /* ms */
+/* Well within the settle timeout */
+#define ENUMERATION_TIME 1000 /* ms */
+
+using namespace MeeGo;
+
+class ChargerRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    QList<QmBattery::ChargerType> chargers;
+    QList<QmBattery::ChargingState> charging;
+
+    void clear() {
+        chargers.clear();
+        charging.clear();
+    }
+
+public slots:
+    void slotChargerEvent(MeeGo::QmBattery::ChargerType type) {
+        chargers << type;
+    }
+
+    void slotChargingStateChanged(MeeGo::QmBattery::ChargingState state) {
+        charging << state;
+    }
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QProcess simulator;
+    QString socketPath;
+    QmBattery *battery;
+    ChargerRecorder recorder;
+
+    /* Runs a trace command in the simulator */
+    bool command(const QString &line)
+    {
+        QLocalSocket socket;
+        socket.connectToServer(socketPath);
+        if (!socket.waitForConnected(1000))
+            return false;
+
+        QByteArray payload = line.toLocal8Bit();
+        emsim_hdr hdr;
+        hdr.type = EMSIM_HELLO_IPC;
+        hdr.len = 0;
+        socket.write((const char *)&hdr, sizeof(hdr));
+        hdr.type = EMSIM_COMMAND;
+        hdr.len = payload.size();
+        socket.write((const char *)&hdr, sizeof(hdr));
+        socket.write(payload);
+
+        while (socket.bytesAvailable() < (qint64)sizeof(hdr)) {
+            if (!socket.waitForReadyRead(REPLY_TIMEOUT))
+                return false;
+        }
+        socket.read((char *)&hdr, sizeof(hdr));
+        return hdr.type == EMSIM_REPLY && hdr.len == 0;
+    }
+
+    /* Sets the BME charger type and sends the charger event */
+    bool plug(int bmeType, int bmeCharging = CHARGING_STATE_STOPPED)
+    {
+        return command(QString("stat CHARGER_TYPE=%1 CHARGING_STATE=%2")
+                       .arg(bmeType).arg(bmeCharging))
+            && command("event charger charge");
+    }
+
+private slots:
+    void initTestCase() {
+        socketPath = QDir::tempPath() + "/batterycharger-test.sock";
+        QFile::remove(socketPath);
+        simulator.start(SIMULATOR, QStringList() << socketPath);
+        QVERIFY(simulator.waitForStarted());
+        /* Wait for the socket */
+        for (int i = 0; i < 50 && !QFile::exists(socketPath); i++)
+            QTest::qWait(100);
+        qputenv(EMSIM_SOCKET_ENV, socketPath.toLocal8Bit());
+
+        battery = new QmBattery();
+        QVERIFY(connect(battery, SIGNAL(chargerEvent(MeeGo::QmBattery::ChargerType)),
+                        &recorder, SLOT(slotChargerEvent(MeeGo::QmBattery::ChargerType))));
+        QVERIFY(connect(battery, SIGNAL(chargingStateChanged(MeeGo::QmBattery::ChargingState)),
+                        &recorder, SLOT(slotChargingStateChanged(MeeGo::QmBattery::ChargingState))));
+        /* Let the simulator take the event connection */
+        QTest::qWait(100);
+        QCOMPARE(battery->getChargerType(), QmBattery::None);
+    }
+
+    void init() {
+        recorder.clear();
+    }
+
+    void testUsb100To500() {
+        QVERIFY(plug(CHARGER_TYPE_USB100MA));
+        QTest::qWait(ENUMERATION_TIME);
+        QCOMPARE(recorder.chargers.size(), 0);
+
+        QVERIFY(plug(CHARGER_TYPE_USB500MA, CHARGING_STATE_STARTED));
+        QTest::qWait(CHARGER_SETTLE_TIMEOUT + 500);
+
+        /* One event for the settled charger, USB 100mA was never seen */
+        QCOMPARE(recorder.chargers.size(), 1);
+        QCOMPARE(recorder.chargers[0], QmBattery::USB_500mA);
+        QCOMPARE(recorder.charging.size(), 1);
+        QCOMPARE(recorder.charging[0], QmBattery::StateCharging);
+
+        QVERIFY(plug(CHARGER_TYPE_NONE));
+        QTest::qWait(200);
+        QCOMPARE(recorder.chargers.size(), 2);
+        QCOMPARE(recorder.chargers[1], QmBattery::None);
+    }
+
+    void testUsb100Settled() {
+        QVERIFY(plug(CHARGER_TYPE_USB100MA, CHARGING_STATE_STARTED));
+        QTest::qWait(CHARGER_SETTLE_TIMEOUT - 500);
+        QCOMPARE(recorder.chargers.size(), 0);
+        QCOMPARE(recorder.charging.size(), 0);
+
+        QTest::qWait(1000);
+        QCOMPARE(recorder.chargers.size(), 1);
+        QCOMPARE(recorder.chargers[0], QmBattery::USB_100mA);
+        QCOMPARE(recorder.charging.size(), 1);
+        QCOMPARE(recorder.charging[0], QmBattery::StateCharging);
+
+        QVERIFY(plug(CHARGER_TYPE_NONE));
+        QTest::qWait(200);
+        QCOMPARE(recorder.chargers.size(), 2);
+        QCOMPARE(recorder.chargers[1], QmBattery::None);
+    }
+
+    void testUnplugWhileSettling() {
+        QVERIFY(plug(CHARGER_TYPE_USB100MA));
+        QTest::qWait(ENUMERATION_TIME);
+        QVERIFY(plug(CHARGER_TYPE_NONE));
+        QTest::qWait(200);
+
+        QCOMPARE(recorder.chargers.size(), 1);
+        QCOMPARE(recorder.chargers[0], QmBattery::None);
+
+        /* The settle timer is gone with it */
+        QTest::qWait(CHARGER_SETTLE_TIMEOUT);
+        QCOMPARE(recorder.chargers.size(), 1);
+        QCOMPARE(battery->getChargerType(), QmBattery::None);
+    }
+
+    void cleanupTestCase() {
+        delete battery;
+        simulator.terminate();
+        simulator.waitForFinished();
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "batterycharger.moc"
@@ -0,0 +1,7 @@
+QT += network
+QT -= gui
+SOURCES += batterycharger.cpp
+
+!linux-g++-maemo: INCLUDEPATH += ../../system/bmewire
+TARGET = batterycharger-test
+include(../common-install.pri)
@@ -0,0 +1,237 @@
+/**
+ * @file batteryenergy.cpp
+ * @brief QmBattery energy accounting tests against the battery simulator
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QLocalSocket>
+#include <QObject>
+#include <QProcess>
+#include <QTest>
+#include <qmbattery.h>
+#include <qmcallstate.h>
+#include <qmdisplaystate.h>
+
+#include "qmbatterysim_p.h"
+
+#define SIMULATOR "battery-simulator"
+#define REPLY_TIMEOUT 2000 /* ms */
+#define ACCOUNT_TIME 3000 /* ms */
+
+/* The simulated measurements, 800 mW */
+#define SIM_CURRENT 200 /* mA */
+#define SIM_VOLTAGE 4000 /* mV */
+
+/* The record file as written by EmEnergyAccounting, see qmbatteryenergy_p.h */
+#define ENERGY_MAGIC 0x41454d51
+#define ENERGY_VERSION 1
+
+struct EnergyHeader
+{
+    quint32 magic;
+    quint32 version;
+};
+
+struct EnergyRecord
+{
+    quint32 start;
+    quint32 duration;
+    qint32 energy;
+    qint32 charge;
+    quint8 interval;
+    quint8 flags;
+    quint16 reserved;
+};
+
+using namespace MeeGo;
+
+class RecordRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    QList<QmBattery::EnergyRecord> records;
+
+public slots:
+    void slotEnergyIntervalClosed(MeeGo::QmBattery::EnergyRecord record) {
+        records << record;
+    }
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QProcess simulator;
+    QString socketPath;
+    QString home;
+    QmBattery *battery;
+    RecordRecorder recorder;
+
+    /* Runs a trace command in the simulator */
+    bool command(const QString &line)
+    {
+        QLocalSocket socket;
+        socket.connectToServer(socketPath);
+        if (!socket.waitForConnected(1000))
+            return false;
+
+        QByteArray payload = line.toLocal8Bit();
+        emsim_hdr hdr;
+        hdr.type = EMSIM_HELLO_IPC;
+        hdr.len = 0;
+        socket.write((const char *)&hdr, sizeof(hdr));
+        hdr.type = EMSIM_COMMAND;
+        hdr.len = payload.size();
+        socket.write((const char *)&hdr, sizeof(hdr));
+        socket.write(payload);
+
+        while (socket.bytesAvailable() < (qint64)sizeof(hdr)) {
+            if (!socket.waitForReadyRead(REPLY_TIMEOUT))
+                return false;
+        }
+        socket.read((char *)&hdr, sizeof(hdr));
+        return hdr.type == EMSIM_REPLY && hdr.len == 0;
+    }
+
+    /* Sets bmestat fields and tells the clients about it */
+    bool change(const QString &fields)
+    {
+        return command("stat " + fields) && command("event batmon");
+    }
+
+    /* What EmEnergyAccounting makes of the current device state */
+    static QmBattery::EnergyInterval currentInterval()
+    {
+        QmCallState::State call = QmCallState().getState();
+        if (call == QmCallState::Active || call == QmCallState::Service)
+            return QmBattery::IntervalCall;
+        if (QmDisplayState().get() != QmDisplayState::Off)
+            return QmBattery::IntervalDisplayOn;
+        return QmBattery::IntervalIdle;
+    }
+
+private slots:
+    void initTestCase() {
+        /* Keep the records of the user out of it */
+        home = QDir::tempPath() + "/batteryenergy-test";
+        QDir().mkpath(home);
+        QFile::remove(home + "/.qmsystem2/battery-energy");
+        qputenv("HOME", home.toLocal8Bit());
+
+        socketPath = QDir::tempPath() + "/batteryenergy-test.sock";
+        QFile::remove(socketPath);
+        simulator.start(SIMULATOR, QStringList() << socketPath);
+        QVERIFY(simulator.waitForStarted());
+        /* Wait for the socket */
+        for (int i = 0; i < 50 && !QFile::exists(socketPath); i++)
+            QTest::qWait(100);
+        qputenv(EMSIM_SOCKET_ENV, socketPath.toLocal8Bit());
+
+        battery = new QmBattery();
+        QVERIFY(connect(battery, SIGNAL(energyIntervalClosed(MeeGo::QmBattery::EnergyRecord)),
+                        &recorder, SLOT(slotEnergyIntervalClosed(MeeGo::QmBattery::EnergyRecord))));
+        QVERIFY(command(QString("meas %1 %2 300").arg(SIM_CURRENT).arg(SIM_VOLTAGE)));
+        QVERIFY(change("COULOMB_COUNTER=1000"));
+        QTest::qWait(100);
+    }
+
+    void testAccounting() {
+        QmBattery::EnergyInterval interval = currentInterval();
+
+        QVERIFY(battery->startEnergyAccounting(QmBattery::RATE_250ms));
+        QVERIFY(battery->startEnergyAccounting() == false);
+        QVERIFY(change("COULOMB_COUNTER=1600"));
+        QTest::qWait(ACCOUNT_TIME);
+        QVERIFY(battery->stopEnergyAccounting());
+
+        QCOMPARE(recorder.records.size(), 1);
+        const QmBattery::EnergyRecord &record = recorder.records[0];
+        QCOMPARE(record.interval, interval);
+        QVERIFY(record.duration >= ACCOUNT_TIME / 1000 - 1);
+        QVERIFY(record.duration <= ACCOUNT_TIME / 1000 + 1);
+        QCOMPARE(record.charge, 600);
+        QVERIFY(!record.estimated);
+
+        /* mW * ms / 3600000 = mWh; the first and the last sample period
+           of the interval are not integrated */
+        double power = SIM_CURRENT * SIM_VOLTAGE / 1000.0;
+        qDebug() << "energy" << record.energy << "mWh in" << record.duration << "s";
+        QVERIFY(record.energy >= power * (ACCOUNT_TIME - 750) / 3600000.0);
+        QVERIFY(record.energy <= power * (ACCOUNT_TIME + 250) / 3600000.0);
+
+        QList<QmBattery::EnergyRecord> stored = battery->getEnergyRecords();
+        QCOMPARE(stored.size(), 1);
+        QCOMPARE(stored[0].start, record.start);
+        QCOMPARE(stored[0].duration, record.duration);
+        QCOMPARE(stored[0].interval, record.interval);
+        QCOMPARE(stored[0].charge, record.charge);
+        QCOMPARE(stored[0].energy, record.energy);
+        QVERIFY(QFile::exists(home + "/.qmsystem2/battery-energy"));
+    }
+
+    void testBadRecords() {
+        QFile file(home + "/.qmsystem2/battery-energy");
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        EnergyHeader header;
+        header.magic = ENERGY_MAGIC;
+        header.version = ENERGY_VERSION;
+        file.write((const char *)&header, sizeof(header));
+
+        /* An hour of calls at 250 mA between intervals no version knows */
+        quint8 intervals[] = { 7, QmBattery::IntervalCall, 255 };
+        for (uint i = 0; i < sizeof(intervals); i++) {
+            EnergyRecord record;
+            memset(&record, 0, sizeof(record));
+            record.start = QDateTime::currentDateTime().toTime_t() - 3600;
+            record.duration = 3600;
+            record.charge = (intervals[i] == QmBattery::IntervalCall ? 250 : 5000) * 3600;
+            record.energy = record.charge;
+            record.interval = intervals[i];
+            file.write((const char *)&record, sizeof(record));
+        }
+        /* Cut short while written */
+        file.write("\x01\x02\x03", 3);
+        file.close();
+
+        QmBattery fresh;
+        QList<QmBattery::EnergyRecord> records = fresh.getEnergyRecords();
+        QCOMPARE(records.size(), 1);
+        QCOMPARE(records[0].interval, QmBattery::IntervalCall);
+        QCOMPARE(records[0].charge, 250 * 3600);
+
+        QCOMPARE(fresh.getAverageTalkCurrent(QmBattery::NormalMode), 250);
+        QVERIFY(fresh.getRemainingTalkTime(QmBattery::NormalMode) > 0);
+        QVERIFY(fresh.getRemainingIdleTime(QmBattery::NormalMode) > 0);
+    }
+
+    void cleanupTestCase() {
+        delete battery;
+        QFile::remove(home + "/.qmsystem2/battery-energy");
+        simulator.terminate();
+        simulator.waitForFinished();
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "batteryenergy.moc"
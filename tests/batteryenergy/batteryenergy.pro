@@ -0,0 +1,6 @@
+QT += network dbus
+QT -= gui
+SOURCES += batteryenergy.cpp
+
+TARGET = batteryenergy-test
+include(../common-install.pri)
@@ -0,0 +1,193 @@
+/**
+ * @file batteryhistory.cpp
+ * @brief QmBatteryHistory tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <stddef.h>
+#include <string.h>
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <QTest>
+#include <qmbatteryhistory.h>
+
+#include "qmbatteryhistory_p.h"
+
+#define START_TIME 1300000000
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString path;
+    MeeGo::QmBatteryHistory *history;
+
+    void append(MeeGo::EmHistoryFile &file, int count, quint32 time)
+    {
+        for (int i = 0; i < count; i++) {
+            MeeGo::QmBatteryHistory::Record record;
+            memset(&record, 0, sizeof(record));
+            record.time = time + i;
+            record.current = i;
+            record.capacityPct = i % 100;
+            QVERIFY(file.append(record));
+        }
+    }
+
+private slots:
+    void initTestCase() {
+        path = QDir::tempPath() + "/batteryhistory-test";
+        QFile::remove(path);
+        history = new MeeGo::QmBatteryHistory();
+        QVERIFY(history);
+    }
+
+    void testOpenMissing() {
+        QVERIFY(history->open(path) == false);
+        QCOMPARE(history->count(), 0);
+        QVERIFY(history->at(0) == 0);
+    }
+
+    void testReadBack() {
+        MeeGo::EmHistoryFile file;
+        QVERIFY(file.map(path, true));
+        append(file, 100, START_TIME);
+
+        QVERIFY(history->open(path));
+        QCOMPARE(history->count(), 100);
+        for (int i = 0; i < 100; i++) {
+            const MeeGo::QmBatteryHistory::Record *record = history->at(i);
+            QVERIFY(record);
+            QCOMPARE(record->seq, (quint32)i + 1);
+            QCOMPARE(record->current, i);
+        }
+        QCOMPARE(history->lowerBound(START_TIME + 42), 42);
+        QCOMPARE(history->lowerBound(0), 0);
+        QCOMPARE(history->lowerBound(START_TIME + 1000), 100);
+
+        /* The snapshot doesn't move until refreshed */
+        append(file, 10, START_TIME + 100);
+        QCOMPARE(history->count(), 100);
+        history->refresh();
+        QCOMPARE(history->count(), 110);
+    }
+
+    void testWrapAround() {
+        MeeGo::EmHistoryFile file;
+        QVERIFY(file.map(path, true));
+        append(file, HISTORY_CAPACITY, START_TIME + 1000);
+
+        history->refresh();
+        QCOMPARE(history->count(), HISTORY_CAPACITY);
+        QCOMPARE(history->at(0)->seq, (quint32)111);
+        QCOMPARE(history->at(HISTORY_CAPACITY - 1)->seq, (quint32)HISTORY_CAPACITY + 110);
+    }
+
+    void testTornRecord() {
+        history->refresh();
+        quint32 last = history->at(history->count() - 1)->seq;
+
+        /* Damage the last record, as if the writer died while writing it */
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        qint64 offset = sizeof(MeeGo::EmHistoryHeader)
+            + ((last - 1) % HISTORY_CAPACITY) * sizeof(MeeGo::QmBatteryHistory::Record)
+            + offsetof(MeeGo::QmBatteryHistory::Record, current);
+        QVERIFY(file.seek(offset));
+        QVERIFY(file.write("junk", 4) == 4);
+        file.close();
+
+        QVERIFY(history->at(history->count() - 1) == 0);
+        history->refresh();
+        QCOMPARE(history->at(history->count() - 1)->seq, last - 1);
+
+        /* The writer continues after the last good record */
+        MeeGo::EmHistoryFile writer;
+        QVERIFY(writer.map(path, true));
+        append(writer, 1, START_TIME + 100000);
+        history->refresh();
+        QCOMPARE(history->at(history->count() - 1)->seq, last);
+        QCOMPARE(history->at(history->count() - 1)->time, (quint32)START_TIME + 100000);
+    }
+
+    void testDuplicates() {
+        /* Two processes logging the same change */
+        MeeGo::EmHistoryFile first;
+        MeeGo::EmHistoryFile second;
+        QVERIFY(first.map(path, true));
+        QVERIFY(second.map(path, true));
+        history->refresh();
+        quint32 last = history->at(history->count() - 1)->seq;
+
+        MeeGo::QmBatteryHistory::Record record;
+        memset(&record, 0, sizeof(record));
+        record.time = START_TIME + 200000;
+        record.current = 123;
+        record.capacityPct = 42;
+        MeeGo::QmBatteryHistory::Record copy = record;
+        QVERIFY(first.append(record, 1));
+        QVERIFY(second.append(copy, 1) == false);
+
+        /* A writer starting late doesn't make it a different change */
+        copy = record;
+        copy.time += 1;
+        copy.flags = MeeGo::QmBatteryHistory::FlagWriterStarted;
+        QVERIFY(second.append(copy, 1) == false);
+
+        /* Out of the window or other values, or without a window */
+        copy.time += 1;
+        QVERIFY(second.append(copy, 1));
+        copy.capacityPct = 41;
+        QVERIFY(first.append(copy, 1));
+        QVERIFY(first.append(copy));
+
+        history->refresh();
+        int count = history->count();
+        QCOMPARE(history->at(count - 1)->seq, last + 4);
+        QCOMPARE(history->at(count - 4)->current, 123);
+        QCOMPARE(history->at(count - 3)->time, record.time + 2);
+        QCOMPARE((int)history->at(count - 2)->capacityPct, 41);
+        QCOMPARE((int)history->at(count - 1)->capacityPct, 41);
+    }
+
+    void testForeignFile() {
+        history->close();
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write("not a history log");
+        file.close();
+
+        QVERIFY(history->open(path) == false);
+
+        MeeGo::EmHistoryFile writer;
+        QVERIFY(writer.map(path, true));
+        QVERIFY(history->open(path));
+        QCOMPARE(history->count(), 0);
+    }
+
+    void cleanupTestCase() {
+        delete history;
+        QFile::remove(path);
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "batteryhistory.moc"
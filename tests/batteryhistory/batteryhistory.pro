@@ -0,0 +1,4 @@
+QT -= gui
+SOURCES += batteryhistory.cpp
+TARGET = batteryhistory-test
+include(../common-install.pri)
@@ -0,0 +1,175 @@
+/**
+ * @file batterymeasurement.cpp
+ * @brief Shared QmBattery current measurement tests against the battery simulator
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QDir>
+#include <QFile>
+#include <QLocalSocket>
+#include <QObject>
+#include <QProcess>
+#include <QTest>
+#include <qmbattery.h>
+
+#include "qmbatterysim_p.h"
+
+#define SIMULATOR "battery-simulator"
+#define REPLY_TIMEOUT 2000 /* ms */
+#define MEASURE_TIME 4100 /* ms */
+
+using namespace MeeGo;
+
+class CurrentRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    QList<int> currents;
+
+public slots:
+    void slotBatteryCurrent(int current) {
+        currents << current;
+    }
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QProcess simulator;
+    QString socketPath;
+    QmBattery *fast;
+    QmBattery *slow;
+    CurrentRecorder fastRecorder;
+    CurrentRecorder slowRecorder;
+
+    bool request(quint32 type, const QByteArray &payload,
+                 void *reply, quint32 replyLen)
+    {
+        QLocalSocket socket;
+        socket.connectToServer(socketPath);
+        if (!socket.waitForConnected(1000))
+            return false;
+
+        emsim_hdr hdr;
+        hdr.type = EMSIM_HELLO_IPC;
+        hdr.len = 0;
+        socket.write((const char *)&hdr, sizeof(hdr));
+        hdr.type = type;
+        hdr.len = payload.size();
+        socket.write((const char *)&hdr, sizeof(hdr));
+        socket.write(payload);
+
+        while (socket.bytesAvailable() < (qint64)(sizeof(hdr) + replyLen)) {
+            if (!socket.waitForReadyRead(REPLY_TIMEOUT))
+                return false;
+        }
+        socket.read((char *)&hdr, sizeof(hdr));
+        return hdr.type == EMSIM_REPLY && hdr.len == replyLen
+            && socket.read((char *)reply, replyLen) == (qint64)replyLen;
+    }
+
+    /* Runs a trace command in the simulator */
+    bool command(const QString &line)
+    {
+        return request(EMSIM_COMMAND, line.toLocal8Bit(), 0, 0);
+    }
+
+    quint32 measurements()
+    {
+        emsim_counters counters;
+        memset(&counters, 0, sizeof(counters));
+        if (!request(EMSIM_COUNTERS, QByteArray(), &counters, sizeof(counters)))
+            qWarning() << "Can't read the simulator counters";
+        return counters.measurements;
+    }
+
+private slots:
+    void initTestCase() {
+        socketPath = QDir::tempPath() + "/batterymeasurement-test.sock";
+        QFile::remove(socketPath);
+        simulator.start(SIMULATOR, QStringList() << socketPath);
+        QVERIFY(simulator.waitForStarted());
+        /* Wait for the socket */
+        for (int i = 0; i < 50 && !QFile::exists(socketPath); i++)
+            QTest::qWait(100);
+        qputenv(EMSIM_SOCKET_ENV, socketPath.toLocal8Bit());
+
+        fast = new QmBattery();
+        slow = new QmBattery();
+        QVERIFY(connect(fast, SIGNAL(batteryCurrent(int)),
+                        &fastRecorder, SLOT(slotBatteryCurrent(int))));
+        QVERIFY(connect(slow, SIGNAL(batteryCurrent(int)),
+                        &slowRecorder, SLOT(slotBatteryCurrent(int))));
+        QVERIFY(command("meas 123 3900 300"));
+    }
+
+    void testDividers() {
+        QVERIFY(fast->startCurrentMeasurement(QmBattery::RATE_250ms));
+        QVERIFY(slow->startCurrentMeasurement(QmBattery::RATE_1000ms));
+
+        fastRecorder.currents.clear();
+        slowRecorder.currents.clear();
+        QTest::qWait(MEASURE_TIME);
+
+        int fastCount = fastRecorder.currents.size();
+        int slowCount = slowRecorder.currents.size();
+        qDebug() << "250ms:" << fastCount << "1000ms:" << slowCount;
+        QVERIFY(slowCount >= 3);
+        /* Every fourth sample of the shared session goes to both */
+        QVERIFY(fastCount >= 4 * slowCount);
+        QVERIFY(fastCount < 4 * (slowCount + 1));
+
+        foreach (int current, fastRecorder.currents + slowRecorder.currents)
+            QCOMPARE(current, 123);
+    }
+
+    void testSlowDown() {
+        QVERIFY(fast->stopCurrentMeasurement());
+        /* Whatever was queued at the old rate */
+        QTest::qWait(300);
+
+        fastRecorder.currents.clear();
+        slowRecorder.currents.clear();
+        quint32 before = measurements();
+        QTest::qWait(MEASURE_TIME);
+        quint32 sent = measurements() - before;
+
+        qDebug() << "sent:" << sent << "1000ms:" << slowRecorder.currents.size();
+        QCOMPARE(fastRecorder.currents.size(), 0);
+        /* The session runs at 1 s now, not 250 ms */
+        QVERIFY(sent >= 3 && sent <= 5);
+        QVERIFY(slowRecorder.currents.size() >= 3);
+        QVERIFY(slowRecorder.currents.size() <= (int)sent);
+
+        QVERIFY(slow->stopCurrentMeasurement());
+    }
+
+    void cleanupTestCase() {
+        delete fast;
+        delete slow;
+        simulator.terminate();
+        simulator.waitForFinished();
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "batterymeasurement.moc"
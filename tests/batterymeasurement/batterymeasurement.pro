@@ -0,0 +1,6 @@
+QT += network
+QT -= gui
+SOURCES += batterymeasurement.cpp
+
+TARGET = batterymeasurement-test
+include(../common-install.pri)
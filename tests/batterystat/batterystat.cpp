@@ -0,0 +1,210 @@
+/**
+ * @file batterystat.cpp
+ * @brief QmBattery statChanged tests against the battery simulator
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QDir>
+#include <QFile>
+#include <QLocalSocket>
+#include <QObject>
+#include <QProcess>
+#include <QTest>
+#include <QTime>
+#include <qmbattery.h>
+
+#include "qmbatterysim_p.h"
+
+#define SIMULATOR "battery-simulator"
+#define RATE_LIMIT 1000 /* ms */
+#define SIGNAL_TIMEOUT 2000 /* ms */
+
+using namespace MeeGo;
+
+class StatRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    QList<QmBattery::StatFields> fields;
+    QList<QmBattery::Stat> stats;
+
+    void clear() {
+        fields.clear();
+        stats.clear();
+    }
+
+    /* Until there are count reports */
+    bool wait(int count) {
+        QTime elapsed;
+        elapsed.start();
+        while (fields.size() < count && elapsed.elapsed() < SIGNAL_TIMEOUT)
+            QTest::qWait(10);
+        return fields.size() >= count;
+    }
+
+public slots:
+    void slotStatChanged(MeeGo::QmBattery::StatFields changed, MeeGo::QmBattery::Stat stat) {
+        fields << changed;
+        stats << stat;
+    }
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QProcess simulator;
+    QString socketPath;
+    QmBattery *battery;
+    StatRecorder recorder;
+
+    /* Runs a trace command in the simulator */
+    bool command(const QString &line)
+    {
+        QLocalSocket socket;
+        socket.connectToServer(socketPath);
+        if (!socket.waitForConnected(1000))
+            return false;
+
+        QByteArray payload = line.toLocal8Bit();
+        emsim_hdr hdr;
+        hdr.type = EMSIM_HELLO_IPC;
+        hdr.len = 0;
+        socket.write((const char *)&hdr, sizeof(hdr));
+        hdr.type = EMSIM_COMMAND;
+        hdr.len = payload.size();
+        socket.write((const char *)&hdr, sizeof(hdr));
+        socket.write(payload);
+
+        while (socket.bytesAvailable() < (qint64)sizeof(hdr)) {
+            if (!socket.waitForReadyRead(SIGNAL_TIMEOUT))
+                return false;
+        }
+        socket.read((char *)&hdr, sizeof(hdr));
+        return hdr.type == EMSIM_REPLY && hdr.len == 0;
+    }
+
+    /* Sets bmestat fields and tells the clients about it */
+    bool change(const QString &fields)
+    {
+        return command("stat " + fields) && command("event batmon");
+    }
+
+private slots:
+    void initTestCase() {
+        socketPath = QDir::tempPath() + "/batterystat-test.sock";
+        QFile::remove(socketPath);
+        simulator.start(SIMULATOR, QStringList() << socketPath);
+        QVERIFY(simulator.waitForStarted());
+        /* Wait for the socket */
+        for (int i = 0; i < 50 && !QFile::exists(socketPath); i++)
+            QTest::qWait(100);
+        qputenv(EMSIM_SOCKET_ENV, socketPath.toLocal8Bit());
+
+        battery = new QmBattery();
+        QVERIFY(connect(battery,
+                        SIGNAL(statChanged(MeeGo::QmBattery::StatFields, MeeGo::QmBattery::Stat)),
+                        &recorder,
+                        SLOT(slotStatChanged(MeeGo::QmBattery::StatFields, MeeGo::QmBattery::Stat))));
+        /* Let the simulator take the event connection */
+        QTest::qWait(100);
+    }
+
+    void testChangedFields() {
+        recorder.clear();
+        QVERIFY(change("BATTERY_VOLT_NOW=3950"));
+        QVERIFY(recorder.wait(1));
+        QCOMPARE(recorder.fields.size(), 1);
+        QCOMPARE(recorder.fields[0], QmBattery::StatFields(QmBattery::StatVoltage));
+        QCOMPARE(recorder.stats[0].voltage, 3950);
+    }
+
+    void testChangedFieldsTogether() {
+        recorder.clear();
+        QVERIFY(change("BATTERY_CURRENT=250 BATTERY_TEMP=310 BATTERY_LEVEL_PCT=74"));
+        QVERIFY(recorder.wait(1));
+        QCOMPARE(recorder.fields.size(), 1);
+        QCOMPARE(recorder.fields[0], QmBattery::StatCurrent
+                                     | QmBattery::StatTemperature
+                                     | QmBattery::StatCapacityLevel);
+        QCOMPARE(recorder.stats[0].current, 250);
+        QCOMPARE(recorder.stats[0].temperature, 37);
+        QCOMPARE(recorder.stats[0].capacityPct, 74);
+    }
+
+    void testUnchangedFields() {
+        recorder.clear();
+        QVERIFY(change("BATTERY_VOLT_NOW=3950"));
+        QTest::qWait(200);
+        QCOMPARE(recorder.fields.size(), 0);
+    }
+
+    void testRateLimit() {
+        battery->setStatRateLimit(QmBattery::StatVoltage, RATE_LIMIT);
+        /* The voltage was last reported longer ago than the limit */
+        QTest::qWait(RATE_LIMIT + 100);
+
+        recorder.clear();
+        QVERIFY(change("BATTERY_VOLT_NOW=3960"));
+        QVERIFY(recorder.wait(1));
+        QCOMPARE(recorder.fields[0], QmBattery::StatFields(QmBattery::StatVoltage));
+
+        /* Held back, only the last value counts */
+        QVERIFY(change("BATTERY_VOLT_NOW=3970"));
+        QVERIFY(change("BATTERY_VOLT_NOW=3980"));
+        QTest::qWait(200);
+        QCOMPARE(recorder.fields.size(), 1);
+
+        /* Fields without a limit are not held back with it */
+        QVERIFY(change("BATTERY_TEMP=315"));
+        QVERIFY(recorder.wait(2));
+        QCOMPARE(recorder.fields[1], QmBattery::StatFields(QmBattery::StatTemperature));
+        QCOMPARE(recorder.stats[1].temperature, 42);
+
+        QVERIFY(recorder.wait(3));
+        QCOMPARE(recorder.fields.size(), 3);
+        QCOMPARE(recorder.fields[2], QmBattery::StatFields(QmBattery::StatVoltage));
+        QCOMPARE(recorder.stats[2].voltage, 3980);
+
+        QTest::qWait(RATE_LIMIT + 100);
+        QCOMPARE(recorder.fields.size(), 3);
+
+        battery->setStatRateLimit(QmBattery::StatVoltage, 0);
+    }
+
+    void testRateLimitRemoved() {
+        recorder.clear();
+        QVERIFY(change("BATTERY_VOLT_NOW=3990"));
+        QVERIFY(change("BATTERY_VOLT_NOW=4000"));
+        QVERIFY(recorder.wait(2));
+        QCOMPARE(recorder.stats[0].voltage, 3990);
+        QCOMPARE(recorder.stats[1].voltage, 4000);
+    }
+
+    void cleanupTestCase() {
+        delete battery;
+        simulator.terminate();
+        simulator.waitForFinished();
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "batterystat.moc"
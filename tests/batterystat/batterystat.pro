@@ -0,0 +1,6 @@
+QT += network
+QT -= gui
+SOURCES += batterystat.cpp
+
+TARGET = batterystat-test
+include(../common-install.pri)
@@ -0,0 +1,195 @@
+/**
+ * @file fusedorientation.cpp
+ * @brief QmFusedOrientation tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QObject>
+#include <QTest>
+#include <qmfusedorientation.h>
+#include <math.h>
+
+#include "qmaccelerometer_p.h"
+#include "qmfusedorientation_p.h"
+#include "qmmagnetometer_p.h"
+
+using namespace MeeGo;
+
+/* Angles are compared to a hundredth of a degree */
+#define FUZZY(a, b) (fabsf((a) - (b)) < 0.01f)
+/* Or to half a degree, from readings rounded to integers */
+#define ROUNDED(a, b) (fabsf((a) - (b)) < 0.5f)
+
+class SignalDump : public QObject {
+    Q_OBJECT
+
+public:
+    SignalDump(QObject *parent = NULL) : QObject(parent) {}
+
+public slots:
+    void receive(const MeeGo::QmFusedOrientationReading&) {}
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    MeeGo::QmFusedOrientation *sensor;
+    SignalDump signalDump;
+
+private slots:
+    void initTestCase() {
+        sensor = new MeeGo::QmFusedOrientation();
+        QVERIFY(sensor);
+    }
+
+    void testFlat() {
+        // Face up, top edge towards north, field pointing north and down
+        QmOrientationFusion fusion;
+        fusion.setGravity(0, 0, 9.81f);
+        QVERIFY(!fusion.update());
+        fusion.setField(0, 20, -40);
+        QVERIFY(fusion.update());
+        QVERIFY(FUZZY(fusion.heading(), 0));
+        QVERIFY(FUZZY(fusion.pitch(), 0));
+        QVERIFY(FUZZY(fusion.roll(), 0));
+        QVERIFY(FUZZY(fusion.quaternion()[0], 1));
+    }
+
+    void testHeading() {
+        // Turned clockwise, north is to the left of the device
+        QmOrientationFusion fusion;
+        fusion.setGravity(0, 0, 9.81f);
+        fusion.setField(-20, 0, -40);
+        QVERIFY(fusion.update());
+        QVERIFY(FUZZY(fusion.heading(), 90));
+
+        fusion.reset();
+        fusion.setGravity(0, 0, 9.81f);
+        fusion.setField(20, 0, -40);
+        QVERIFY(fusion.update());
+        QVERIFY(FUZZY(fusion.heading(), 270));
+    }
+
+    void testTilt() {
+        // Top edge raised by 30 degrees
+        QmOrientationFusion fusion;
+        float angle = 30 * (float)M_PI / 180;
+        fusion.setGravity(0, sinf(angle), cosf(angle));
+        fusion.setField(0, cosf(angle), -sinf(angle));
+        QVERIFY(fusion.update());
+        QVERIFY(FUZZY(fusion.heading(), 0));
+        QVERIFY(FUZZY(fusion.pitch(), 30));
+        QVERIFY(FUZZY(fusion.roll(), 0));
+
+        // Right edge raised by 30 degrees
+        fusion.reset();
+        fusion.setGravity(sinf(angle), 0, cosf(angle));
+        fusion.setField(-40 * sinf(angle), 20, -40 * cosf(angle));
+        QVERIFY(fusion.update());
+        QVERIFY(FUZZY(fusion.heading(), 0));
+        QVERIFY(FUZZY(fusion.pitch(), 0));
+        QVERIFY(FUZZY(fusion.roll(), 30));
+    }
+
+    void testSmoothing() {
+        QmOrientationFusion fusion;
+        fusion.smoothing = 0.5f;
+        fusion.setGravity(0, 0, 9.81f);
+        fusion.setField(0, 20, -40);
+        QVERIFY(fusion.update());
+
+        // Moves part of the way, and gets there if the device stays still
+        fusion.setField(-20, 0, -40);
+        QVERIFY(fusion.update());
+        QVERIFY(fusion.heading() > 1 && fusion.heading() < 89);
+        for (int i = 0; i < 40; i++) {
+            QVERIFY(fusion.update());
+        }
+        QVERIFY(FUZZY(fusion.heading(), 90));
+
+        // Parallel gravity and field give no heading
+        fusion.setField(0, 0, 40);
+        QVERIFY(!fusion.update());
+        QVERIFY(FUZZY(fusion.heading(), 90));
+    }
+
+    void testSensorFrames() {
+        // Readings as sensord delivers them, in the axes of the sensors:
+        // device x is sensor -y and device y is sensor x
+        QmFusedOrientationPrivate priv(sensor);
+
+        // Face up and turned clockwise, north is to the left of the device
+        priv.slotMagneticField(QmMagnetometerPrivate::convert(
+            MagneticField(CalibratedMagneticFieldData(1000, 0, 200, -400, 0, 200, -400, 3))));
+        priv.slotAcceleration(QmAccelerometerPrivate::convert(
+            XYZ(TimedXyzData(1000, 0, 0, 1000))));
+        QVERIFY(ROUNDED(priv.fusion.heading(), 90));
+        QVERIFY(ROUNDED(priv.fusion.pitch(), 0));
+        QVERIFY(ROUNDED(priv.fusion.roll(), 0));
+
+        // Right edge raised by 30 degrees, top edge towards north
+        priv.fusion.reset();
+        priv.slotMagneticField(QmMagnetometerPrivate::convert(
+            MagneticField(CalibratedMagneticFieldData(2000, 200, 200, -346, 200, 200, -346, 3))));
+        priv.slotAcceleration(QmAccelerometerPrivate::convert(
+            XYZ(TimedXyzData(2000, 0, -500, 866))));
+        QVERIFY(ROUNDED(priv.fusion.heading(), 0));
+        QVERIFY(ROUNDED(priv.fusion.pitch(), 0));
+        QVERIFY(ROUNDED(priv.fusion.roll(), 30));
+    }
+
+    void testConnectSignals() {
+        QVERIFY(connect(sensor, SIGNAL(dataAvailable(const MeeGo::QmFusedOrientationReading&)),
+                &signalDump, SLOT(receive(const MeeGo::QmFusedOrientationReading&))));
+    }
+
+    void testRequestSession() {
+        QVERIFY2(sensor->requestSession(MeeGo::QmSensor::SessionTypeControl) != MeeGo::QmSensor::SessionTypeNone,
+                 sensor->lastError().toLocal8Bit());
+    }
+
+    void testStartStop() {
+        QVERIFY2(sensor->start(), sensor->lastError().toLocal8Bit());
+        QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
+    }
+
+    void testSettings() {
+        sensor->setSmoothing(0.5f);
+        QCOMPARE(sensor->smoothing(), 0.5f);
+        sensor->setSmoothing(2);
+        QCOMPARE(sensor->smoothing(), 1.0f);
+
+        sensor->setInterval(100);
+        QCOMPARE(sensor->interval(), 100);
+    }
+
+    void testGetFunction() {
+        QmFusedOrientationReading result = sensor->orientation();
+        Q_UNUSED(result);
+    }
+
+    void cleanupTestCase() {
+        delete sensor;
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "fusedorientation.moc"
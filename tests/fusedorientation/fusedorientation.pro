@@ -0,0 +1,6 @@
+QT += dbus
+QT -= gui
+SOURCES += fusedorientation.cpp
+
+TARGET = fusedorientation-test
+include(../common-install.pri)
@@ -0,0 +1,213 @@
+/**
+ * @file gesture.cpp
+ * @brief QmGesture tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QObject>
+#include <QList>
+#include <QTest>
+#include <qmgesture.h>
+#include <math.h>
+
+#include "qmgesture_p.h"
+
+using namespace MeeGo;
+
+/* Readings every 20 ms, as the sensor asks for */
+#define STEP 20000
+
+class SignalDump : public QObject {
+    Q_OBJECT
+
+public:
+    SignalDump(QObject *parent = NULL) : QObject(parent) {}
+
+public slots:
+    void receive(const MeeGo::QmGestureReading) {}
+};
+
+/* Feeds the detector and collects the gestures */
+class Stream
+{
+public:
+    Stream() : time(0) {}
+
+    void add(int count, int x, int y, int z) {
+        for (int i = 0; i < count; i++) {
+            QmGestureReading found[GESTURE_EVENTS_MAX];
+            time += STEP;
+            int n = detector.add(time, x, y, z, found);
+            for (int j = 0; j < n; j++) {
+                events.append(found[j]);
+            }
+        }
+    }
+
+    /* Held still, turned by degrees to the right and to the front */
+    void hold(int count, float roll, float pitch) {
+        float r = roll * (float)M_PI / 180;
+        float p = pitch * (float)M_PI / 180;
+        add(count, qRound(-1000 * sinf(r) * cosf(p)), qRound(-1000 * sinf(p)), qRound(1000 * cosf(r) * cosf(p)));
+    }
+
+    /* Shaken along the x-axis, a swing every 100 ms */
+    void shake(int count, int strength) {
+        for (int i = 0; i < count; i++) {
+            add(5, (i % 2) ? -strength : strength, 0, 1000);
+        }
+    }
+
+    QmGestureDetector detector;
+    QList<QmGestureReading> events;
+    quint64 time;
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    MeeGo::QmGesture *sensor;
+    SignalDump signalDump;
+
+private slots:
+    void initTestCase() {
+        sensor = new MeeGo::QmGesture();
+        QVERIFY(sensor);
+    }
+
+    void testRest() {
+        Stream stream;
+        stream.hold(200, 0, 0);
+        stream.hold(200, 10, 5);
+        QCOMPARE(stream.events.count(), 0);
+    }
+
+    void testShake() {
+        // One event per second of shaking
+        Stream stream;
+        stream.hold(50, 0, 0);
+        stream.shake(30, 1800);
+        stream.hold(50, 0, 0);
+        QCOMPARE(stream.events.count(), 3);
+        foreach (QmGestureReading event, stream.events) {
+            QCOMPARE(event.gesture, QmGesture::Shake);
+            QCOMPARE(event.direction, QmGesture::X);
+            QVERIFY(event.value >= 1200);
+        }
+
+        // Too gentle
+        stream.events.clear();
+        stream.shake(30, 800);
+        QCOMPARE(stream.events.count(), 0);
+    }
+
+    void testFreeFall() {
+        Stream stream;
+        stream.hold(50, 0, 0);
+        quint64 start = stream.time;
+        stream.add(20, 50, -30, 100);
+        stream.hold(50, 0, 0);
+        QCOMPARE(stream.events.count(), 1);
+        QCOMPARE(stream.events[0].gesture, QmGesture::FreeFall);
+        QCOMPARE(stream.events[0].direction, QmGesture::NoDirection);
+        QVERIFY(stream.events[0].timestamp - start >= FREEFALL_DURATION);
+        QVERIFY(stream.events[0].value >= FREEFALL_DURATION / 1000);
+
+        // Too short a drop
+        stream.events.clear();
+        stream.add(3, 0, 0, 100);
+        stream.hold(50, 0, 0);
+        QCOMPARE(stream.events.count(), 0);
+    }
+
+    void testTilt() {
+        Stream stream;
+        stream.hold(50, 0, 0);
+        stream.hold(100, 40, 0);
+        QCOMPARE(stream.events.count(), 1);
+        QCOMPARE(stream.events[0].gesture, QmGesture::Tilt);
+        QCOMPARE(stream.events[0].direction, QmGesture::Right);
+        QVERIFY(stream.events[0].value >= 30 && stream.events[0].value <= 40);
+
+        // From the attitude of the previous tilt
+        stream.hold(100, 0, 0);
+        QCOMPARE(stream.events.count(), 2);
+        QCOMPARE(stream.events[1].direction, QmGesture::Left);
+
+        stream.hold(100, 0, 40);
+        QCOMPARE(stream.events.count(), 3);
+        QCOMPARE(stream.events[2].direction, QmGesture::Forward);
+    }
+
+    void testThresholds() {
+        Stream stream;
+        stream.detector.thresholds[QmGesture::Tilt] = 0;
+        stream.hold(50, 0, 0);
+        stream.hold(100, 40, 0);
+        QCOMPARE(stream.events.count(), 0);
+
+        // A shake is no tilt, even with shakes not detected
+        stream.detector.thresholds[QmGesture::Tilt] = 30;
+        stream.detector.thresholds[QmGesture::Shake] = 0;
+        stream.hold(100, 0, 0);
+        stream.events.clear();
+        stream.shake(30, 1800);
+        QCOMPARE(stream.events.count(), 0);
+
+        stream.detector.thresholds[QmGesture::Tilt] = 10;
+        stream.hold(100, 15, 0);
+        QCOMPARE(stream.events.count(), 1);
+    }
+
+    void testConnectSignals() {
+        QVERIFY(connect(sensor, SIGNAL(gestureDetected(const MeeGo::QmGestureReading)),
+                &signalDump, SLOT(receive(const MeeGo::QmGestureReading))));
+    }
+
+    void testRequestSession() {
+        QVERIFY2(sensor->requestSession(MeeGo::QmSensor::SessionTypeControl) != MeeGo::QmSensor::SessionTypeNone,
+                 sensor->lastError().toLocal8Bit());
+        QCOMPARE(sensor->interval(), GESTURE_INTERVAL);
+    }
+
+    void testStartStop() {
+        QVERIFY2(sensor->start(), sensor->lastError().toLocal8Bit());
+        QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
+    }
+
+    void testSettings() {
+        QCOMPARE(sensor->threshold(MeeGo::QmGesture::Shake), 1200);
+        QCOMPARE(sensor->threshold(MeeGo::QmGesture::Tilt), 30);
+        QCOMPARE(sensor->threshold(MeeGo::QmGesture::FreeFall), 300);
+
+        sensor->setThreshold(MeeGo::QmGesture::Tilt, 45);
+        QCOMPARE(sensor->threshold(MeeGo::QmGesture::Tilt), 45);
+        sensor->setThreshold(MeeGo::QmGesture::Shake, -1);
+        QCOMPARE(sensor->threshold(MeeGo::QmGesture::Shake), 0);
+    }
+
+    void cleanupTestCase() {
+        delete sensor;
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "gesture.moc"
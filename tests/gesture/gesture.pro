@@ -0,0 +1,6 @@
+QT += dbus
+QT -= gui
+SOURCES += gesture.cpp
+
+TARGET = gesture-test
+include(../common-install.pri)
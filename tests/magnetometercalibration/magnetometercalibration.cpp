@@ -0,0 +1,283 @@
+/**
+ * @file magnetometercalibration.cpp
+ * @brief Magnetometer calibration tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+#include <math.h>
+#include <string.h>
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QTest>
+#include <qmmagnetometer.h>
+
+#include "qmmagnetometer_p.h"
+#include "qmmagnetometercalibration_p.h"
+#include "qmsensorkernels_p.h"
+
+#define FIELD 48000 /* nT */
+#define NOISE 300   /* nT */
+
+using namespace MeeGo;
+
+class SignalDump : public QObject {
+    Q_OBJECT
+
+public:
+    SignalDump(QObject *parent = NULL) : QObject(parent) {}
+
+    QList<QmMagnetometerReading> readings;
+
+public slots:
+    void receive(const MeeGo::QmMagnetometerReading& data) {
+        readings.append(data);
+    }
+};
+
+/*
+ * Raw readings of a device turned all around in a field of FIELD, seen
+ * through an offset and a distortion
+ */
+class Device
+{
+public:
+    Device()
+    {
+        double distortion[3][3] = { { 1.2, 0.1, 0 }, { 0.1, 0.9, -0.05 }, { 0, -0.05, 1.0 } };
+        memcpy(soft, distortion, sizeof(soft));
+        hard[0] = 12000;
+        hard[1] = -7000;
+        hard[2] = 3000;
+    }
+
+    double hard[3];
+    double soft[3][3];
+
+    void next(int *raw)
+    {
+        double theta = acos(2 * random() - 1);
+        double phi = 2 * M_PI * random();
+        double field[3] = { FIELD * sin(theta) * cos(phi), FIELD * sin(theta) * sin(phi), FIELD * cos(theta) };
+        for (int i = 0; i < 3; i++) {
+            double value = hard[i] + (random() - 0.5) * NOISE;
+            for (int j = 0; j < 3; j++) {
+                value += soft[i][j] * field[j];
+            }
+            raw[i] = qRound(value);
+        }
+    }
+
+    /* The field strength after the correction, which keeps the volume
+       of the distorted sphere */
+    double strength() const
+    {
+        double det = soft[0][0] * (soft[1][1] * soft[2][2] - soft[1][2] * soft[2][1])
+                   - soft[0][1] * (soft[1][0] * soft[2][2] - soft[1][2] * soft[2][0])
+                   + soft[0][2] * (soft[1][0] * soft[2][1] - soft[1][1] * soft[2][0]);
+        return FIELD * cbrt(det);
+    }
+
+    static double random()
+    {
+        return qrand() / (double)RAND_MAX;
+    }
+};
+
+static double length(int x, int y, int z)
+{
+    return sqrt((double)x * x + (double)y * y + (double)z * z);
+}
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString home;
+
+    /* Largest difference of the corrected field strength from the expected one, relative */
+    static double error(const QmMagneticCorrection &correction)
+    {
+        Device device;
+        double strength = device.strength();
+        double worst = 0;
+        for (int i = 0; i < 500; i++) {
+            int v[3];
+            device.next(v);
+            kernelMagneticCorrectionScalar(&v[0], &v[1], &v[2], 1, correction.offset, correction.matrix);
+            worst = qMax(worst, fabs(length(v[0], v[1], v[2]) / strength - 1));
+        }
+        return worst;
+    }
+
+    static MagneticField magneticField(quint64 timestamp, const int *raw)
+    {
+        return MagneticField(CalibratedMagneticFieldData(timestamp, 1, 2, 3, raw[0], raw[1], raw[2], 1));
+    }
+
+private slots:
+    void initTestCase() {
+        qsrand(1);
+        // The stored calibration goes under the home directory
+        home = QDir::tempPath() + "/magnetometercalibration-test";
+        QDir().mkpath(home);
+        qputenv("HOME", home.toLocal8Bit());
+    }
+
+    void testFit() {
+        QmMagneticCalibration calibration;
+        Device device;
+        int changes = 0;
+        for (int i = 0; i < 2000; i++) {
+            int v[3];
+            device.next(v);
+            if (calibration.add(v[0], v[1], v[2])) {
+                changes++;
+            }
+        }
+        QVERIFY(changes > 0);
+        QCOMPARE(calibration.correction.level, 3);
+        for (int i = 0; i < 3; i++) {
+            QVERIFY(fabs(calibration.correction.offset[i] - device.hard[i]) < NOISE);
+        }
+        QVERIFY(error(calibration.correction) < 0.02);
+    }
+
+    void testCoverage() {
+        // Held still, the samples are skipped
+        QmMagneticCalibration still;
+        for (int i = 0; i < 2000; i++) {
+            still.add(20000 + i % 3, -10000, 40000);
+        }
+        QCOMPARE(still.correction.level, 0);
+
+        // Turned around one axis only, the ellipsoid is not determined
+        QmMagneticCalibration flat;
+        for (int i = 0; i < 2000; i++) {
+            double phi = 2 * M_PI * Device::random();
+            flat.add(qRound(FIELD * cos(phi)), qRound(FIELD * sin(phi)), 20000);
+        }
+        QCOMPARE(flat.correction.level, 0);
+    }
+
+    void testAdapts() {
+        QmMagneticCalibration calibration;
+        Device device;
+        int v[3];
+        for (int i = 0; i < 2000; i++) {
+            device.next(v);
+            calibration.add(v[0], v[1], v[2]);
+        }
+        QCOMPARE(calibration.correction.level, 3);
+
+        // A magnet nearby: the old samples are forgotten
+        device.hard[0] += 10000;
+        for (int i = 0; i < 3000; i++) {
+            device.next(v);
+            calibration.add(v[0], v[1], v[2]);
+        }
+        QCOMPARE(calibration.correction.level, 3);
+        QVERIFY(fabs(calibration.correction.offset[0] - device.hard[0]) < NOISE);
+    }
+
+    void testKernel() {
+        QmMagneticCorrection correction;
+        QmMagneticCalibration calibration;
+        Device device;
+        int v[3];
+        for (int i = 0; i < 2000; i++) {
+            device.next(v);
+            calibration.add(v[0], v[1], v[2]);
+        }
+        correction = calibration.correction;
+        QVERIFY(correction.level > 0);
+
+        // Any batch size, the rest of a batch is done one at a time
+        for (int count = 1; count < 40; count++) {
+            int x[40], y[40], z[40];
+            int sx[40], sy[40], sz[40];
+            for (int i = 0; i < count; i++) {
+                device.next(v);
+                sx[i] = x[i] = v[0];
+                sy[i] = y[i] = v[1];
+                sz[i] = z[i] = v[2];
+            }
+            kernelMagneticCorrection(x, y, z, count, correction.offset, correction.matrix);
+            kernelMagneticCorrectionScalar(sx, sy, sz, count, correction.offset, correction.matrix);
+            for (int i = 0; i < count; i++) {
+                // Fused multiply-adds may round differently
+                QVERIFY(qAbs(x[i] - sx[i]) <= 1);
+                QVERIFY(qAbs(y[i] - sy[i]) <= 1);
+                QVERIFY(qAbs(z[i] - sz[i]) <= 1);
+            }
+        }
+    }
+
+    void testStream() {
+        QFile::remove(home + "/.qmsystem2/magnetometer-calibration");
+
+        QmMagnetometer magnetometer;
+        QmMagnetometerPrivate *priv = new QmMagnetometerPrivate(&magnetometer);
+        SignalDump dump;
+        QVERIFY(connect(priv, SIGNAL(dataAvailable(const MeeGo::QmMagnetometerReading&)),
+                        &dump, SLOT(receive(const MeeGo::QmMagnetometerReading&))));
+
+        // Off by default, the readings of the daemon pass
+        Device device;
+        int v[3];
+        device.next(v);
+        priv->slotDataAvailable(magneticField(1000, v));
+        QCOMPARE(dump.readings.size(), 1);
+        QCOMPARE(dump.readings[0].x, 1);
+        QCOMPARE(dump.readings[0].level, 1);
+
+        priv->setCalibrating(true);
+        QCOMPARE(priv->calibrationLevel(), 0);
+        for (int i = 0; i < 2000; i++) {
+            device.next(v);
+            priv->slotDataAvailable(magneticField(2000 + i * 20000, v));
+        }
+        QCOMPARE(priv->calibrationLevel(), 3);
+        const QmMagnetometerReading &last = dump.readings.last();
+        QCOMPARE(last.level, 3);
+        QVERIFY(fabs(length(last.x, last.y, last.z) / device.strength() - 1) < 0.02);
+        QCOMPARE(last.rx, v[0]);
+        priv->setCalibrating(false);
+        QVERIFY(QFile::exists(home + "/.qmsystem2/magnetometer-calibration"));
+
+        // The stored one is in use from the start
+        QmMagnetometer other;
+        other.setCalibration(true);
+        QVERIFY(other.calibration());
+        QCOMPARE(other.calibrationLevel(), 3);
+
+        // Gone with the calibration of the daemon
+        other.reset();
+        QCOMPARE(other.calibrationLevel(), 0);
+        QVERIFY(!QFile::exists(home + "/.qmsystem2/magnetometer-calibration"));
+    }
+
+    void cleanupTestCase() {
+        QFile::remove(home + "/.qmsystem2/magnetometer-calibration");
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "magnetometercalibration.moc"
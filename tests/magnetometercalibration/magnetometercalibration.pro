@@ -0,0 +1,6 @@
+QT += dbus
+QT -= gui
+SOURCES += magnetometercalibration.cpp
+
+TARGET = magnetometercalibration-test
+include(../common-install.pri)
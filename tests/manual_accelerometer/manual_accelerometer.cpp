@@ -26,6 +26,7 @@
 #include <QObject>
 #include <qmaccelerometer.h>
 #include <QTest>
+#include <QDebug>
 #include <cstdio>
 
 #define TOLERANCE 150
@@ -120,6 +121,7 @@ private slots:
     }
 
     void cleanupTestCase() {
+        qDebug() << "Statistics:" << sensor->statistics().toString();
         QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
         delete sensor;
     }
@@ -124,6 +124,7 @@ private slots:
     }
 
     void cleanupTestCase() {
+        qDebug() << "Statistics:" << sensor->statistics().toString();
         QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
         delete sensor;
     }
@@ -25,6 +25,7 @@
 #include <QObject>
 #include <qmmagnetometer.h>
 #include <QTest>
+#include <QDebug>
 #include <QList>
 #include <QTime>
 #include <cstdio>
@@ -99,6 +100,7 @@ private slots:
 
 
     void cleanupTestCase() {
+        qDebug() << "Statistics:" << sensor->statistics().toString();
         QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
         delete sensor;
     }
@@ -27,6 +27,7 @@
 #include <QObject>
 #include <qmcompass.h>
 #include <QTest>
+#include <QDebug>
 #include <QList>
 #include <QTime>
 #include <cstdio>
@@ -155,6 +156,7 @@ private slots:
 
 
     void cleanupTestCase() {
+        qDebug() << "Statistics:" << sensor->statistics().toString();
         QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
         delete sensor;
     }
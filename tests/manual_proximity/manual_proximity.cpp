@@ -26,6 +26,7 @@
 #include <QObject>
 #include <qmproximity.h>
 #include <QTest>
+#include <QDebug>
 #include <cstdio>
 
 using namespace MeeGo;
@@ -82,6 +83,7 @@ private slots:
     }
 
     void cleanupTestCase() {
+        qDebug() << "Statistics:" << sensor->statistics().toString();
         QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
         delete sensor;
     }
@@ -31,10 +31,22 @@ class SignalDump : public QObject {
     Q_OBJECT
 
 public:
-    SignalDump(QObject *parent = NULL) : QObject(parent) {}
+    SignalDump(QObject *parent = NULL) : QObject(parent), batches(0), largestBatch(0), emptyBatches(0) {}
+
+    int batches;
+    int largestBatch;
+    int emptyBatches;
 
 public slots:
     void receive(const MeeGo::QmRotationReading&) {}
+
+    void receiveBatch(const QVector<MeeGo::QmRotationReading>& data) {
+        batches++;
+        largestBatch = qMax(largestBatch, data.size());
+        if (data.isEmpty()) {
+            emptyBatches++;
+        }
+    }
 };
 
 class TestClass : public QObject
@@ -76,6 +88,25 @@ private slots:
         Q_UNUSED(result);
     }
 
+    void testBatch() {
+        QCOMPARE(sensor->batchSize(), 0);
+        QVERIFY(connect(sensor, SIGNAL(dataAvailable(const QVector<MeeGo::QmRotationReading>&)),
+                &signalDump, SLOT(receiveBatch(const QVector<MeeGo::QmRotationReading>&))));
+
+        sensor->setBatchSize(10, 100);
+        QCOMPARE(sensor->batchSize(), 10);
+
+        QVERIFY2(sensor->start(), sensor->lastError().toLocal8Bit());
+        QTest::qWait(500);
+        QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
+
+        QVERIFY(signalDump.largestBatch <= 10);
+        QCOMPARE(signalDump.emptyBatches, 0);
+
+        sensor->setBatchSize(1);
+        QCOMPARE(sensor->batchSize(), 0);
+    }
+
     void cleanupTestCase() {
         delete sensor;
     }
@@ -0,0 +1,192 @@
+/**
+ * @file sensorarena.cpp
+ * @brief Sensor reading type and arena tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+#include <QCoreApplication>
+#include <QMetaType>
+#include <QObject>
+#include <QTest>
+#include <QThread>
+#include <QTime>
+#include <QVector>
+#include <qmaccelerometer.h>
+#include <qmals.h>
+#include <qmrotation.h>
+#include <qmsensorsynchronizer.h>
+
+#include "qmsensorarena_p.h"
+
+#define READINGS 1000
+
+using namespace MeeGo;
+
+/* Lives on the worker thread and emits readings from there */
+class Emitter : public QObject {
+    Q_OBJECT
+
+signals:
+    void dataAvailable(const MeeGo::QmAccelerometerReading& data);
+
+public slots:
+    void run() {
+        for (int i = 0; i < READINGS; i++) {
+            QmAccelerometerReading reading;
+            reading.timestamp = i * 10000;
+            reading.x = i;
+            reading.y = -i;
+            reading.z = 1000;
+            emit dataAvailable(reading);
+        }
+    }
+};
+
+class SignalDump : public QObject {
+    Q_OBJECT
+
+public:
+    SignalDump() : received(0), wrong(0) {}
+
+    int received;
+    int wrong;
+
+public slots:
+    void receive(const MeeGo::QmAccelerometerReading& data) {
+        if (data.timestamp != (quint64)received * 10000 || data.x != received || data.y != -received) {
+            wrong++;
+        }
+        received++;
+    }
+};
+
+/* Bytes from the start of the reading to the field */
+template <typename Reading, typename Field>
+static int offset(const Reading &reading, const Field &field)
+{
+    return (const char *)&field - (const char *)&reading;
+}
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRegistered() {
+        // Before any sensor has been created
+        const char *names[] = {
+            "MeeGo::QmAccelerometerReading", "QVector<MeeGo::QmAccelerometerReading>",
+            "MeeGo::QmAlsReading", "MeeGo::QmCompassReading", "MeeGo::QmFusedOrientationReading",
+            "MeeGo::QmGestureReading", "MeeGo::QmMagnetometerReading", "MeeGo::QmOrientationReading",
+            "MeeGo::QmProximityReading", "MeeGo::QmRotationReading", "QVector<MeeGo::QmRotationReading>",
+            "MeeGo::QmSynchronizedReading", "MeeGo::QmTapReading"
+        };
+        for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            QVERIFY2(QMetaType::isRegistered(QMetaType::type(names[i])), names[i]);
+        }
+    }
+
+    void testLayout() {
+        // Copied as bytes: the timestamp of QmSensorReading, then the fields
+        QVERIFY(!QTypeInfo<QmAccelerometerReading>::isComplex);
+        QVERIFY(!QTypeInfo<QmSynchronizedReading>::isComplex);
+        QmAccelerometerReading acceleration = QmAccelerometerReading();
+        QmAlsReading lux = QmAlsReading();
+        QmSynchronizedReading frame = QmSynchronizedReading();
+        QCOMPARE(offset(acceleration, acceleration.timestamp), 0);
+        QCOMPARE(offset(acceleration, acceleration.x), 8);
+        QCOMPARE(offset(lux, lux.value), 8);
+        QCOMPARE(offset(frame, frame.sources), 8);
+    }
+
+    void testArena() {
+        int type = QMetaType::type("MeeGo::QmAccelerometerReading");
+        QmAccelerometerReading reading;
+        reading.timestamp = 1234;
+        reading.x = 1;
+        reading.y = 2;
+        reading.z = 3;
+
+        void *copy = QMetaType::construct(type, &reading);
+        QVERIFY(QmSensorArena<QmAccelerometerReading>::owns(copy));
+        QCOMPARE(QmSensorArena<QmAccelerometerReading>::used(), 1);
+        QCOMPARE(static_cast<QmAccelerometerReading*>(copy)->timestamp, (quint64)1234);
+        QCOMPARE(static_cast<QmAccelerometerReading*>(copy)->z, 3);
+        QMetaType::destroy(type, copy);
+        QCOMPARE(QmSensorArena<QmAccelerometerReading>::used(), 0);
+
+        // Default constructed ones are zeroed
+        copy = QMetaType::construct(type, 0);
+        QCOMPARE(static_cast<QmAccelerometerReading*>(copy)->x, 0);
+        QMetaType::destroy(type, copy);
+
+        // Past the arena, copies go to the heap and come back from there
+        QList<void*> copies;
+        for (int i = 0; i < SENSOR_ARENA_SLOTS + 10; i++) {
+            copies.append(QMetaType::construct(type, &reading));
+        }
+        QCOMPARE(QmSensorArena<QmAccelerometerReading>::used(), SENSOR_ARENA_SLOTS);
+        QVERIFY(!QmSensorArena<QmAccelerometerReading>::owns(copies.last()));
+        foreach (void *p, copies) {
+            QCOMPARE(static_cast<QmAccelerometerReading*>(p)->y, 2);
+            QMetaType::destroy(type, p);
+        }
+        QCOMPARE(QmSensorArena<QmAccelerometerReading>::used(), 0);
+    }
+
+    void testBatch() {
+        int type = QMetaType::type("QVector<MeeGo::QmRotationReading>");
+        QVector<QmRotationReading> batch(5);
+        batch[4].x = 90;
+        void *copy = QMetaType::construct(type, &batch);
+        QVERIFY(QmSensorArena<QVector<QmRotationReading> >::owns(copy));
+        QCOMPARE(static_cast<QVector<QmRotationReading>*>(copy)->at(4).x, 90);
+        QMetaType::destroy(type, copy);
+        QCOMPARE(QmSensorArena<QVector<QmRotationReading> >::used(), 0);
+    }
+
+    void testQueued() {
+        QThread worker;
+        worker.start();
+        Emitter emitter;
+        emitter.moveToThread(&worker);
+        SignalDump dump;
+        QVERIFY(connect(&emitter, SIGNAL(dataAvailable(const MeeGo::QmAccelerometerReading&)),
+                        &dump, SLOT(receive(const MeeGo::QmAccelerometerReading&))));
+
+        QMetaObject::invokeMethod(&emitter, "run", Qt::BlockingQueuedConnection);
+        // The ones still queued are in the arena, up to its size
+        QVERIFY(QmSensorArena<QmAccelerometerReading>::used() > 0);
+        QVERIFY(QmSensorArena<QmAccelerometerReading>::used() <= SENSOR_ARENA_SLOTS);
+
+        QTime wait;
+        wait.start();
+        while (dump.received < READINGS && wait.elapsed() < 5000) {
+            QCoreApplication::processEvents();
+        }
+        QCOMPARE(dump.received, READINGS);
+        QCOMPARE(dump.wrong, 0);
+        QCOMPARE(QmSensorArena<QmAccelerometerReading>::used(), 0);
+
+        worker.quit();
+        worker.wait();
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorarena.moc"
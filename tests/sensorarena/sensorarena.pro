@@ -0,0 +1,6 @@
+QT += dbus
+QT -= gui
+SOURCES += sensorarena.cpp
+
+TARGET = sensorarena-test
+include(../common-install.pri)
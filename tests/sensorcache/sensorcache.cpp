@@ -0,0 +1,121 @@
+/**
+ * @file sensorcache.cpp
+ * @brief QmSensorCache tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QObject>
+#include <QThread>
+#include <QTest>
+#include <qmaccelerometer.h>
+#include <qmmagnetometer.h>
+
+#include "qmmagnetometer_p.h"
+#include "qmsensor_p.h"
+
+#define STORES 2000000
+
+using namespace MeeGo;
+
+static QmAccelerometerReading reading(int i)
+{
+    QmAccelerometerReading r;
+    r.timestamp = i;
+    r.x = i;
+    r.y = -i;
+    r.z = 2 * i;
+    return r;
+}
+
+class CacheReader : public QThread
+{
+public:
+    CacheReader(QmSensorCache<QmAccelerometerReading> *cache) : cache(cache), done(false), loaded(0), torn(0) {}
+
+    QmSensorCache<QmAccelerometerReading> *cache;
+    volatile bool done;
+    int loaded;
+    int torn;
+
+protected:
+    void run() {
+        QmAccelerometerReading out;
+        while (!done) {
+            if (cache->load(&out)) {
+                if (out.x != (int)out.timestamp || out.y != -out.x || out.z != 2 * out.x) {
+                    torn++;
+                }
+                loaded++;
+            }
+        }
+    }
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testStoreLoad() {
+        QmSensorCache<QmAccelerometerReading> cache;
+        QmAccelerometerReading out;
+        QVERIFY(!cache.load(&out));
+        cache.store(reading(7));
+        QVERIFY(cache.load(&out));
+        QCOMPARE(out.z, 14);
+        cache.store(reading(8));
+        QVERIFY(cache.load(&out));
+        QCOMPARE(out.timestamp, (quint64)8);
+        cache.clear();
+        QVERIFY(!cache.load(&out));
+    }
+
+    void testThreaded() {
+        // Readers never see half of a store
+        QmSensorCache<QmAccelerometerReading> cache;
+        CacheReader reader(&cache);
+        reader.start();
+        for (int i = 0; i < STORES; i++) {
+            cache.store(reading(i));
+        }
+        reader.done = true;
+        QVERIFY(reader.wait(10000));
+        QVERIFY(reader.loaded > 0);
+        QCOMPARE(reader.torn, 0);
+    }
+
+    void testDeliveredReading() {
+        // The getters see the reading as it was delivered
+        QmMagnetometer magnetometer;
+        QmMagnetometerPrivate priv(&magnetometer);
+        QmMagnetometerReading out;
+        QVERIFY(!priv.cache.load(&out));
+
+        priv.slotDataAvailable(MagneticField(CalibratedMagneticFieldData(1000, 10, 20, 30, 11, 21, 31, 2)));
+        QVERIFY(priv.cache.load(&out));
+        QCOMPARE(out.timestamp, (quint64)1000);
+        QCOMPARE(out.x, 10);
+        QCOMPARE(out.z, 30);
+        QCOMPARE(out.rx, 11);
+        QCOMPARE(out.level, 2);
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorcache.moc"
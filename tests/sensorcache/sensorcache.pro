@@ -0,0 +1,6 @@
+QT += dbus
+QT -= gui
+SOURCES += sensorcache.cpp
+
+TARGET = sensorcache-test
+include(../common-install.pri)
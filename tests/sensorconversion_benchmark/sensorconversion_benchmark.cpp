@@ -0,0 +1,258 @@
+/**
+ * @file sensorconversion_benchmark.cpp
+ * @brief Sensor conversion kernel equivalence and throughput
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <stdlib.h>
+#include <QDebug>
+#include <QObject>
+#include <QTest>
+#include <QTime>
+#include <QVector>
+
+#include "qmsensorkernels_p.h"
+
+#define SAMPLES 10007
+#define BENCHMARK_SAMPLES 4096
+#define BENCHMARK_ROUNDS 2000
+
+using namespace MeeGo;
+
+/* The per-sample conversions as the sensor classes had them */
+static void referenceRotation(int *x, int *y, int *z, int count)
+{
+    for (int i = 0; i < count; i++) {
+        int dx = x[i], dy = y[i], dz = z[i];
+        if (abs(dy) <= 90) {
+            x[i] = -dy;
+        } else {
+            x[i] = (dy < 0 ? 1 : -1) * 180 + dy;
+        }
+        if (abs(dy) <= 90) {
+            y[i] = dx;
+        } else {
+            y[i] = (dx > 0 ? 1 : -1) * (180 - abs(dx));
+        }
+        z[i] = (((dz + 180) + 90) % 360) - 180;
+    }
+}
+
+static void referenceCompass(int *degrees, int count)
+{
+    for (int i = 0; i < count; i++) {
+        degrees[i] = (degrees[i] + 90) % 360;
+    }
+}
+
+static void referenceAccelerometer(int *x, int *y, int count)
+{
+    for (int i = 0; i < count; i++) {
+        int dx = x[i];
+        x[i] = -y[i];
+        y[i] = dx;
+    }
+}
+
+typedef void (*RotationKernel)(int *, int *, int *, int);
+typedef void (*CompassKernel)(int *, int);
+typedef void (*AccelerometerKernel)(int *, int *, int);
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QVector<int> x, y, z;
+
+    /* Samples in the range of the readings, or far outside of it */
+    void fill(int range)
+    {
+        x.resize(SAMPLES);
+        y.resize(SAMPLES);
+        z.resize(SAMPLES);
+        for (int i = 0; i < SAMPLES; i++) {
+            x[i] = qrand() % (2 * range + 1) - range;
+            y[i] = qrand() % (2 * range + 1) - range;
+            z[i] = qrand() % (2 * range + 1) - range;
+        }
+    }
+
+    /* Runs the kernel over the samples in batches of varying size */
+    template <typename Kernel, typename Run>
+    QVector<int> batched(Run run, Kernel kernel)
+    {
+        QVector<int> ax = x, ay = y, az = z;
+        for (int done = 0; done < SAMPLES; ) {
+            int count = qMin(SAMPLES - done, 1 + qrand() % 37);
+            run(kernel, ax.data() + done, ay.data() + done, az.data() + done, count);
+            done += count;
+        }
+        return ax + ay + az;
+    }
+
+    static void runRotation(RotationKernel kernel, int *x, int *y, int *z, int count)
+    {
+        kernel(x, y, z, count);
+    }
+
+    static void runCompass(CompassKernel kernel, int *x, int *, int *, int count)
+    {
+        kernel(x, count);
+    }
+
+    static void runAccelerometer(AccelerometerKernel kernel, int *x, int *y, int *, int count)
+    {
+        kernel(x, y, count);
+    }
+
+    void compareAll()
+    {
+        QVector<int> expected = batched(runRotation, referenceRotation);
+        QVERIFY(batched(runRotation, kernelRotationAxes) == expected);
+        QVERIFY(batched(runRotation, kernelRotationAxesScalar) == expected);
+
+        expected = batched(runCompass, referenceCompass);
+        QVERIFY(batched(runCompass, kernelCompassAzimuth) == expected);
+        QVERIFY(batched(runCompass, kernelCompassAzimuthScalar) == expected);
+
+        expected = batched(runAccelerometer, referenceAccelerometer);
+        QVERIFY(batched(runAccelerometer, kernelAccelerometerAxes) == expected);
+        QVERIFY(batched(runAccelerometer, kernelAccelerometerAxesScalar) == expected);
+    }
+
+    void kernels()
+    {
+        QTest::addColumn<int>("kernel");
+        QTest::newRow("reference") << 0;
+        QTest::newRow("scalar") << 1;
+        QTest::newRow("vectorized") << 2;
+    }
+
+    void report(const char *name, int iterations, int elapsed)
+    {
+        qDebug() << name << QTest::currentDataTag() << ":"
+                 << elapsed * 1e6 / ((double)iterations * BENCHMARK_ROUNDS * BENCHMARK_SAMPLES) << "ns per sample";
+    }
+
+private slots:
+    void initTestCase() {
+        qsrand(1);
+        qDebug() << "Kernels are" << (kernelsVectorized() ? "vectorized" : "scalar");
+    }
+
+    void testEveryAngle() {
+        // The whole input range of sensord, and a turn around it
+        x.clear();
+        y.clear();
+        z.clear();
+        for (int a = -540; a <= 540; a++) {
+            for (int b = -540; b <= 540; b += 7) {
+                x.append(a);
+                y.append(b);
+                z.append(a + b);
+            }
+        }
+        QVector<int> ax = x, ay = y, az = z;
+        QVector<int> bx = x, by = y, bz = z;
+        referenceRotation(ax.data(), ay.data(), az.data(), ax.size());
+        kernelRotationAxes(bx.data(), by.data(), bz.data(), bx.size());
+        QVERIFY(ax == bx);
+        QVERIFY(ay == by);
+        QVERIFY(az == bz);
+
+        ax = x;
+        bx = x;
+        referenceCompass(ax.data(), ax.size());
+        kernelCompassAzimuth(bx.data(), bx.size());
+        QVERIFY(ax == bx);
+    }
+
+    void testReadingRange() {
+        fill(360);
+        compareAll();
+    }
+
+    void testOutOfRange() {
+        // Garbage in, the same garbage out
+        fill(1000000);
+        compareAll();
+    }
+
+    void benchmarkRotation_data() { kernels(); }
+    void benchmarkRotation() {
+        QFETCH(int, kernel);
+        static const RotationKernel functions[] = { referenceRotation, kernelRotationAxesScalar, kernelRotationAxes };
+        fill(180);
+
+        // The conversion keeps readings in range, so it is run in place
+        int iterations = 0;
+        QTime timer;
+        timer.start();
+        QBENCHMARK {
+            iterations++;
+            for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+                functions[kernel](x.data(), y.data(), z.data(), BENCHMARK_SAMPLES);
+            }
+        }
+        report("rotation", iterations, timer.elapsed());
+    }
+
+    void benchmarkCompass_data() { kernels(); }
+    void benchmarkCompass() {
+        QFETCH(int, kernel);
+        static const CompassKernel functions[] = { referenceCompass, kernelCompassAzimuthScalar, kernelCompassAzimuth };
+        fill(180);
+        for (int i = 0; i < SAMPLES; i++) {
+            x[i] += 180;
+        }
+
+        int iterations = 0;
+        QTime timer;
+        timer.start();
+        QBENCHMARK {
+            iterations++;
+            for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+                functions[kernel](x.data(), BENCHMARK_SAMPLES);
+            }
+        }
+        report("compass", iterations, timer.elapsed());
+    }
+
+    void benchmarkAccelerometer_data() { kernels(); }
+    void benchmarkAccelerometer() {
+        QFETCH(int, kernel);
+        static const AccelerometerKernel functions[] = { referenceAccelerometer, kernelAccelerometerAxesScalar, kernelAccelerometerAxes };
+        fill(2000);
+
+        int iterations = 0;
+        QTime timer;
+        timer.start();
+        QBENCHMARK {
+            iterations++;
+            for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+                functions[kernel](x.data(), y.data(), BENCHMARK_SAMPLES);
+            }
+        }
+        report("accelerometer", iterations, timer.elapsed());
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorconversion_benchmark.moc"
@@ -0,0 +1,4 @@
+QT -= gui
+SOURCES += sensorconversion_benchmark.cpp
+TARGET = sensorconversion-benchmark-test
+include(../common-install.pri)
@@ -0,0 +1,128 @@
+/**
+ * @file sensordecimator.cpp
+ * @brief QmSensorDecimator tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QObject>
+#include <QTest>
+
+#include "qmaccelerometer_p.h"
+#include "qmcompass_p.h"
+#include "qmrotation_p.h"
+
+using namespace MeeGo;
+
+static QmAccelerometerReading acceleration(quint64 timestamp, int x)
+{
+    QmAccelerometerReading reading;
+    reading.timestamp = timestamp;
+    reading.x = x;
+    reading.y = -x;
+    reading.z = 1000;
+    return reading;
+}
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testOff() {
+        QmSensorDecimator<QmAccelerometerReading> decimator;
+        for (int i = 0; i < 10; i++) {
+            QmAccelerometerReading reading = acceleration(i * 10000, i);
+            QVERIFY(decimator.add(reading, QmSensor::DecimationOff, 100000));
+            QCOMPARE(reading.x, i);
+            QVERIFY(decimator.add(reading, QmSensor::DecimationLast, 0));
+        }
+    }
+
+    void testExactRate() {
+        // 20 ms samples with jitter reduced to 50 ms intervals
+        QmSensorDecimator<QmAccelerometerReading> decimator;
+        int delivered = 0;
+        for (int i = 0; i < 1000; i++) {
+            QmAccelerometerReading reading = acceleration(i * 20000 + (i % 3) * 1000, i);
+            if (decimator.add(reading, QmSensor::DecimationLast, 50000)) {
+                QCOMPARE(reading.x, i);
+                delivered++;
+            }
+        }
+        QCOMPARE(delivered, 400);
+    }
+
+    void testAverage() {
+        QmSensorDecimator<QmAccelerometerReading> decimator;
+        QmAccelerometerReading reading = acceleration(0, 0);
+        QVERIFY(decimator.add(reading, QmSensor::DecimationAverage, 40000));
+
+        int values[] = { 10, 20, 30, 40 };
+        for (int i = 0; i < 4; i++) {
+            reading = acceleration((i + 1) * 10000, values[i]);
+            QCOMPARE(decimator.add(reading, QmSensor::DecimationAverage, 40000), i == 3);
+        }
+        QCOMPARE(reading.x, 25);
+        QCOMPARE(reading.y, -25);
+        QCOMPARE(reading.z, 1000);
+        QCOMPARE(reading.timestamp, (quint64)40000);
+    }
+
+    void testMaxAbs() {
+        QmSensorDecimator<QmAccelerometerReading> decimator;
+        QmAccelerometerReading reading = acceleration(0, 0);
+        QVERIFY(decimator.add(reading, QmSensor::DecimationMaxAbs, 40000));
+
+        int values[] = { 5, -40, 20, 3 };
+        for (int i = 0; i < 4; i++) {
+            reading = acceleration((i + 1) * 10000, values[i]);
+            decimator.add(reading, QmSensor::DecimationMaxAbs, 40000);
+        }
+        QCOMPARE(reading.x, -40);
+        QCOMPARE(reading.y, 40);
+    }
+
+    void testAngles() {
+        QmSensorDecimator<QmRotationReading> rotation;
+        QmSensorDecimator<QmCompassReading> compass;
+        for (int i = 0; i < 4; i++) {
+            QmRotationReading r;
+            r.timestamp = i * 10000;
+            r.x = 0;
+            r.y = (i % 2) ? 179 : -179;
+            r.z = (i % 2) ? 180 : -178;
+            QmCompassReading c;
+            c.timestamp = i * 10000;
+            c.degrees = (i % 2) ? 359 : 1;
+            c.level = 3;
+            bool due = rotation.add(r, QmSensor::DecimationAverage, 30000);
+            QCOMPARE(compass.add(c, QmSensor::DecimationAverage, 30000), due);
+            if (i == 3) {
+                QVERIFY(due);
+                QCOMPARE(r.y, 180);
+                QCOMPARE(r.z, -179);
+                QCOMPARE(c.degrees, 0);
+                QCOMPARE(c.level, 3);
+            }
+        }
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensordecimator.moc"
@@ -0,0 +1,5 @@
+QT += dbus
+QT -= gui
+SOURCES += sensordecimator.cpp
+TARGET = sensordecimator-test
+include(../common-install.pri)
@@ -0,0 +1,209 @@
+/**
+ * @file sensorfilter_benchmark.cpp
+ * @brief QmSensorFilter kernel equivalence and throughput
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QDebug>
+#include <QObject>
+#include <QTest>
+#include <QTime>
+#include <QVector>
+#include <qmsensorfilter.h>
+
+#include "qmsensorkernels_p.h"
+
+#define SAMPLES 10007
+#define BENCHMARK_SAMPLES 65536
+#define BENCHMARK_ROUNDS 200
+
+using namespace MeeGo;
+
+/* Kernels of one filter type, vectorized and scalar, with the state for both */
+struct KernelPair
+{
+    int type;
+    int window;
+    float state[2];
+    float sum[2];
+    float history[2][KERNEL_AVERAGE_MAX];
+
+    KernelPair(int type, int window, float first) : type(type), window(window)
+    {
+        for (int k = 0; k < 2; k++) {
+            state[k] = first;
+            sum[k] = first * window;
+            for (int i = 0; i < KERNEL_AVERAGE_MAX; i++) {
+                history[k][i] = first;
+            }
+        }
+    }
+
+    void run(int k, float *data, int count)
+    {
+        switch (type) {
+            case QmSensorFilter::LowPass:
+                (k ? kernelLowPassScalar : kernelLowPass)(data, count, 0.1f, &state[k]);
+                break;
+            case QmSensorFilter::MovingAverage:
+                (k ? kernelMovingAverageScalar : kernelMovingAverage)(data, count, window, history[k], &sum[k]);
+                break;
+            case QmSensorFilter::Median:
+                (k ? kernelMedianScalar : kernelMedian)(data, count, window, history[k]);
+                break;
+        }
+    }
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QVector<float> input;
+
+    /* Feeds both kernels the same stream in batches of varying size */
+    float maxDifference(int type, int window)
+    {
+        QVector<float> vector = input;
+        QVector<float> scalar = input;
+        KernelPair kernels(type, window, input[0]);
+        qsrand(window);
+        for (int done = 0; done < SAMPLES; ) {
+            int count = qMin(SAMPLES - done, 1 + qrand() % 150);
+            kernels.run(0, vector.data() + done, count);
+            kernels.run(1, scalar.data() + done, count);
+            done += count;
+        }
+
+        float difference = 0;
+        for (int i = 0; i < SAMPLES; i++) {
+            difference = qMax(difference, qAbs(vector[i] - scalar[i]));
+        }
+        return difference;
+    }
+
+    void benchmark(QmSensorFilter::Type type, float parameter)
+    {
+        QFETCH(int, batch);
+
+        QmSensorFilter filter(type, parameter);
+        QVector<float> x(BENCHMARK_SAMPLES), y(BENCHMARK_SAMPLES), z(BENCHMARK_SAMPLES);
+        for (int i = 0; i < BENCHMARK_SAMPLES; i++) {
+            x[i] = input[i % SAMPLES];
+            y[i] = -input[i % SAMPLES];
+            z[i] = 1000 + input[(i * 7) % SAMPLES];
+        }
+
+        int iterations = 0;
+        QTime timer;
+        timer.start();
+        QBENCHMARK {
+            iterations++;
+            for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+                for (int i = 0; i + batch <= BENCHMARK_SAMPLES; i += batch) {
+                    filter.process(x.data() + i, y.data() + i, z.data() + i, batch);
+                }
+            }
+        }
+        qDebug() << (filter.isVectorized() ? "vectorized" : "scalar") << "batch" << batch << ":"
+                 << timer.elapsed() * 1e6 / ((double)iterations * BENCHMARK_ROUNDS * BENCHMARK_SAMPLES) << "ns per XYZ sample";
+    }
+
+    void batches()
+    {
+        QTest::addColumn<int>("batch");
+        QTest::newRow("1") << 1;
+        QTest::newRow("16") << 16;
+        QTest::newRow("256") << 256;
+    }
+
+private slots:
+    void initTestCase() {
+        qsrand(1);
+        input.resize(SAMPLES);
+        for (int i = 0; i < SAMPLES; i++) {
+            input[i] = qrand() % 2001 - 1000;
+        }
+        qDebug() << "Kernels are" << (QmSensorFilter::isVectorized() ? "vectorized" : "scalar");
+    }
+
+    void testLowPassEquivalence() {
+        // Blocked recurrence rounds differently, stay within float precision
+        QVERIFY(maxDifference(QmSensorFilter::LowPass, 1) < 0.01f);
+    }
+
+    void testMovingAverageEquivalence() {
+        QCOMPARE(maxDifference(QmSensorFilter::MovingAverage, 1), 0.0f);
+        QCOMPARE(maxDifference(QmSensorFilter::MovingAverage, 16), 0.0f);
+        QCOMPARE(maxDifference(QmSensorFilter::MovingAverage, 64), 0.0f);
+    }
+
+    void testMedianEquivalence() {
+        QCOMPARE(maxDifference(QmSensorFilter::Median, 3), 0.0f);
+        QCOMPARE(maxDifference(QmSensorFilter::Median, 5), 0.0f);
+        QCOMPARE(maxDifference(QmSensorFilter::Median, 15), 0.0f);
+    }
+
+    void testMedianRemovesSpike() {
+        QmSensorFilter filter(QmSensorFilter::Median, 3);
+        float x[] = { 10, 10, 900, 10, 10 };
+        float y[] = { 0, 0, 0, 0, 0 };
+        float z[] = { 1, 2, 3, 4, 5 };
+        filter.process(x, y, z, 5);
+        for (int i = 0; i < 5; i++) {
+            QCOMPARE(x[i], 10.0f);
+        }
+        QCOMPARE(z[4], 4.0f);
+    }
+
+    void testHighPassRemovesOffset() {
+        QmSensorFilter filter(QmSensorFilter::HighPass, 0.2f);
+        float x[100], y[100], z[100];
+        for (int i = 0; i < 100; i++) {
+            x[i] = 5;
+            y[i] = -3;
+            z[i] = 1000;
+        }
+        filter.process(x, y, z, 100);
+        QCOMPARE(x[99], 0.0f);
+        QCOMPARE(z[0], 0.0f);
+    }
+
+    void testClamping() {
+        QCOMPARE(QmSensorFilter(QmSensorFilter::Median, 4).parameter(), 5.0f);
+        QCOMPARE(QmSensorFilter(QmSensorFilter::MovingAverage, 1000).parameter(), 64.0f);
+        QCOMPARE(QmSensorFilter(QmSensorFilter::LowPass, 2).parameter(), 1.0f);
+    }
+
+    void benchmarkLowPass_data() { batches(); }
+    void benchmarkLowPass() { benchmark(QmSensorFilter::LowPass, 0.1f); }
+
+    void benchmarkHighPass_data() { batches(); }
+    void benchmarkHighPass() { benchmark(QmSensorFilter::HighPass, 0.1f); }
+
+    void benchmarkMovingAverage_data() { batches(); }
+    void benchmarkMovingAverage() { benchmark(QmSensorFilter::MovingAverage, 16); }
+
+    void benchmarkMedian_data() { batches(); }
+    void benchmarkMedian() { benchmark(QmSensorFilter::Median, 5); }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorfilter_benchmark.moc"
@@ -0,0 +1,4 @@
+QT -= gui
+SOURCES += sensorfilter_benchmark.cpp
+TARGET = sensorfilter-benchmark-test
+include(../common-install.pri)
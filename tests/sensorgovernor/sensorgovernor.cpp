@@ -0,0 +1,197 @@
+/**
+ * @file sensorgovernor.cpp
+ * @brief QmSensorGovernor tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QObject>
+#include <QTest>
+#include <qmaccelerometer.h>
+#include <qmals.h>
+#include <qmcompass.h>
+#include <qmmagnetometer.h>
+#include <qmrotation.h>
+#include <qmsensorgovernor.h>
+
+#include "qmsensorgovernor_p.h"
+
+using namespace MeeGo;
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSettle() {
+        // Still readings with noise: 20 ms doubled every 2 s up to 500 ms
+        QmIntervalGovernor governor;
+        int values[3] = { 0, 0, 1000 };
+        QVERIFY(!governor.add(0, values, 3));
+        QCOMPARE(governor.interval(), GOVERNOR_FASTEST);
+
+        int expected[] = { 40, 80, 160, 320, 500 };
+        int changes = 0;
+        quint64 time = 0;
+        for (int i = 0; i < 600; i++) {
+            time += 20000;
+            values[0] = (i % 3) * 10;
+            if (governor.add(time, values, 3)) {
+                QVERIFY(changes < 5);
+                QCOMPARE(governor.interval(), expected[changes]);
+                changes++;
+            }
+        }
+        QCOMPARE(changes, 5);
+        QCOMPARE(governor.interval(), GOVERNOR_SLOWEST);
+    }
+
+    void testMotion() {
+        QmIntervalGovernor governor;
+        governor.slowest = 100;
+        int values[3] = { 0, 0, 1000 };
+        quint64 time = 0;
+        for (int i = 0; i < 10; i++, time += 1000000) {
+            governor.add(time, values, 3);
+        }
+        QCOMPARE(governor.interval(), 100);
+
+        // Back to the fastest at once, and settles again
+        values[2] = 900;
+        QVERIFY(governor.add(time, values, 3));
+        QCOMPARE(governor.interval(), GOVERNOR_FASTEST);
+        QVERIFY(!governor.add(time + 1000000, values, 3));
+        QVERIFY(governor.add(time + 2000000, values, 3));
+        QCOMPARE(governor.interval(), 40);
+    }
+
+    void testAngles() {
+        QmIntervalGovernor governor;
+        governor.angles = true;
+        int degrees = 359;
+        governor.add(0, &degrees, 1);
+        degrees = 1;
+        QVERIFY(governor.add(2000000, &degrees, 1));
+        QCOMPARE(governor.interval(), 40);
+
+        degrees = 181;
+        QVERIFY(governor.add(2100000, &degrees, 1));
+        QCOMPARE(governor.interval(), GOVERNOR_FASTEST);
+    }
+
+    void testAttach() {
+        QmSensorGovernor governor;
+        QmAccelerometer accelerometer;
+        QmALS als;
+        QVERIFY(governor.attach(&accelerometer));
+        QVERIFY(!governor.attach(&als));
+
+        // One governor per sensor
+        QmSensorGovernor other;
+        QVERIFY(!other.attach(&accelerometer));
+        governor.detach(&accelerometer);
+        QVERIFY(other.attach(&accelerometer));
+    }
+
+    void testRunning() {
+        QmSensorGovernor governor;
+        QmAccelerometer accelerometer;
+        QVERIFY2(accelerometer.requestSession(QmSensor::SessionTypeListen) != QmSensor::SessionTypeNone,
+                 accelerometer.lastError().toLocal8Bit());
+        accelerometer.setInterval(100);
+        QVERIFY(governor.attach(&accelerometer));
+        QVERIFY2(accelerometer.start(), accelerometer.lastError().toLocal8Bit());
+        QVERIFY(accelerometer.isRunning());
+
+        governor.detach(&accelerometer);
+        QCOMPARE(accelerometer.interval(), 100);
+        QVERIFY(accelerometer.stop());
+    }
+
+    void testRunningWithoutInterval() {
+        // The sensor goes back to the interval of the session
+        QmSensorGovernor governor;
+        QmAccelerometer accelerometer;
+        QmAccelerometer other;
+        QVERIFY(governor.attach(&accelerometer));
+        QVERIFY2(accelerometer.requestSession(QmSensor::SessionTypeListen) != QmSensor::SessionTypeNone,
+                 accelerometer.lastError().toLocal8Bit());
+        QVERIFY2(other.requestSession(QmSensor::SessionTypeListen) != QmSensor::SessionTypeNone,
+                 other.lastError().toLocal8Bit());
+        other.setInterval(200);
+        QVERIFY2(accelerometer.start(), accelerometer.lastError().toLocal8Bit());
+        QVERIFY2(other.start(), other.lastError().toLocal8Bit());
+        QCOMPARE(accelerometer.interval(), GOVERNOR_FASTEST);
+
+        // Runs at the only interval asked for then
+        governor.detach(&accelerometer);
+        QCOMPARE(accelerometer.interval(), 200);
+        QVERIFY(accelerometer.stop());
+        QVERIFY(other.stop());
+    }
+
+    void testSettings() {
+        QmSensorGovernor governor;
+        QCOMPARE(governor.fastest(), GOVERNOR_FASTEST);
+        QCOMPARE(governor.slowest(), GOVERNOR_SLOWEST);
+        QCOMPARE(governor.settleTime(), GOVERNOR_SETTLE_TIME);
+
+        governor.setRange(50, 10);
+        QCOMPARE(governor.fastest(), 50);
+        QCOMPARE(governor.slowest(), 50);
+        governor.setSettleTime(500);
+        QCOMPARE(governor.settleTime(), 500);
+    }
+
+    void testThresholds() {
+        // In the units of each sensor
+        QmSensorGovernor governor;
+        QmAccelerometer accelerometer;
+        QmRotation rotation;
+        QmMagnetometer magnetometer;
+        QmCompass compass;
+        QCOMPARE(governor.motionThreshold(&accelerometer), -1);
+        QVERIFY(!governor.setMotionThreshold(&accelerometer, 10));
+
+        QVERIFY(governor.attach(&accelerometer));
+        QVERIFY(governor.attach(&rotation));
+        QVERIFY(governor.attach(&magnetometer));
+        QVERIFY(governor.attach(&compass));
+        QCOMPARE(governor.motionThreshold(&accelerometer), GOVERNOR_THRESHOLD_ACCELERATION);
+        QCOMPARE(governor.motionThreshold(&rotation), GOVERNOR_THRESHOLD_ANGLE);
+        QCOMPARE(governor.motionThreshold(&magnetometer), GOVERNOR_THRESHOLD_FIELD);
+        QCOMPARE(governor.motionThreshold(&compass), GOVERNOR_THRESHOLD_ANGLE);
+
+        QVERIFY(governor.setMotionThreshold(&rotation, 10));
+        QCOMPARE(governor.motionThreshold(&rotation), 10);
+        QCOMPARE(governor.motionThreshold(&compass), GOVERNOR_THRESHOLD_ANGLE);
+        QVERIFY(governor.setMotionThreshold(&rotation, -1));
+        QCOMPARE(governor.motionThreshold(&rotation), 0);
+
+        // Kept over the other settings, gone with the sensor
+        governor.setRange(40, 400);
+        QCOMPARE(governor.motionThreshold(&rotation), 0);
+        governor.detach(&rotation);
+        QCOMPARE(governor.motionThreshold(&rotation), -1);
+        QVERIFY(governor.attach(&rotation));
+        QCOMPARE(governor.motionThreshold(&rotation), GOVERNOR_THRESHOLD_ANGLE);
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorgovernor.moc"
@@ -0,0 +1,6 @@
+QT += dbus
+QT -= gui
+SOURCES += sensorgovernor.cpp
+
+TARGET = sensorgovernor-test
+include(../common-install.pri)
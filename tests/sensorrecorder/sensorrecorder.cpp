@@ -0,0 +1,279 @@
+/**
+ * @file sensorrecorder.cpp
+ * @brief QmSensorRecorder and trace encoding tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <string.h>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QTest>
+#include <QVector>
+#include <qmaccelerometer.h>
+#include <qmals.h>
+#include <qmcompass.h>
+#include <qmfusedorientation.h>
+#include <qmmagnetometer.h>
+#include <qmorientation.h>
+#include <qmproximity.h>
+#include <qmrotation.h>
+#include <qmsensorrecorder.h>
+#include <qmsensorreplay.h>
+#include <qmtap.h>
+
+#include "qmsensorrecorder_p.h"
+
+/* 100 Hz, one minute */
+#define TRACE_READINGS 6000
+#define TRACE_PERIOD 10000 /* us */
+
+using namespace MeeGo;
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString source;
+    QString path;
+    QVector<QmTraceRecord> records;
+    QmSensor *sensors[TraceSensorCount];
+
+    /* A device at rest: small noise around steady values and intervals */
+    static QVector<QmTraceRecord> trace(int readings)
+    {
+        QVector<QmTraceRecord> records;
+        quint64 timestamp = 1000000;
+        for (int i = 0; i < readings; i++) {
+            timestamp += TRACE_PERIOD + (i % 3) - 1;
+            for (int sensor = 0; sensor < TraceSensorCount; sensor++) {
+                QmTraceRecord record;
+                memset(&record, 0, sizeof(record));
+                record.timestamp = timestamp + sensor;
+                record.sensor = sensor;
+                for (int k = 0; k < traceValues(sensor); k++) {
+                    record.values[k] = (sensor + 1) * 100 + ((i * (k + 7)) % 11) - 5;
+                }
+                records.append(record);
+            }
+        }
+        return records;
+    }
+
+    static bool equal(const QVector<QmTraceRecord> &a, const QVector<QmTraceRecord> &b)
+    {
+        return a.size() == b.size()
+            && memcmp(a.constData(), b.constData(), a.size() * sizeof(QmTraceRecord)) == 0;
+    }
+
+    bool startAll(QmSensorReplay &replay, QmSensorRecorder &recorder)
+    {
+        for (int i = 0; i < TraceSensorCount; i++) {
+            if (!replay.attach(sensors[i]) || !recorder.attach(sensors[i]) ||
+                sensors[i]->requestSession(QmSensor::SessionTypeListen) == QmSensor::SessionTypeNone ||
+                !sensors[i]->start()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void detachAll(QmSensorReplay &replay, QmSensorRecorder &recorder)
+    {
+        for (int i = 0; i < TraceSensorCount; i++) {
+            recorder.detach(sensors[i]);
+            replay.detach(sensors[i]);
+        }
+    }
+
+private slots:
+    void initTestCase() {
+        sensors[TraceAccelerometer] = new QmAccelerometer(this);
+        sensors[TraceRotation] = new QmRotation(this);
+        sensors[TraceMagnetometer] = new QmMagnetometer(this);
+        sensors[TraceCompass] = new QmCompass(this);
+        sensors[TraceAls] = new QmALS(this);
+        sensors[TraceProximity] = new QmProximity(this);
+        sensors[TraceOrientation] = new QmOrientation(this);
+        sensors[TraceTap] = new QmTap(this);
+
+        records = trace(TRACE_READINGS);
+        source = QDir::tempPath() + "/sensorrecorder-source-test.trace";
+        path = QDir::tempPath() + "/sensorrecorder-test.trace";
+        QVERIFY(traceSave(source, records));
+    }
+
+    void testEncoding() {
+        QVERIFY(traceSave(path, records, TraceEncodingDelta));
+        QVector<QmTraceRecord> loaded;
+        QVERIFY(traceLoad(path, &loaded));
+        QVERIFY(equal(loaded, records));
+
+        qint64 raw = QFile(source).size();
+        qint64 delta = QFile(path).size();
+        qDebug() << "raw" << raw << "delta" << delta << "bytes,"
+                 << (double)delta / records.size() << "bytes/reading";
+        QVERIFY(delta * 5 < raw);
+
+        // Jumps, wraps and steps back take more bytes but survive
+        QVector<QmTraceRecord> extremes;
+        QmTraceRecord record;
+        memset(&record, 0, sizeof(record));
+        record.sensor = TraceMagnetometer;
+        record.timestamp = Q_UINT64_C(0xffffffffffffff00);
+        for (int k = 0; k < TRACE_VALUES; k++) {
+            record.values[k] = k % 2 ? 2147483647 : -2147483647 - 1;
+        }
+        extremes.append(record);
+        record.timestamp = 5;
+        record.values[0] = 2147483647;
+        record.values[1] = -2147483647 - 1;
+        extremes.append(record);
+        record.timestamp = 4;
+        extremes.append(record);
+        QVERIFY(traceSave(path, extremes, TraceEncodingDelta));
+        QVERIFY(traceLoad(path, &loaded));
+        QVERIFY(equal(loaded, extremes));
+    }
+
+    void testTornTrace() {
+        QVERIFY(traceSave(path, records, TraceEncodingDelta));
+        QFile file(path);
+        QVERIFY(file.resize(file.size() - 1));
+
+        QVector<QmTraceRecord> loaded;
+        QVERIFY(traceLoad(path, &loaded));
+        QCOMPARE(loaded.size(), records.size() - 1);
+        QVERIFY(memcmp(loaded.constData(), records.constData(), loaded.size() * sizeof(QmTraceRecord)) == 0);
+    }
+
+    void testRecordReplay() {
+        QmSensorReplay replay;
+        QmSensorRecorder recorder;
+        QVERIFY(replay.open(source));
+        QVERIFY(recorder.open(path));
+        QVERIFY(recorder.isOpen());
+        QVERIFY(startAll(replay, recorder));
+
+        QCOMPARE(replay.step(replay.count()), records.size());
+        recorder.flush();
+        QCOMPARE(recorder.recorded(), records.size());
+        QCOMPARE(recorder.dropped(), 0);
+        QCOMPARE(recorder.written(), QFile(path).size());
+
+        recorder.close();
+        QVERIFY(!recorder.isOpen());
+        QVector<QmTraceRecord> loaded;
+        QVERIFY(traceLoad(path, &loaded));
+        QVERIFY(equal(loaded, records));
+
+        detachAll(replay, recorder);
+    }
+
+    void testAttach() {
+        QmSensorReplay replay;
+        QmSensorRecorder recorder;
+        QVERIFY(replay.open(source));
+        QVERIFY(recorder.open(path));
+        QVERIFY(startAll(replay, recorder));
+
+        // Stopped sensors are not recorded
+        sensors[TraceRotation]->stop();
+        replay.step(TraceSensorCount);
+        recorder.flush();
+        QCOMPARE(recorder.recorded(), TraceSensorCount - 1);
+
+        // Attaching a running sensor starts recording it
+        QVERIFY(sensors[TraceRotation]->start());
+        recorder.detach(sensors[TraceAccelerometer]);
+        QVERIFY(recorder.attach(sensors[TraceAccelerometer]));
+        recorder.detach(sensors[TraceTap]);
+        replay.step(TraceSensorCount);
+        recorder.flush();
+        QCOMPARE(recorder.recorded(), 2 * TraceSensorCount - 2);
+
+        // Sensors without a sensord sensor of their own can't be recorded
+        QmFusedOrientation fused;
+        QVERIFY(!recorder.attach(&fused));
+
+        detachAll(replay, recorder);
+    }
+
+    void testBoundedBuffer() {
+        QmSensorReplay replay;
+        QmSensorRecorder recorder;
+        recorder.setBufferSize(256);
+        QCOMPARE(recorder.bufferSize(), 256);
+        QVERIFY(replay.open(source));
+        QVERIFY(recorder.open(path));
+        QVERIFY(startAll(replay, recorder));
+
+        // Faster than a file can take it, readings may be dropped
+        QCOMPARE(replay.step(replay.count()), records.size());
+        recorder.close();
+        QCOMPARE(recorder.recorded() + recorder.dropped(), records.size());
+        qDebug() << "dropped" << recorder.dropped() << "of" << records.size();
+
+        // What made it is complete, and consistent after the gaps
+        QVector<QmTraceRecord> loaded;
+        QVERIFY(traceLoad(path, &loaded));
+        QCOMPARE(loaded.size(), recorder.recorded());
+        int next = 0;
+        foreach (const QmTraceRecord &record, loaded) {
+            while (next < records.size() && memcmp(&records[next], &record, sizeof(record)) != 0) {
+                next++;
+            }
+            QVERIFY(next < records.size());
+            next++;
+        }
+
+        detachAll(replay, recorder);
+    }
+
+    void benchmarkRecord() {
+        QmSensorTraceWriter writer;
+        QVERIFY(writer.open(path, RECORDER_BUFFER_SIZE));
+
+        QElapsedTimer elapsed;
+        qint64 count = 0;
+        elapsed.start();
+        QBENCHMARK {
+            for (int i = 0; i < records.size(); i++) {
+                writer.append(records[i]);
+            }
+            count += records.size();
+        }
+        qint64 ns = qMax((qint64)1, elapsed.elapsed()) * 1000000;
+        writer.close();
+        qDebug() << "ns/reading" << ns / count
+                 << "bytes/reading" << (double)writer.written() / writer.recorded()
+                 << "dropped" << writer.dropped();
+    }
+
+    void cleanupTestCase() {
+        QFile::remove(source);
+        QFile::remove(path);
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorrecorder.moc"
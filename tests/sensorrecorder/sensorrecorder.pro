@@ -0,0 +1,6 @@
+QT += dbus
+QT -= gui
+SOURCES += sensorrecorder.cpp
+
+TARGET = sensorrecorder-test
+include(../common-install.pri)
@@ -0,0 +1,327 @@
+/**
+ * @file sensorreplay_benchmark.cpp
+ * @brief Sensor class throughput and latency on replayed traces
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QObject>
+#include <QTest>
+#include <QTimer>
+#include <QVector>
+#include <qmaccelerometer.h>
+#include <qmals.h>
+#include <qmcompass.h>
+#include <qmmagnetometer.h>
+#include <qmorientation.h>
+#include <qmproximity.h>
+#include <qmrotation.h>
+#include <qmsensorreplay.h>
+#include <qmtap.h>
+
+#include "qmsensortrace_p.h"
+
+/* Readings per sensor, 100 Hz */
+#define TRACE_READINGS 2000
+#define TRACE_PERIOD 10000 /* us */
+#define LATENCY_READINGS 100
+
+using namespace MeeGo;
+
+/* Counts the readings of each sensor, see QmTraceSensor */
+class Counter : public QObject {
+    Q_OBJECT
+
+public:
+    Counter(QObject *parent = NULL) : QObject(parent)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (int i = 0; i < TraceSensorCount; i++) {
+            received[i] = 0;
+        }
+        lastAcceleration.timestamp = 0;
+        latencies.clear();
+    }
+
+    int received[TraceSensorCount];
+    QmAccelerometerReading lastAcceleration;
+
+    /* Set to measure the delay of accelerometer readings */
+    QElapsedTimer clock;
+    quint64 origin;
+    double rate;
+    QVector<qint64> latencies;
+
+public slots:
+    void receive(const MeeGo::QmAccelerometerReading& reading) {
+        received[TraceAccelerometer]++;
+        lastAcceleration = reading;
+        if (clock.isValid()) {
+            latencies.append(clock.elapsed() - (qint64)((reading.timestamp - origin) / 1000 / rate));
+        }
+    }
+    void receive(const MeeGo::QmRotationReading&) { received[TraceRotation]++; }
+    void receive(const MeeGo::QmMagnetometerReading&) { received[TraceMagnetometer]++; }
+    void receive(const MeeGo::QmCompassReading&) { received[TraceCompass]++; }
+    void receive(const MeeGo::QmAlsReading&) { received[TraceAls]++; }
+    void receive(const MeeGo::QmProximityReading&) { received[TraceProximity]++; }
+    void receive(const MeeGo::QmOrientationReading&) { received[TraceOrientation]++; }
+    void receive(const MeeGo::QmTapReading&) { received[TraceTap]++; }
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString path;
+    QString shortPath;
+    QmSensor *sensors[TraceSensorCount];
+    Counter counter;
+
+    static QmTraceRecord record(int sensor, quint64 timestamp, int i)
+    {
+        QmTraceRecord r;
+        memset(&r, 0, sizeof(r));
+        r.timestamp = timestamp;
+        r.sensor = sensor;
+        for (int k = 0; k < TRACE_VALUES; k++) {
+            r.values[k] = (i * (k + 3)) % 1000;
+        }
+        // Unsigned and tap values are small enumerations or levels
+        if (sensor >= TraceAls) {
+            r.values[0] = i % 4;
+            r.values[1] = i % 2;
+        }
+        return r;
+    }
+
+    /* All sensors interleaved, as a recorder writes them */
+    static QVector<QmTraceRecord> trace(int readings)
+    {
+        QVector<QmTraceRecord> records;
+        for (int i = 0; i < readings; i++) {
+            for (int sensor = 0; sensor < TraceSensorCount; sensor++) {
+                records.append(record(sensor, 1000000 + (quint64)i * TRACE_PERIOD + sensor, i));
+            }
+        }
+        return records;
+    }
+
+    bool startAll(QmSensorReplay &replay)
+    {
+        for (int i = 0; i < TraceSensorCount; i++) {
+            if (!replay.attach(sensors[i]) ||
+                sensors[i]->requestSession(QmSensor::SessionTypeListen) == QmSensor::SessionTypeNone ||
+                !sensors[i]->start()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void benchmark(int sensor)
+    {
+        QmSensorReplay replay;
+        QVERIFY(replay.open(path));
+        QVERIFY(replay.attach(sensors[sensor]));
+        QVERIFY(sensors[sensor]->requestSession(QmSensor::SessionTypeListen) != QmSensor::SessionTypeNone);
+        QVERIFY(sensors[sensor]->start());
+
+        QElapsedTimer elapsed;
+        qint64 delivered = 0;
+        elapsed.start();
+        QBENCHMARK {
+            replay.rewind();
+            counter.reset();
+            replay.step(replay.count());
+            delivered += counter.received[sensor];
+        }
+        qint64 ns = qMax((qint64)1, elapsed.elapsed()) * 1000000;
+        qDebug() << "readings/s" << delivered * 1000000000 / ns
+                 << "ns/reading" << ns / qMax((qint64)1, delivered);
+
+        replay.detach(sensors[sensor]);
+    }
+
+private slots:
+    void initTestCase() {
+        sensors[TraceAccelerometer] = new QmAccelerometer(this);
+        sensors[TraceRotation] = new QmRotation(this);
+        sensors[TraceMagnetometer] = new QmMagnetometer(this);
+        sensors[TraceCompass] = new QmCompass(this);
+        sensors[TraceAls] = new QmALS(this);
+        sensors[TraceProximity] = new QmProximity(this);
+        sensors[TraceOrientation] = new QmOrientation(this);
+        sensors[TraceTap] = new QmTap(this);
+
+        QVERIFY(connect(sensors[TraceAccelerometer], SIGNAL(dataAvailable(const MeeGo::QmAccelerometerReading&)),
+                        &counter, SLOT(receive(const MeeGo::QmAccelerometerReading&))));
+        QVERIFY(connect(sensors[TraceRotation], SIGNAL(dataAvailable(const MeeGo::QmRotationReading&)),
+                        &counter, SLOT(receive(const MeeGo::QmRotationReading&))));
+        QVERIFY(connect(sensors[TraceMagnetometer], SIGNAL(dataAvailable(const MeeGo::QmMagnetometerReading&)),
+                        &counter, SLOT(receive(const MeeGo::QmMagnetometerReading&))));
+        QVERIFY(connect(sensors[TraceCompass], SIGNAL(dataAvailable(const MeeGo::QmCompassReading)),
+                        &counter, SLOT(receive(const MeeGo::QmCompassReading&))));
+        QVERIFY(connect(sensors[TraceAls], SIGNAL(ALSChanged(const MeeGo::QmAlsReading)),
+                        &counter, SLOT(receive(const MeeGo::QmAlsReading&))));
+        QVERIFY(connect(sensors[TraceProximity], SIGNAL(ProximityChanged(const MeeGo::QmProximityReading)),
+                        &counter, SLOT(receive(const MeeGo::QmProximityReading&))));
+        QVERIFY(connect(sensors[TraceOrientation], SIGNAL(orientationChanged(const MeeGo::QmOrientationReading)),
+                        &counter, SLOT(receive(const MeeGo::QmOrientationReading&))));
+        QVERIFY(connect(sensors[TraceTap], SIGNAL(tapped(const MeeGo::QmTapReading)),
+                        &counter, SLOT(receive(const MeeGo::QmTapReading&))));
+
+        path = QDir::tempPath() + "/sensorreplay-test.trace";
+        shortPath = QDir::tempPath() + "/sensorreplay-short-test.trace";
+        QVERIFY(traceSave(path, trace(TRACE_READINGS)));
+        QVERIFY(traceSave(shortPath, trace(LATENCY_READINGS)));
+    }
+
+    void testOpen() {
+        QmSensorReplay replay;
+        QVERIFY(replay.open(path));
+        QCOMPARE(replay.count(), TRACE_READINGS * TraceSensorCount);
+        QCOMPARE(replay.position(), 0);
+
+        QFile file(QDir::tempPath() + "/sensorreplay-junk-test.trace");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not a sensor trace");
+        file.close();
+        QVERIFY(!replay.open(file.fileName()));
+        QCOMPARE(replay.count(), 0);
+        file.remove();
+    }
+
+    void testStep() {
+        QmSensorReplay replay;
+        QVERIFY(replay.open(path));
+        QVERIFY(startAll(replay));
+        counter.reset();
+
+        QCOMPARE(replay.step(TraceSensorCount), TraceSensorCount);
+        for (int i = 0; i < TraceSensorCount; i++) {
+            QCOMPARE(counter.received[i], 1);
+        }
+
+        // Converted like sensord readings
+        QmTraceRecord first = record(TraceAccelerometer, 0, 0);
+        QCOMPARE(counter.lastAcceleration.x, -first.values[1]);
+        QCOMPARE(counter.lastAcceleration.y, first.values[0]);
+        QCOMPARE(counter.lastAcceleration.timestamp, (quint64)1000000);
+
+        QCOMPARE(replay.step(replay.count()), replay.count() - TraceSensorCount);
+        QCOMPARE(replay.step(1), 0);
+        for (int i = 0; i < TraceSensorCount; i++) {
+            QCOMPARE(counter.received[i], TRACE_READINGS);
+        }
+
+        // The getters serve the replayed readings
+        QmCompass *compass = static_cast<QmCompass*>(sensors[TraceCompass]);
+        QCOMPARE(compass->get().timestamp, (quint64)(1000000 + (TRACE_READINGS - 1) * TRACE_PERIOD + TraceCompass));
+
+        // Stopped sensors don't receive
+        sensors[TraceRotation]->stop();
+        replay.rewind();
+        counter.reset();
+        replay.step(replay.count());
+        QCOMPARE(counter.received[TraceRotation], 0);
+        QCOMPARE(counter.received[TraceAccelerometer], TRACE_READINGS);
+
+        for (int i = 0; i < TraceSensorCount; i++) {
+            replay.detach(sensors[i]);
+            QCOMPARE(sensors[i]->sessionType(), QmSensor::SessionTypeNone);
+        }
+    }
+
+    void testRate() {
+        QmSensorReplay replay;
+        QVERIFY(replay.open(shortPath));
+        QVERIFY(startAll(replay));
+
+        // One second of readings at four times the pace
+        QEventLoop loop;
+        connect(&replay, SIGNAL(finished()), &loop, SLOT(quit()));
+        QTimer::singleShot(5000, &loop, SLOT(quit()));
+
+        counter.reset();
+        counter.origin = 1000000;
+        counter.rate = 4;
+        replay.setRate(4);
+        QElapsedTimer elapsed;
+        elapsed.start();
+        counter.clock.start();
+        QVERIFY(replay.start());
+        loop.exec();
+        qint64 duration = elapsed.elapsed();
+        counter.clock.invalidate();
+
+        QVERIFY(!replay.isRunning());
+        QCOMPARE(replay.position(), replay.count());
+        QCOMPARE(counter.received[TraceAccelerometer], LATENCY_READINGS);
+        QVERIFY2(duration >= (LATENCY_READINGS - 1) * TRACE_PERIOD / 1000 / 4, qPrintable(QString::number(duration)));
+
+        qint64 worst = 0;
+        qint64 total = 0;
+        foreach (qint64 latency, counter.latencies) {
+            worst = qMax(worst, latency);
+            total += latency;
+        }
+        qDebug() << "replay latency ms: mean" << (double)total / counter.latencies.count() << "worst" << worst;
+
+        // As fast as possible
+        replay.rewind();
+        replay.setRate(0);
+        QCOMPARE(replay.rate(), 0.0);
+        counter.reset();
+        QTimer::singleShot(5000, &loop, SLOT(quit()));
+        QVERIFY(replay.start());
+        loop.exec();
+        QCOMPARE(counter.received[TraceTap], LATENCY_READINGS);
+
+        for (int i = 0; i < TraceSensorCount; i++) {
+            replay.detach(sensors[i]);
+        }
+    }
+
+    void benchmarkAccelerometer() { benchmark(TraceAccelerometer); }
+    void benchmarkRotation() { benchmark(TraceRotation); }
+    void benchmarkMagnetometer() { benchmark(TraceMagnetometer); }
+    void benchmarkCompass() { benchmark(TraceCompass); }
+    void benchmarkAls() { benchmark(TraceAls); }
+    void benchmarkProximity() { benchmark(TraceProximity); }
+    void benchmarkOrientation() { benchmark(TraceOrientation); }
+    void benchmarkTap() { benchmark(TraceTap); }
+
+    void cleanupTestCase() {
+        QFile::remove(path);
+        QFile::remove(shortPath);
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorreplay_benchmark.moc"
@@ -0,0 +1,5 @@
+QT += dbus
+QT -= gui
+SOURCES += sensorreplay_benchmark.cpp
+TARGET = sensorreplay-benchmark-test
+include(../common-install.pri)
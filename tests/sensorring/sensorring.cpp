@@ -0,0 +1,187 @@
+/**
+ * @file sensorring.cpp
+ * @brief QmSensorRing tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <poll.h>
+#include <QObject>
+#include <QThread>
+#include <QTest>
+#include <qmaccelerometer.h>
+
+#include "qmsensor_p.h"
+#include "qmsensorring_p.h"
+
+#define THREADED_READINGS 200000
+
+using namespace MeeGo;
+
+static QmAccelerometerReading reading(int i)
+{
+    QmAccelerometerReading r;
+    r.timestamp = i;
+    r.x = i;
+    r.y = -i;
+    r.z = 2 * i;
+    return r;
+}
+
+static bool readable(int fd)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) == 1;
+}
+
+class Consumer : public QThread
+{
+public:
+    Consumer(QmSensorRing *ring) : ring(ring), received(0), misordered(0) {}
+
+    QmSensorRing *ring;
+    int received;
+    int misordered;
+
+protected:
+    void run() {
+        QmAccelerometerReading readings[32];
+        quint64 expected = 0;
+        while (received < THREADED_READINGS) {
+            int count = ring->pop(readings, sizeof(readings[0]), 32);
+            if (count == 0) {
+                struct pollfd pfd = { ring->fd(), POLLIN, 0 };
+                poll(&pfd, 1, 100);
+                continue;
+            }
+            for (int i = 0; i < count; i++) {
+                if (readings[i].timestamp != expected || readings[i].y != -(int)expected) {
+                    misordered++;
+                }
+                expected++;
+            }
+            received += count;
+        }
+    }
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCapacity() {
+        QmSensorRing ring;
+        QVERIFY(!ring.isOpen());
+        QCOMPARE(ring.fd(), -1);
+        QVERIFY(ring.open(100));
+        QCOMPARE(ring.capacity(), 128);
+        QVERIFY(ring.fd() >= 0);
+        ring.close();
+        QVERIFY(!ring.isOpen());
+    }
+
+    void testPushPop() {
+        QmSensorRing ring;
+        QVERIFY(ring.open(8));
+        QVERIFY(!readable(ring.fd()));
+
+        QmAccelerometerReading out[8];
+        QCOMPARE(ring.pop(out, sizeof(out[0]), 8), 0);
+
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < 5; i++) {
+                QmAccelerometerReading in = reading(round * 5 + i);
+                QVERIFY(ring.push(&in, sizeof(in)));
+            }
+            QVERIFY(readable(ring.fd()));
+            QCOMPARE(ring.pop(out, sizeof(out[0]), 3), 3);
+            QCOMPARE(ring.pop(out + 3, sizeof(out[0]), 8), 2);
+            for (int i = 0; i < 5; i++) {
+                QCOMPARE(out[i].timestamp, (quint64)(round * 5 + i));
+                QCOMPARE(out[i].z, 2 * (round * 5 + i));
+            }
+            QCOMPARE(ring.pop(out, sizeof(out[0]), 8), 0);
+            QVERIFY(!readable(ring.fd()));
+        }
+    }
+
+    void testOverflow() {
+        QmSensorRing ring;
+        QVERIFY(ring.open(4));
+        for (int i = 0; i < 6; i++) {
+            QmAccelerometerReading in = reading(i);
+            QCOMPARE(ring.push(&in, sizeof(in)), i < 4);
+        }
+        QCOMPARE(ring.dropped(), (quint32)2);
+
+        QmAccelerometerReading out[8];
+        QCOMPARE(ring.pop(out, sizeof(out[0]), 8), 4);
+        QCOMPARE(out[3].timestamp, (quint64)3);
+    }
+
+    void testSizeMismatch() {
+        QmSensorRing ring;
+        QVERIFY(ring.open(4));
+        QmAccelerometerReading in = reading(1);
+        QVERIFY(ring.push(&in, sizeof(in)));
+
+        QmIntReading out[4];
+        QCOMPARE(ring.pop(out, sizeof(out[0]), 4), -1);
+    }
+
+    void testThreaded() {
+        QmSensorRing ring;
+        QVERIFY(ring.open(256));
+
+        Consumer consumer(&ring);
+        consumer.start();
+        for (int i = 0; i < THREADED_READINGS; ) {
+            QmAccelerometerReading in = reading(i);
+            if (ring.push(&in, sizeof(in))) {
+                i++;
+            } else {
+                QThread::yieldCurrentThread();
+            }
+        }
+        QVERIFY(consumer.wait(10000));
+
+        QCOMPARE(consumer.received, THREADED_READINGS);
+        QCOMPARE(consumer.misordered, 0);
+    }
+
+    void testConsumerMode() {
+        QmAccelerometer sensor;
+        QVERIFY(!sensor.consumerMode());
+        QCOMPARE(sensor.consumerFd(), -1);
+
+        QVERIFY(sensor.setConsumerMode(64));
+        QVERIFY(sensor.consumerMode());
+        QVERIFY(sensor.consumerFd() >= 0);
+
+        QmAccelerometerReading out[4];
+        QCOMPARE(sensor.read(out, 4), 0);
+
+        QVERIFY(sensor.setConsumerMode(0));
+        QVERIFY(!sensor.consumerMode());
+        QCOMPARE(sensor.read(out, 4), -1);
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorring.moc"
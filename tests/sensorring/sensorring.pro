@@ -0,0 +1,5 @@
+QT += dbus
+QT -= gui
+SOURCES += sensorring.cpp
+TARGET = sensorring-test
+include(../common-install.pri)
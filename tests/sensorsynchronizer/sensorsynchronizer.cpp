@@ -0,0 +1,194 @@
+/**
+ * @file sensorsynchronizer.cpp
+ * @brief QmSensorSynchronizer tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QList>
+#include <QObject>
+#include <QTest>
+#include <qmsensorsynchronizer.h>
+
+#include "qmsensorsynchronizer_p.h"
+
+using namespace MeeGo;
+
+class SignalDump : public QObject {
+    Q_OBJECT
+
+public:
+    SignalDump(QObject *parent = NULL) : QObject(parent) {}
+
+    QList<QmSynchronizedReading> frames;
+
+public slots:
+    void receive(const MeeGo::QmSynchronizedReading& frame) {
+        frames.append(frame);
+    }
+};
+
+static QmAccelerometerReading acceleration(quint64 timestamp, int x)
+{
+    QmAccelerometerReading reading;
+    reading.timestamp = timestamp;
+    reading.x = x;
+    reading.y = reading.z = 0;
+    return reading;
+}
+
+static QmMagnetometerReading magneticField(quint64 timestamp, int x)
+{
+    QmMagnetometerReading reading;
+    reading.timestamp = timestamp;
+    reading.x = x;
+    reading.y = reading.z = 0;
+    reading.rx = reading.ry = reading.rz = 0;
+    reading.level = 3;
+    return reading;
+}
+
+static QmRotationReading rotation(quint64 timestamp, int y)
+{
+    QmRotationReading reading;
+    reading.timestamp = timestamp;
+    reading.x = reading.z = 0;
+    reading.y = y;
+    return reading;
+}
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QmSensorSynchronizerPrivate *priv;
+    SignalDump *signalDump;
+
+private slots:
+    void init() {
+        priv = new QmSensorSynchronizerPrivate();
+        signalDump = new SignalDump();
+        QVERIFY(connect(priv, SIGNAL(frameAvailable(const MeeGo::QmSynchronizedReading&)),
+                        signalDump, SLOT(receive(const MeeGo::QmSynchronizedReading&))));
+    }
+
+    void cleanup() {
+        delete priv;
+        delete signalDump;
+    }
+
+    void testFollowFirst() {
+        // Accelerometer at 100 Hz, magnetometer at 50 Hz and 3 ms late
+        priv->sources = QmSensorSynchronizer::Acceleration | QmSensorSynchronizer::MagneticField;
+        for (int i = 0; i < 20; i++) {
+            quint64 time = 10000 + i * 10000;
+            priv->slotAcceleration(acceleration(time, time / 1000));
+            if (i % 2 == 0) {
+                priv->slotMagneticField(magneticField(time + 3000, (time + 3000) / 100));
+            }
+        }
+
+        // The last accelerometer reading waits for the magnetometer
+        QCOMPARE(signalDump->frames.count(), 19);
+        for (int i = 0; i < signalDump->frames.count(); i++) {
+            const QmSynchronizedReading& frame = signalDump->frames[i];
+            QCOMPARE(frame.timestamp, (quint64)(10000 + i * 10000));
+            QCOMPARE(frame.sources, (int)(QmSensorSynchronizer::Acceleration | QmSensorSynchronizer::MagneticField));
+            QCOMPARE(frame.acceleration.x, (int)(frame.timestamp / 1000));
+            QCOMPARE(frame.acceleration.timestamp, frame.timestamp);
+            QCOMPARE(frame.magneticField.timestamp, frame.timestamp);
+            if (i > 0) {
+                QCOMPARE(frame.magneticField.x, (int)(frame.timestamp / 100));
+            }
+        }
+    }
+
+    void testTimebase() {
+        // Upsampled, across the wrap-around point
+        priv->sources = QmSensorSynchronizer::Rotation;
+        priv->interval = 5000;
+        priv->slotRotation(rotation(100000, 170));
+        priv->slotRotation(rotation(110000, -170));
+        QCOMPARE(signalDump->frames.count(), 3);
+        QCOMPARE(signalDump->frames[1].timestamp, (quint64)105000);
+        QCOMPARE(signalDump->frames[1].rotation.y, 180);
+        QCOMPARE(signalDump->frames[2].rotation.y, -170);
+    }
+
+    void testLatency() {
+        // The magnetometer never delivers
+        priv->sources = QmSensorSynchronizer::Acceleration | QmSensorSynchronizer::MagneticField;
+        priv->latency = 20000;
+        for (int i = 0; i < 5; i++) {
+            priv->slotAcceleration(acceleration(10000 + i * 10000, i));
+        }
+        QCOMPARE(signalDump->frames.count(), 3);
+        QCOMPARE(signalDump->frames[0].sources, (int)QmSensorSynchronizer::Acceleration);
+
+        // Late readings are still used where frames wait for them
+        priv->slotMagneticField(magneticField(40000, 1));
+        QCOMPARE(signalDump->frames.count(), 4);
+        QCOMPARE(signalDump->frames[3].sources, (int)(QmSensorSynchronizer::Acceleration | QmSensorSynchronizer::MagneticField));
+    }
+
+    void testGap() {
+        priv->sources = QmSensorSynchronizer::Acceleration;
+        priv->interval = 10000;
+        for (int i = 0; i < 3; i++) {
+            priv->slotAcceleration(acceleration(10000 + i * 10000, i));
+        }
+        for (int i = 0; i < 3; i++) {
+            priv->slotAcceleration(acceleration(10000000 + i * 10000, i));
+        }
+        QCOMPARE(signalDump->frames.count(), 6);
+        QCOMPARE(signalDump->frames[3].timestamp, (quint64)10000000);
+    }
+
+    void testBounded() {
+        // A stalled stream does not hold more than the buffer
+        priv->sources = QmSensorSynchronizer::Acceleration | QmSensorSynchronizer::Rotation;
+        priv->latency = 1000000000;
+        priv->slotRotation(rotation(10000, 0));
+        for (int i = 0; i < 10 * SYNC_BUFFER_MAX; i++) {
+            priv->slotAcceleration(acceleration(10000 + i * 10000, i));
+            QVERIFY(priv->acceleration.count() <= SYNC_BUFFER_MAX);
+        }
+        QVERIFY(signalDump->frames.count() > 8 * SYNC_BUFFER_MAX);
+    }
+
+    void testSensors() {
+        QmSensorSynchronizer synchronizer;
+        synchronizer.setInterval(20);
+        QCOMPARE(synchronizer.interval(), 20);
+        synchronizer.setLatency(100);
+        QCOMPARE(synchronizer.latency(), 100);
+
+        QmAccelerometer *accelerometer = new QmAccelerometer();
+        QmRotation *rotationSensor = new QmRotation();
+        synchronizer.setAccelerometer(accelerometer);
+        synchronizer.setRotation(rotationSensor);
+        delete accelerometer;
+        synchronizer.setRotation(NULL);
+        delete rotationSensor;
+        synchronizer.reset();
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorsynchronizer.moc"
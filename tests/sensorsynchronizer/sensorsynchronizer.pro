@@ -0,0 +1,6 @@
+QT += dbus
+QT -= gui
+SOURCES += sensorsynchronizer.cpp
+
+TARGET = sensorsynchronizer-test
+include(../common-install.pri)
@@ -0,0 +1,212 @@
+/**
+ * @file sensorthread.cpp
+ * @brief QmSensor::setDeliveryThread() tests
+
+   <p>
+   Copyright (C) 2009-2011 Nokia Corporation
+
+   This file is part of SystemSW QtAPI.
+
+   SystemSW QtAPI is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License
+   version 2.1 as published by the Free Software Foundation.
+
+   SystemSW QtAPI is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with SystemSW QtAPI.  If not, see <http://www.gnu.org/licenses/>.
+   </p>
+ */
+#include <QMutex>
+#include <QObject>
+#include <QTest>
+#include <QThread>
+#include <QTime>
+#include <qmaccelerometer.h>
+#include <qmfusedorientation.h>
+#include <qmsensorfilter.h>
+#include <qmsensorgovernor.h>
+
+using namespace MeeGo;
+
+/* Lives on the worker thread and notes where the readings arrive */
+class SignalDump : public QObject {
+    Q_OBJECT
+
+public:
+    SignalDump() : received(0), elsewhere(0) {}
+
+    int count() {
+        QMutexLocker locker(&mutex);
+        return received;
+    }
+
+    int wrongThread() {
+        QMutexLocker locker(&mutex);
+        return elsewhere;
+    }
+
+public slots:
+    void receive(const MeeGo::QmAccelerometerReading&) {
+        note();
+    }
+
+    void receive(const MeeGo::QmFusedOrientationReading&) {
+        note();
+    }
+
+private:
+    void note() {
+        QMutexLocker locker(&mutex);
+        received++;
+        if (QThread::currentThread() != thread()) {
+            elsewhere++;
+        }
+    }
+
+    QMutex mutex;
+    int received;
+    int elsewhere;
+};
+
+class TestClass : public QObject
+{
+    Q_OBJECT
+
+private:
+    QThread worker;
+
+private slots:
+    void initTestCase() {
+        worker.start();
+    }
+
+    void testMove() {
+        QmAccelerometer sensor;
+        QVERIFY2(sensor.setDeliveryThread(&worker), sensor.lastError().toLocal8Bit());
+        QCOMPARE(sensor.thread(), &worker);
+
+        // Not from another thread than the one of the sensor
+        QVERIFY(!sensor.setDeliveryThread(QThread::currentThread()));
+    }
+
+    void testParent() {
+        // Qt moves no objects with a parent
+        QObject parent;
+        QmAccelerometer *sensor = new QmAccelerometer(&parent);
+        QVERIFY(!sensor->setDeliveryThread(&worker));
+        QCOMPARE(sensor->thread(), QThread::currentThread());
+    }
+
+    void testSessionOpen() {
+        QmAccelerometer sensor;
+        QVERIFY2(sensor.requestSession(QmSensor::SessionTypeListen) != QmSensor::SessionTypeNone,
+                 sensor.lastError().toLocal8Bit());
+        QVERIFY(!sensor.setDeliveryThread(&worker));
+        QCOMPARE(sensor.thread(), QThread::currentThread());
+    }
+
+    void testDelivery() {
+        QmAccelerometer *sensor = new QmAccelerometer();
+        SignalDump dump;
+        dump.moveToThread(&worker);
+        QVERIFY(sensor->setDeliveryThread(&worker));
+        QVERIFY(connect(sensor, SIGNAL(dataAvailable(const MeeGo::QmAccelerometerReading&)),
+                        &dump, SLOT(receive(const MeeGo::QmAccelerometerReading&))));
+
+        // Called from here, carried out on the worker
+        QVERIFY2(sensor->requestSession(QmSensor::SessionTypeListen) != QmSensor::SessionTypeNone,
+                 sensor->lastError().toLocal8Bit());
+        sensor->setInterval(20);
+        QCOMPARE(sensor->interval(), 20);
+        QVERIFY2(sensor->start(), sensor->lastError().toLocal8Bit());
+        QVERIFY(sensor->isRunning());
+
+        // Readings keep coming while this thread is busy
+        QTime busy;
+        busy.start();
+        while (busy.elapsed() < 500) {
+        }
+        QVERIFY(dump.count() > 0);
+
+        QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
+        QCOMPARE(dump.wrongThread(), 0);
+        delete sensor;
+    }
+
+    void testComposite() {
+        QmFusedOrientation *sensor = new QmFusedOrientation();
+        SignalDump dump;
+        dump.moveToThread(&worker);
+        QVERIFY(sensor->setDeliveryThread(&worker));
+        QVERIFY(connect(sensor, SIGNAL(dataAvailable(const MeeGo::QmFusedOrientationReading&)),
+                        &dump, SLOT(receive(const MeeGo::QmFusedOrientationReading&))));
+
+        QVERIFY2(sensor->requestSession(QmSensor::SessionTypeListen) != QmSensor::SessionTypeNone,
+                 sensor->lastError().toLocal8Bit());
+        QVERIFY2(sensor->start(), sensor->lastError().toLocal8Bit());
+        QTest::qWait(500);
+        QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
+        QCOMPARE(dump.wrongThread(), 0);
+        delete sensor;
+    }
+
+    void testSettings() {
+        // Set from here, carried out on the worker
+        QmAccelerometer *sensor = new QmAccelerometer();
+        QVERIFY(sensor->setDeliveryThread(&worker));
+        sensor->setDecimation(QmSensor::DecimationAverage);
+        QCOMPARE(sensor->decimation(), QmSensor::DecimationAverage);
+        QVERIFY(sensor->setConsumerMode(16));
+        QVERIFY(sensor->consumerMode());
+        QVERIFY(sensor->setConsumerMode(0));
+        QVERIFY(!sensor->consumerMode());
+        sensor->setBatchSize(8, 100);
+        QCOMPARE(sensor->batchSize(), 8);
+        sensor->setBatchSize(0, 0);
+        QCOMPARE(sensor->batchSize(), 0);
+
+        QmSensorFilter filter(QmSensorFilter::LowPass, 0.5);
+        sensor->addFilter(&filter);
+        sensor->removeFilter(&filter);
+        delete sensor;
+    }
+
+    void testGovernor() {
+        // The governor works on its channel on the worker
+        QmAccelerometer *sensor = new QmAccelerometer();
+        QVERIFY(sensor->setDeliveryThread(&worker));
+        QVERIFY2(sensor->requestSession(QmSensor::SessionTypeListen) != QmSensor::SessionTypeNone,
+                 sensor->lastError().toLocal8Bit());
+        sensor->setInterval(100);
+        QVERIFY2(sensor->start(), sensor->lastError().toLocal8Bit());
+
+        QmSensorGovernor *governor = new QmSensorGovernor();
+        QVERIFY(governor->attach(sensor));
+        QVERIFY(governor->setMotionThreshold(sensor, 10));
+        QCOMPARE(governor->motionThreshold(sensor), 10);
+        governor->setRange(40, 200);
+        QTest::qWait(500);
+
+        // Gone while the sensor runs, it leaves the interval as it was
+        delete governor;
+        QCOMPARE(sensor->interval(), 100);
+        QmSensorGovernor other;
+        QVERIFY(other.attach(sensor));
+        other.detach(sensor);
+
+        QVERIFY2(sensor->stop(), sensor->lastError().toLocal8Bit());
+        delete sensor;
+    }
+
+    void cleanupTestCase() {
+        worker.quit();
+        worker.wait();
+    }
+};
+
+QTEST_MAIN(TestClass)
+#include "sensorthread.moc"
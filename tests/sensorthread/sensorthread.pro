@@ -0,0 +1,6 @@
+QT += dbus
+QT -= gui
+SOURCES += sensorthread.cpp
+
+TARGET = sensorthread-test
+include(../common-install.pri)
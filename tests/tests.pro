@@ -4,11 +4,14 @@ TEMPLATE = subdirs
 SUBDIRS = accelerometer \
           activity \
           als \
+          batteryhistory \
           cabc \
           callstate \
           compass \
           devicemode \
           displaystate \
+          fusedorientation \
+          gesture \
           heartbeat \
           hw_keys \
           led \
@@ -16,7 +19,19 @@ SUBDIRS = accelerometer \
           orientation \
           proximity \
           rotation \
+          sensorarena \
+          sensorcache \
+          sensorconversion_benchmark \
+          sensordecimator \
+          sensorfilter_benchmark \
+          sensorgovernor \
+          sensorrecorder \
+          sensorreplay_benchmark \
+          sensorring \
+          sensorsynchronizer \
+          sensorthread \
           magnetometer \
+          magnetometercalibration \
           system \
           systeminformation \
           systemsignals \
@@ -39,7 +54,18 @@ SUBDIRS = accelerometer \
           manual_usbmode \
           manual_tap\
           usbmode \
-	  powerontime
+	  powerontime \
+          battery_simulator
+
+# QmBattery on the battery simulator, needs the library built with
+# CONFIG+=bmesim
+bmesim {
+    SUBDIRS += batterycharger \
+               batteryenergy \
+               batterymeasurement \
+               batterystat \
+               battery_benchmark
+}
 
 linux-g++-maemo {
     SUBDIRS += battery \